@@ -0,0 +1,333 @@
+/*
+
+  Aggregate
+
+  How one thread reduces its range as a balanced tree without
+  building the tree:
+
+    partial[level] holds the result of 2^level groups, like the
+    digits of a binary counter. Each new group is carried upwards,
+    combined with every full level it meets, and left in the first
+    empty one. At the end the levels are combined from the bottom.
+
+  A group is AGGREGATE_GROUP fractions, combined with 64 bit
+  numbers (reducing each step). If a group overflows, it is done
+  again with Bignums.
+
+*/
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "Software.h"
+#include "Bignum.h"
+#include "Aggregate.h"
+
+/*
+
+  Fractions per group worked out in 64 bits
+
+*/
+
+#define AGGREGATE_GROUP 16
+
+/*
+
+  Fewest fractions worth a thread of their own
+
+*/
+
+#define AGGREGATE_PER_THREAD 16384
+
+/*
+
+  Most threads used
+
+*/
+
+#define AGGREGATE_MAX_THREADS 64
+
+/*
+
+  Levels of partial results, enough for 2^64 groups
+
+*/
+
+#define AGGREGATE_LEVELS 64
+
+/*
+
+  One thread's share of the store
+
+  Type: AggregateWorker
+
+*/
+
+typedef struct {
+
+  // Multiply instead of add
+  int product;
+
+  // Indexes first to last - 1 of the store
+  int first;
+  int last;
+
+  BigFraction result;
+
+  // The caller's session, whose store the worker reads
+  Session *session;
+
+}
+AggregateWorker;
+
+static uint64_t gcd64(uint64_t a, uint64_t b) {
+
+  while (b) {
+    uint64_t t = a % b;
+    a = b;
+    b = t;
+  }
+
+  return a;
+}
+
+static uint64_t size64(int64_t a) {
+  return a < 0 ? -(uint64_t) a : (uint64_t) a;
+}
+
+/*
+
+  n/d = n/d + or * n2/d2, everything reduced, denominators above 0.
+  Returns 0 if it doesn't fit in 64 bits.
+
+*/
+
+static int combineSmall(int64_t *n, int64_t *d, int64_t n2, int64_t d2, const int product) {
+
+  int64_t numerator, denominator;
+
+  if (product) {
+
+    // 0 times anything
+    if (!*n || !n2) {
+      *n = 0;
+      *d = 1;
+      return 1;
+    }
+
+    int64_t g1 = (int64_t) gcd64(size64(*n), (uint64_t) d2);
+    int64_t g2 = (int64_t) gcd64(size64(n2), (uint64_t) *d);
+
+    if (
+      __builtin_mul_overflow(*n / g1, n2 / g2, &numerator) ||
+      __builtin_mul_overflow(*d / g2, d2 / g1, &denominator))
+      return 0;
+  }
+  else {
+
+    int64_t g = (int64_t) gcd64((uint64_t) *d, (uint64_t) d2);
+    int64_t left, right;
+
+    if (
+      __builtin_mul_overflow(*n, d2 / g, &left) ||
+      __builtin_mul_overflow(n2, *d / g, &right) ||
+      __builtin_add_overflow(left, right, &numerator) ||
+      __builtin_mul_overflow(*d / g, d2, &denominator))
+      return 0;
+
+    int64_t common = (int64_t) gcd64(size64(numerator), (uint64_t) denominator);
+
+    numerator /= common;
+    denominator /= common;
+  }
+
+  *n = numerator;
+  *d = denominator;
+
+  return 1;
+}
+
+static void combine(BigFraction *r, const BigFraction *a, const BigFraction *b, const int product) {
+
+  if (product)
+    Bignums->fractionMultiply(r, a, b);
+  else
+    Bignums->fractionAdd(r, a, b);
+}
+
+/*
+
+  Sets group to the fractions at first to last - 1.
+  0/0 (reserved but not filled in yet) is skipped.
+
+*/
+
+static void reduceGroup(BigFraction *group, const int first, const int last, const int product) {
+
+  int64_t n = product, d = 1;
+  int i;
+
+  for (i = first; i < last; i++) {
+
+    Fraction *f = Fractions->get(i);
+
+    if (!f->denomenator)
+      continue;
+
+    int64_t n2 = f->denomenator < 0 ? -(int64_t) f->numerator : f->numerator;
+    int64_t d2 = f->denomenator < 0 ? -(int64_t) f->denomenator : f->denomenator;
+    int64_t common = (int64_t) gcd64(size64(n2), (uint64_t) d2);
+
+    if (!combineSmall(&n, &d, n2 / common, d2 / common, product))
+      break;
+  }
+
+  Bignums->fractionSet(group, n, d);
+
+  // Too big for 64 bits, the rest of the group one by one
+  if (i < last) {
+
+    BigFraction f;
+
+    Bignums->fractionInit(&f);
+
+    for (; i < last; i++) {
+
+      Fraction *g = Fractions->get(i);
+
+      if (!g->denomenator)
+        continue;
+
+      Bignums->fractionSet(&f, g->numerator, g->denomenator);
+      combine(group, group, &f, product);
+    }
+
+    Bignums->fractionFree(&f);
+  }
+}
+
+static void *reduceRange(void *argument) {
+
+  AggregateWorker *w = argument;
+
+  Sessions->use(w->session);
+
+  BigFraction partial[AGGREGATE_LEVELS] = { 0 };
+  BigFraction group;
+  uint64_t full = 0;
+
+  Bignums->fractionInit(&group);
+
+  for (int first = w->first; first < w->last; first += AGGREGATE_GROUP) {
+
+    int last = w->last - first < AGGREGATE_GROUP ? w->last : first + AGGREGATE_GROUP;
+
+    reduceGroup(&group, first, last, w->product);
+
+    // Carry it up to the first empty level
+    int level = 0;
+
+    while (full & (1ULL << level)) {
+      combine(&group, &partial[level], &group, w->product);
+      full &= ~(1ULL << level);
+      level++;
+    }
+
+    BigFraction t = partial[level];
+    partial[level] = group;
+    group = t;
+
+    full |= 1ULL << level;
+  }
+
+  // What is left, smallest first
+  Bignums->fractionSet(&w->result, w->product, 1);
+
+  for (int level = 0; level < AGGREGATE_LEVELS; level++)
+    if (full & (1ULL << level))
+      combine(&w->result, &partial[level], &w->result, w->product);
+
+  for (int level = 0; level < AGGREGATE_LEVELS; level++)
+    Bignums->fractionFree(&partial[level]);
+
+  Bignums->fractionFree(&group);
+
+  return NULL;
+}
+
+/*
+
+  Number of threads to use for count fractions
+
+*/
+
+static int threadsFor(const int count) {
+
+  int threads = Software->Threads();
+  int useful = count / AGGREGATE_PER_THREAD;
+
+  if (threads > useful)
+    threads = useful;
+
+  if (threads > AGGREGATE_MAX_THREADS)
+    threads = AGGREGATE_MAX_THREADS;
+
+  return threads < 1 ? 1 : threads;
+}
+
+static void reduceStore(BigFraction *result, const int product) {
+
+  int count = Fractions->count();
+  int threads = threadsFor(count);
+
+  AggregateWorker workers[AGGREGATE_MAX_THREADS];
+
+  for (int t = 0; t < threads; t++) {
+
+    workers[t] = (AggregateWorker) {
+      product,
+      (int) ((long) count * t / threads),
+      (int) ((long) count * (t + 1) / threads),
+      { BIGNUM_ZERO, BIGNUM_ZERO },
+      Sessions->current()
+    };
+
+    Bignums->fractionInit(&workers[t].result);
+  }
+
+  // Worker 0 runs on this thread, the rest get their own
+  Software->RunWorkers(&reduceRange, workers, sizeof *workers, threads);
+
+  // The threads' results are combined in pairs too
+  for (int step = 1; step < threads; step *= 2)
+    for (int t = 0; t + step < threads; t += 2 * step)
+      combine(&workers[t].result, &workers[t].result, &workers[t + step].result, product);
+
+  BigFraction swap = *result;
+  *result = workers[0].result;
+  workers[0].result = swap;
+
+  for (int t = 0; t < threads; t++)
+    Bignums->fractionFree(&workers[t].result);
+}
+
+static void sum(BigFraction *result) {
+  reduceStore(result, 0);
+}
+
+static void product(BigFraction *result) {
+  reduceStore(result, 1);
+}
+
+/*
+
+  Abstraction, same as in Software.c
+
+*/
+
+const static aggregator AggregateFunctions = {
+  &sum,
+  &product
+};
+
+const aggregator *restrict Aggregate = &AggregateFunctions;
@@ -0,0 +1,67 @@
+/*
+
+  Aggregate
+
+  Adds up, or multiplies together, every fraction in the
+  fractions data base, exactly.
+
+  Folding them left to right, a/b + c/d + e/f + ..., makes one
+  operand grow with every step while the other stays small. Instead
+  they are combined in pairs, then pairs of pairs, and so on (a
+  balanced tree), so both sides of every step are about the same size
+  and each partial result stays as small as it can. The store is
+  cut into one range per thread (Software->Threads()), and the
+  partial results of the threads are combined the same way.
+
+  Small groups are worked out with 64 bit numbers, anything bigger
+  with Bignum.h, so the result never overflows.
+
+*/
+
+#ifndef AGGREGATE
+#define AGGREGATE
+
+#include "Bignum.h"
+
+typedef struct {
+
+  /*
+
+    void sum(BigFraction *result)
+
+    Sets result (started with Bignums->fractionInit()) to
+    the sum of every stored fraction, 0/1 if there are none.
+
+    Access: Aggregate->sum()
+
+  */
+
+  void(*const sum)(BigFraction *result);
+
+  /*
+
+    void product(BigFraction *result)
+
+    Sets result (started with Bignums->fractionInit()) to
+    the product of every stored fraction, 1/1 if there are none.
+
+    Access: Aggregate->product()
+
+  */
+
+  void(*const product)(BigFraction *result);
+
+}
+aggregator;
+
+/*
+
+  Call this, Aggregate, to access all
+  the publicly available functions.
+
+*/
+
+extern
+const aggregator * restrict Aggregate;
+
+#endif //Aggregate.h
@@ -0,0 +1,239 @@
+/*
+
+  Approximate
+
+  The continued fraction of x, x = a0 + 1/(a1 + 1/(a2 + ...)),
+  gives its convergents h/k:
+
+    h(n) = a(n) h(n - 1) + h(n - 2)
+    k(n) = a(n) k(n - 1) + k(n - 2)
+
+  Each term a(n) is a run of a(n) steps in the same direction down
+  the Stern-Brocot tree, taken at once.
+
+  closest(): the convergents are the best approximations, and when
+  the next one's denominator is too big, the only other candidate is
+  the biggest in-between fraction (semiconvergent) of that run that
+  still fits, so the nearer of the two is the answer.
+
+  simplest(): the continued fractions of both ends of the range are
+  followed while they agree, the first term where they don't is
+  replaced by the smallest whole number between them, that is
+  where the range's subtree is rooted.
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <limits.h>
+#include <math.h>
+
+#include "Software.h"
+#include "Approximate.h"
+
+#define DISPLAY_MALLOC_ERROR { fprintf(stderr, "FATAL ERROR: UNABLE TO ALLOCATE MEMORY IN HEAP"); exit(-1); }
+
+/*
+
+  Terms of the continued fraction followed at most, the
+  denominators grow at least as fast as the Fibonacci numbers,
+  so they are past INT_MAX well before this
+
+*/
+
+#define APPROXIMATE_MAX_STEPS 64
+
+/*
+
+  Sets f to h/k with the sign, if it fits in an int
+
+*/
+
+static int setFraction(Fraction *f, const int64_t h, const int64_t k, const int negative) {
+
+  if (h > INT_MAX || k > INT_MAX)
+    return 0;
+
+  f->numerator = negative ? (int) -h : (int) h;
+  f->denomenator = (int) k;
+
+  return 1;
+}
+
+static int closest(double x, int maxDenominator, Fraction *restrict f) {
+
+  if (isnan(x) || maxDenominator < 1)
+    return 0;
+
+  int negative = x < 0;
+  double y = fabs(x);
+
+  if (y > INT_MAX)
+    return 0;
+
+  // h(n - 2), h(n - 1), and the same for k
+  int64_t h0 = 0, h1 = 1;
+  int64_t k0 = 1, k1 = 0;
+
+  double rest = y;
+
+  for (int step = 0; step < APPROXIMATE_MAX_STEPS; step++) {
+
+    double a = floor(rest);
+
+    // The denominator would pass maxDenominator during this run
+    if (k1 && a > (double) ((maxDenominator - k0) / k1)) {
+
+      int64_t t = (maxDenominator - k0) / k1;
+      int64_t h = t * h1 + h0;
+      int64_t k = t * k1 + k0;
+
+      // Of two as near, the convergent, it has the smaller denominator
+      long double semiconvergent = fabsl((long double) h / k - y);
+      long double convergent = fabsl((long double) h1 / k1 - y);
+
+      if (semiconvergent < convergent)
+        return setFraction(f, h, k, negative);
+
+      break;
+    }
+
+    int64_t h = (int64_t) a * h1 + h0;
+    int64_t k = (int64_t) a * k1 + k0;
+
+    h0 = h1;
+    h1 = h;
+    k0 = k1;
+    k1 = k;
+
+    // x is exactly h/k
+    if (rest == a)
+      break;
+
+    rest = 1 / (rest - a);
+  }
+
+  return setFraction(f, h1, k1, negative);
+}
+
+static int simplest(double x, double tolerance, Fraction *restrict f) {
+
+  if (isnan(x) || isnan(tolerance))
+    return 0;
+
+  tolerance = fabs(tolerance);
+
+  double low = x - tolerance;
+  double high = x + tolerance;
+
+  // Nothing is simpler than 0
+  if (low <= 0 && high >= 0) {
+    f->numerator = 0;
+    f->denomenator = 1;
+    return 1;
+  }
+
+  int negative = high < 0;
+
+  if (negative) {
+    double t = low;
+    low = -high;
+    high = -t;
+  }
+
+  int64_t h0 = 0, h1 = 1;
+  int64_t k0 = 1, k1 = 0;
+
+  for (int step = 0; step < APPROXIMATE_MAX_STEPS; step++) {
+
+    // A whole number in the range ends it
+    double a = ceil(low);
+    int last = a <= high;
+
+    if (!last)
+      a = floor(low);
+
+    if (a > INT_MAX)
+      return 0;
+
+    int64_t h = (int64_t) a * h1 + h0;
+    int64_t k = (int64_t) a * k1 + k0;
+
+    if (h > INT_MAX || k > INT_MAX)
+      return 0;
+
+    h0 = h1;
+    h1 = h;
+    k0 = k1;
+    k1 = k;
+
+    if (last)
+      return setFraction(f, h1, k1, negative);
+
+    // Both ends are between a and a + 1, go on with what is left
+    double nextLow = 1 / (high - a);
+    double nextHigh = 1 / (low - a);
+
+    low = nextLow;
+    high = nextHigh;
+  }
+
+  return 0;
+}
+
+static long fractions(const double *restrict values, long count, int maxDenominator, Fraction *restrict f) {
+
+  long converted = 0;
+
+  for (long i = 0; i < count; i++) {
+
+    if (closest(values[i], maxDenominator, &f[i]))
+      converted++;
+    else
+      f[i] = (Fraction) { 0, 0 };
+  }
+
+  return converted;
+}
+
+static long store(const double *restrict values, long count, int maxDenominator) {
+
+  if (count <= 0)
+    return 0;
+
+  Fraction *converted = malloc((size_t) count * sizeof (Fraction));
+
+  if (!converted) DISPLAY_MALLOC_ERROR
+
+  long stored = fractions(values, count, maxDenominator, converted);
+
+  if (stored > INT_MAX)
+    stored = INT_MAX;
+
+  Fraction *f = Fractions->reserve((int) stored);
+
+  // Only the ones that were converted, in order
+  for (long i = 0, j = 0; j < stored; i++)
+    if (converted[i].denomenator)
+      f[j++] = converted[i];
+
+  free(converted);
+
+  return stored;
+}
+
+/*
+
+  Abstraction, same as in Software.c
+
+*/
+
+const static approximator ApproximateFunctions = {
+  &closest,
+  &simplest,
+  &fractions,
+  &store
+};
+
+const approximator *restrict Approximate = &ApproximateFunctions;
@@ -0,0 +1,102 @@
+/*
+
+  Approximate
+
+  Turns decimal numbers (doubles) into fractions, two ways:
+
+    closest(x, n)    the fraction nearest to x with a
+                     denominator no bigger than n
+    simplest(x, t)   the fraction with the smallest denominator
+                     that is within t of x
+
+  Both walk down the Stern-Brocot tree a whole run of steps at a
+  time, using the continued fraction of x, so they take a number of
+  steps that grows with the log of the denominator, not with the
+  denominator itself.
+
+*/
+
+#ifndef APPROXIMATE
+#define APPROXIMATE
+
+#include "Software.h"
+
+typedef struct {
+
+  /*
+
+    int closest(double x, int maxDenominator, Fraction *f)
+
+    Sets f to the fraction nearest to x with a denominator from
+    1 to maxDenominator (of two equally near, the simpler one).
+
+    Returns 0 (f unchanged) if x isn't a number, or the numerator
+    wouldn't fit in an int, else 1.
+
+    Access: Approximate->closest()
+
+  */
+
+  int(*const closest)(double x, int maxDenominator, Fraction * restrict f);
+
+  /*
+
+    int simplest(double x, double tolerance, Fraction *f)
+
+    Sets f to the fraction with the smallest denominator from
+    x - tolerance to x + tolerance.
+
+    Returns 0 (f unchanged) if x isn't a number, or the fraction
+    wouldn't fit in an int, else 1.
+
+    Access: Approximate->simplest()
+
+  */
+
+  int(*const simplest)(double x, double tolerance, Fraction * restrict f);
+
+  /*
+
+    long fractions(double *values, long count, int maxDenominator, Fraction *f)
+
+    closest() for a whole array, f[i] is the fraction for values[i],
+    0/0 for the ones that can't be converted.
+
+    Returns how many were converted.
+
+    Access: Approximate->fractions()
+
+  */
+
+  long(*const fractions)(const double * restrict values, long count, int maxDenominator, Fraction * restrict f);
+
+  /*
+
+    long store(double *values, long count, int maxDenominator)
+
+    closest() for a whole array, straight into the fractions data
+    base, in the same order. Values that can't be converted are
+    left out.
+
+    Returns how many were stored.
+
+    Access: Approximate->store()
+
+  */
+
+  long(*const store)(const double * restrict values, long count, int maxDenominator);
+
+}
+approximator;
+
+/*
+
+  Call this, Approximate, to access all
+  the publicly available functions.
+
+*/
+
+extern
+const approximator * restrict Approximate;
+
+#endif //Approximate.h
@@ -0,0 +1,1037 @@
+/*
+
+  Batch
+
+  Evaluating files of expressions, with plain read()/write()
+  or with io_uring. See Batch.h.
+
+  How the io_uring backend works:
+
+    The input file is read in chunks of BATCH_CHUNK bytes, and
+    BATCH_DEPTH chunks are always being read at once, each into its
+    own registered buffer. Chunks are evaluated in file order as they
+    arrive (lines cross chunk boundaries, so the order matters), and
+    the answers go into one of BATCH_DEPTH registered write buffers.
+    A full write buffer is written out while the next one fills up,
+    and the read buffer of an evaluated chunk is immediately reused
+    for the chunk BATCH_DEPTH further along.
+
+    io_uring is used through the raw system calls, so that
+    liburing doesn't have to be installed.
+
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+
+#include "Software.h"
+#include "Operations.h"
+#include "Batch.h"
+#include "Trace.h"
+
+/*
+
+  Error Messages
+
+*/
+
+#define DISPLAY_FILE_ERROR(file) fprintf(stderr, "Batch: %s: %s\n", file, strerror(errno));
+#define DISPLAY_URING_FALLBACK_ERROR fprintf(stderr, "Batch: io_uring unavailable (%s), using plain read/write\n", strerror(errno));
+#define DISPLAY_MALLOC_ERROR { fprintf(stderr, "FATAL ERROR: UNABLE TO ALLOCATE MEMORY IN HEAP"); exit(-1); }
+
+/*
+
+  Sizes
+
+*/
+
+// Bytes per read and per write
+#define BATCH_CHUNK (256 * 1024)
+
+// Reads in flight, and write buffers, for io_uring
+#define BATCH_DEPTH 8
+
+// Longest line, longer lines are answered with an error
+#define BATCH_MAX_LINE 4096
+
+// Longest answer
+#define BATCH_MAX_ANSWER 64
+
+// Submission queue entries, enough for every read and write at once
+#define BATCH_RING_ENTRIES (4 * BATCH_DEPTH)
+
+/*
+
+
+
+  Lines
+
+
+
+*/
+
+/*
+
+  The line being put together, it can start in one
+  chunk and end in the next.
+
+  Type: LineState
+
+*/
+
+typedef struct {
+
+  char line[BATCH_MAX_LINE];
+  size_t length;
+
+  // Set while skipping the rest of a line that was too long
+  int discarding;
+
+  long lines;
+  long errors;
+
+}
+LineState;
+
+/*
+
+  Answers the line that was put together
+
+*/
+
+static size_t answerLine(LineState *state, char *output) {
+
+  int length;
+
+  if (state->discarding)
+    length = sprintf(output, "error: line too long\n");
+
+  else {
+
+    if (state->length && state->line[state->length - 1] == '\r')
+      state->length--;
+
+    state->line[state->length] = 0;
+
+    length = answerExpression(state->line, output, BATCH_MAX_ANSWER);
+  }
+
+  state->lines++;
+
+  if (output[0] == 'e')
+    state->errors++;
+
+  state->length = 0;
+  state->discarding = 0;
+
+  return (size_t) length;
+}
+
+/*
+
+  Evaluates the lines of input starting at *position, until the
+  input runs out or there is no room left in output for another
+  answer. *position is moved past what was used.
+
+  Returns the number of bytes written to output.
+
+*/
+
+static size_t evaluateChunk(LineState *state, const char *input, size_t length, size_t *position, char *output, size_t capacity) {
+
+  size_t produced = 0;
+
+  TRACE_BEGIN(start)
+
+  while (*position < length && capacity - produced >= BATCH_MAX_ANSWER) {
+
+    const char *start = input + *position;
+    const char *newline = memchr(start, '\n', length - *position);
+    size_t take = newline ? (size_t) (newline - start) : length - *position;
+
+    if (!state->discarding) {
+
+      if (state->length + take < BATCH_MAX_LINE) {
+        memcpy(state->line + state->length, start, take);
+        state->length += take;
+      }
+
+      else
+        state->discarding = 1;
+    }
+
+    *position += take;
+
+    // The line continues in the next chunk
+    if (!newline)
+      break;
+
+    (*position)++;
+
+    produced += answerLine(state, output + produced);
+  }
+
+  TRACE_END(start, "batch", "evaluate")
+
+  return produced;
+}
+
+/*
+
+  Answers a last line that had no newline after it
+
+*/
+
+static size_t finishInput(LineState *state, char *output) {
+
+  if (!state->length && !state->discarding)
+    return 0;
+
+  return answerLine(state, output);
+}
+
+/*
+
+
+
+  Plain backend
+
+
+
+*/
+
+/*
+
+  write() until everything is written
+
+*/
+
+static int writeAll(int fd, const char *data, size_t length) {
+
+  TRACE_BEGIN(start)
+
+  while (length) {
+
+    ssize_t written = write(fd, data, length);
+
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return 0;
+    }
+
+    data += written;
+    length -= (size_t) written;
+  }
+
+  TRACE_END(start, "batch", "write")
+
+  return 1;
+}
+
+static int evaluatePlain(int in, int out, LineState *state, batchResult *restrict result) {
+
+  char *input  = malloc(BATCH_CHUNK);
+  char *output = malloc(BATCH_CHUNK);
+
+  if (!input || !output) DISPLAY_MALLOC_ERROR
+
+  int ok = 1;
+
+  for (;;) {
+
+    TRACE_BEGIN(start)
+
+    ssize_t got = read(in, input, BATCH_CHUNK);
+
+    TRACE_END(start, "batch", "read")
+
+    if (got < 0) {
+      if (errno == EINTR) continue;
+      ok = 0;
+      break;
+    }
+
+    if (got == 0)
+      break;
+
+    result->bytesRead += got;
+
+    size_t position = 0;
+
+    while (ok && position < (size_t) got) {
+      size_t produced = evaluateChunk(state, input, (size_t) got, &position, output, BATCH_CHUNK);
+      ok = writeAll(out, output, produced);
+      result->bytesWritten += (long long) produced;
+    }
+
+    if (!ok)
+      break;
+  }
+
+  if (ok) {
+    size_t produced = finishInput(state, output);
+    ok = writeAll(out, output, produced);
+    result->bytesWritten += (long long) produced;
+  }
+
+  free(input);
+  free(output);
+
+  return ok;
+}
+
+/*
+
+
+
+  io_uring backend
+
+
+
+*/
+
+/*
+
+  The memory shared with the kernel
+
+  Type: Ring
+
+*/
+
+typedef struct {
+
+  int fd;
+
+  // Submission queue
+  unsigned *sqHead;
+  unsigned *sqTail;
+  unsigned *sqMask;
+  unsigned *sqArray;
+  struct io_uring_sqe *sqes;
+
+  // Completion queue
+  unsigned *cqHead;
+  unsigned *cqTail;
+  unsigned *cqMask;
+  struct io_uring_cqe *cqes;
+
+  // For unmapping
+  void *sqRing;
+  void *cqRing;
+  size_t sqRingSize;
+  size_t cqRingSize;
+  size_t sqesSize;
+
+  // Entries queued but not yet submitted
+  unsigned queued;
+
+}
+Ring;
+
+/*
+
+  Everything the io_uring backend keeps track of
+
+  Type: Uring
+
+*/
+
+typedef struct {
+
+  Ring ring;
+
+  // BATCH_DEPTH read buffers followed by BATCH_DEPTH write buffers
+  char *buffers;
+
+  // Reads, one per read buffer
+  long long readOffset[BATCH_DEPTH];
+  size_t readWanted[BATCH_DEPTH];
+  size_t readGot[BATCH_DEPTH];
+  int readReady[BATCH_DEPTH];
+
+  // Writes, one per write buffer
+  long long writeOffset[BATCH_DEPTH];
+  size_t writeLength[BATCH_DEPTH];
+  size_t writeDone[BATCH_DEPTH];
+  int writeBusy[BATCH_DEPTH];
+  int writesInFlight;
+
+  // Set when a read or write failed, errno tells why
+  int failed;
+
+}
+Uring;
+
+#define URING_READ_BUFFER(u, slot)  ((u)->buffers + (size_t) (slot) * BATCH_CHUNK)
+#define URING_WRITE_BUFFER(u, slot) ((u)->buffers + (size_t) (BATCH_DEPTH + (slot)) * BATCH_CHUNK)
+
+// Fixed file indexes
+#define URING_INPUT 0
+#define URING_OUTPUT 1
+
+// Marks writes in user_data
+#define URING_WRITE (1ULL << 32)
+
+/*
+
+  The system calls, liburing would wrap these
+
+*/
+
+static int uringSetup(unsigned entries, struct io_uring_params *params) {
+  return (int) syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int uringEnter(int fd, unsigned submit, unsigned wait, unsigned flags) {
+  return (int) syscall(__NR_io_uring_enter, fd, submit, wait, flags, NULL, 0);
+}
+
+static int uringRegister(int fd, unsigned opcode, void *arg, unsigned count) {
+  return (int) syscall(__NR_io_uring_register, fd, opcode, arg, count);
+}
+
+/*
+
+  Creates the ring and maps its queues
+
+  Returns 1 on success, else 0 with errno set.
+
+*/
+
+static int ringOpen(Ring *ring, unsigned entries) {
+
+  struct io_uring_params params;
+  memset(&params, 0, sizeof (params));
+  memset(ring, 0, sizeof (*ring));
+
+  ring->fd = uringSetup(entries, &params);
+
+  if (ring->fd < 0)
+    return 0;
+
+  ring->sqRingSize = params.sq_off.array + params.sq_entries * sizeof (unsigned);
+  ring->cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof (struct io_uring_cqe);
+  ring->sqesSize   = params.sq_entries * sizeof (struct io_uring_sqe);
+
+  // Newer kernels map both queues with one mmap()
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    if (ring->cqRingSize > ring->sqRingSize)
+      ring->sqRingSize = ring->cqRingSize;
+    ring->cqRingSize = ring->sqRingSize;
+  }
+
+  ring->sqRing = mmap(NULL, ring->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+
+  ring->cqRing = params.features & IORING_FEAT_SINGLE_MMAP ?
+    ring->sqRing :
+    mmap(NULL, ring->cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+
+  ring->sqes = mmap(NULL, ring->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+
+  if (ring->sqRing == MAP_FAILED || ring->cqRing == MAP_FAILED || ring->sqes == MAP_FAILED) {
+    close(ring->fd);
+    return 0;
+  }
+
+  char *sq = ring->sqRing, *cq = ring->cqRing;
+
+  ring->sqHead  = (unsigned *) (sq + params.sq_off.head);
+  ring->sqTail  = (unsigned *) (sq + params.sq_off.tail);
+  ring->sqMask  = (unsigned *) (sq + params.sq_off.ring_mask);
+  ring->sqArray = (unsigned *) (sq + params.sq_off.array);
+
+  ring->cqHead = (unsigned *) (cq + params.cq_off.head);
+  ring->cqTail = (unsigned *) (cq + params.cq_off.tail);
+  ring->cqMask = (unsigned *) (cq + params.cq_off.ring_mask);
+  ring->cqes   = (struct io_uring_cqe *) (cq + params.cq_off.cqes);
+
+  return 1;
+}
+
+static void ringClose(Ring *ring) {
+
+  munmap(ring->sqes, ring->sqesSize);
+
+  if (ring->cqRing != ring->sqRing)
+    munmap(ring->cqRing, ring->cqRingSize);
+
+  munmap(ring->sqRing, ring->sqRingSize);
+  close(ring->fd);
+}
+
+/*
+
+  Gets the next free submission queue entry. There are always
+  enough, BATCH_RING_ENTRIES covers every read and write at once,
+  and the kernel takes everything queued on each submit.
+
+*/
+
+static struct io_uring_sqe *ringEntry(Ring *ring) {
+
+  unsigned tail = *ring->sqTail;
+  unsigned index = tail & *ring->sqMask;
+
+  struct io_uring_sqe *sqe = &ring->sqes[index];
+  memset(sqe, 0, sizeof (*sqe));
+
+  ring->sqArray[index] = index;
+  __atomic_store_n(ring->sqTail, tail + 1, __ATOMIC_RELEASE);
+  ring->queued++;
+
+  return sqe;
+}
+
+/*
+
+  Submits everything queued, and waits for at least
+  wait completions.
+
+*/
+
+static int ringSubmit(Ring *ring, unsigned wait) {
+
+  int submitted;
+
+  do
+    submitted = uringEnter(ring->fd, ring->queued, wait, wait ? IORING_ENTER_GETEVENTS : 0);
+  while (submitted < 0 && errno == EINTR);
+
+  if (submitted < 0)
+    return 0;
+
+  ring->queued -= (unsigned) submitted;
+
+  return 1;
+}
+
+/*
+
+  Queues the (rest of the) read of a read buffer
+
+*/
+
+static void startRead(Uring *u, int slot) {
+
+  struct io_uring_sqe *sqe = ringEntry(&u->ring);
+
+  sqe->opcode = IORING_OP_READ_FIXED;
+  sqe->flags = IOSQE_FIXED_FILE;
+  sqe->fd = URING_INPUT;
+  sqe->addr = (unsigned long long) (URING_READ_BUFFER(u, slot) + u->readGot[slot]);
+  sqe->len = (unsigned) (u->readWanted[slot] - u->readGot[slot]);
+  sqe->off = (unsigned long long) (u->readOffset[slot] + (long long) u->readGot[slot]);
+  sqe->buf_index = (unsigned short) slot;
+  sqe->user_data = (unsigned long long) slot;
+}
+
+/*
+
+  Queues the (rest of the) write of a write buffer
+
+*/
+
+static void startWrite(Uring *u, int slot) {
+
+  struct io_uring_sqe *sqe = ringEntry(&u->ring);
+
+  sqe->opcode = IORING_OP_WRITE_FIXED;
+  sqe->flags = IOSQE_FIXED_FILE;
+  sqe->fd = URING_OUTPUT;
+  sqe->addr = (unsigned long long) (URING_WRITE_BUFFER(u, slot) + u->writeDone[slot]);
+  sqe->len = (unsigned) (u->writeLength[slot] - u->writeDone[slot]);
+  sqe->off = (unsigned long long) (u->writeOffset[slot] + (long long) u->writeDone[slot]);
+  sqe->buf_index = (unsigned short) (BATCH_DEPTH + slot);
+  sqe->user_data = URING_WRITE | (unsigned long long) slot;
+}
+
+/*
+
+  Submits what is queued, waits for wait completions, and
+  handles every completion that is there. Short reads and
+  writes are queued again for the rest.
+
+*/
+
+static void reap(Uring *u, unsigned wait) {
+
+  // Waiting is the only time spent on I/O here, the rest is in flight
+  TRACE_BEGIN(start)
+
+  if (!ringSubmit(&u->ring, wait)) {
+    u->failed = 1;
+    return;
+  }
+
+  if (wait)
+    TRACE_END(start, "batch", "wait")
+
+  unsigned head = *u->ring.cqHead;
+
+  while (head != __atomic_load_n(u->ring.cqTail, __ATOMIC_ACQUIRE)) {
+
+    struct io_uring_cqe *cqe = &u->ring.cqes[head & *u->ring.cqMask];
+    int slot = (int) (cqe->user_data & 0xffffffff);
+    int result = cqe->res;
+
+    head++;
+
+    if (result < 0) {
+      errno = -result;
+      u->failed = 1;
+      continue;
+    }
+
+    if (cqe->user_data & URING_WRITE) {
+
+      u->writeDone[slot] += (size_t) result;
+
+      if (!result) {
+        errno = EIO;
+        u->failed = 1;
+      }
+      else if (u->writeDone[slot] < u->writeLength[slot])
+        startWrite(u, slot);
+      else {
+        u->writeBusy[slot] = 0;
+        u->writesInFlight--;
+      }
+    }
+
+    else {
+
+      u->readGot[slot] += (size_t) result;
+
+      // 0 means the file got shorter while we were reading it
+      if (result && u->readGot[slot] < u->readWanted[slot])
+        startRead(u, slot);
+      else
+        u->readReady[slot] = 1;
+    }
+  }
+
+  __atomic_store_n(u->ring.cqHead, head, __ATOMIC_RELEASE);
+
+  if (u->ring.queued && !ringSubmit(&u->ring, 0))
+    u->failed = 1;
+}
+
+/*
+
+  Starts reading chunk number chunk into its read buffer
+
+*/
+
+static void readChunk(Uring *u, long long chunk, long long size) {
+
+  int slot = (int) (chunk % BATCH_DEPTH);
+  long long offset = chunk * BATCH_CHUNK;
+
+  u->readOffset[slot] = offset;
+  u->readWanted[slot] = (size_t) (size - offset < BATCH_CHUNK ? size - offset : BATCH_CHUNK);
+  u->readGot[slot] = 0;
+  u->readReady[slot] = 0;
+
+  startRead(u, slot);
+}
+
+/*
+
+  Waits for a free write buffer and returns it
+
+*/
+
+static int takeWriteBuffer(Uring *u) {
+
+  for (;;) {
+
+    for (int slot = 0; slot < BATCH_DEPTH; slot++)
+      if (!u->writeBusy[slot]) {
+        u->writeBusy[slot] = 1;
+        u->writeLength[slot] = 0;
+        u->writeDone[slot] = 0;
+        return slot;
+      }
+
+    reap(u, 1);
+
+    if (u->failed)
+      return -1;
+  }
+}
+
+/*
+
+  Writes out a write buffer at the end of the output so far
+
+*/
+
+static void flushWriteBuffer(Uring *u, int slot, long long *outputOffset, batchResult *restrict result) {
+
+  if (!u->writeLength[slot]) {
+    u->writeBusy[slot] = 0;
+    return;
+  }
+
+  u->writeOffset[slot] = *outputOffset;
+  *outputOffset += (long long) u->writeLength[slot];
+  result->bytesWritten += (long long) u->writeLength[slot];
+
+  u->writesInFlight++;
+  startWrite(u, slot);
+}
+
+/*
+
+  Evaluates one file pair with io_uring, the
+  files already registered by openUring().
+
+  Returns 1 on success, 0 if a read or write failed.
+
+*/
+
+static int evaluateUring(Uring *u, long long size, LineState *state, batchResult *restrict result) {
+
+  long long chunks = (size + BATCH_CHUNK - 1) / BATCH_CHUNK;
+  long long outputOffset = 0;
+  int writing = -1;
+
+  u->failed = 0;
+  u->writesInFlight = 0;
+  memset(u->writeBusy, 0, sizeof (u->writeBusy));
+
+  // Fill the pipeline
+  for (long long chunk = 0; chunk < chunks && chunk < BATCH_DEPTH; chunk++)
+    readChunk(u, chunk, size);
+
+  for (long long chunk = 0; chunk < chunks && !u->failed; chunk++) {
+
+    int slot = (int) (chunk % BATCH_DEPTH);
+
+    while (!u->readReady[slot] && !u->failed)
+      reap(u, 1);
+
+    if (u->failed)
+      break;
+
+    /*
+
+      Evaluate the chunk while the other reads, and
+      the writes of earlier chunks, are in flight.
+
+    */
+
+    const char *input = URING_READ_BUFFER(u, slot);
+    size_t position = 0;
+
+    while (position < u->readGot[slot] && !u->failed) {
+
+      if (writing < 0 && (writing = takeWriteBuffer(u)) < 0)
+        break;
+
+      u->writeLength[writing] += evaluateChunk(
+        state,
+        input,
+        u->readGot[slot],
+        &position,
+        URING_WRITE_BUFFER(u, writing) + u->writeLength[writing],
+        BATCH_CHUNK - u->writeLength[writing]
+      );
+
+      if (BATCH_CHUNK - u->writeLength[writing] < BATCH_MAX_ANSWER) {
+        flushWriteBuffer(u, writing, &outputOffset, result);
+        writing = -1;
+      }
+    }
+
+    result->bytesRead += (long long) u->readGot[slot];
+
+    // Reuse the buffer for the chunk BATCH_DEPTH further along
+    if (chunk + BATCH_DEPTH < chunks)
+      readChunk(u, chunk + BATCH_DEPTH, size);
+
+    // Get the new read and any full write buffer going now
+    reap(u, 0);
+  }
+
+  if (!u->failed) {
+
+    if (writing < 0)
+      writing = takeWriteBuffer(u);
+
+    if (writing >= 0) {
+      u->writeLength[writing] += finishInput(state, URING_WRITE_BUFFER(u, writing) + u->writeLength[writing]);
+      flushWriteBuffer(u, writing, &outputOffset, result);
+    }
+  }
+
+  while (!u->failed && (u->writesInFlight || u->ring.queued))
+    reap(u, 1);
+
+  /*
+
+    After a failure there can still be reads and writes in
+    flight, they land in the registered buffers, which stay
+    pinned until the ring is closed by the caller.
+
+  */
+
+  return !u->failed;
+}
+
+/*
+
+  Sets up io_uring with its registered buffers, and
+  in and out as its fixed files 0 and 1.
+
+  Returns NULL (with errno set) if io_uring can't be used.
+
+*/
+
+static Uring *openUring(int in, int out) {
+
+  Uring *u = calloc(1, sizeof (Uring));
+
+  if (!u) DISPLAY_MALLOC_ERROR
+
+  u->buffers = mmap(NULL, 2 * BATCH_DEPTH * (size_t) BATCH_CHUNK, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+  if (u->buffers == MAP_FAILED) {
+    free(u);
+    return NULL;
+  }
+
+  if (!ringOpen(&u->ring, BATCH_RING_ENTRIES)) {
+    munmap(u->buffers, 2 * BATCH_DEPTH * (size_t) BATCH_CHUNK);
+    free(u);
+    return NULL;
+  }
+
+  struct iovec buffers[2 * BATCH_DEPTH];
+
+  for (int i = 0; i < 2 * BATCH_DEPTH; i++) {
+    buffers[i].iov_base = u->buffers + (size_t) i * BATCH_CHUNK;
+    buffers[i].iov_len = BATCH_CHUNK;
+  }
+
+  int files[2] = { in, out };
+
+  // Some kernels and sandboxes take the buffers but not the files
+  if (
+    uringRegister(u->ring.fd, IORING_REGISTER_BUFFERS, buffers, 2 * BATCH_DEPTH) < 0 ||
+    uringRegister(u->ring.fd, IORING_REGISTER_FILES, files, 2) < 0
+  ) {
+    int error = errno;
+    ringClose(&u->ring);
+    munmap(u->buffers, 2 * BATCH_DEPTH * (size_t) BATCH_CHUNK);
+    free(u);
+    errno = error;
+    return NULL;
+  }
+
+  return u;
+}
+
+static void closeUring(Uring *u) {
+  ringClose(&u->ring);
+  munmap(u->buffers, 2 * BATCH_DEPTH * (size_t) BATCH_CHUNK);
+  free(u);
+}
+
+/*
+
+
+
+  Batch functions
+
+
+
+*/
+
+/*
+
+  int evaluate(char *input, char *output, int backend, batchResult *result)
+
+*/
+
+static int evaluateFile(const char *input, const char *output, int backend, batchResult *restrict result) {
+
+  int in = open(input, O_RDONLY | O_CLOEXEC);
+
+  if (in < 0) {
+    DISPLAY_FILE_ERROR(input)
+    return 0;
+  }
+
+  int out = open(output, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+  if (out < 0) {
+    DISPLAY_FILE_ERROR(output)
+    close(in);
+    return 0;
+  }
+
+  LineState *state = calloc(1, sizeof (LineState));
+
+  if (!state) DISPLAY_MALLOC_ERROR
+
+  struct stat info;
+  int ok;
+  Uring *u = NULL;
+
+  /*
+
+    io_uring reads at known offsets, so it needs the size
+    up front. Pipes and the like go through read().
+
+  */
+
+  if (backend == BATCH_BACKEND_URING && fstat(in, &info) == 0 && S_ISREG(info.st_mode)) {
+    u = openUring(in, out);
+    if (!u) DISPLAY_URING_FALLBACK_ERROR
+  }
+
+  if (u) {
+    result->backend = BATCH_BACKEND_URING;
+    ok = evaluateUring(u, info.st_size, state, result);
+    closeUring(u);
+  }
+
+  else {
+    result->backend = BATCH_BACKEND_PLAIN;
+    ok = evaluatePlain(in, out, state, result);
+  }
+
+  if (!ok)
+    DISPLAY_FILE_ERROR(input)
+
+  result->lines  += state->lines;
+  result->errors += state->errors;
+
+  free(state);
+  close(in);
+  close(out);
+
+  return ok;
+}
+
+/*
+
+  Seconds on the monotonic clock
+
+*/
+
+static double seconds() {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (double) t.tv_sec + (double) t.tv_nsec / 1e9;
+}
+
+/*
+
+  FNV-1a hash of a file, to check that both
+  backends wrote the same answers.
+
+*/
+
+static unsigned long long hashFile(const char *path) {
+
+  unsigned long long hash = 14695981039346656037ULL;
+  char buffer[65536];
+  FILE *file = fopen(path, "rb");
+  size_t got;
+
+  if (!file)
+    return 0;
+
+  while ((got = fread(buffer, 1, sizeof (buffer), file)) > 0)
+    for (size_t i = 0; i < got; i++)
+      hash = (hash ^ (unsigned char) buffer[i]) * 1099511628211ULL;
+
+  fclose(file);
+
+  return hash;
+}
+
+/*
+
+  int benchmark(char **inputs, int count, int runs)
+
+*/
+
+static int benchmark(char **inputs, int count, int runs) {
+
+  static const char *names[] = { "plain", "io_uring" };
+
+  unsigned long long hashes[2] = { 0, 0 };
+  char output[4096];
+
+  printf("%-10s %10s %10s %12s %8s\n", "backend", "best s", "MB/s", "lines/s", "lines");
+
+  for (int backend = BATCH_BACKEND_PLAIN; backend <= BATCH_BACKEND_URING; backend++) {
+
+    double best = 0;
+    batchResult result = { 0, 0, 0, 0, 0 };
+
+    for (int run = 0; run < runs; run++) {
+
+      result = (batchResult) { 0, 0, 0, 0, 0 };
+      double started = seconds();
+
+      for (int i = 0; i < count; i++) {
+        snprintf(output, sizeof (output), "%s.results", inputs[i]);
+        if (!evaluateFile(inputs[i], output, backend, &result))
+          return 0;
+      }
+
+      double took = seconds() - started;
+
+      if (!run || took < best)
+        best = took;
+    }
+
+    // Hash of every output, in order
+    for (int i = 0; i < count; i++) {
+      snprintf(output, sizeof (output), "%s.results", inputs[i]);
+      hashes[backend] = hashes[backend] * 31 + hashFile(output);
+    }
+
+    printf(
+      "%-10s %10.3f %10.1f %12.0f %8li\n",
+      names[result.backend],
+      best,
+      (double) result.bytesRead / best / 1e6,
+      (double) result.lines / best,
+      result.lines
+    );
+  }
+
+  printf("Outputs %s\n", hashes[0] == hashes[1] ? "identical" : "DIFFER");
+
+  return hashes[0] == hashes[1];
+}
+
+/*
+
+  Abstraction, same as in Software.c
+
+*/
+
+const static batchEvaluator BatchFunctions = {
+  &evaluateFile,
+  &benchmark
+};
+
+const batchEvaluator *restrict Batch = &BatchFunctions;
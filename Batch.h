@@ -0,0 +1,99 @@
+/*
+
+  Batch
+
+  Evaluates whole files of expressions, one expression per line,
+  writing one answer per line to an output file (same answers as
+  the daemon, see answerExpression() in Operations.h).
+
+  There are two ways of doing the reading and writing (backends):
+
+    BATCH_BACKEND_PLAIN
+      Plain read() and write(), one chunk at a time.
+
+    BATCH_BACKEND_URING
+      io_uring, with several reads and writes in flight at once,
+      registered buffers and fixed files, so the evaluation of one
+      chunk overlaps the I/O of the others.
+
+  If io_uring isn't available (old kernel, or blocked by a sandbox),
+  BATCH_BACKEND_URING falls back to BATCH_BACKEND_PLAIN.
+
+*/
+
+#ifndef BATCH
+#define BATCH
+
+#define BATCH_BACKEND_PLAIN 0
+#define BATCH_BACKEND_URING 1
+
+/*
+
+  Totals of one run
+
+  Type: batchResult
+
+*/
+
+typedef struct {
+
+  // Backend that actually ran (after any fall back)
+  int backend;
+
+  long long bytesRead;
+  long long bytesWritten;
+
+  long lines;
+  long errors;
+
+}
+batchResult;
+
+typedef struct {
+
+  /*
+
+    int evaluate(char *input, char *output, int backend, batchResult *result)
+
+    Evaluates every line of the file input into the file output
+    with the given backend. Adds the totals to *result.
+
+    Returns 1 on success, else 0 (and prints why).
+
+    Access: Batch->evaluate()
+
+  */
+
+  int(*const evaluate)(const char *input, const char *output, int backend, batchResult * restrict result);
+
+  /*
+
+    int benchmark(char **inputs, int count, int runs)
+
+    Evaluates every input file runs times with each backend,
+    writing to "<input>.results", and prints the best time,
+    MB/s and lines/s of each backend, and whether both
+    backends wrote the same answers.
+
+    Returns 1 on success, else 0.
+
+    Access: Batch->benchmark()
+
+  */
+
+  int(*const benchmark)(char **inputs, int count, int runs);
+
+}
+batchEvaluator;
+
+/*
+
+  Call this, Batch, to access all
+  the publicly available functions.
+
+*/
+
+extern
+const batchEvaluator * restrict Batch;
+
+#endif //Batch.h
@@ -0,0 +1,726 @@
+/*
+
+  Bench
+
+  Every benchmark is a function that does ops operations on the
+  data set (going round it as many times as it takes) and returns
+  how many it did. Timing is the same for all of them, around the
+  whole call, so the clock isn't read inside the loop.
+
+  Results go into benchSink, which is volatile, so the compiler
+  can't drop the work that produced them.
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "IO.h"
+#include "Software.h"
+#include "Operations.h"
+#include "Random.h"
+#include "Bench.h"
+
+#define DISPLAY_MALLOC_ERROR { fprintf(stderr, "FATAL ERROR: UNABLE TO ALLOCATE MEMORY IN HEAP"); exit(-1); }
+
+#define BENCH_MASK (BENCH_DATASET_SIZE - 1)
+
+/*
+
+  Longest text of one expression, "-16384/16384 + -16384/16384"
+
+*/
+
+#define BENCH_TEXT 32
+
+/*
+
+  Operations in the first try of a benchmark, doubled until
+  one sample takes options->seconds
+
+*/
+
+#define BENCH_FIRST_OPS 256
+
+/*
+
+  Operands, in every form a benchmark needs them
+
+  Type: BenchData
+
+*/
+
+typedef struct {
+
+  const char *name;
+
+  Fraction left[BENCH_DATASET_SIZE];
+  Fraction right[BENCH_DATASET_SIZE];
+
+  // Whole numbers, the right operand of ^
+  Fraction exponent[BENCH_DATASET_SIZE];
+
+  int gcdLeft[BENCH_DATASET_SIZE];
+  int gcdRight[BENCH_DATASET_SIZE];
+
+  char operator[BENCH_DATASET_SIZE];
+  char text[BENCH_DATASET_SIZE][BENCH_TEXT];
+
+  // Equations left[i] operator[i] right[i], with their results
+  Fraction result[BENCH_DATASET_SIZE];
+  Equation equation[BENCH_DATASET_SIZE];
+
+}
+BenchData;
+
+/*
+
+  One benchmark
+
+  Type: Benchmark
+
+*/
+
+typedef struct {
+
+  const char *name;
+
+  long(*run)(BenchData *data, long ops);
+
+  // Most operations in one sample, for those that use memory as they go
+  long maxOps;
+
+}
+Benchmark;
+
+/*
+
+  The timing of one benchmark on one data set
+
+  Type: BenchResult
+
+*/
+
+typedef struct {
+
+  const char *benchmark;
+  const char *dataset;
+
+  long ops;
+
+  // ns per operation
+  double mean;
+  double deviation;
+  double fastest;
+  double slowest;
+
+}
+BenchResult;
+
+static volatile long benchSink;
+
+/*
+
+  Data sets
+
+*/
+
+/*
+
+  F(k), without working out F(k + 1) past it, which
+  would overflow for F(46)
+
+*/
+
+static int fibonacci(int k) {
+
+  if (!k)
+    return 0;
+
+  int a = 0, b = 1;
+
+  while (--k) {
+    int c = a + b;
+    a = b;
+    b = c;
+  }
+
+  return b;
+}
+
+/*
+
+  A random number from -(range - 1) to range - 1
+
+*/
+
+static int signedBounded(int range) {
+  return (int) Random->bounded((uint32_t) (2 * range - 1)) - (range - 1);
+}
+
+/*
+
+  Numbers anywhere, but fractions small enough that
+  a * d + b * c can't overflow in Operation()
+
+*/
+
+static void uniformEntry(BenchData *data, int i) {
+
+  data->gcdLeft[i] = (int) Random->bounded(0x7fffffff) + 1;
+  data->gcdRight[i] = (int) Random->bounded(0x7fffffff) + 1;
+
+  data->left[i] = (Fraction) { signedBounded(1 << 14), (int) Random->bounded(1 << 14) + 1 };
+  data->right[i] = (Fraction) { signedBounded(1 << 14), (int) Random->bounded(1 << 14) + 1 };
+}
+
+static void boundedEntry(BenchData *data, int i) {
+
+  Random->fraction(&data->left[i]);
+  Random->fraction(&data->right[i]);
+
+  data->gcdLeft[i] = abs(data->left[i].numerator);
+  data->gcdRight[i] = data->left[i].denomenator;
+}
+
+static void fibonacciEntry(BenchData *data, int i) {
+
+  // F(46) is the largest that fits in an int
+  int k = 30 + (int) Random->bounded(16);
+
+  data->gcdLeft[i] = fibonacci(k);
+  data->gcdRight[i] = fibonacci(k + 1);
+
+  // F(22) is below 2^15, so products stay inside an int
+  k = 10 + (int) Random->bounded(11);
+
+  data->left[i] = (Fraction) { fibonacci(k), fibonacci(k + 1) };
+  data->right[i] = (Fraction) { fibonacci(k + 1), fibonacci(k + 2) };
+}
+
+static const char *datasets[] = { "uniform", "bounded", "duplicates", "fibonacci" };
+
+#define BENCH_DATASETS ((int) (sizeof (datasets) / sizeof (datasets[0])))
+
+static void makeDataset(BenchData *data, const int which, const uint64_t seed) {
+
+  static const char operators[] = { OP_ADD, OP_SUB, OP_MUL, OP_DIV };
+
+  Random->seed(seed);
+
+  data->name = datasets[which];
+
+  for (int i = 0; i < BENCH_DATASET_SIZE; i++) {
+
+    switch (which) {
+    case 0: uniformEntry(data, i); break;
+    case 1: boundedEntry(data, i); break;
+    case 3: fibonacciEntry(data, i); break;
+
+    // 16 different ones, then copies of them
+    case 2:
+
+      if (i < 16)
+        boundedEntry(data, i);
+      else {
+        int j = (int) Random->bounded(16);
+        data->left[i] = data->left[j];
+        data->right[i] = data->right[j];
+        data->gcdLeft[i] = data->gcdLeft[j];
+        data->gcdRight[i] = data->gcdRight[j];
+      }
+
+      break;
+    }
+
+    data->exponent[i] = (Fraction) { signedBounded(4), 1 };
+    data->operator[i] = operators[Random->bounded(4)];
+
+    snprintf(data->text[i], BENCH_TEXT, "%i/%i %c %i/%i",
+      data->left[i].numerator, data->left[i].denomenator, data->operator[i],
+      data->right[i].numerator, data->right[i].denomenator);
+
+    data->equation[i] = (Equation) { &data->left[i], &data->operator[i], &data->right[i], &data->result[i] };
+    data->result[i] = (Fraction) { 0, 1 };
+
+    Operation(&data->equation[i]);
+  }
+}
+
+/*
+
+  Benchmarks
+
+*/
+
+static long gcdBench(BenchData *data, long ops) {
+
+  long sum = 0;
+
+  for (long i = 0; i < ops; i++)
+    sum += getGCD(data->gcdLeft[i & BENCH_MASK], data->gcdRight[i & BENCH_MASK]);
+
+  benchSink += sum;
+
+  return ops;
+}
+
+static long simplifyBench(BenchData *data, long ops) {
+
+  long sum = 0;
+
+  for (long i = 0; i < ops; i++) {
+
+    int numerator = data->left[i & BENCH_MASK].numerator;
+    int denominator = data->left[i & BENCH_MASK].denomenator;
+
+    simplifyFractions(&numerator, &denominator);
+
+    sum += numerator + denominator;
+  }
+
+  benchSink += sum;
+
+  return ops;
+}
+
+/*
+
+  Operation() with one operator on every pair
+
+*/
+
+static long operationBench(BenchData *data, long ops, char operator) {
+
+  Fraction result;
+  long sum = 0;
+
+  for (long i = 0; i < ops; i++) {
+
+    Fraction *right = operator == OP_POW ? &data->exponent[i & BENCH_MASK] : &data->right[i & BENCH_MASK];
+    Equation equation = { &data->left[i & BENCH_MASK], &operator, right, &result };
+
+    if (Operation(&equation))
+      sum += result.numerator;
+  }
+
+  benchSink += sum;
+
+  return ops;
+}
+
+static long addBench(BenchData *data, long ops) { return operationBench(data, ops, OP_ADD); }
+static long subtractBench(BenchData *data, long ops) { return operationBench(data, ops, OP_SUB); }
+static long multiplyBench(BenchData *data, long ops) { return operationBench(data, ops, OP_MUL); }
+static long divideBench(BenchData *data, long ops) { return operationBench(data, ops, OP_DIV); }
+static long powerBench(BenchData *data, long ops) { return operationBench(data, ops, OP_POW); }
+
+/*
+
+  parseExpression() changes the text, so each one is copied first.
+  Outside the limits in IO.h (most of uniform and fibonacci) this
+  times how fast bad input is turned down.
+
+*/
+
+static long parseBench(BenchData *data, long ops) {
+
+  Fraction left, right;
+  char operator;
+  Equation equation = { &left, &operator, &right, NULL };
+  char text[BENCH_TEXT];
+  long valid = 0;
+
+  for (long i = 0; i < ops; i++) {
+    memcpy(text, data->text[i & BENCH_MASK], BENCH_TEXT);
+    valid += parseExpression(&equation, text);
+  }
+
+  benchSink += valid;
+
+  return ops;
+}
+
+static long formatBench(BenchData *data, long ops) {
+
+  long length = 0;
+
+  for (long i = 0; i < ops; i++)
+    length += (long) strlen(Equations->getFormatted(&data->equation[i & BENCH_MASK]));
+
+  benchSink += length;
+
+  return ops;
+}
+
+static long storeBench(BenchData *data, long ops) {
+
+  for (long i = 0; i < ops; i++) {
+
+    Fraction *f = Fractions->new();
+
+    *f = data->left[i & BENCH_MASK];
+
+    Fractions->Store(f);
+  }
+
+  return ops;
+}
+
+static void visitFraction(__attribute__((unused)) const int index, Fraction *restrict f) {
+  benchSink += f->numerator;
+}
+
+static void visitEquation(__attribute__((unused)) const int index, Equation *restrict e) {
+  benchSink += e->result->numerator;
+}
+
+/*
+
+  Whole passes over the data base, at least ops fractions
+
+*/
+
+static long fractionsBench(BenchData *data, long ops) {
+
+  // A data set's worth, if store didn't run first
+  if (Fractions->count() < BENCH_DATASET_SIZE)
+    storeBench(data, BENCH_DATASET_SIZE - Fractions->count());
+
+  long done = 0;
+
+  while (done < ops) {
+    Fractions->forEach(&visitFraction);
+    done += Fractions->count();
+  }
+
+  return done;
+}
+
+/*
+
+  The equations data base only holds IO_MAX_FRACTIONS (or
+  FRACTIONS_HISTORY), it is filled once from the data set
+
+*/
+
+static long equationsBench(BenchData *data, long ops) {
+
+  for (int i = 0; Equations->canStore(); i++) {
+
+    Equation *e = Equations->new();
+
+    *e->operand1 = *data->equation[i & BENCH_MASK].operand1;
+    *e->operator = *data->equation[i & BENCH_MASK].operator;
+    *e->operand2 = *data->equation[i & BENCH_MASK].operand2;
+    *e->result = *data->equation[i & BENCH_MASK].result;
+
+    Equations->Store(e);
+  }
+
+  long done = 0;
+
+  while (done < ops) {
+    Equations->forEach(&visitEquation);
+    done += Equations->count();
+  }
+
+  return done;
+}
+
+/*
+
+  Equations stored into a new session by Software->Threads()
+  threads at once, or by one thread if the store isn't sharded
+  (see Software.h), and freed with it after. Only as many as the
+  history holds are stored, so FRACTIONS_HISTORY sets how many
+  one sample times.
+
+*/
+
+typedef struct {
+  BenchData *data;
+  Session *session;
+  long first;
+  long last;
+  long stored;
+}
+AppendWork;
+
+static void *appendEquations(void *argument) {
+
+  AppendWork *work = argument;
+
+  // The calling thread is one of the workers, and goes back to its own
+  Session *was = Sessions->current();
+
+  Sessions->use(work->session);
+
+  for (long i = work->first; i < work->last; i++) {
+
+    Equation *e = Equations->new();
+    Equation *from = &work->data->equation[i & BENCH_MASK];
+
+    *e->operand1 = *from->operand1;
+    *e->operator = *from->operator;
+    *e->operand2 = *from->operand2;
+    *e->result = *from->result;
+
+    if (!Equations->Store(e))
+      break;
+
+    work->stored++;
+  }
+
+  Sessions->use(was);
+
+  return NULL;
+}
+
+static long appendBench(BenchData *data, long ops) {
+
+  Session *session = Sessions->create();
+
+  int threads = Equations->concurrent() ? Software->Threads() : 1;
+
+  AppendWork work[threads];
+  pthread_t ids[threads];
+
+  for (int t = 0; t < threads; t++) {
+
+    work[t] = (AppendWork) { data, session, ops * t / threads, ops * (t + 1) / threads, 0 };
+
+    if (t && pthread_create(&ids[t], NULL, &appendEquations, &work[t])) {
+      fprintf(stderr, "Bench: can't start a thread\n");
+      exit(-1);
+    }
+  }
+
+  // The calling thread is one of them
+  appendEquations(&work[0]);
+
+  long stored = work[0].stored;
+
+  for (int t = 1; t < threads; t++) {
+    pthread_join(ids[t], NULL);
+    stored += work[t].stored;
+  }
+
+  Sessions->destroy(session);
+
+  return stored;
+}
+
+static const Benchmark benchmarks[] = {
+  { "gcd",       &gcdBench,       0 },
+  { "simplify",  &simplifyBench,  0 },
+  { "add",       &addBench,       0 },
+  { "subtract",  &subtractBench,  0 },
+  { "multiply",  &multiplyBench,  0 },
+  { "divide",    &divideBench,    0 },
+  { "power",     &powerBench,     0 },
+  { "parse",     &parseBench,     0 },
+  { "format",    &formatBench,    0 },
+  { "store",     &storeBench,     1L << 18 },
+  { "fractions", &fractionsBench, 0 },
+  { "equations", &equationsBench, 0 },
+  { "append",    &appendBench,    1L << 18 }
+};
+
+#define BENCH_BENCHMARKS ((int) (sizeof (benchmarks) / sizeof (benchmarks[0])))
+
+/*
+
+  Timing
+
+*/
+
+static double now() {
+
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+
+  return (double) t.tv_sec + (double) t.tv_nsec / 1e9;
+}
+
+/*
+
+  Newton's method, the build doesn't link the maths library
+
+*/
+
+static double squareRoot(double x) {
+
+  if (x <= 0)
+    return 0;
+
+  double r = x > 1 ? x : 1;
+
+  for (int i = 0; i < 64; i++)
+    r = (r + x / r) / 2;
+
+  return r;
+}
+
+/*
+
+  Seconds for one call of run, and the operations it did into *ops
+
+*/
+
+static double timeOnce(const Benchmark *b, BenchData *data, long *ops) {
+
+  double start = now();
+
+  *ops = b->run(data, *ops);
+
+  return now() - start;
+}
+
+static void measure(const Benchmark *b, BenchData *data, const benchOptions *options, BenchResult *r) {
+
+  long ops = BENCH_FIRST_OPS;
+
+  // Until a sample is long enough, which also warms up the caches
+  for (;;) {
+
+    long asked = ops;
+    double seconds = timeOnce(b, data, &ops);
+
+    if (seconds >= options->seconds || (b->maxOps && asked * 2 > b->maxOps))
+      break;
+
+    ops = asked * 2;
+  }
+
+  double sum = 0, squares = 0;
+
+  r->benchmark = b->name;
+  r->dataset = data->name;
+  r->fastest = 0;
+  r->slowest = 0;
+
+  for (int s = 0; s < options->samples; s++) {
+
+    long done = ops;
+    double ns = timeOnce(b, data, &done) * 1e9 / (double) done;
+
+    sum += ns;
+    squares += ns * ns;
+
+    if (!s || ns < r->fastest) r->fastest = ns;
+    if (!s || ns > r->slowest) r->slowest = ns;
+
+    r->ops = done;
+  }
+
+  r->mean = sum / options->samples;
+  r->deviation = options->samples > 1 ? squareRoot((squares - sum * r->mean) / (options->samples - 1)) : 0;
+}
+
+/*
+
+  Output
+
+*/
+
+static void writeLine(FILE *table, const BenchResult *r) {
+
+  fprintf(table, "%-10s %-11s %10.2f ns/op  +-%5.1f%%  %14.0f ops/s  %10li ops/sample\n",
+    r->benchmark, r->dataset, r->mean, r->mean > 0 ? 100 * r->deviation / r->mean : 0,
+    r->mean > 0 ? 1e9 / r->mean : 0, r->ops);
+}
+
+static void writeJSON(FILE *json, const benchOptions *options, const BenchResult *results, const int count) {
+
+  fprintf(json, "{\n  \"label\": \"");
+
+  // Only " and \ would break the string
+  for (const char *c = options->label ? options->label : ""; *c; c++)
+    fprintf(json, *c == '"' || *c == '\\' ? "\\%c" : "%c", *c);
+
+  fprintf(json, "\",\n  \"seed\": %llu,\n  \"samples\": %i,\n  \"sample_seconds\": %g,\n  \"results\": [\n",
+    (unsigned long long) options->seed, options->samples, options->seconds);
+
+  for (int i = 0; i < count; i++) {
+
+    const BenchResult *r = &results[i];
+
+    fprintf(json,
+      "    { \"benchmark\": \"%s\", \"dataset\": \"%s\", \"ops_per_sample\": %li, "
+      "\"ns_per_op\": %.3f, \"stddev_ns\": %.3f, \"min_ns\": %.3f, \"max_ns\": %.3f, \"ops_per_second\": %.0f }%s\n",
+      r->benchmark, r->dataset, r->ops, r->mean, r->deviation, r->fastest, r->slowest,
+      r->mean > 0 ? 1e9 / r->mean : 0, i + 1 < count ? "," : "");
+  }
+
+  fprintf(json, "  ]\n}\n");
+}
+
+static int selected(const char *name, const char *wanted) {
+  return !strcmp(wanted, "all") || !strcmp(wanted, name);
+}
+
+static int run(const benchOptions *restrict options, FILE *restrict table, FILE *restrict json) {
+
+  int datasetsRun = 0, benchmarksRun = 0;
+
+  for (int d = 0; d < BENCH_DATASETS; d++)
+    datasetsRun += selected(datasets[d], options->dataset);
+
+  for (int b = 0; b < BENCH_BENCHMARKS; b++)
+    benchmarksRun += selected(benchmarks[b].name, options->benchmark);
+
+  if (!datasetsRun || !benchmarksRun)
+    return 0;
+
+  BenchData *data = malloc(sizeof (BenchData));
+  BenchResult *results = malloc((size_t) (datasetsRun * benchmarksRun) * sizeof (BenchResult));
+
+  if (!data || !results) DISPLAY_MALLOC_ERROR
+
+  int count = 0;
+
+  for (int d = 0; d < BENCH_DATASETS; d++) {
+
+    if (!selected(datasets[d], options->dataset))
+      continue;
+
+    makeDataset(data, d, options->seed);
+
+    for (int b = 0; b < BENCH_BENCHMARKS; b++) {
+
+      if (!selected(benchmarks[b].name, options->benchmark))
+        continue;
+
+      measure(&benchmarks[b], data, options, &results[count]);
+      writeLine(table, &results[count]);
+      fflush(table);
+
+      count++;
+    }
+  }
+
+  if (json)
+    writeJSON(json, options, results, count);
+
+  free(data);
+  free(results);
+
+  return count;
+}
+
+/*
+
+  Abstraction, same as in Software.c
+
+*/
+
+const static benchmarkSuite BenchFunctions = {
+  &run
+};
+
+const benchmarkSuite *restrict Bench = &BenchFunctions;
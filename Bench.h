@@ -0,0 +1,114 @@
+/*
+
+  Bench
+
+  Times the hot paths of the program on the same data every run,
+  so runs of different commits can be compared:
+
+    gcd            getGCD()
+    simplify       simplifyFractions()
+    add ... power  Operation(), one for each operator
+    parse          parseExpression() (setExpressionParts() without
+                   the error message)
+    format         Equations->getFormatted()
+    store          Fractions->new() and Fractions->Store()
+    fractions      Fractions->forEach(), per fraction
+    equations      Equations->forEach(), per equation
+    append         Equations->Store() into a new session, from every
+                   thread at once if the store is sharded, as many
+                   as FRACTIONS_HISTORY lets it
+
+  on each data set, drawn from Random.h with a fixed seed:
+
+    uniform        numbers anywhere (for Operation(), small enough
+                   that int products don't overflow)
+    bounded        fractions inside the limits in IO.h
+    duplicates     16 bounded fractions, over and over
+    fibonacci      consecutive Fibonacci numbers, the slowest
+                   case for Euclid's algorithm
+
+  Each benchmark is run until one sample takes long enough, then
+  timed over a number of samples, and reported as the mean ns/op,
+  its standard deviation, the fastest and slowest sample, and
+  operations per second.
+
+*/
+
+#ifndef BENCH
+#define BENCH
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "Software.h"
+
+/*
+
+  Fractions in each data set, a power of 2
+
+*/
+
+#define BENCH_DATASET_SIZE 4096
+
+/*
+
+  What to run
+
+  Type: benchOptions
+
+*/
+
+typedef struct {
+
+  // A data set, or "all"
+  const char *dataset;
+
+  // A benchmark, or "all"
+  const char *benchmark;
+
+  int samples;
+
+  // Shortest time for one sample
+  double seconds;
+
+  uint64_t seed;
+
+  // Put in the JSON as is, like a commit hash, may be NULL
+  const char *label;
+
+}
+benchOptions;
+
+typedef struct {
+
+  /*
+
+    int run(benchOptions *options, FILE *table, FILE *json)
+
+    Runs the benchmarks, writing a line per benchmark and data
+    set to table, and, if json isn't NULL, all the results to
+    it as one JSON object when they are done.
+
+    Returns how many benchmarks ran, 0 if the data set or the
+    benchmark name is unknown.
+
+    Access: Bench->run()
+
+  */
+
+  int(*const run)(const benchOptions * restrict options, FILE * restrict table, FILE * restrict json);
+
+}
+benchmarkSuite;
+
+/*
+
+  Call this, Bench, to access all
+  the publicly available functions.
+
+*/
+
+extern
+const benchmarkSuite * restrict Bench;
+
+#endif //Bench.h
@@ -0,0 +1,1190 @@
+/*
+
+  Bignum
+
+  Sign and size numbers, 32 bit limbs, with 64 bit arithmetic
+  for the carries. See Bignum.h.
+
+  Multiplication is schoolbook for small numbers and Karatsuba
+  above BIGNUM_KARATSUBA limbs, division is Knuth's algorithm D
+  (TAOCP vol. 2, 4.3.1), and the gcd is Lehmer's (4.5.2, algorithm
+  L), finishing with 64 bit numbers once both fit.
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "Bignum.h"
+
+#define DISPLAY_MALLOC_ERROR { fprintf(stderr, "FATAL ERROR: UNABLE TO ALLOCATE MEMORY IN HEAP"); exit(-1); }
+
+/*
+
+  Limbs (of the smaller number) from which multiplying
+  splits the numbers in halves (Karatsuba)
+
+*/
+
+#define BIGNUM_KARATSUBA 32
+
+/*
+
+  Top bits of the numbers Lehmer's steps are worked out from,
+  so that nothing overflows an int64_t
+
+*/
+
+#define BIGNUM_LEHMER_BITS 60
+
+/*
+
+  Helpers on the limbs alone
+
+*/
+
+/*
+
+  Makes room for capacity limbs, keeping the ones in use
+
+*/
+
+static void reserveLimbs(Bignum *a, const int capacity) {
+
+  if (capacity <= a->capacity)
+    return;
+
+  int size = a->capacity ? a->capacity : 4;
+
+  while (size < capacity)
+    size *= 2;
+
+  uint32_t *limbs = realloc(a->limbs, (size_t) size * sizeof (uint32_t));
+
+  if (!limbs) DISPLAY_MALLOC_ERROR
+
+  a->limbs = limbs;
+  a->capacity = size;
+}
+
+/*
+
+  Drops 0 limbs from the top, so the length is right
+
+*/
+
+static void trim(Bignum *a) {
+
+  while (a->length && !a->limbs[a->length - 1])
+    a->length--;
+
+  // There is no -0
+  if (!a->length)
+    a->negative = 0;
+}
+
+static void swapBignums(Bignum *a, Bignum *b) {
+
+  Bignum t = *a;
+
+  *a = *b;
+  *b = t;
+}
+
+static int compareLimbs(const uint32_t *a, const int an, const uint32_t *b, const int bn) {
+
+  if (an != bn)
+    return an < bn ? -1 : 1;
+
+  for (int i = an - 1; i >= 0; i--)
+    if (a[i] != b[i])
+      return a[i] < b[i] ? -1 : 1;
+
+  return 0;
+}
+
+/*
+
+  r = a + b, an >= bn, r has room for an + 1 limbs and may be a or b.
+  Returns the length of r.
+
+*/
+
+static int addLimbs(uint32_t *r, const uint32_t *a, const int an, const uint32_t *b, const int bn) {
+
+  uint64_t carry = 0;
+  int i = 0;
+
+  for (; i < bn; i++) {
+    carry += (uint64_t) a[i] + b[i];
+    r[i] = (uint32_t) carry;
+    carry >>= 32;
+  }
+
+  for (; i < an; i++) {
+    carry += a[i];
+    r[i] = (uint32_t) carry;
+    carry >>= 32;
+  }
+
+  r[an] = (uint32_t) carry;
+
+  return an + 1;
+}
+
+/*
+
+  r = a - b, a >= b, r has room for an limbs and may be a or b.
+  Returns the length of r.
+
+*/
+
+static int subtractLimbs(uint32_t *r, const uint32_t *a, const int an, const uint32_t *b, const int bn) {
+
+  int64_t borrow = 0;
+  int i = 0;
+
+  for (; i < bn; i++) {
+    int64_t d = (int64_t) a[i] - b[i] - borrow;
+    r[i] = (uint32_t) d;
+    borrow = d < 0;
+  }
+
+  for (; i < an; i++) {
+    int64_t d = (int64_t) a[i] - borrow;
+    r[i] = (uint32_t) d;
+    borrow = d < 0;
+  }
+
+  return an;
+}
+
+/*
+
+  r += a, r has rn limbs, rn >= an, and the sum fits in them
+
+*/
+
+static void addInto(uint32_t *r, const int rn, const uint32_t *a, const int an) {
+
+  uint64_t carry = 0;
+  int i = 0;
+
+  for (; i < an; i++) {
+    carry += (uint64_t) r[i] + a[i];
+    r[i] = (uint32_t) carry;
+    carry >>= 32;
+  }
+
+  for (; carry && i < rn; i++) {
+    carry += r[i];
+    r[i] = (uint32_t) carry;
+    carry >>= 32;
+  }
+}
+
+/*
+
+  r -= a, r has rn limbs, rn >= an, r >= a
+
+*/
+
+static void subtractFrom(uint32_t *r, const int rn, const uint32_t *a, const int an) {
+
+  int64_t borrow = 0;
+  int i = 0;
+
+  for (; i < an; i++) {
+    int64_t d = (int64_t) r[i] - a[i] - borrow;
+    r[i] = (uint32_t) d;
+    borrow = d < 0;
+  }
+
+  for (; borrow && i < rn; i++) {
+    int64_t d = (int64_t) r[i] - borrow;
+    r[i] = (uint32_t) d;
+    borrow = d < 0;
+  }
+}
+
+/*
+
+  r = a * b in an + bn limbs, r is neither a nor b
+
+*/
+
+static void schoolbook(uint32_t *r, const uint32_t *a, const int an, const uint32_t *b, const int bn) {
+
+  memset(r, 0, (size_t) (an + bn) * sizeof (uint32_t));
+
+  for (int j = 0; j < bn; j++) {
+
+    uint64_t carry = 0, bj = b[j];
+
+    if (!bj)
+      continue;
+
+    for (int i = 0; i < an; i++) {
+      carry += a[i] * bj + r[i + j];
+      r[i + j] = (uint32_t) carry;
+      carry >>= 32;
+    }
+
+    r[j + an] = (uint32_t) carry;
+  }
+}
+
+static void multiplyLimbs(uint32_t *r, const uint32_t *a, int an, const uint32_t *b, int bn);
+
+/*
+
+  Karatsuba, for bn <= an < 2 * bn
+
+    a = a1 B^h + a0, b = b1 B^h + b0
+
+    a b = a1 b1 B^2h + ((a0 + a1)(b0 + b1) - a0 b0 - a1 b1) B^h + a0 b0
+
+  Three products of half the size instead of four.
+
+*/
+
+static void karatsuba(uint32_t *r, const uint32_t *a, const int an, const uint32_t *b, const int bn) {
+
+  // bn > an / 2 >= h, so b1 is never empty
+  int h = an / 2;
+
+  int sizeA = an - h + 1;
+  int sizeB = (bn - h > h ? bn - h : h) + 1;
+  int sizeMiddle = sizeA + sizeB;
+
+  uint32_t *sumA = malloc((size_t) (sizeA + sizeB + sizeMiddle) * sizeof (uint32_t));
+
+  if (!sumA) DISPLAY_MALLOC_ERROR
+
+  uint32_t *sumB = sumA + sizeA;
+  uint32_t *middle = sumB + sizeB;
+
+  // a0 b0 and a1 b1 go straight to where they belong in r
+  multiplyLimbs(r, a, h, b, h);
+  multiplyLimbs(r + 2 * h, a + h, an - h, b + h, bn - h);
+
+  // (a0 + a1)(b0 + b1), a1 is never shorter than a0
+  addLimbs(sumA, a + h, an - h, a, h);
+
+  if (bn - h >= h)
+    addLimbs(sumB, b + h, bn - h, b, h);
+  else
+    addLimbs(sumB, b, h, b + h, bn - h);
+
+  multiplyLimbs(middle, sumA, sizeA, sumB, sizeB);
+
+  subtractFrom(middle, sizeMiddle, r, 2 * h);
+  subtractFrom(middle, sizeMiddle, r + 2 * h, an + bn - 2 * h);
+
+  // What is left of the middle fits in r above B^h
+  int length = sizeMiddle;
+
+  while (length && !middle[length - 1])
+    length--;
+
+  addInto(r + h, an + bn - h, middle, length);
+
+  free(sumA);
+}
+
+/*
+
+  r = a * b in an + bn limbs, r is neither a nor b
+
+*/
+
+static void multiplyLimbs(uint32_t *r, const uint32_t *a, int an, const uint32_t *b, int bn) {
+
+  // The longer one first
+  if (an < bn) {
+
+    const uint32_t *t = a;
+    a = b;
+    b = t;
+
+    int tn = an;
+    an = bn;
+    bn = tn;
+  }
+
+  if (bn < BIGNUM_KARATSUBA) {
+    schoolbook(r, a, an, b, bn);
+    return;
+  }
+
+  if (an < 2 * bn) {
+    karatsuba(r, a, an, b, bn);
+    return;
+  }
+
+  /*
+
+    Very different sizes, a is cut in pieces as long as b,
+    and each piece times b is added in at its place.
+
+  */
+
+  uint32_t *piece = malloc((size_t) (2 * bn) * sizeof (uint32_t));
+
+  if (!piece) DISPLAY_MALLOC_ERROR
+
+  memset(r, 0, (size_t) (an + bn) * sizeof (uint32_t));
+
+  for (int i = 0; i < an; i += bn) {
+
+    int length = an - i < bn ? an - i : bn;
+
+    multiplyLimbs(piece, a + i, length, b, bn);
+    addInto(r + i, an + bn - i, piece, length + bn);
+  }
+
+  free(piece);
+}
+
+/*
+
+  quotient = u / v (m - n + 1 limbs), remainder = u % v (n limbs),
+  m >= n, the top limb of v isn't 0. remainder can be NULL.
+
+  Knuth's algorithm D, as written up in Hacker's Delight (divmnu):
+  both are shifted so the top bit of v is set, then each quotient
+  limb is guessed from the top two limbs, at most 2 too high.
+
+*/
+
+static void divideLimbs(uint32_t *quotient, uint32_t *remainder, const uint32_t *u, const int m, const uint32_t *v, const int n) {
+
+  const uint64_t base = 1ULL << 32;
+
+  // One limb, no guessing needed
+  if (n == 1) {
+
+    uint64_t rest = 0;
+
+    for (int j = m - 1; j >= 0; j--) {
+      uint64_t current = (rest << 32) | u[j];
+      quotient[j] = (uint32_t) (current / v[0]);
+      rest = current % v[0];
+    }
+
+    if (remainder)
+      remainder[0] = (uint32_t) rest;
+
+    return;
+  }
+
+  int s = __builtin_clz(v[n - 1]);
+
+  uint32_t *vn = malloc((size_t) (n + m + 1) * sizeof (uint32_t));
+
+  if (!vn) DISPLAY_MALLOC_ERROR
+
+  uint32_t *un = vn + n;
+
+  for (int i = n - 1; i > 0; i--)
+    vn[i] = (uint32_t) ((((uint64_t) v[i] << 32) | v[i - 1]) >> (32 - s));
+
+  vn[0] = v[0] << s;
+
+  un[m] = (uint32_t) ((uint64_t) u[m - 1] >> (32 - s));
+
+  for (int i = m - 1; i > 0; i--)
+    un[i] = (uint32_t) ((((uint64_t) u[i] << 32) | u[i - 1]) >> (32 - s));
+
+  un[0] = u[0] << s;
+
+  for (int j = m - n; j >= 0; j--) {
+
+    uint64_t top = ((uint64_t) un[j + n] << 32) | un[j + n - 1];
+    uint64_t qhat = top / vn[n - 1];
+    uint64_t rhat = top % vn[n - 1];
+
+    while (qhat >= base || qhat * vn[n - 2] > ((rhat << 32) | un[j + n - 2])) {
+
+      qhat--;
+      rhat += vn[n - 1];
+
+      if (rhat >= base)
+        break;
+    }
+
+    // un -= qhat * vn, shifted by j
+    int64_t borrow = 0, t;
+
+    for (int i = 0; i < n; i++) {
+
+      uint64_t p = qhat * vn[i];
+
+      t = (int64_t) un[i + j] - borrow - (int64_t) (p & 0xFFFFFFFFULL);
+      un[i + j] = (uint32_t) t;
+      borrow = (int64_t) (p >> 32) - (t >> 32);
+    }
+
+    t = (int64_t) un[j + n] - borrow;
+    un[j + n] = (uint32_t) t;
+
+    quotient[j] = (uint32_t) qhat;
+
+    // Guessed one too high, add vn back
+    if (t < 0) {
+
+      quotient[j]--;
+
+      uint64_t carry = 0;
+
+      for (int i = 0; i < n; i++) {
+        carry += (uint64_t) un[i + j] + vn[i];
+        un[i + j] = (uint32_t) carry;
+        carry >>= 32;
+      }
+
+      un[j + n] += (uint32_t) carry;
+    }
+  }
+
+  if (remainder)
+    for (int i = 0; i < n; i++)
+      remainder[i] = (uint32_t) ((((uint64_t) un[i + 1] << 32) | un[i]) >> s);
+
+  free(vn);
+}
+
+/*
+
+  quotient = u / v (m - n + 1 limbs), when v divides u exactly
+  and v is odd. u is used as room to work in, and is changed.
+
+  Jebelean's exact division: the quotient is found from the lowest
+  limb up. The lowest limb of what is left of u, times the inverse
+  of v[0] modulo 2^32, is the next quotient limb, so nothing is
+  guessed or corrected, and only the low m - n + 1 limbs of u
+  are ever needed.
+
+*/
+
+static void divideExactLimbs(uint32_t *quotient, uint32_t *u, const int m, const uint32_t *v, const int n) {
+
+  const int length = m - n + 1;
+
+  // Newton's method, every step doubles the bits that are right (3 to start)
+  uint32_t inverse = v[0];
+
+  for (int i = 0; i < 4; i++)
+    inverse *= 2 - v[0] * inverse;
+
+  for (int i = 0; i < length; i++) {
+
+    uint32_t q = u[i] * inverse;
+    quotient[i] = q;
+
+    // u -= q v, shifted by i, up to the quotient's length
+    int top = n < length - i ? n : length - i;
+    uint64_t borrow = 0;
+    int j = 0;
+
+    for (; j < top; j++) {
+
+      uint64_t p = (uint64_t) q * v[j] + borrow;
+      uint32_t low = (uint32_t) p;
+
+      borrow = (p >> 32) + (u[i + j] < low);
+      u[i + j] -= low;
+    }
+
+    for (j += i; borrow && j < length; j++) {
+
+      uint32_t limb = u[j];
+
+      u[j] -= (uint32_t) borrow;
+      borrow = limb < (uint32_t) borrow;
+    }
+  }
+}
+
+/*
+
+  Sign and size
+
+*/
+
+static void freeBignum(Bignum *a) {
+
+  free(a->limbs);
+
+  *a = (Bignum) BIGNUM_ZERO;
+}
+
+static void fromSize(Bignum *r, const uint64_t size, const int negative) {
+
+  reserveLimbs(r, 2);
+
+  r->limbs[0] = (uint32_t) size;
+  r->limbs[1] = (uint32_t) (size >> 32);
+  r->length = 2;
+  r->negative = negative;
+
+  trim(r);
+}
+
+/*
+
+  The size of a, which has at most 2 limbs
+
+*/
+
+static uint64_t toSize(const Bignum *a) {
+
+  uint64_t size = 0;
+
+  for (int i = a->length - 1; i >= 0; i--)
+    size = (size << 32) | a->limbs[i];
+
+  return size;
+}
+
+static void fromInt(Bignum *r, int64_t value) {
+  fromSize(r, value < 0 ? -(uint64_t) value : (uint64_t) value, value < 0);
+}
+
+static int toInt(const Bignum *a, int64_t *value) {
+
+  if (a->length > 2)
+    return 0;
+
+  uint64_t size = toSize(a);
+
+  if (size > (uint64_t) INT64_MAX + (uint64_t) a->negative)
+    return 0;
+
+  *value = a->negative ? (int64_t) -size : (int64_t) size;
+
+  return 1;
+}
+
+static void copy(Bignum *r, const Bignum *a) {
+
+  if (r == a)
+    return;
+
+  reserveLimbs(r, a->length);
+
+  if (a->length)
+    memcpy(r->limbs, a->limbs, (size_t) a->length * sizeof (uint32_t));
+
+  r->length = a->length;
+  r->negative = a->negative;
+}
+
+static int compare(const Bignum *a, const Bignum *b) {
+
+  if (a->negative != b->negative)
+    return a->negative ? -1 : 1;
+
+  int sizes = compareLimbs(a->limbs, a->length, b->limbs, b->length);
+
+  return a->negative ? -sizes : sizes;
+}
+
+/*
+
+  r = a + b, with b's sign taken as bNegative (so it subtracts too)
+
+*/
+
+static void addSigned(Bignum *r, const Bignum *a, const Bignum *b, const int bNegative) {
+
+  if (a->negative == bNegative) {
+
+    const Bignum *longer  = a->length >= b->length ? a : b;
+    const Bignum *shorter = a->length >= b->length ? b : a;
+
+    int negative = bNegative;
+
+    // If r is a or b, growing it moves their limbs too
+    reserveLimbs(r, longer->length + 1);
+
+    r->length = addLimbs(r->limbs, longer->limbs, longer->length, shorter->limbs, shorter->length);
+    r->negative = negative;
+
+    trim(r);
+    return;
+  }
+
+  int sizes = compareLimbs(a->limbs, a->length, b->limbs, b->length);
+
+  if (!sizes) {
+    r->length = 0;
+    r->negative = 0;
+    return;
+  }
+
+  const Bignum *larger  = sizes > 0 ? a : b;
+  const Bignum *smaller = sizes > 0 ? b : a;
+
+  int negative = sizes > 0 ? a->negative : bNegative;
+
+  reserveLimbs(r, larger->length);
+
+  r->length = subtractLimbs(r->limbs, larger->limbs, larger->length, smaller->limbs, smaller->length);
+  r->negative = negative;
+
+  trim(r);
+}
+
+static void add(Bignum *r, const Bignum *a, const Bignum *b) {
+  addSigned(r, a, b, b->negative);
+}
+
+static void subtract(Bignum *r, const Bignum *a, const Bignum *b) {
+  addSigned(r, a, b, b->length ? !b->negative : 0);
+}
+
+static void multiply(Bignum *r, const Bignum *a, const Bignum *b) {
+
+  if (!a->length || !b->length) {
+    r->length = 0;
+    r->negative = 0;
+    return;
+  }
+
+  // The limbs can't be written while they are read
+  Bignum t = BIGNUM_ZERO;
+  Bignum *out = (r == a || r == b) ? &t : r;
+
+  int negative = a->negative != b->negative;
+  int length = a->length + b->length;
+
+  reserveLimbs(out, length);
+  multiplyLimbs(out->limbs, a->limbs, a->length, b->limbs, b->length);
+
+  out->length = length;
+  out->negative = negative;
+
+  trim(out);
+
+  if (out == &t) {
+    swapBignums(r, &t);
+    freeBignum(&t);
+  }
+}
+
+static int divide(Bignum *quotient, Bignum *remainder, const Bignum *a, const Bignum *b) {
+
+  if (!b->length)
+    return 0;
+
+  // Less than b, nothing to divide
+  if (compareLimbs(a->limbs, a->length, b->limbs, b->length) < 0) {
+
+    if (remainder)
+      copy(remainder, a);
+
+    if (quotient) {
+      quotient->length = 0;
+      quotient->negative = 0;
+    }
+
+    return 1;
+  }
+
+  Bignum q = BIGNUM_ZERO, r = BIGNUM_ZERO;
+
+  reserveLimbs(&q, a->length - b->length + 1);
+  reserveLimbs(&r, b->length);
+
+  divideLimbs(q.limbs, r.limbs, a->limbs, a->length, b->limbs, b->length);
+
+  q.length = a->length - b->length + 1;
+  q.negative = a->negative != b->negative;
+  r.length = b->length;
+  r.negative = a->negative;
+
+  trim(&q);
+  trim(&r);
+
+  // Swapped in last, quotient or remainder can be a or b
+  if (quotient)
+    swapBignums(quotient, &q);
+
+  if (remainder)
+    swapBignums(remainder, &r);
+
+  freeBignum(&q);
+  freeBignum(&r);
+
+  return 1;
+}
+
+/*
+
+  r = a >> bits, a has length limbs, 0 <= bits < 32
+
+*/
+
+static void shiftRight(uint32_t *r, const uint32_t *a, const int length, const int bits) {
+
+  for (int i = 0; i < length; i++) {
+
+    uint64_t pair = a[i];
+
+    if (i + 1 < length)
+      pair |= (uint64_t) a[i + 1] << 32;
+
+    r[i] = (uint32_t) (pair >> bits);
+  }
+}
+
+static int divideExact(Bignum *quotient, const Bignum *a, const Bignum *b) {
+
+  if (!b->length)
+    return 0;
+
+  // The factors of 2 of b are taken out of both, b is left odd
+  int zeroLimbs = 0;
+
+  while (!b->limbs[zeroLimbs])
+    zeroLimbs++;
+
+  int zeroBits = __builtin_ctz(b->limbs[zeroLimbs]);
+  int m = a->length - zeroLimbs;
+  int n = b->length - zeroLimbs;
+
+  if (m < n) {
+    quotient->length = 0;
+    quotient->negative = 0;
+    return 1;
+  }
+
+  uint32_t *u = malloc((size_t) (m + n) * sizeof (uint32_t));
+
+  if (!u) DISPLAY_MALLOC_ERROR
+
+  uint32_t *v = u + m;
+
+  shiftRight(u, a->limbs + zeroLimbs, m, zeroBits);
+  shiftRight(v, b->limbs + zeroLimbs, n, zeroBits);
+
+  while (!v[n - 1])
+    n--;
+
+  while (m && !u[m - 1])
+    m--;
+
+  Bignum q = BIGNUM_ZERO;
+
+  if (m >= n) {
+
+    reserveLimbs(&q, m - n + 1);
+    divideExactLimbs(q.limbs, u, m, v, n);
+
+    q.length = m - n + 1;
+    q.negative = a->negative != b->negative;
+
+    trim(&q);
+  }
+
+  swapBignums(quotient, &q);
+  freeBignum(&q);
+  free(u);
+
+  return 1;
+}
+
+static uint64_t gcd64(uint64_t a, uint64_t b) {
+
+  while (b) {
+    uint64_t t = a % b;
+    a = b;
+    b = t;
+  }
+
+  return a;
+}
+
+/*
+
+  (a >> shift), the low 64 bits of it
+
+*/
+
+static uint64_t bitsFrom(const Bignum *a, const long shift) {
+
+  long limb = shift / 32;
+  unsigned __int128 window = 0;
+
+  for (int i = 0; i < 3; i++)
+    if (limb + i < a->length)
+      window |= (unsigned __int128) a->limbs[limb + i] << (32 * i);
+
+  return (uint64_t) (window >> (shift % 32));
+}
+
+/*
+
+  x, y = A x + B y, C x + D y, both known to be 0 or above and
+  no longer than x. t is room for the new x.
+
+*/
+
+static void lehmerStep(Bignum *x, Bignum *y, Bignum *t, const int64_t A, const int64_t B, const int64_t C, const int64_t D) {
+
+  int n = x->length;
+
+  reserveLimbs(t, n);
+  reserveLimbs(y, n);
+
+  for (int i = y->length; i < n; i++)
+    y->limbs[i] = 0;
+
+  __int128 first = 0, second = 0;
+
+  for (int i = 0; i < n; i++) {
+
+    first += (__int128) A * x->limbs[i] + (__int128) B * y->limbs[i];
+    second += (__int128) C * x->limbs[i] + (__int128) D * y->limbs[i];
+
+    t->limbs[i] = (uint32_t) first;
+    y->limbs[i] = (uint32_t) second;
+
+    first >>= 32;
+    second >>= 32;
+  }
+
+  t->length = y->length = n;
+  t->negative = y->negative = 0;
+
+  trim(t);
+  trim(y);
+
+  swapBignums(x, t);
+}
+
+static void gcd(Bignum *r, const Bignum *a, const Bignum *b) {
+
+  Bignum x = BIGNUM_ZERO, y = BIGNUM_ZERO, t = BIGNUM_ZERO;
+
+  copy(&x, a);
+  copy(&y, b);
+
+  x.negative = y.negative = 0;
+
+  if (compareLimbs(x.limbs, x.length, y.limbs, y.length) < 0)
+    swapBignums(&x, &y);
+
+  while (y.length) {
+
+    // Both fit in 64 bits, the rest is quick
+    if (x.length <= 2 && y.length <= 2) {
+      fromSize(&x, gcd64(toSize(&x), toSize(&y)), 0);
+      break;
+    }
+
+    // Several steps from the top bits alone, while they are sure
+    long shift = 32L * x.length - __builtin_clz(x.limbs[x.length - 1]) - BIGNUM_LEHMER_BITS;
+
+    int64_t u = (int64_t) bitsFrom(&x, shift), v = (int64_t) bitsFrom(&y, shift);
+    int64_t A = 1, B = 0, C = 0, D = 1;
+
+    while (v + C > 0 && v + D > 0 && u + A >= 0 && u + B >= 0) {
+
+      int64_t quotient = (u + A) / (v + C);
+
+      if (quotient != (u + B) / (v + D))
+        break;
+
+      int64_t T = A - quotient * C;
+      A = C;
+      C = T;
+
+      T = B - quotient * D;
+      B = D;
+      D = T;
+
+      T = u - quotient * v;
+      u = v;
+      v = T;
+    }
+
+    if (B) {
+      lehmerStep(&x, &y, &t, A, B, C, D);
+      continue;
+    }
+
+    divide(NULL, &t, &x, &y);
+
+    swapBignums(&x, &y);
+    swapBignums(&y, &t);
+  }
+
+  swapBignums(r, &x);
+
+  freeBignum(&x);
+  freeBignum(&y);
+  freeBignum(&t);
+}
+
+static char *toText(const Bignum *a) {
+
+  // 9 digits per limb of 32 bits is always enough (10 per 1e9 chunk)
+  int size = a->length * 10 + 3;
+
+  char *text = malloc((size_t) size);
+  uint32_t *rest = malloc((size_t) (a->length + 1) * sizeof (uint32_t));
+
+  if (!text || !rest) DISPLAY_MALLOC_ERROR
+
+  if (a->length)
+    memcpy(rest, a->limbs, (size_t) a->length * sizeof (uint32_t));
+
+  // Digits are written backwards from the end
+  char *digit = text + size - 1;
+  int length = a->length;
+
+  *digit = 0;
+
+  do {
+
+    // Divide by 10^9, 9 digits at a time
+    uint64_t chunk = 0;
+
+    for (int i = length - 1; i >= 0; i--) {
+      uint64_t current = (chunk << 32) | rest[i];
+      rest[i] = (uint32_t) (current / 1000000000);
+      chunk = current % 1000000000;
+    }
+
+    while (length && !rest[length - 1])
+      length--;
+
+    for (int i = 0; i < 9 && (length || chunk); i++) {
+      *--digit = (char) ('0' + chunk % 10);
+      chunk /= 10;
+    }
+
+  } while (length);
+
+  if (!*digit)
+    *--digit = '0';
+
+  if (a->negative)
+    *--digit = '-';
+
+  memmove(text, digit, (size_t) (text + size - digit));
+
+  free(rest);
+
+  return text;
+}
+
+/*
+
+  Fractions of Bignums
+
+*/
+
+static int isOne(const Bignum *a) {
+  return a->length == 1 && a->limbs[0] == 1 && !a->negative;
+}
+
+static void fractionInit(BigFraction *f) {
+
+  f->numerator = (Bignum) BIGNUM_ZERO;
+  f->denominator = (Bignum) BIGNUM_ZERO;
+
+  fromInt(&f->denominator, 1);
+}
+
+static void fractionFree(BigFraction *f) {
+  freeBignum(&f->numerator);
+  freeBignum(&f->denominator);
+}
+
+static int fractionSet(BigFraction *f, int64_t numerator, int64_t denominator) {
+
+  if (!denominator)
+    return 0;
+
+  if (denominator < 0) {
+    numerator = -numerator;
+    denominator = -denominator;
+  }
+
+  int64_t g = (int64_t) gcd64(numerator < 0 ? -(uint64_t) numerator : (uint64_t) numerator, (uint64_t) denominator);
+
+  fromInt(&f->numerator, numerator / g);
+  fromInt(&f->denominator, denominator / g);
+
+  return 1;
+}
+
+/*
+
+  Moves numerator and denominator into r, 0 is always 0/1
+
+*/
+
+static void fractionMove(BigFraction *r, Bignum *numerator, Bignum *denominator) {
+
+  swapBignums(&r->numerator, numerator);
+  swapBignums(&r->denominator, denominator);
+
+  if (!r->numerator.length)
+    fromInt(&r->denominator, 1);
+}
+
+/*
+
+  a/b + c/d
+
+    g = gcd(b, d)
+    t = a (d / g) + c (b / g)
+
+  t / (b / g * d) only has factors in common with g, so
+
+    g2 = gcd(t, g)
+    r  = (t / g2) / ((b / g) (d / g2))
+
+*/
+
+static void fractionAdd(BigFraction *r, const BigFraction *x, const BigFraction *y) {
+
+  Bignum g = BIGNUM_ZERO, t = BIGNUM_ZERO, u = BIGNUM_ZERO;
+  Bignum b = BIGNUM_ZERO, d = BIGNUM_ZERO;
+
+  gcd(&g, &x->denominator, &y->denominator);
+
+  if (isOne(&g)) {
+
+    multiply(&t, &x->numerator, &y->denominator);
+    multiply(&u, &y->numerator, &x->denominator);
+    add(&t, &t, &u);
+
+    multiply(&u, &x->denominator, &y->denominator);
+  }
+  else {
+
+    divide(&b, NULL, &x->denominator, &g);
+    divide(&d, NULL, &y->denominator, &g);
+
+    multiply(&t, &x->numerator, &d);
+    multiply(&u, &y->numerator, &b);
+    add(&t, &t, &u);
+
+    gcd(&g, &t, &g);
+
+    if (!isOne(&g)) {
+      divide(&t, NULL, &t, &g);
+      divide(&d, NULL, &y->denominator, &g);
+    }
+    else
+      copy(&d, &y->denominator);
+
+    multiply(&u, &b, &d);
+  }
+
+  fractionMove(r, &t, &u);
+
+  freeBignum(&g);
+  freeBignum(&t);
+  freeBignum(&u);
+  freeBignum(&b);
+  freeBignum(&d);
+}
+
+/*
+
+  a/b * c/d
+
+    g1 = gcd(a, d), g2 = gcd(c, b)
+    r  = ((a / g1)(c / g2)) / ((b / g2)(d / g1))
+
+*/
+
+static void fractionMultiply(BigFraction *r, const BigFraction *x, const BigFraction *y) {
+
+  Bignum g1 = BIGNUM_ZERO, g2 = BIGNUM_ZERO;
+  Bignum a = BIGNUM_ZERO, b = BIGNUM_ZERO, c = BIGNUM_ZERO, d = BIGNUM_ZERO;
+
+  // Anything times 0 is 0/1
+  if (!x->numerator.length || !y->numerator.length) {
+
+    freeBignum(&r->numerator);
+    fromInt(&r->denominator, 1);
+
+    return;
+  }
+
+  gcd(&g1, &x->numerator, &y->denominator);
+  gcd(&g2, &y->numerator, &x->denominator);
+
+  divide(&a, NULL, &x->numerator, &g1);
+  divide(&d, NULL, &y->denominator, &g1);
+  divide(&c, NULL, &y->numerator, &g2);
+  divide(&b, NULL, &x->denominator, &g2);
+
+  multiply(&a, &a, &c);
+  multiply(&b, &b, &d);
+
+  fractionMove(r, &a, &b);
+
+  freeBignum(&g1);
+  freeBignum(&g2);
+  freeBignum(&a);
+  freeBignum(&b);
+  freeBignum(&c);
+  freeBignum(&d);
+}
+
+static char *fractionToText(const BigFraction *f) {
+
+  char *numerator = toText(&f->numerator);
+  char *denominator = toText(&f->denominator);
+
+  size_t size = strlen(numerator) + strlen(denominator) + 2;
+  char *text = malloc(size);
+
+  if (!text) DISPLAY_MALLOC_ERROR
+
+  snprintf(text, size, "%s/%s", numerator, denominator);
+
+  free(numerator);
+  free(denominator);
+
+  return text;
+}
+
+/*
+
+  Abstraction, same as in Software.c
+
+*/
+
+const static bignumMath BignumFunctions = {
+  &freeBignum,
+  &fromInt,
+  &toInt,
+  &copy,
+  &compare,
+  &add,
+  &subtract,
+  &multiply,
+  &divide,
+  &divideExact,
+  &gcd,
+  &toText,
+  &fractionInit,
+  &fractionFree,
+  &fractionSet,
+  &fractionAdd,
+  &fractionMultiply,
+  &fractionToText
+};
+
+const bignumMath *restrict Bignums = &BignumFunctions;
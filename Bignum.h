@@ -0,0 +1,269 @@
+/*
+
+  Bignum
+
+  Whole numbers of any size, for results that don't fit in an int,
+  and fractions made of them (BigFraction), which are always kept
+  reduced, with the sign on the numerator.
+
+  Every function writes its result into a Bignum the caller owns,
+  and the result may be one of the inputs:
+
+    Bignum a = BIGNUM_ZERO, b = BIGNUM_ZERO;
+
+    Bignums->fromInt(&a, 99);
+    Bignums->fromInt(&b, 98);
+    Bignums->multiply(&a, &a, &b);
+
+    char *text = Bignums->toText(&a);   // "9702", free() it
+
+    Bignums->free(&a);
+    Bignums->free(&b);
+
+*/
+
+#ifndef BIGNUM
+#define BIGNUM
+
+#include <stdint.h>
+
+/*
+
+  A whole number of any size
+
+  Type: Bignum
+
+*/
+
+typedef struct {
+
+  // Size, 32 bits per limb, least significant first
+  uint32_t *limbs;
+
+  // Limbs in use, 0 for zero, the top one is never 0
+  int length;
+
+  // Limbs allocated
+  int capacity;
+
+  // 1 if below zero
+  int negative;
+
+}
+Bignum;
+
+#define BIGNUM_ZERO { NULL, 0, 0, 0 }
+
+/*
+
+  A fraction of Bignums, reduced, denominator above 0.
+  Start it with Bignums->fractionInit(), it is 0/1.
+
+  Type: BigFraction
+
+*/
+
+typedef struct {
+
+  Bignum numerator;
+
+  Bignum denominator;
+
+}
+BigFraction;
+
+typedef struct {
+
+  /*
+
+    void free(Bignum *a)
+
+    Frees the limbs, a is 0 afterwards and can be used again.
+
+    Access: Bignums->free()
+
+  */
+
+  void(*const free)(Bignum *a);
+
+  /*
+
+    void fromInt(Bignum *r, int64_t value)
+
+    Access: Bignums->fromInt()
+
+  */
+
+  void(*const fromInt)(Bignum *r, int64_t value);
+
+  /*
+
+    int toInt(Bignum *a, int64_t *value)
+
+    Returns 1 and sets value if a fits in an int64_t, else returns 0.
+
+    Access: Bignums->toInt()
+
+  */
+
+  int(*const toInt)(const Bignum *a, int64_t *value);
+
+  /*
+
+    void copy(Bignum *r, Bignum *a)
+
+    Access: Bignums->copy()
+
+  */
+
+  void(*const copy)(Bignum *r, const Bignum *a);
+
+  /*
+
+    int compare(Bignum *a, Bignum *b)
+
+    Returns below 0, 0 or above 0 as a is below, equal to or above b.
+
+    Access: Bignums->compare()
+
+  */
+
+  int(*const compare)(const Bignum *a, const Bignum *b);
+
+  /*
+
+    void add(Bignum *r, Bignum *a, Bignum *b)        r = a + b
+    void subtract(Bignum *r, Bignum *a, Bignum *b)   r = a - b
+    void multiply(Bignum *r, Bignum *a, Bignum *b)   r = a * b
+
+    Multiplication switches to Karatsuba for large numbers.
+
+    Access: Bignums->add(), Bignums->subtract(), Bignums->multiply()
+
+  */
+
+  void(*const add)(Bignum *r, const Bignum *a, const Bignum *b);
+  void(*const subtract)(Bignum *r, const Bignum *a, const Bignum *b);
+  void(*const multiply)(Bignum *r, const Bignum *a, const Bignum *b);
+
+  /*
+
+    int divide(Bignum *quotient, Bignum *remainder, Bignum *a, Bignum *b)
+
+    Divides a by b, rounding towards 0 like C does, the remainder
+    has the sign of a. Either result can be NULL if it isn't needed.
+
+    Returns 0 (and changes nothing) if b is 0, else 1.
+
+    Access: Bignums->divide()
+
+  */
+
+  int(*const divide)(Bignum *quotient, Bignum *remainder, const Bignum *a, const Bignum *b);
+
+  /*
+
+    int divideExact(Bignum *quotient, Bignum *a, Bignum *b)
+
+    a / b, when b is known to divide a, quicker than divide().
+    If it doesn't, the quotient is wrong.
+
+    Returns 0 (and changes nothing) if b is 0, else 1.
+
+    Access: Bignums->divideExact()
+
+  */
+
+  int(*const divideExact)(Bignum *quotient, const Bignum *a, const Bignum *b);
+
+  /*
+
+    void gcd(Bignum *r, Bignum *a, Bignum *b)
+
+    Greatest common divisor, never below 0. gcd(0, 0) is 0.
+
+    Access: Bignums->gcd()
+
+  */
+
+  void(*const gcd)(Bignum *r, const Bignum *a, const Bignum *b);
+
+  /*
+
+    char* toText(Bignum *a)
+
+    Returns a in decimal, in memory from malloc() the caller frees.
+
+    Access: Bignums->toText()
+
+  */
+
+  char*(*const toText)(const Bignum *a);
+
+  /*
+
+    void fractionInit(BigFraction *f)    sets f to 0/1, call it first
+    void fractionFree(BigFraction *f)
+
+    Access: Bignums->fractionInit(), Bignums->fractionFree()
+
+  */
+
+  void(*const fractionInit)(BigFraction *f);
+  void(*const fractionFree)(BigFraction *f);
+
+  /*
+
+    int fractionSet(BigFraction *f, int64_t numerator, int64_t denominator)
+
+    Sets f to numerator/denominator, reduced.
+    Returns 0 (and changes nothing) if denominator is 0, else 1.
+
+    Access: Bignums->fractionSet()
+
+  */
+
+  int(*const fractionSet)(BigFraction *f, int64_t numerator, int64_t denominator);
+
+  /*
+
+    void fractionAdd(BigFraction *r, BigFraction *a, BigFraction *b)        r = a + b
+    void fractionMultiply(BigFraction *r, BigFraction *a, BigFraction *b)   r = a * b
+
+    The common factors are divided out before multiplying
+    (Knuth, TAOCP vol. 2, 4.5.1), so the numbers multiplied
+    are as small as they can be, and the result is reduced.
+
+    Access: Bignums->fractionAdd(), Bignums->fractionMultiply()
+
+  */
+
+  void(*const fractionAdd)(BigFraction *r, const BigFraction *a, const BigFraction *b);
+  void(*const fractionMultiply)(BigFraction *r, const BigFraction *a, const BigFraction *b);
+
+  /*
+
+    char* fractionToText(BigFraction *f)
+
+    Returns "numerator/denominator", in memory from malloc() the caller frees.
+
+    Access: Bignums->fractionToText()
+
+  */
+
+  char*(*const fractionToText)(const BigFraction *f);
+
+}
+bignumMath;
+
+/*
+
+  Call this, Bignums, to access all
+  the publicly available functions.
+
+*/
+
+extern
+const bignumMath * restrict Bignums;
+
+#endif //Bignum.h
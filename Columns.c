@@ -0,0 +1,681 @@
+/*
+
+  Columns
+
+  Writing and reading columnar files. See Columns.h for the format.
+
+  The writer fills one array per column with the rows of the
+  group, and when it is full encodes the columns one after the
+  other into the same buffer, writing each one out as a chunk and
+  adding it to the index. Only the index grows, by COLUMNS_COUNT
+  entries (175 bytes) per COLUMNS_GROUP rows.
+
+*/
+
+#define _FILE_OFFSET_BITS 64
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "Software.h"
+#include "Columns.h"
+
+/*
+
+  Error Messages
+
+*/
+
+#define DISPLAY_MALLOC_ERROR { fprintf(stderr, "FATAL ERROR: UNABLE TO ALLOCATE MEMORY IN HEAP"); exit(-1); }
+#define DISPLAY_FILE_ERROR(file) fprintf(stderr, "Columns: %s: %s\n", file, strerror(errno));
+#define DISPLAY_FORMAT_ERROR(file) fprintf(stderr, "Columns: %s: not a columns file, or damaged\n", file);
+
+/*
+
+  Sizes in the file
+
+*/
+
+#define COLUMNS_MAGIC "FCOL"
+#define COLUMNS_HEADER_SIZE 16
+#define COLUMNS_ENTRY_SIZE 25
+#define COLUMNS_TRAILER_SIZE 24
+
+// Longest encoding of one value, a 5 byte varint, or an operator and its run
+#define COLUMNS_MAX_VALUE_SIZE 6
+
+static const char *const names[COLUMNS_COUNT] = {
+  "operand1Numerator",
+  "operand1Denomenator",
+  "operator",
+  "operand2Numerator",
+  "operand2Denomenator",
+  "resultNumerator",
+  "resultDenomenator"
+};
+
+/*
+
+  One entry of the index
+
+  Type: ColumnsChunk
+
+*/
+
+typedef struct {
+
+  int column;
+  uint32_t rows;
+
+  int32_t min;
+  int32_t max;
+
+  uint64_t offset;
+  uint32_t size;
+
+}
+ColumnsChunk;
+
+struct ColumnsWriter {
+
+  FILE *file;
+  char *path;
+
+  // The group being filled
+  int32_t values[COLUMNS_COUNT][COLUMNS_GROUP];
+  int rows;
+
+  long long total;
+
+  // One column of a group, encoded
+  uint8_t encoded[COLUMNS_GROUP * COLUMNS_MAX_VALUE_SIZE];
+
+  ColumnsChunk *chunks;
+  int chunkCount;
+  int chunkCapacity;
+
+  uint64_t offset;
+
+  int failed;
+};
+
+struct ColumnsReader {
+
+  FILE *file;
+  char *path;
+
+  long long rows;
+
+  ColumnsChunk *chunks;
+  int chunkCount;
+
+  // The chunk being decoded
+  uint8_t *buffer;
+  uint32_t bufferSize;
+};
+
+/*
+
+
+
+  Encoding
+
+
+
+*/
+
+static void putU32(uint8_t *at, uint32_t value) {
+  for (int i = 0; i < 4; i++)
+    at[i] = (uint8_t) (value >> (8 * i));
+}
+
+static void putU64(uint8_t *at, uint64_t value) {
+  for (int i = 0; i < 8; i++)
+    at[i] = (uint8_t) (value >> (8 * i));
+}
+
+static uint32_t getU32(const uint8_t *at) {
+
+  uint32_t value = 0;
+
+  for (int i = 0; i < 4; i++)
+    value |= (uint32_t) at[i] << (8 * i);
+
+  return value;
+}
+
+static uint64_t getU64(const uint8_t *at) {
+
+  uint64_t value = 0;
+
+  for (int i = 0; i < 8; i++)
+    value |= (uint64_t) at[i] << (8 * i);
+
+  return value;
+}
+
+static inline uint32_t zigzag(int32_t value) {
+  return ((uint32_t) value << 1) ^ (uint32_t) (value >> 31);
+}
+
+static inline int32_t unzigzag(uint32_t value) {
+  return (int32_t) ((value >> 1) ^ -(value & 1));
+}
+
+static inline uint8_t *putVarint(uint8_t *at, uint32_t value) {
+
+  while (value >= 0x80) {
+    *at++ = (uint8_t) (value | 0x80);
+    value >>= 7;
+  }
+
+  *at++ = (uint8_t) value;
+
+  return at;
+}
+
+/*
+
+  Returns NULL if the varint runs past end
+
+*/
+
+static inline const uint8_t *getVarint(const uint8_t *at, const uint8_t *end, uint32_t *value) {
+
+  uint32_t result = 0;
+
+  for (int shift = 0; shift < 35; shift += 7) {
+
+    if (at == end)
+      return NULL;
+
+    uint8_t byte = *at++;
+
+    result |= (uint32_t) (byte & 0x7f) << shift;
+
+    if (!(byte & 0x80)) {
+      *value = result;
+      return at;
+    }
+  }
+
+  return NULL;
+}
+
+/*
+
+  Encodes count values of a column, returns the size
+
+*/
+
+static size_t encode(int column, const int32_t *values, int count, uint8_t *out) {
+
+  uint8_t *at = out;
+
+  if (column == COLUMNS_OPERATOR) {
+
+    for (int i = 0; i < count; ) {
+
+      int run = 1;
+
+      while (i + run < count && values[i + run] == values[i])
+        run++;
+
+      *at++ = (uint8_t) values[i];
+      at = putVarint(at, (uint32_t) run);
+
+      i += run;
+    }
+
+    return (size_t) (at - out);
+  }
+
+  uint32_t previous = 0;
+
+  for (int i = 0; i < count; i++) {
+
+    // Differences wrap around, so every int32 works
+    at = putVarint(at, zigzag((int32_t) ((uint32_t) values[i] - previous)));
+    previous = (uint32_t) values[i];
+  }
+
+  return (size_t) (at - out);
+}
+
+/*
+
+  Decodes a chunk of count values, returns 0 if it doesn't
+  hold exactly that many
+
+*/
+
+static int decode(int column, const uint8_t *in, size_t size, int32_t *values, uint32_t count) {
+
+  const uint8_t *end = in + size;
+  uint32_t filled = 0;
+
+  if (column == COLUMNS_OPERATOR) {
+
+    while (in < end) {
+
+      uint8_t operator = *in++;
+      uint32_t run;
+
+      if (!(in = getVarint(in, end, &run)) || run > count - filled)
+        return 0;
+
+      for (uint32_t i = 0; i < run; i++)
+        values[filled++] = operator;
+    }
+
+    return filled == count;
+  }
+
+  uint32_t previous = 0;
+
+  while (in < end && filled < count) {
+
+    uint32_t delta;
+
+    if (!(in = getVarint(in, end, &delta)))
+      return 0;
+
+    previous += (uint32_t) unzigzag(delta);
+    values[filled++] = (int32_t) previous;
+  }
+
+  return filled == count && in == end;
+}
+
+/*
+
+
+
+  Writer
+
+
+
+*/
+
+static int writeBytes(ColumnsWriter *w, const void *data, size_t size) {
+
+  if (w->failed)
+    return 0;
+
+  if (fwrite(data, 1, size, w->file) != size) {
+    DISPLAY_FILE_ERROR(w->path)
+    w->failed = 1;
+    return 0;
+  }
+
+  w->offset += size;
+
+  return 1;
+}
+
+static ColumnsWriter *createWriter(const char *path) {
+
+  ColumnsWriter *w = malloc(sizeof (ColumnsWriter));
+
+  if (!w) DISPLAY_MALLOC_ERROR
+
+  if (!(w->file = fopen(path, "wb"))) {
+    DISPLAY_FILE_ERROR(path)
+    free(w);
+    return NULL;
+  }
+
+  if (!(w->path = strdup(path))) DISPLAY_MALLOC_ERROR
+
+  w->rows = 0;
+  w->total = 0;
+  w->chunks = NULL;
+  w->chunkCount = 0;
+  w->chunkCapacity = 0;
+  w->offset = 0;
+  w->failed = 0;
+
+  uint8_t header[COLUMNS_HEADER_SIZE];
+
+  memcpy(header, COLUMNS_MAGIC, 4);
+  putU32(header + 4, COLUMNS_VERSION);
+  putU32(header + 8, COLUMNS_COUNT);
+  putU32(header + 12, COLUMNS_GROUP);
+
+  writeBytes(w, header, sizeof (header));
+
+  return w;
+}
+
+/*
+
+  Writes out the group, column by column
+
+*/
+
+static void flushGroup(ColumnsWriter *w) {
+
+  if (!w->rows)
+    return;
+
+  for (int c = 0; c < COLUMNS_COUNT; c++) {
+
+    const int32_t *values = w->values[c];
+    int32_t min = values[0], max = values[0];
+
+    for (int i = 1; i < w->rows; i++) {
+      if (values[i] < min) min = values[i];
+      if (values[i] > max) max = values[i];
+    }
+
+    size_t size = encode(c, values, w->rows, w->encoded);
+
+    if (w->chunkCount == w->chunkCapacity) {
+
+      w->chunkCapacity = w->chunkCapacity ? 2 * w->chunkCapacity : 4 * COLUMNS_COUNT;
+      w->chunks = realloc(w->chunks, (size_t) w->chunkCapacity * sizeof (ColumnsChunk));
+
+      if (!w->chunks) DISPLAY_MALLOC_ERROR
+    }
+
+    w->chunks[w->chunkCount++] = (ColumnsChunk) { c, (uint32_t) w->rows, min, max, w->offset, (uint32_t) size };
+
+    writeBytes(w, w->encoded, size);
+  }
+
+  w->rows = 0;
+}
+
+static void append(ColumnsWriter *w, Equation *restrict e) {
+
+  int row = w->rows;
+
+  w->values[COLUMNS_OPERAND1_NUMERATOR][row]   = e->operand1->numerator;
+  w->values[COLUMNS_OPERAND1_DENOMENATOR][row] = e->operand1->denomenator;
+  w->values[COLUMNS_OPERATOR][row]             = (unsigned char) *e->operator;
+  w->values[COLUMNS_OPERAND2_NUMERATOR][row]   = e->operand2->numerator;
+  w->values[COLUMNS_OPERAND2_DENOMENATOR][row] = e->operand2->denomenator;
+  w->values[COLUMNS_RESULT_NUMERATOR][row]     = e->result->numerator;
+  w->values[COLUMNS_RESULT_DENOMENATOR][row]   = e->result->denomenator;
+
+  w->total++;
+
+  if (++w->rows == COLUMNS_GROUP)
+    flushGroup(w);
+}
+
+static long long closeWriter(ColumnsWriter *w) {
+
+  flushGroup(w);
+
+  uint64_t indexOffset = w->offset;
+  uint8_t entry[COLUMNS_ENTRY_SIZE];
+
+  for (int i = 0; i < w->chunkCount; i++) {
+
+    ColumnsChunk *chunk = &w->chunks[i];
+
+    entry[0] = (uint8_t) chunk->column;
+    putU32(entry + 1, chunk->rows);
+    putU32(entry + 5, (uint32_t) chunk->min);
+    putU32(entry + 9, (uint32_t) chunk->max);
+    putU64(entry + 13, chunk->offset);
+    putU32(entry + 21, chunk->size);
+
+    writeBytes(w, entry, sizeof (entry));
+  }
+
+  uint8_t trailer[COLUMNS_TRAILER_SIZE];
+
+  putU64(trailer, indexOffset);
+  putU32(trailer + 8, (uint32_t) w->chunkCount);
+  putU64(trailer + 12, (uint64_t) w->total);
+  memcpy(trailer + 20, COLUMNS_MAGIC, 4);
+
+  writeBytes(w, trailer, sizeof (trailer));
+
+  if (fclose(w->file) && !w->failed) {
+    DISPLAY_FILE_ERROR(w->path)
+    w->failed = 1;
+  }
+
+  long long rows = w->failed ? -1 : w->total;
+
+  free(w->chunks);
+  free(w->path);
+  free(w);
+
+  return rows;
+}
+
+/*
+
+  Equations->forEach() takes no argument for its function,
+  so the writer of the export in progress is kept here
+
+*/
+
+static ColumnsWriter *exporting = NULL;
+
+static void exportEquation(__attribute__((unused)) const int index, Equation *restrict e) {
+  append(exporting, e);
+}
+
+static long long export(const char *path) {
+
+  if (!(exporting = createWriter(path)))
+    return -1;
+
+  Equations->forEach(&exportEquation);
+
+  long long rows = closeWriter(exporting);
+
+  exporting = NULL;
+
+  return rows;
+}
+
+/*
+
+
+
+  Reader
+
+
+
+*/
+
+static void closeReader(ColumnsReader *r);
+
+static ColumnsReader *openReader(const char *path) {
+
+  FILE *file = fopen(path, "rb");
+
+  if (!file) {
+    DISPLAY_FILE_ERROR(path)
+    return NULL;
+  }
+
+  uint8_t header[COLUMNS_HEADER_SIZE], trailer[COLUMNS_TRAILER_SIZE];
+
+  if (
+    fread(header, 1, sizeof (header), file) != sizeof (header) ||
+    memcmp(header, COLUMNS_MAGIC, 4) ||
+    getU32(header + 4) != COLUMNS_VERSION ||
+    getU32(header + 8) != COLUMNS_COUNT ||
+    getU32(header + 12) > COLUMNS_GROUP ||
+    fseeko(file, -COLUMNS_TRAILER_SIZE, SEEK_END) ||
+    fread(trailer, 1, sizeof (trailer), file) != sizeof (trailer) ||
+    memcmp(trailer + 20, COLUMNS_MAGIC, 4)) {
+    DISPLAY_FORMAT_ERROR(path)
+    fclose(file);
+    return NULL;
+  }
+
+  uint64_t rowCount = getU64(trailer + 12);
+  uint32_t chunkCount = getU32(trailer + 8);
+
+  // A full group of every column, and one part full group at the end
+  if (rowCount > INT64_MAX / 2 || chunkCount != COLUMNS_COUNT * ((rowCount + getU32(header + 12) - 1) / (getU32(header + 12) ? getU32(header + 12) : 1))) {
+    DISPLAY_FORMAT_ERROR(path)
+    fclose(file);
+    return NULL;
+  }
+
+  ColumnsReader *r = malloc(sizeof (ColumnsReader));
+
+  if (!r) DISPLAY_MALLOC_ERROR
+
+  r->file = file;
+  r->rows = (long long) rowCount;
+  r->chunkCount = (int) chunkCount;
+  r->buffer = NULL;
+  r->bufferSize = 0;
+
+  if (!(r->path = strdup(path))) DISPLAY_MALLOC_ERROR
+  if (!(r->chunks = malloc((size_t) (r->chunkCount ? r->chunkCount : 1) * sizeof (ColumnsChunk)))) DISPLAY_MALLOC_ERROR
+
+  long long counted[COLUMNS_COUNT] = { 0 };
+  int ok = !fseeko(file, (off_t) getU64(trailer), SEEK_SET);
+
+  for (int i = 0; ok && i < r->chunkCount; i++) {
+
+    uint8_t entry[COLUMNS_ENTRY_SIZE];
+
+    if (fread(entry, 1, sizeof (entry), file) != sizeof (entry) || entry[0] >= COLUMNS_COUNT) {
+      ok = 0;
+      break;
+    }
+
+    r->chunks[i] = (ColumnsChunk) {
+      entry[0],
+      getU32(entry + 1),
+      (int32_t) getU32(entry + 5),
+      (int32_t) getU32(entry + 9),
+      getU64(entry + 13),
+      getU32(entry + 21)
+    };
+
+    ok = r->chunks[i].rows <= COLUMNS_GROUP && r->chunks[i].size <= COLUMNS_GROUP * COLUMNS_MAX_VALUE_SIZE;
+    counted[entry[0]] += r->chunks[i].rows;
+  }
+
+  // Every column has to have every row
+  for (int c = 0; ok && c < COLUMNS_COUNT; c++)
+    ok = counted[c] == r->rows;
+
+  if (!ok) {
+    DISPLAY_FORMAT_ERROR(path)
+    closeReader(r);
+    return NULL;
+  }
+
+  return r;
+}
+
+static long long rows(const ColumnsReader *r) {
+  return r->rows;
+}
+
+static int stats(const ColumnsReader *r, int column, int32_t *min, int32_t *max, long long *bytes) {
+
+  int found = 0;
+
+  *bytes = 0;
+
+  for (int i = 0; i < r->chunkCount; i++) {
+
+    const ColumnsChunk *chunk = &r->chunks[i];
+
+    if (chunk->column != column)
+      continue;
+
+    if (!found || chunk->min < *min) *min = chunk->min;
+    if (!found || chunk->max > *max) *max = chunk->max;
+
+    *bytes += chunk->size;
+    found = 1;
+  }
+
+  return found;
+}
+
+static int load(ColumnsReader *r, int column, int32_t *restrict values) {
+
+  long long filled = 0;
+
+  for (int i = 0; i < r->chunkCount; i++) {
+
+    const ColumnsChunk *chunk = &r->chunks[i];
+
+    if (chunk->column != column)
+      continue;
+
+    if (chunk->size > r->bufferSize) {
+
+      r->bufferSize = COLUMNS_GROUP * COLUMNS_MAX_VALUE_SIZE;
+      r->buffer = realloc(r->buffer, r->bufferSize);
+
+      if (!r->buffer) DISPLAY_MALLOC_ERROR
+    }
+
+    if (
+      fseeko(r->file, (off_t) chunk->offset, SEEK_SET) ||
+      fread(r->buffer, 1, chunk->size, r->file) != chunk->size ||
+      !decode(column, r->buffer, chunk->size, values + filled, chunk->rows)) {
+      DISPLAY_FORMAT_ERROR(r->path)
+      return 0;
+    }
+
+    filled += chunk->rows;
+  }
+
+  return 1;
+}
+
+static void closeReader(ColumnsReader *r) {
+
+  fclose(r->file);
+
+  free(r->chunks);
+  free(r->buffer);
+  free(r->path);
+  free(r);
+}
+
+static int column(const char *name) {
+
+  for (int c = 0; c < COLUMNS_COUNT; c++)
+    if (!strcmp(names[c], name))
+      return c;
+
+  return -1;
+}
+
+static const char *name(int column) {
+  return column >= 0 && column < COLUMNS_COUNT ? names[column] : NULL;
+}
+
+/*
+
+  Abstraction, same as in Software.c
+
+*/
+
+const static columnarFiles ColumnsFunctions = {
+  &createWriter,
+  &append,
+  &closeWriter,
+  &export,
+  &openReader,
+  &rows,
+  &stats,
+  &load,
+  &closeReader,
+  &column,
+  &name
+};
+
+const columnarFiles *restrict Columns = &ColumnsFunctions;
@@ -0,0 +1,240 @@
+/*
+
+  Columns
+
+  Equation history in a columnar file, for analytics tools to load
+  instead of parsing the text of Equations->getFormatted().
+
+  Every field of an equation is its own column. The rows are cut
+  into groups of COLUMNS_GROUP, and each column of a group is one
+  chunk, compressed on its own:
+
+    numerators, denominators   the first value, then the difference
+                               from the one before, zigzag encoded
+                               (small either sign) as LEB128 varints
+    operators                  runs of the same operator, as the
+                               operator and a varint length
+
+  The file, all integers little endian:
+
+    "FCOL"  version  columns  COLUMNS_GROUP     (4 x 4 bytes)
+    chunks, group by group, column by column
+    index, one entry per chunk                  (25 bytes each)
+      column (1) rows (4) min (4) max (4) offset (8) size (4)
+    index offset (8)  chunks (4)  rows (8)  "FCOL"
+
+  The writer only keeps one group and the index in memory, so it
+  can be fed rows one at a time, and a reader finds every chunk of
+  a column (and its min and max) in the index, so it reads only
+  the columns it is asked for.
+
+*/
+
+#ifndef COLUMNS
+#define COLUMNS
+
+#include <stdint.h>
+#include "Software.h"
+
+/*
+
+  Columns, in the order of the file
+
+*/
+
+#define COLUMNS_OPERAND1_NUMERATOR   0
+#define COLUMNS_OPERAND1_DENOMENATOR 1
+#define COLUMNS_OPERATOR             2
+#define COLUMNS_OPERAND2_NUMERATOR   3
+#define COLUMNS_OPERAND2_DENOMENATOR 4
+#define COLUMNS_RESULT_NUMERATOR     5
+#define COLUMNS_RESULT_DENOMENATOR   6
+
+#define COLUMNS_COUNT 7
+
+/*
+
+  Rows per chunk
+
+*/
+
+#define COLUMNS_GROUP 65536
+
+#define COLUMNS_VERSION 1
+
+/*
+
+  An open file being written, or read, only Columns looks inside
+
+  Type: ColumnsWriter, ColumnsReader
+
+*/
+
+typedef struct ColumnsWriter ColumnsWriter;
+typedef struct ColumnsReader ColumnsReader;
+
+typedef struct {
+
+  /*
+
+    ColumnsWriter* create(char *path)
+
+    Creates (or empties) the file at path.
+
+    Returns NULL if it can't be created (and prints why).
+
+    Access: Columns->create()
+
+  */
+
+  ColumnsWriter*(*const create)(const char *path);
+
+  /*
+
+    void append(ColumnsWriter *w, Equation *e)
+
+    Adds an equation as the next row, a group is written
+    out as soon as it is full.
+
+    Access: Columns->append()
+
+  */
+
+  void(*const append)(ColumnsWriter *w, Equation * restrict e);
+
+  /*
+
+    long long close(ColumnsWriter *w)
+
+    Writes the last group and the index, and frees w.
+
+    Returns the number of rows, or -1 if anything
+    couldn't be written.
+
+    Access: Columns->close()
+
+  */
+
+  long long(*const close)(ColumnsWriter *w);
+
+  /*
+
+    long long export(char *path)
+
+    Writes every stored equation to a new file at path,
+    through Equations->forEach().
+
+    Returns the number of rows, or -1 on failure.
+
+    Access: Columns->export()
+
+  */
+
+  long long(*const export)(const char *path);
+
+  /*
+
+    ColumnsReader* open(char *path)
+
+    Opens a file and reads its index, no chunk is read yet.
+
+    Returns NULL if it isn't a columns file (and prints why).
+
+    Access: Columns->open()
+
+  */
+
+  ColumnsReader*(*const open)(const char *path);
+
+  /*
+
+    long long rows(ColumnsReader *r)
+
+    Rows in the file.
+
+    Access: Columns->rows()
+
+  */
+
+  long long(*const rows)(const ColumnsReader *r);
+
+  /*
+
+    int stats(ColumnsReader *r, int column, int32_t *min, int32_t *max, long long *bytes)
+
+    The smallest and largest value of a column, and the size of
+    its chunks, from the index alone. Returns 0 if the file has no
+    rows or there is no such column.
+
+    Access: Columns->stats()
+
+  */
+
+  int(*const stats)(const ColumnsReader *r, int column, int32_t *min, int32_t *max, long long *bytes);
+
+  /*
+
+    int load(ColumnsReader *r, int column, int32_t *values)
+
+    Reads and decodes every chunk of one column, and only those,
+    into values (rows() of them, operators as their character).
+
+    Returns 1 on success, else 0 (and prints why).
+
+    Access: Columns->load()
+
+  */
+
+  int(*const load)(ColumnsReader *r, int column, int32_t * restrict values);
+
+  /*
+
+    void closeReader(ColumnsReader *r)
+
+    Closes the file and frees r.
+
+    Access: Columns->closeReader()
+
+  */
+
+  void(*const closeReader)(ColumnsReader *r);
+
+  /*
+
+    int column(char *name)
+
+    The column called name (the field names of WireRecord, like
+    "resultNumerator"), or -1 if there is none.
+
+    Access: Columns->column()
+
+  */
+
+  int(*const column)(const char *name);
+
+  /*
+
+    char* name(int column)
+
+    The name of a column.
+
+    Access: Columns->name()
+
+  */
+
+  const char*(*const name)(int column);
+
+}
+columnarFiles;
+
+/*
+
+  Call this, Columns, to access all
+  the publicly available functions.
+
+*/
+
+extern
+const columnarFiles * restrict Columns;
+
+#endif //Columns.h
@@ -0,0 +1,857 @@
+/*
+
+  Daemon
+
+  A single threaded, non-blocking epoll event loop that answers
+  expressions from many clients at once, and the load test client
+  used to measure it. See Daemon.h for the protocol.
+
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#include "Software.h"
+#include "Operations.h"
+#include "Daemon.h"
+
+/*
+
+  Error Messages
+
+*/
+
+#define DISPLAY_SOCKET_ERROR(what) fprintf(stderr, "Daemon: %s failed: %s\n", what, strerror(errno));
+#define DISPLAY_MALLOC_ERROR { fprintf(stderr, "FATAL ERROR: UNABLE TO ALLOCATE MEMORY IN HEAP"); exit(-1); }
+
+/*
+
+  Limits
+
+*/
+
+// Events handled per epoll_wait()
+#define DAEMON_MAX_EVENTS 256
+
+// Bytes of unanswered input kept per connection, longer lines are rejected
+#define DAEMON_INPUT_SIZE 65536
+
+// Stop reading from a client that isn't reading its answers
+#define DAEMON_OUTPUT_HIGH_WATER (1 << 20)
+
+// Longest answer line
+#define DAEMON_MAX_ANSWER 64
+
+/*
+
+  One client connection, or one of the listening sockets
+
+  Type: Connection
+
+*/
+
+typedef struct {
+
+  int fd;
+
+  // 1 for the listening sockets
+  int listener;
+
+  // Unanswered input
+  char *input;
+  size_t inputLength;
+
+  // Set while skipping the rest of a line that was too long
+  int discarding;
+
+  // Set once the client closed its side, kept until it has its answers
+  int closing;
+
+  // Answers not yet written
+  char *output;
+  size_t outputStart;
+  size_t outputLength;
+  size_t outputCapacity;
+
+  // Events currently registered with epoll
+  unsigned int events;
+
+}
+Connection;
+
+/*
+
+  Set by the signal handler to stop the event loop
+
+*/
+
+static volatile sig_atomic_t stopping = 0;
+
+static void stopServing(__attribute__((unused)) int signal) {
+  stopping = 1;
+}
+
+/*
+
+  Nanoseconds on the monotonic clock
+
+*/
+
+static long long now() {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (long long) t.tv_sec * 1000000000LL + t.tv_nsec;
+}
+
+/*
+
+  Appends bytes to the output buffer of a connection
+
+*/
+
+static void appendOutput(Connection *c, const char *text, size_t length) {
+
+  if (c->outputStart + c->outputLength + length > c->outputCapacity) {
+
+    // Move what is left to the front before growing
+    if (c->outputLength)
+      memmove(c->output, c->output + c->outputStart, c->outputLength);
+
+    c->outputStart = 0;
+
+    while (c->outputLength + length > c->outputCapacity) {
+
+      c->outputCapacity = c->outputCapacity ? c->outputCapacity * 2 : 4096;
+      c->output = realloc(c->output, c->outputCapacity);
+
+      if (!c->output) DISPLAY_MALLOC_ERROR
+    }
+  }
+
+  memcpy(c->output + c->outputStart + c->outputLength, text, length);
+  c->outputLength += length;
+}
+
+/*
+
+  Evaluates one line and appends the answer
+
+*/
+
+static void answerLine(Connection *c, char *line) {
+
+  char answer[DAEMON_MAX_ANSWER];
+  int length = answerExpression(line, answer, sizeof (answer));
+
+  appendOutput(c, answer, (size_t) length);
+}
+
+/*
+
+  Tells epoll which events we want for a connection,
+  only calls epoll_ctl() if they changed.
+
+*/
+
+static void watch(int epoll, Connection *c, unsigned int events) {
+
+  if (events == c->events)
+    return;
+
+  struct epoll_event event = { .events = events, .data.ptr = c };
+  epoll_ctl(epoll, EPOLL_CTL_MOD, c->fd, &event);
+
+  c->events = events;
+}
+
+/*
+
+  Closes and frees a connection
+
+*/
+
+static void closeConnection(int epoll, Connection *c) {
+  epoll_ctl(epoll, EPOLL_CTL_DEL, c->fd, NULL);
+  close(c->fd);
+  free(c->input);
+  free(c->output);
+  free(c);
+}
+
+/*
+
+  Writes as many answers as the socket takes.
+
+  Returns 0 if the connection broke.
+
+*/
+
+static int flushOutput(Connection *c) {
+
+  while (c->outputLength) {
+
+    ssize_t written = send(c->fd, c->output + c->outputStart, c->outputLength, MSG_NOSIGNAL);
+
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+
+    c->outputStart  += (size_t) written;
+    c->outputLength -= (size_t) written;
+  }
+
+  c->outputStart = 0;
+
+  return 1;
+}
+
+/*
+
+  Reads everything available and answers every complete line,
+  sets closing if the client closed its side.
+
+  Returns 0 if the connection broke.
+
+*/
+
+static int readInput(Connection *c) {
+
+  for (;;) {
+
+    // Stop reading until the client catches up with its answers
+    if (c->outputLength > DAEMON_OUTPUT_HIGH_WATER)
+      return 1;
+
+    ssize_t got = read(c->fd, c->input + c->inputLength, DAEMON_INPUT_SIZE - c->inputLength - 1);
+
+    if (got == 0) {
+      c->closing = 1;
+      return 1;
+    }
+
+    if (got < 0) {
+      if (errno == EINTR) continue;
+      return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+
+    size_t end = c->inputLength + (size_t) got;
+    size_t start = 0;
+
+    /*
+
+      Answer every complete line, pipelined lines
+      are answered in the order they arrived.
+
+    */
+
+    for (size_t i = c->inputLength; i < end; i++) {
+
+      if (c->input[i] != '\n')
+        continue;
+
+      c->input[i] = 0;
+
+      if (i > start && c->input[i - 1] == '\r')
+        c->input[i - 1] = 0;
+
+      if (c->discarding)
+        c->discarding = 0;
+      else
+        answerLine(c, c->input + start);
+
+      start = i + 1;
+    }
+
+    // Keep the incomplete line for next time
+    memmove(c->input, c->input + start, end - start);
+    c->inputLength = end - start;
+
+    // A line that doesn't fit is answered once, then skipped
+    if (c->inputLength == DAEMON_INPUT_SIZE - 1) {
+      if (!c->discarding)
+        appendOutput(c, "error: line too long\n", 21);
+      c->discarding = 1;
+      c->inputLength = 0;
+    }
+  }
+}
+
+/*
+
+  Creates a connection for a socket and adds it to epoll
+
+*/
+
+static Connection *addConnection(int epoll, int fd, int listener) {
+
+  Connection *c = calloc(1, sizeof (Connection));
+
+  if (!c) DISPLAY_MALLOC_ERROR
+
+  c->fd = fd;
+  c->listener = listener;
+  c->events = EPOLLIN;
+
+  if (!listener) {
+    c->input = malloc(DAEMON_INPUT_SIZE);
+    if (!c->input) DISPLAY_MALLOC_ERROR
+  }
+
+  struct epoll_event event = { .events = EPOLLIN, .data.ptr = c };
+
+  if (epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &event) < 0) {
+    DISPLAY_SOCKET_ERROR("epoll_ctl")
+    close(fd);
+    free(c->input);
+    free(c);
+    return NULL;
+  }
+
+  return c;
+}
+
+/*
+
+  Opens the Unix domain socket
+
+*/
+
+static int listenUnix(const char *path) {
+
+  struct sockaddr_un address = { .sun_family = AF_UNIX };
+
+  if (strlen(path) >= sizeof (address.sun_path)) {
+    fprintf(stderr, "Daemon: socket path too long\n");
+    return -1;
+  }
+
+  strcpy(address.sun_path, path);
+
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+  if (fd < 0) {
+    DISPLAY_SOCKET_ERROR("socket")
+    return -1;
+  }
+
+  // A socket file left behind by a previous run
+  unlink(path);
+
+  if (bind(fd, (struct sockaddr *) &address, sizeof (address)) < 0 || listen(fd, SOMAXCONN) < 0) {
+    DISPLAY_SOCKET_ERROR(path)
+    close(fd);
+    return -1;
+  }
+
+  return fd;
+}
+
+/*
+
+  Opens the localhost TCP port
+
+*/
+
+static int listenTCP(int port) {
+
+  struct sockaddr_in address = {
+    .sin_family = AF_INET,
+    .sin_port = htons((uint16_t) port),
+    .sin_addr.s_addr = htonl(INADDR_LOOPBACK)
+  };
+
+  int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  int yes = 1;
+
+  if (fd < 0) {
+    DISPLAY_SOCKET_ERROR("socket")
+    return -1;
+  }
+
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof (yes));
+
+  if (bind(fd, (struct sockaddr *) &address, sizeof (address)) < 0 || listen(fd, SOMAXCONN) < 0) {
+    DISPLAY_SOCKET_ERROR("TCP port")
+    close(fd);
+    return -1;
+  }
+
+  return fd;
+}
+
+/*
+
+  Accepts every pending client of a listening socket
+
+*/
+
+static void acceptClients(int epoll, Connection *listener) {
+
+  for (;;) {
+
+    int fd = accept4(listener->fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+    if (fd < 0) {
+      if (errno == EINTR) continue;
+      if (errno != EAGAIN && errno != EWOULDBLOCK) DISPLAY_SOCKET_ERROR("accept")
+      return;
+    }
+
+    // Answers are small, don't let Nagle hold them back (fails harmlessly on Unix sockets)
+    int yes = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof (yes));
+
+    addConnection(epoll, fd, 0);
+  }
+}
+
+/*
+
+  Handles the events of one client
+
+*/
+
+static void serveClient(int epoll, Connection *c, unsigned int events) {
+
+  /*
+
+    Hung up both ways, nothing more reaches the client. Over the
+    high water mark nothing is read, so this is the only way it
+    is noticed, and EPOLLHUP would be reported again forever.
+
+  */
+
+  int alive = !(events & (EPOLLERR | EPOLLHUP));
+
+  // A client that only closed its side is seen by read() returning 0
+  if (alive && (events & EPOLLIN) && !c->closing)
+    alive = readInput(c);
+
+  /*
+
+    Pipelined lines and then a closed side still get every answer:
+    the connection stays until they are all written.
+
+  */
+
+  if (!flushOutput(c) || !alive || (c->closing && !c->outputLength)) {
+    closeConnection(epoll, c);
+    return;
+  }
+
+  /*
+
+    Level triggered, so input left unread while over the
+    high water mark is reported again once EPOLLIN is back.
+    After the end of the input only EPOLLOUT is left.
+
+  */
+
+  watch(
+    epoll,
+    c,
+    (c->closing || c->outputLength > DAEMON_OUTPUT_HIGH_WATER ? 0 : EPOLLIN) |
+    (c->outputLength ? EPOLLOUT : 0)
+  );
+}
+
+/*
+
+  int serve(daemonOptions *options)
+
+*/
+
+static int serve(const daemonOptions *restrict options) {
+
+  int epoll = epoll_create1(EPOLL_CLOEXEC);
+  int listeners = 0;
+
+  if (epoll < 0) {
+    DISPLAY_SOCKET_ERROR("epoll_create1")
+    return 1;
+  }
+
+  if (options->socketPath) {
+    int fd = listenUnix(options->socketPath);
+    if (fd >= 0 && addConnection(epoll, fd, 1)) {
+      printf("Listening on %s\n", options->socketPath);
+      listeners++;
+    }
+  }
+
+  if (options->port) {
+    int fd = listenTCP(options->port);
+    if (fd >= 0 && addConnection(epoll, fd, 1)) {
+      printf("Listening on 127.0.0.1:%i\n", options->port);
+      listeners++;
+    }
+  }
+
+  if (!listeners) {
+    close(epoll);
+    return 1;
+  }
+
+  fflush(stdout);
+
+  /*
+
+    SIGINT and SIGTERM interrupt epoll_wait() and stop the loop.
+
+  */
+
+  struct sigaction action = { .sa_handler = &stopServing };
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGINT, &action, NULL);
+  sigaction(SIGTERM, &action, NULL);
+
+  struct epoll_event events[DAEMON_MAX_EVENTS];
+
+  while (!stopping) {
+
+    int count = epoll_wait(epoll, events, DAEMON_MAX_EVENTS, -1);
+
+    if (count < 0) {
+      if (errno == EINTR) continue;
+      DISPLAY_SOCKET_ERROR("epoll_wait")
+      break;
+    }
+
+    for (int i = 0; i < count; i++) {
+
+      Connection *c = events[i].data.ptr;
+
+      if (c->listener)
+        acceptClients(epoll, c);
+      else
+        serveClient(epoll, c, events[i].events);
+    }
+  }
+
+  if (options->socketPath)
+    unlink(options->socketPath);
+
+  close(epoll);
+
+  printf("\nDaemon stopped\n");
+
+  return 0;
+}
+
+/*
+
+
+
+  Load Test
+
+
+
+*/
+
+/*
+
+  One load test connection
+
+  Type: Client
+
+*/
+
+typedef struct {
+
+  int fd;
+
+  // When each request in flight was sent, oldest first (a ring)
+  long long *sentAt;
+  int head;
+  int inFlight;
+
+  // Requests written but not yet accepted by the socket
+  char *pending;
+  size_t pendingStart;
+  size_t pendingLength;
+
+  // Part of an answer line that hasn't arrived completely
+  int partial;
+
+}
+Client;
+
+/*
+
+  Connects to the daemon
+
+*/
+
+static int connectToDaemon(const daemonOptions *restrict options) {
+
+  int fd;
+
+  if (options->socketPath) {
+
+    struct sockaddr_un address = { .sun_family = AF_UNIX };
+    strncpy(address.sun_path, options->socketPath, sizeof (address.sun_path) - 1);
+
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+    if (fd >= 0 && connect(fd, (struct sockaddr *) &address, sizeof (address)) < 0) {
+      close(fd);
+      fd = -1;
+    }
+  }
+
+  else {
+
+    struct sockaddr_in address = {
+      .sin_family = AF_INET,
+      .sin_port = htons((uint16_t) options->port),
+      .sin_addr.s_addr = htonl(INADDR_LOOPBACK)
+    };
+
+    fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+    if (fd >= 0 && connect(fd, (struct sockaddr *) &address, sizeof (address)) < 0) {
+      close(fd);
+      fd = -1;
+    }
+
+    int yes = 1;
+    if (fd >= 0)
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof (yes));
+  }
+
+  if (fd < 0) {
+    DISPLAY_SOCKET_ERROR("connect")
+    return -1;
+  }
+
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+  return fd;
+}
+
+/*
+
+  Writes the i'th test expression into text, they cycle
+  through every operator and a spread of valid fractions.
+
+*/
+
+static int testExpression(long i, char *text) {
+
+  static const char operators[] = { OP_ADD, OP_SUB, OP_MUL, OP_DIV };
+
+  return sprintf(
+    text,
+    "%li/%li %c %li/%li\n",
+    i % 97, i % 89 + 1,
+    operators[i % 4],
+    i % 83 + 1, i % 79 + 1
+  );
+}
+
+/*
+
+  Sends more requests on a client, keeping pipeline in flight
+
+*/
+
+static void sendRequests(int epoll, Client *client, const daemonOptions *restrict options, long *sent) {
+
+  char text[DAEMON_MAX_ANSWER];
+
+  memmove(client->pending, client->pending + client->pendingStart, client->pendingLength);
+  client->pendingStart = 0;
+
+  while (client->inFlight < options->pipeline && *sent < options->requests) {
+
+    int length = testExpression(*sent, text);
+
+    memcpy(client->pending + client->pendingStart + client->pendingLength, text, (size_t) length);
+    client->pendingLength += (size_t) length;
+
+    client->sentAt[(client->head + client->inFlight) % options->pipeline] = now();
+    client->inFlight++;
+
+    (*sent)++;
+  }
+
+  while (client->pendingLength) {
+
+    ssize_t written = send(client->fd, client->pending + client->pendingStart, client->pendingLength, MSG_NOSIGNAL);
+
+    if (written <= 0)
+      break;
+
+    client->pendingStart  += (size_t) written;
+    client->pendingLength -= (size_t) written;
+  }
+
+  // Ask to be told when the rest can be written
+  struct epoll_event event = {
+    .events = EPOLLIN | (client->pendingLength ? EPOLLOUT : 0),
+    .data.ptr = client
+  };
+
+  epoll_ctl(epoll, EPOLL_CTL_MOD, client->fd, &event);
+}
+
+/*
+
+  For sorting latencies
+
+*/
+
+static int compareLatency(const void *a, const void *b) {
+  long long x = *(const long long *) a, y = *(const long long *) b;
+  return (x > y) - (x < y);
+}
+
+/*
+
+  int loadTest(daemonOptions *options)
+
+*/
+
+static int loadTest(const daemonOptions *restrict options) {
+
+  int connections = options->connections;
+  int pipeline = options->pipeline;
+
+  Client *clients = calloc((size_t) connections, sizeof (Client));
+  long long *latencies = malloc((size_t) options->requests * sizeof (long long));
+
+  if (!clients || !latencies) DISPLAY_MALLOC_ERROR
+
+  int epoll = epoll_create1(EPOLL_CLOEXEC);
+
+  for (int i = 0; i < connections; i++) {
+
+    clients[i].fd = connectToDaemon(options);
+
+    if (clients[i].fd < 0)
+      return 1;
+
+    clients[i].sentAt  = malloc((size_t) pipeline * sizeof (long long));
+    clients[i].pending = malloc((size_t) pipeline * DAEMON_MAX_ANSWER);
+
+    if (!clients[i].sentAt || !clients[i].pending) DISPLAY_MALLOC_ERROR
+
+    struct epoll_event event = { .events = EPOLLIN, .data.ptr = &clients[i] };
+    epoll_ctl(epoll, EPOLL_CTL_ADD, clients[i].fd, &event);
+  }
+
+  long sent = 0, received = 0, errors = 0;
+  int dropped = 0;
+  long long started = now();
+
+  for (int i = 0; i < connections; i++)
+    sendRequests(epoll, &clients[i], options, &sent);
+
+  struct epoll_event events[DAEMON_MAX_EVENTS];
+  char buffer[DAEMON_INPUT_SIZE];
+
+  while (received < options->requests && !dropped) {
+
+    int count = epoll_wait(epoll, events, DAEMON_MAX_EVENTS, 5000);
+
+    if (count <= 0) {
+      fprintf(stderr, "Load test: daemon stopped answering\n");
+      break;
+    }
+
+    for (int e = 0; e < count; e++) {
+
+      Client *client = events[e].data.ptr;
+
+      if (!(events[e].events & (EPOLLIN | EPOLLHUP | EPOLLERR))) {
+        sendRequests(epoll, client, options, &sent);
+        continue;
+      }
+
+      ssize_t got = read(client->fd, buffer, sizeof (buffer));
+
+      if (got <= 0) {
+        if (got < 0 && (errno == EAGAIN || errno == EINTR)) continue;
+        // Only the answers that came back are measured
+        fprintf(stderr, "Load test: daemon closed a connection\n");
+        dropped = 1;
+        break;
+      }
+
+      long long arrived = now();
+
+      for (ssize_t i = 0; i < got; i++) {
+
+        if (!client->partial && buffer[i] == 'e')
+          errors++;
+
+        client->partial = buffer[i] != '\n';
+
+        // Also ignores answers nobody asked for
+        if (buffer[i] != '\n' || !client->inFlight)
+          continue;
+
+        latencies[received++] = arrived - client->sentAt[client->head];
+        client->head = (client->head + 1) % pipeline;
+        client->inFlight--;
+      }
+
+      sendRequests(epoll, client, options, &sent);
+    }
+  }
+
+  double seconds = (double) (now() - started) / 1e9;
+
+  qsort(latencies, (size_t) received, sizeof (long long), &compareLatency);
+
+  printf("Requests:     %li (%li errors)\n", received, errors);
+  printf("Connections:  %i, pipeline %i\n", connections, pipeline);
+  printf("Time:         %.3f s\n", seconds);
+  printf("Requests/sec: %.0f\n", received / seconds);
+
+  if (received) {
+    printf("Latency p50:  %.1f us\n", latencies[received / 2] / 1e3);
+    printf("Latency p99:  %.1f us\n", latencies[(received * 99) / 100] / 1e3);
+    printf("Latency max:  %.1f us\n", latencies[received - 1] / 1e3);
+  }
+
+  for (int i = 0; i < connections; i++) {
+    close(clients[i].fd);
+    free(clients[i].sentAt);
+    free(clients[i].pending);
+  }
+
+  free(clients);
+  free(latencies);
+  close(epoll);
+
+  return received == options->requests && !errors ? 0 : 1;
+}
+
+/*
+
+  Abstraction, same as in Software.c
+
+*/
+
+const static daemonServer DaemonFunctions = {
+  &serve,
+  &loadTest
+};
+
+const daemonServer *restrict Daemon = &DaemonFunctions;
@@ -0,0 +1,106 @@
+/*
+
+  Daemon
+
+  Keeps the calculator running as a server, so that other programs
+  don't have to start it and go through the menu for every calculation.
+
+  The daemon listens on a Unix domain socket and on a localhost TCP
+  port at the same time. Clients send one expression per line, in the
+  same format the menu accepts ("1/2 + 3/4"), and get one line back
+  for each, in the same order:
+
+    "5/4"                       when the expression was evaluated
+    "error: <what went wrong>"  when it wasn't
+
+  Clients don't have to wait for an answer before sending the next
+  line (pipelining), every line that has arrived is answered.
+
+  Also contains the load test client, which opens many connections
+  to a running daemon and measures requests per second and latency.
+
+*/
+
+#ifndef DAEMON
+#define DAEMON
+
+#define DAEMON_DEFAULT_SOCKET "/tmp/fractions.sock"
+#define DAEMON_DEFAULT_PORT 7777
+
+/*
+
+  Options for both the daemon and the load test
+
+  Type: daemonOptions
+
+*/
+
+typedef struct {
+
+  // Unix domain socket path, NULL to not use it
+  const char *socketPath;
+
+  // Localhost TCP port, 0 to not use it
+  int port;
+
+  // Load test only: connections to open
+  int connections;
+
+  // Load test only: total requests to send
+  long requests;
+
+  // Load test only: requests in flight per connection
+  int pipeline;
+
+}
+daemonOptions;
+
+typedef struct {
+
+  /*
+
+    int serve(daemonOptions *options)
+
+    Runs the daemon until it receives SIGINT or SIGTERM.
+    Uses socketPath and port from options.
+
+    Returns 0 on a clean shutdown, else 1.
+
+    Access: Daemon->serve()
+
+  */
+
+  int(*const serve)(const daemonOptions * restrict options);
+
+  /*
+
+    int loadTest(daemonOptions *options)
+
+    Connects to a running daemon over the socket (or the port
+    if socketPath is NULL), sends options->requests expressions
+    over options->connections connections with options->pipeline
+    requests in flight on each, and prints requests/sec and the
+    p50/p99/max latency.
+
+    Returns 0 if every request was answered, else 1.
+
+    Access: Daemon->loadTest()
+
+  */
+
+  int(*const loadTest)(const daemonOptions * restrict options);
+
+}
+daemonServer;
+
+/*
+
+  Call this, Daemon, to access all
+  the publicly available functions.
+
+*/
+
+extern
+const daemonServer * restrict Daemon;
+
+#endif //Daemon.h
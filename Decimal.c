@@ -0,0 +1,497 @@
+/*
+
+  Decimal
+
+  Where the repeating part of n/d starts, and how long it is:
+
+    Write d = 2^a 5^b m, with m not divisible by 2 or 5. Multiplying
+    by 10^max(a, b) leaves only m in the denominator, so max(a, b)
+    digits come before the repetition. A fraction over m repeats
+    every k digits when 10^k - 1 is divisible by m, and the smallest
+    such k is the multiplicative order of 10 modulo m.
+
+    The order divides phi(m) (Euler), so it is found by starting at
+    phi(m) and dividing out each prime factor q of phi(m) as long as
+    10^(order / q) is still 1 modulo m. That takes a factorisation
+    and a few modular powers, instead of up to m long division steps.
+
+  Denominators below DECIMAL_CACHE are worked out once, the first
+  time they are needed, so that writing many small fractions
+  (the usual case) doesn't factorise anything.
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <limits.h>
+#include <pthread.h>
+
+#include "Software.h"
+#include "Bignum.h"
+#include "Decimal.h"
+
+/*
+
+  Denominators whose periods are kept
+
+*/
+
+#define DECIMAL_CACHE 1024
+
+/*
+
+  Most distinct prime factors of a 32 bit number
+  (2 3 5 7 11 13 17 19 23 is already past 2^31)
+
+*/
+
+#define DECIMAL_MAX_PRIMES 10
+
+/*
+
+  Most digits fromText() reads, enough for the repeating
+  part of any fraction with a denominator below DECIMAL_CACHE
+
+*/
+
+#define DECIMAL_MAX_DIGITS 1100
+
+static int cachedPeriods[DECIMAL_CACHE];
+static int cachedPrefixes[DECIMAL_CACHE];
+static pthread_once_t cacheOnce = PTHREAD_ONCE_INIT;
+
+static uint64_t gcd64(uint64_t a, uint64_t b) {
+
+  while (b) {
+    uint64_t t = a % b;
+    a = b;
+    b = t;
+  }
+
+  return a;
+}
+
+/*
+
+  Distinct prime factors of n, by trial division, into primes.
+  Returns how many.
+
+*/
+
+static int primeFactors(uint32_t n, uint32_t *primes) {
+
+  int count = 0;
+
+  for (uint32_t p = 2; (uint64_t) p * p <= n; p += p == 2 ? 1 : 2)
+    if (n % p == 0) {
+
+      primes[count++] = p;
+
+      while (n % p == 0)
+        n /= p;
+    }
+
+  if (n > 1)
+    primes[count++] = n;
+
+  return count;
+}
+
+/*
+
+  base^exponent modulo m, m below 2^32 so the products fit in 64 bits
+
+*/
+
+static uint64_t powerModulo(uint64_t base, uint64_t exponent, const uint64_t m) {
+
+  uint64_t result = 1 % m;
+
+  base %= m;
+
+  while (exponent) {
+
+    if (exponent & 1)
+      result = result * base % m;
+
+    base = base * base % m;
+    exponent >>= 1;
+  }
+
+  return result;
+}
+
+/*
+
+  Multiplicative order of 10 modulo m, m above 1 and
+  not divisible by 2 or 5
+
+*/
+
+static int orderOfTen(const uint32_t m) {
+
+  uint32_t primes[DECIMAL_MAX_PRIMES];
+  int count = primeFactors(m, primes);
+
+  // Euler's phi
+  uint64_t phi = m;
+
+  for (int i = 0; i < count; i++)
+    phi = phi / primes[i] * (primes[i] - 1);
+
+  uint64_t order = phi;
+
+  count = primeFactors((uint32_t) phi, primes);
+
+  for (int i = 0; i < count; i++)
+    while (order % primes[i] == 0 && powerModulo(10, order / primes[i], m) == 1)
+      order /= primes[i];
+
+  return (int) order;
+}
+
+static int periodOf(uint32_t denominator, int *prefix) {
+
+  int twos = 0, fives = 0;
+
+  if (!denominator) {
+    *prefix = 0;
+    return 0;
+  }
+
+  while (denominator % 2 == 0) {
+    denominator /= 2;
+    twos++;
+  }
+
+  while (denominator % 5 == 0) {
+    denominator /= 5;
+    fives++;
+  }
+
+  *prefix = twos > fives ? twos : fives;
+
+  return denominator == 1 ? 0 : orderOfTen(denominator);
+}
+
+static void fillCache() {
+
+  for (int d = 0; d < DECIMAL_CACHE; d++)
+    cachedPeriods[d] = periodOf((uint32_t) d, &cachedPrefixes[d]);
+}
+
+static int periodOfAny(const uint32_t denominator, int *prefix) {
+
+  if (denominator >= DECIMAL_CACHE)
+    return periodOf(denominator, prefix);
+
+  pthread_once(&cacheOnce, &fillCache);
+
+  *prefix = cachedPrefixes[denominator];
+
+  return cachedPeriods[denominator];
+}
+
+static int period(int denominator, int *prefix) {
+  return periodOfAny(denominator < 0 ? -(uint32_t) denominator : (uint32_t) denominator, prefix);
+}
+
+static int toText(int numerator, int denominator, char *restrict text, int size) {
+
+  if (!denominator)
+    return 0;
+
+  int64_t n = numerator, d = denominator;
+
+  if (d < 0) {
+    n = -n;
+    d = -d;
+  }
+
+  int negative = n < 0;
+
+  if (negative)
+    n = -n;
+
+  int64_t common = (int64_t) gcd64((uint64_t) n, (uint64_t) d);
+
+  n /= common;
+  d /= common;
+
+  int prefix;
+  int repeat = periodOfAny((uint32_t) d, &prefix);
+
+  int64_t rest = n % d;
+
+  char whole[24];
+  int length = snprintf(whole, sizeof (whole), "%s%lld", negative ? "-" : "", (long long) (n / d));
+
+  // Whole part, point, digits, brackets and the terminator
+  long needed = length + 1;
+
+  if (rest)
+    needed += 1 + prefix + (repeat ? repeat + 2 : 0);
+
+  if (needed > size)
+    return 0;
+
+  char *digit = text;
+
+  for (int i = 0; i < length; i++)
+    *digit++ = whole[i];
+
+  if (rest) {
+
+    *digit++ = '.';
+
+    // Long division, one digit per step
+    for (int i = 0; i < prefix; i++) {
+      rest *= 10;
+      *digit++ = (char) ('0' + rest / d);
+      rest %= d;
+    }
+
+    if (repeat) {
+
+      *digit++ = '(';
+
+      for (int i = 0; i < repeat; i++) {
+        rest *= 10;
+        *digit++ = (char) ('0' + rest / d);
+        rest %= d;
+      }
+
+      *digit++ = ')';
+    }
+  }
+
+  *digit = 0;
+
+  return (int) (digit - text);
+}
+
+/*
+
+  Digits from to to - 1 as one number, skipping the point
+
+*/
+
+static int64_t digitsValue(const char *from, const char *to) {
+
+  int64_t value = 0;
+
+  for (; from < to; from++)
+    if (*from != '.')
+      value = value * 10 + (*from - '0');
+
+  return value;
+}
+
+static void digitsBignum(Bignum *value, const char *from, const char *to) {
+
+  Bignum scale = BIGNUM_ZERO, chunk = BIGNUM_ZERO;
+
+  Bignums->fromInt(value, 0);
+
+  // 9 digits at a time, they fit in an int64_t
+  while (from < to) {
+
+    int64_t digits = 0, ten = 1;
+
+    for (int count = 0; from < to && count < 9; from++)
+      if (*from != '.') {
+        digits = digits * 10 + (*from - '0');
+        ten *= 10;
+        count++;
+      }
+
+    Bignums->fromInt(&scale, ten);
+    Bignums->fromInt(&chunk, digits);
+    Bignums->multiply(value, value, &scale);
+    Bignums->add(value, value, &chunk);
+  }
+
+  Bignums->free(&scale);
+  Bignums->free(&chunk);
+}
+
+/*
+
+  10^count as a Bignum
+
+*/
+
+static void powerOfTen(Bignum *value, const int count) {
+
+  Bignum ten = BIGNUM_ZERO;
+
+  Bignums->fromInt(&ten, 10);
+  Bignums->fromInt(value, 1);
+
+  for (int i = 0; i < count; i++)
+    Bignums->multiply(value, value, &ten);
+
+  Bignums->free(&ten);
+}
+
+/*
+
+  Same as below, for more digits than fit in 64 bits, like the
+  96 repeating digits of 1/97. The fraction itself can still be small.
+
+*/
+
+static int fractionOfLongDigits(const char *digits, const char *end, const char *repeat, const char *repeatEnd, const int decimals, int64_t *n, int64_t *d) {
+
+  Bignum numerator = BIGNUM_ZERO, denominator = BIGNUM_ZERO;
+  Bignum repeating = BIGNUM_ZERO, nines = BIGNUM_ZERO, common = BIGNUM_ZERO;
+
+  digitsBignum(&numerator, digits, end);
+  powerOfTen(&denominator, decimals);
+
+  if (repeat) {
+
+    Bignum one = BIGNUM_ZERO;
+
+    Bignums->fromInt(&one, 1);
+    powerOfTen(&nines, (int) (repeatEnd - repeat));
+    Bignums->subtract(&nines, &nines, &one);
+    Bignums->free(&one);
+
+    digitsBignum(&repeating, repeat, repeatEnd);
+
+    Bignums->multiply(&numerator, &numerator, &nines);
+    Bignums->add(&numerator, &numerator, &repeating);
+    Bignums->multiply(&denominator, &denominator, &nines);
+  }
+
+  Bignums->gcd(&common, &numerator, &denominator);
+  Bignums->divide(&numerator, NULL, &numerator, &common);
+  Bignums->divide(&denominator, NULL, &denominator, &common);
+
+  int fits = Bignums->toInt(&numerator, n) && Bignums->toInt(&denominator, d);
+
+  Bignums->free(&numerator);
+  Bignums->free(&denominator);
+  Bignums->free(&repeating);
+  Bignums->free(&nines);
+  Bignums->free(&common);
+
+  return fits;
+}
+
+/*
+
+  [-]whole[.digits[(repeating)]]
+
+    x.y(z) = (xy (10^r - 1) + z) / (10^k (10^r - 1))
+
+  where xy are the digits before the brackets read as one number,
+  k is how many of them are after the point, and r how many repeat.
+
+*/
+
+static int fromText(const char *restrict text, Fraction *restrict f) {
+
+  const char *c = text;
+  int negative = *c == '-';
+
+  if (negative)
+    c++;
+
+  // The digits before any brackets, with the point in them
+  const char *digits = c;
+  const char *point = NULL;
+
+  while (*c >= '0' && *c <= '9')
+    c++;
+
+  if (*c == '.') {
+
+    point = c++;
+
+    while (*c >= '0' && *c <= '9')
+      c++;
+  }
+
+  const char *end = c;
+
+  // Only taken if the brackets are closed with digits in them
+  const char *repeat = NULL, *repeatEnd = NULL;
+
+  if (point && *c == '(') {
+
+    const char *bracket = c + 1;
+
+    while (*bracket >= '0' && *bracket <= '9')
+      bracket++;
+
+    if (bracket > c + 1 && *bracket == ')') {
+      repeat = c + 1;
+      repeatEnd = bracket;
+      c = bracket + 1;
+    }
+  }
+
+  int decimals = point ? (int) (end - point - 1) : 0;
+  int repeats = repeat ? (int) (repeatEnd - repeat) : 0;
+  int count = (int) (end - digits) - (point ? 1 : 0) + repeats;
+
+  if (!count || count > DECIMAL_MAX_DIGITS)
+    return 0;
+
+  int64_t numerator, denominator;
+
+  // 18 digits always fit in 64 bits, and so do the products below
+  if (count <= 18) {
+
+    numerator = digitsValue(digits, end);
+    denominator = 1;
+
+    for (int i = 0; i < decimals; i++)
+      denominator *= 10;
+
+    if (repeat) {
+
+      int64_t nines = 1;
+
+      for (int i = 0; i < repeats; i++)
+        nines *= 10;
+
+      nines--;
+
+      numerator = numerator * nines + digitsValue(repeat, repeatEnd);
+      denominator *= nines;
+    }
+
+    int64_t common = (int64_t) gcd64((uint64_t) numerator, (uint64_t) denominator);
+
+    numerator /= common;
+    denominator /= common;
+  }
+  else if (!fractionOfLongDigits(digits, end, repeat, repeatEnd, decimals, &numerator, &denominator))
+    return 0;
+
+  if (numerator > INT_MAX || denominator > INT_MAX)
+    return 0;
+
+  f->numerator = negative ? (int) -numerator : (int) numerator;
+  f->denomenator = (int) denominator;
+
+  return (int) (c - text);
+}
+
+/*
+
+  Abstraction, same as in Software.c
+
+*/
+
+const static decimalFormat DecimalFunctions = {
+  &period,
+  &toText,
+  &fromText
+};
+
+const decimalFormat *restrict Decimal = &DecimalFunctions;
@@ -0,0 +1,85 @@
+/*
+
+  Decimal
+
+  Exact decimal form of fractions, with the repeating part in
+  brackets, and back:
+
+    1/4  <->  0.25
+    1/6  <->  0.1(6)
+   -4/3  <-> -1.(3)
+
+  How long the repeating part is, is worked out with number theory
+  (the multiplicative order of 10, see Decimal.c), so writing a
+  decimal is only the long division of the digits that are printed,
+  without remembering remainders to spot the repetition.
+
+*/
+
+#ifndef DECIMAL
+#define DECIMAL
+
+#include "Software.h"
+
+typedef struct {
+
+  /*
+
+    int period(int denominator, int *prefix)
+
+    For any fraction n/denominator in lowest terms, returns how many
+    digits repeat (0 if it ends), and sets prefix to how many digits
+    after the point come before the repeating part.
+
+    Access: Decimal->period()
+
+  */
+
+  int(*const period)(int denominator, int *prefix);
+
+  /*
+
+    int toText(int numerator, int denominator, char *text, int size)
+
+    Writes numerator/denominator in decimal into text.
+
+    Returns the length written, or 0 (text unchanged) if the
+    denominator is 0 or the decimal doesn't fit in size bytes.
+
+    Access: Decimal->toText()
+
+  */
+
+  int(*const toText)(int numerator, int denominator, char * restrict text, int size);
+
+  /*
+
+    int fromText(char *text, Fraction *f)
+
+    Reads a decimal at the start of text, like "2", "-0.25", ".5"
+    or "0.1(6)", into f, in lowest terms.
+
+    Returns how many characters were read, or 0 (f unchanged) if
+    there isn't a decimal there, it doesn't fit in an int, or it
+    has more digits than DECIMAL_MAX_DIGITS (see Decimal.c).
+
+    Access: Decimal->fromText()
+
+  */
+
+  int(*const fromText)(const char * restrict text, Fraction * restrict f);
+
+}
+decimalFormat;
+
+/*
+
+  Call this, Decimal, to access all
+  the publicly available functions.
+
+*/
+
+extern
+const decimalFormat * restrict Decimal;
+
+#endif //Decimal.h
@@ -0,0 +1,728 @@
+/*
+
+  Expression
+
+  Recursive descent, one function per level of precedence:
+
+    sum       = product { ("+" | "-") product }
+    product   = negation { ("*" | "/") negation }
+    negation  = "-" negation | power
+    power     = primary [ "^" ["-" | "+"] digits ]
+    primary   = number | "#" digits | "(" sum ")"
+
+  Each function adds its node after the nodes of its operands,
+  which is what puts the list in the order it is evaluated in.
+  -x is added as 0 - x, so evaluating only needs the operators.
+
+  Nodes go through a hash table on their contents on the way in,
+  which is what shares them, and folding happens there too, so a
+  folded number is shared like any other.
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+
+#include "Software.h"
+#include "Operations.h"
+#include "Bignum.h"
+#include "Decimal.h"
+#include "Expression.h"
+
+#define DISPLAY_MALLOC_ERROR { fprintf(stderr, "FATAL ERROR: UNABLE TO ALLOCATE MEMORY IN HEAP"); exit(-1); }
+
+/*
+
+  Where parsing is up to
+
+  Type: ExpressionParser
+
+*/
+
+typedef struct {
+
+  const char *c;
+
+  Expression *e;
+
+  // Brackets open
+  int depth;
+
+  // Open addressing, node indexes by their contents, -1 is empty
+  int *table;
+  int size;
+
+}
+ExpressionParser;
+
+static long long gcdOf(long long a, long long b) {
+
+  if (a < 0) a = -a;
+  if (b < 0) b = -b;
+
+  while (b) {
+    long long t = a % b;
+    a = b;
+    b = t;
+  }
+
+  return a;
+}
+
+/*
+
+  numerator / denominator into r, reduced with the sign on top,
+  0 if it doesn't fit in a Fraction (or the denominator is 0)
+
+*/
+
+static int toFraction(long long numerator, long long denominator, Fraction *r) {
+
+  if (!denominator)
+    return 0;
+
+  if (denominator < 0) {
+    numerator = -numerator;
+    denominator = -denominator;
+  }
+
+  long long divisor = gcdOf(numerator, denominator);
+
+  numerator /= divisor;
+  denominator /= divisor;
+
+  // Not INT_MIN, so it can always be negated
+  if (numerator > INT_MAX || numerator < -INT_MAX || denominator > INT_MAX)
+    return 0;
+
+  *r = (Fraction) { (int) numerator, (int) denominator };
+
+  return 1;
+}
+
+/*
+
+  a^exponent into r, 0 if it gets too big for a Fraction
+
+*/
+
+static int foldPower(const Fraction a, const int exponent, Fraction *r) {
+
+  if (exponent < 0 && !a.numerator)
+    return 0;
+
+  long long numerator = exponent < 0 ? a.denomenator : a.numerator;
+  long long denominator = exponent < 0 ? a.numerator : a.denomenator;
+  long long n = 1, d = 1;
+
+  unsigned int rest = exponent < 0 ? -(unsigned int) exponent : (unsigned int) exponent;
+
+  // Both only ever grow, so once one is past INT_MAX it stays there
+  while (rest) {
+
+    if (rest & 1) {
+      n *= numerator;
+      d *= denominator;
+    }
+
+    rest >>= 1;
+
+    if (n > INT_MAX || n < -INT_MAX || d > INT_MAX || d < -INT_MAX)
+      return 0;
+
+    if (rest) {
+
+      numerator *= numerator;
+      denominator *= denominator;
+
+      if (numerator > INT_MAX || denominator > INT_MAX)
+        return 0;
+    }
+  }
+
+  return toFraction(n, d, r);
+}
+
+/*
+
+  Works out an operator on two numbers into r, 0 if it can't be
+  (the result doesn't fit, or a division by 0, which is left
+  for evaluating to report)
+
+*/
+
+static int fold(const ExpressionNode *node, const Fraction a, const Fraction b, Fraction *r) {
+
+  long long an = a.numerator, ad = a.denomenator;
+  long long bn = b.numerator, bd = b.denomenator;
+
+  switch (node->kind) {
+
+  case OP_ADD: return toFraction(an * bd + bn * ad, ad * bd, r);
+  case OP_SUB: return toFraction(an * bd - bn * ad, ad * bd, r);
+  case OP_MUL: return toFraction(an * bn, ad * bd, r);
+  case OP_DIV: return toFraction(an * bd, ad * bn, r);
+  case OP_POW: return foldPower(a, node->exponent, r);
+  }
+
+  return 0;
+}
+
+static unsigned int hashNode(const ExpressionNode *node) {
+
+  unsigned long long h = (unsigned char) node->kind;
+
+  h = h * 0x9E3779B97F4A7C15ULL + (unsigned int) node->left;
+  h = h * 0x9E3779B97F4A7C15ULL + (unsigned int) node->right;
+  h = h * 0x9E3779B97F4A7C15ULL + (unsigned int) node->value.numerator;
+  h = h * 0x9E3779B97F4A7C15ULL + (unsigned int) node->value.denomenator;
+  h = h * 0x9E3779B97F4A7C15ULL + (unsigned int) node->exponent;
+  h = h * 0x9E3779B97F4A7C15ULL + (unsigned int) node->index;
+
+  return (unsigned int) (h ^ h >> 29);
+}
+
+static int sameNode(const ExpressionNode *a, const ExpressionNode *b) {
+
+  return a->kind == b->kind && a->left == b->left && a->right == b->right &&
+    a->value.numerator == b->value.numerator && a->value.denomenator == b->value.denomenator &&
+    a->exponent == b->exponent && a->index == b->index;
+}
+
+/*
+
+  Doubles the table, and puts every node back in it
+
+*/
+
+static void growTable(ExpressionParser *p) {
+
+  int size = p->size ? p->size * 2 : 256;
+  int *table = malloc((size_t) size * sizeof (int));
+
+  if (!table) DISPLAY_MALLOC_ERROR
+
+  for (int i = 0; i < size; i++)
+    table[i] = -1;
+
+  for (int i = 0; i < p->e->count; i++) {
+
+    unsigned int slot = hashNode(&p->e->nodes[i]) & (unsigned int) (size - 1);
+
+    while (table[slot] >= 0)
+      slot = (slot + 1) & (unsigned int) (size - 1);
+
+    table[slot] = i;
+  }
+
+  free(p->table);
+
+  p->table = table;
+  p->size = size;
+}
+
+/*
+
+  Returns the index of a node like this one, adding it
+  at the end first if there isn't one yet
+
+*/
+
+static int addNode(ExpressionParser *p, ExpressionNode node) {
+
+  Expression *e = p->e;
+
+  e->written++;
+
+  // a + b and b + a are the same node, so are a * b and b * a
+  if ((node.kind == OP_ADD || node.kind == OP_MUL) && node.left > node.right) {
+    int left = node.left;
+    node.left = node.right;
+    node.right = left;
+  }
+
+  if (!EXPRESSION_LEAF(node.kind) && e->nodes[node.left].kind == EXPRESSION_NUMBER &&
+    (node.right < 0 || e->nodes[node.right].kind == EXPRESSION_NUMBER)) {
+
+    Fraction value;
+
+    if (fold(&node, e->nodes[node.left].value, node.right < 0 ? (Fraction) { 0, 1 } : e->nodes[node.right].value, &value)) {
+      node = (ExpressionNode) { EXPRESSION_NUMBER, -1, -1, value, 0 };
+    }
+  }
+
+  if (e->count * 2 >= p->size)
+    growTable(p);
+
+  unsigned int slot = hashNode(&node) & (unsigned int) (p->size - 1);
+
+  for (; p->table[slot] >= 0; slot = (slot + 1) & (unsigned int) (p->size - 1))
+    if (sameNode(&e->nodes[p->table[slot]], &node))
+      return p->table[slot];
+
+  if (e->count == e->capacity) {
+
+    int capacity = e->capacity ? e->capacity * 2 : 64;
+    ExpressionNode *nodes = realloc(e->nodes, (size_t) capacity * sizeof (ExpressionNode));
+
+    if (!nodes) DISPLAY_MALLOC_ERROR
+
+    e->nodes = nodes;
+    e->capacity = capacity;
+  }
+
+  e->nodes[e->count] = node;
+  p->table[slot] = e->count;
+
+  return e->count++;
+}
+
+static int addNumber(ExpressionParser *p, const Fraction value) {
+
+  Fraction reduced = value;
+
+  // Equal numbers must look the same to be shared
+  toFraction(value.numerator, value.denomenator, &reduced);
+
+  return addNode(p, (ExpressionNode) { EXPRESSION_NUMBER, -1, -1, reduced, 0 });
+}
+
+static int addOperator(ExpressionParser *p, const char kind, const int left, const int right, const int exponent) {
+  return addNode(p, (ExpressionNode) { kind, left, right, { 0, 1 }, exponent });
+}
+
+/*
+
+  Drops the nodes root doesn't use (numbers that were folded
+  into others), keeping the rest in the same order, which makes
+  root the last one: everything it uses is before it
+
+*/
+
+static void dropUnused(Expression *e, const int root) {
+
+  char *used = calloc((size_t) e->count, 1);
+  int *index = malloc((size_t) e->count * sizeof (int));
+
+  if (!used || !index) DISPLAY_MALLOC_ERROR
+
+  used[root] = 1;
+
+  // Operands are always before, so one pass back from root is enough
+  for (int i = root; i >= 0; i--) {
+
+    if (!used[i] || EXPRESSION_LEAF(e->nodes[i].kind))
+      continue;
+
+    used[e->nodes[i].left] = 1;
+
+    if (e->nodes[i].right >= 0)
+      used[e->nodes[i].right] = 1;
+  }
+
+  int count = 0;
+
+  for (int i = 0; i < e->count; i++) {
+
+    if (!used[i])
+      continue;
+
+    ExpressionNode node = e->nodes[i];
+
+    if (node.kind == EXPRESSION_REFERENCE)
+      e->references++;
+
+    if (!EXPRESSION_LEAF(node.kind)) {
+
+      node.left = index[node.left];
+
+      if (node.right >= 0)
+        node.right = index[node.right];
+    }
+
+    index[i] = count;
+    e->nodes[count++] = node;
+  }
+
+  e->count = count;
+
+  free(used);
+  free(index);
+}
+
+static void skipSpaces(ExpressionParser *p) {
+
+  while (isspace((unsigned char) *p->c))
+    p->c++;
+}
+
+static int parseSum(ExpressionParser *p);
+
+/*
+
+  Every parse function returns the index of its node, or -1
+
+*/
+
+static int parsePrimary(ExpressionParser *p) {
+
+  skipSpaces(p);
+
+  if (*p->c == '(') {
+
+    if (++p->depth > EXPRESSION_MAX_DEPTH)
+      return -1;
+
+    p->c++;
+
+    int inside = parseSum(p);
+
+    skipSpaces(p);
+
+    if (inside < 0 || *p->c != ')')
+      return -1;
+
+    p->c++;
+    p->depth--;
+
+    return inside;
+  }
+
+  if (*p->c == EXPRESSION_REFERENCE) {
+
+    if (!isdigit((unsigned char) p->c[1]))
+      return -1;
+
+    char *end;
+
+    errno = 0;
+
+    long n = strtol(p->c + 1, &end, 10);
+
+    if (errno || n < 1 || n > INT_MAX)
+      return -1;
+
+    p->c = end;
+
+    return addNode(p, (ExpressionNode) { EXPRESSION_REFERENCE, -1, -1, { 0, 1 }, 0, (int) n - 1 });
+  }
+
+  // The sign is an operator here, not part of the number
+  if (!isdigit((unsigned char) *p->c) && *p->c != '.')
+    return -1;
+
+  Fraction value;
+  int used = Decimal->fromText(p->c, &value);
+
+  if (!used)
+    return -1;
+
+  p->c += used;
+
+  return addNumber(p, value);
+}
+
+static int parsePower(ExpressionParser *p) {
+
+  int base = parsePrimary(p);
+
+  skipSpaces(p);
+
+  if (base < 0 || *p->c != OP_POW)
+    return base;
+
+  p->c++;
+  skipSpaces(p);
+
+  if (!isdigit((unsigned char) *p->c) && !((*p->c == '-' || *p->c == '+') && isdigit((unsigned char) p->c[1])))
+    return -1;
+
+  char *end;
+
+  errno = 0;
+
+  long exponent = strtol(p->c, &end, 10);
+
+  if (errno || exponent > EXPRESSION_MAX_EXPONENT || exponent < -EXPRESSION_MAX_EXPONENT)
+    return -1;
+
+  p->c = end;
+
+  return addOperator(p, OP_POW, base, -1, (int) exponent);
+}
+
+static int parseNegation(ExpressionParser *p) {
+
+  skipSpaces(p);
+
+  if (*p->c != OP_SUB)
+    return parsePower(p);
+
+  p->c++;
+
+  int zero = addNumber(p, (Fraction) { 0, 1 });
+  int operand = parseNegation(p);
+
+  if (operand < 0)
+    return -1;
+
+  return addOperator(p, OP_SUB, zero, operand, 0);
+}
+
+static int parseProduct(ExpressionParser *p) {
+
+  int left = parseNegation(p);
+
+  for (skipSpaces(p); left >= 0 && (*p->c == OP_MUL || *p->c == OP_DIV); skipSpaces(p)) {
+
+    char operator = *p->c++;
+    int right = parseNegation(p);
+
+    left = right < 0 ? -1 : addOperator(p, operator, left, right, 0);
+  }
+
+  return left;
+}
+
+static int parseSum(ExpressionParser *p) {
+
+  int left = parseProduct(p);
+
+  for (skipSpaces(p); left >= 0 && (*p->c == OP_ADD || *p->c == OP_SUB); skipSpaces(p)) {
+
+    char operator = *p->c++;
+    int right = parseProduct(p);
+
+    left = right < 0 ? -1 : addOperator(p, operator, left, right, 0);
+  }
+
+  return left;
+}
+
+static int parse(const char *restrict text, Expression *restrict e) {
+
+  ExpressionParser p = { text, e, 0, NULL, 0 };
+
+  e->count = 0;
+  e->written = 0;
+  e->references = 0;
+
+  int root = parseSum(&p);
+
+  free(p.table);
+
+  if (root < 0)
+    return 0;
+
+  skipSpaces(&p);
+
+  if (*p.c)
+    return 0;
+
+  dropUnused(e, root);
+
+  return 1;
+}
+
+static void freeExpression(Expression *restrict e) {
+
+  free(e->nodes);
+
+  *e = (Expression) EXPRESSION_EMPTY;
+}
+
+/*
+
+  r = -r
+
+*/
+
+static void negate(BigFraction *r) {
+
+  if (r->numerator.length)
+    r->numerator.negative = !r->numerator.negative;
+}
+
+/*
+
+  r = 1 / a, a isn't 0
+
+*/
+
+static void reciprocal(BigFraction *r, const BigFraction *a) {
+
+  Bignum numerator = BIGNUM_ZERO;
+
+  Bignums->copy(&numerator, &a->denominator);
+  Bignums->copy(&r->denominator, &a->numerator);
+  Bignums->copy(&r->numerator, &numerator);
+
+  // The sign stays on the numerator
+  if (r->denominator.negative) {
+    r->denominator.negative = 0;
+    negate(r);
+  }
+
+  Bignums->free(&numerator);
+}
+
+/*
+
+  r = a^exponent, by squaring, 0 if a is 0 and exponent is below 0
+
+*/
+
+static int power(BigFraction *r, const BigFraction *a, int exponent) {
+
+  if (exponent < 0 && !a->numerator.length)
+    return 0;
+
+  BigFraction square;
+
+  Bignums->fractionInit(&square);
+
+  if (exponent < 0)
+    reciprocal(&square, a);
+  else {
+    Bignums->copy(&square.numerator, &a->numerator);
+    Bignums->copy(&square.denominator, &a->denominator);
+  }
+
+  unsigned int rest = exponent < 0 ? -(unsigned int) exponent : (unsigned int) exponent;
+
+  Bignums->fractionSet(r, 1, 1);
+
+  while (rest) {
+
+    if (rest & 1)
+      Bignums->fractionMultiply(r, r, &square);
+
+    rest >>= 1;
+
+    if (rest)
+      Bignums->fractionMultiply(&square, &square, &square);
+  }
+
+  Bignums->fractionFree(&square);
+
+  return 1;
+}
+
+static int evaluate(const Expression *restrict e, BigFraction *restrict result) {
+
+  if (!e->count)
+    return EXPRESSION_OK;
+
+  BigFraction *values = malloc((size_t) e->count * sizeof (BigFraction));
+
+  if (!values) DISPLAY_MALLOC_ERROR
+
+  // How many nodes still need each value, it is freed at 0
+  int *uses = calloc((size_t) e->count, sizeof (int));
+
+  if (!uses) DISPLAY_MALLOC_ERROR
+
+  for (int i = 0; i < e->count; i++) {
+
+    Bignums->fractionInit(&values[i]);
+
+    if (!EXPRESSION_LEAF(e->nodes[i].kind)) {
+
+      uses[e->nodes[i].left]++;
+
+      if (e->nodes[i].right >= 0)
+        uses[e->nodes[i].right]++;
+    }
+  }
+
+  int status = EXPRESSION_OK;
+
+  for (int i = 0; i < e->count && status == EXPRESSION_OK; i++) {
+
+    const ExpressionNode *node = &e->nodes[i];
+    BigFraction *value = &values[i];
+
+    switch (node->kind) {
+
+    case EXPRESSION_NUMBER:
+    case EXPRESSION_REFERENCE:
+
+      if (!Bignums->fractionSet(value, node->value.numerator, node->value.denomenator))
+        status = EXPRESSION_DIVIDE_BY_ZERO;
+
+      break;
+
+    case OP_ADD:
+      Bignums->fractionAdd(value, &values[node->left], &values[node->right]);
+      break;
+
+    case OP_SUB:
+      Bignums->copy(&value->numerator, &values[node->right].numerator);
+      Bignums->copy(&value->denominator, &values[node->right].denominator);
+      negate(value);
+      Bignums->fractionAdd(value, &values[node->left], value);
+      break;
+
+    case OP_MUL:
+      Bignums->fractionMultiply(value, &values[node->left], &values[node->right]);
+      break;
+
+    case OP_DIV:
+
+      if (!values[node->right].numerator.length) {
+        status = EXPRESSION_DIVIDE_BY_ZERO;
+        break;
+      }
+
+      reciprocal(value, &values[node->right]);
+      Bignums->fractionMultiply(value, &values[node->left], value);
+      break;
+
+    case OP_POW:
+
+      if (!power(value, &values[node->left], node->exponent))
+        status = EXPRESSION_DIVIDE_BY_ZERO;
+
+      break;
+    }
+
+    if (!EXPRESSION_LEAF(node->kind)) {
+
+      if (!--uses[node->left])
+        Bignums->fractionFree(&values[node->left]);
+
+      if (node->right >= 0 && !--uses[node->right])
+        Bignums->fractionFree(&values[node->right]);
+    }
+  }
+
+  if (status == EXPRESSION_OK) {
+    Bignums->copy(&result->numerator, &values[e->count - 1].numerator);
+    Bignums->copy(&result->denominator, &values[e->count - 1].denominator);
+  }
+
+  for (int i = 0; i < e->count; i++)
+    Bignums->fractionFree(&values[i]);
+
+  free(values);
+  free(uses);
+
+  return status;
+}
+
+/*
+
+  Abstraction, same as in Software.c
+
+*/
+
+const static expressionParser ExpressionFunctions = {
+  &parse,
+  &freeExpression,
+  &evaluate
+};
+
+const expressionParser *restrict Expressions = &ExpressionFunctions;
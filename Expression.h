@@ -0,0 +1,208 @@
+/*
+
+  Expression
+
+  Whole expressions, of any length, like
+
+    (1/2 + 0.25) * 3 - 2^-3 / (1/7 - 5)
+
+  parsed once into a list of nodes and evaluated exactly.
+
+  #n is the stored fraction n (as option 3 numbers them), whatever
+  it is when the expression is evaluated (see Formula.h).
+
+  The usual order applies: brackets, then ^ (right to left),
+  then a leading -, then * and /, then + and -. Numbers are
+  whole or decimal, like in Decimal.h ("2", "0.5", "0.(3)"), so
+  1/2 is 1 divided by 2, which is the same. The exponent of ^
+  must be a whole number written out, like 2^10 or 2^-3.
+
+  The nodes are in an array, every node after its operands, so
+  they are evaluated in a single pass from the first to the last,
+  which is the value of the whole expression:
+
+    1/2 + 3    ->   [0] 1   [1] 2   [2] [0] / [1]   [3] 3   [4] [2] + [3]
+
+  The list is really a graph: while parsing, a node that is
+  already in it (same operator, same operands, or same number) is
+  not added again, the earlier one is used instead, and an
+  operator on two numbers is worked out there and then if the
+  result fits in a Fraction. So every distinct subexpression is
+  one node, evaluated once, however many times it is written:
+
+    (3/7 + 1/9) * (3/7 + 1/9)   ->   [0] 34/63   [1] [0] * [0]
+
+*/
+
+#ifndef EXPRESSION
+#define EXPRESSION
+
+#include "Software.h"
+#include "Bignum.h"
+
+/*
+
+  Kind of a node that is a number, other nodes
+  are operators (OP_ADD ... OP_POW, see Operations.h)
+
+*/
+
+#define EXPRESSION_NUMBER 'n'
+
+/*
+
+  Kind of a node that is a stored fraction, #n, its
+  value is set from Fractions->get() before evaluating
+
+*/
+
+#define EXPRESSION_REFERENCE '#'
+
+/*
+
+  1 if a node of this kind has no operands
+
+*/
+
+#define EXPRESSION_LEAF(kind) ((kind) == EXPRESSION_NUMBER || (kind) == EXPRESSION_REFERENCE)
+
+/*
+
+  Biggest exponent allowed after ^, either sign
+
+*/
+
+#define EXPRESSION_MAX_EXPONENT 65536
+
+/*
+
+  Deepest brackets allowed
+
+*/
+
+#define EXPRESSION_MAX_DEPTH 1024
+
+/*
+
+  What evaluating an expression can end with
+
+*/
+
+#define EXPRESSION_OK 0
+#define EXPRESSION_DIVIDE_BY_ZERO 1
+
+/*
+
+  One number or operator
+
+  Type: ExpressionNode
+
+*/
+
+typedef struct {
+
+  // EXPRESSION_NUMBER, EXPRESSION_REFERENCE or an operator
+  char kind;
+
+  // Operands, indexes of earlier nodes (only left for ^)
+  int left;
+  int right;
+
+  // Numbers and references: the value
+  Fraction value;
+
+  // ^: the exponent
+  int exponent;
+
+  // References: the index of the stored fraction
+  int index;
+
+}
+ExpressionNode;
+
+/*
+
+  A parsed expression, start it with EXPRESSION_EMPTY
+
+  Type: Expression
+
+*/
+
+typedef struct {
+
+  // Every node after its operands, the last one is the result
+  ExpressionNode *nodes;
+
+  int count;
+  int capacity;
+
+  // Nodes the text stood for, before sharing and folding
+  int written;
+
+  // Nodes that are references, each to a different fraction
+  int references;
+
+}
+Expression;
+
+#define EXPRESSION_EMPTY { NULL, 0, 0, 0, 0 }
+
+typedef struct {
+
+  /*
+
+    int parse(char *text, Expression *e)
+
+    Parses text into e, replacing what was in it. Only the
+    distinct subexpressions are kept, e->written - e->count
+    nodes were shared or folded away.
+
+    Returns 1 if text is a whole valid expression, else 0.
+
+    Access: Expressions->parse()
+
+  */
+
+  int(*const parse)(const char * restrict text, Expression * restrict e);
+
+  /*
+
+    void free(Expression *e)
+
+    Access: Expressions->free()
+
+  */
+
+  void(*const free)(Expression * restrict e);
+
+  /*
+
+    int evaluate(Expression *e, BigFraction *result)
+
+    Works out e with Bignums, node by node, into result
+    (started with Bignums->fractionInit()). References are
+    taken as the value in their node.
+
+    Returns EXPRESSION_OK, or EXPRESSION_DIVIDE_BY_ZERO
+    (result unchanged).
+
+    Access: Expressions->evaluate()
+
+  */
+
+  int(*const evaluate)(const Expression * restrict e, BigFraction * restrict result);
+
+}
+expressionParser;
+
+/*
+
+  Call this, Expressions, to access all
+  the publicly available functions.
+
+*/
+
+extern
+const expressionParser * restrict Expressions;
+
+#endif //Expression.h
@@ -0,0 +1,250 @@
+/*
+
+  Formula
+
+  Formulas are kept in one array that grows, and so are the lists
+  of formulas that use each fraction, by fraction index, both in
+  the current session's FormulaStore, next to the fractions they
+  refer to. A formula
+  that uses a fraction more than once is in its list once: after
+  Expressions->parse() each fraction is one reference node.
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Software.h"
+#include "Bignum.h"
+#include "Expression.h"
+#include "Formula.h"
+
+#define DISPLAY_MALLOC_ERROR { fprintf(stderr, "FATAL ERROR: UNABLE TO ALLOCATE MEMORY IN HEAP"); exit(-1); }
+
+/*
+
+  Adds formula to the list of fraction index
+
+*/
+
+static void addDependent(const int index, const int formula) {
+
+  FormulaStore *F = Sessions->formulas();
+
+  if (index >= F->dependentsCount) {
+
+    int count = F->dependentsCount ? F->dependentsCount : 64;
+
+    while (count <= index)
+      count *= 2;
+
+    FormulaDependents *grown = realloc(F->dependents, (size_t) count * sizeof (FormulaDependents));
+
+    if (!grown) DISPLAY_MALLOC_ERROR
+
+    memset(grown + F->dependentsCount, 0, (size_t) (count - F->dependentsCount) * sizeof (FormulaDependents));
+
+    F->dependents = grown;
+    F->dependentsCount = count;
+  }
+
+  FormulaDependents *d = &F->dependents[index];
+
+  if (d->count == d->capacity) {
+
+    int capacity = d->capacity ? d->capacity * 2 : 4;
+    int *grown = realloc(d->formulas, (size_t) capacity * sizeof (int));
+
+    if (!grown) DISPLAY_MALLOC_ERROR
+
+    d->formulas = grown;
+    d->capacity = capacity;
+  }
+
+  d->formulas[d->count++] = formula;
+}
+
+static int add(const char *restrict text) {
+
+  FormulaStore *F = Sessions->formulas();
+
+  Expression e = EXPRESSION_EMPTY;
+
+  int valid = Expressions->parse(text, &e);
+
+  for (int i = 0; valid && i < e.count; i++)
+    if (e.nodes[i].kind == EXPRESSION_REFERENCE && e.nodes[i].index >= Fractions->count())
+      valid = 0;
+
+  if (!valid) {
+    Expressions->free(&e);
+    return FORMULA_INVALID;
+  }
+
+  if (F->count == F->capacity) {
+
+    int capacity = F->capacity ? F->capacity * 2 : 16;
+    Formula *grown = realloc(F->formulas, (size_t) capacity * sizeof (Formula));
+
+    if (!grown) DISPLAY_MALLOC_ERROR
+
+    F->formulas = grown;
+    F->capacity = capacity;
+  }
+
+  Formula *f = &F->formulas[F->count];
+
+  f->text = strdup(text);
+
+  if (!f->text) DISPLAY_MALLOC_ERROR
+
+  f->e = e;
+  f->status = EXPRESSION_OK;
+  f->dirty = 1;
+
+  Bignums->fractionInit(&f->value);
+
+  for (int i = 0; i < e.count; i++)
+    if (e.nodes[i].kind == EXPRESSION_REFERENCE)
+      addDependent(e.nodes[i].index, F->count);
+
+  return F->count++;
+}
+
+static void changed(const int index) {
+
+  FormulaStore *F = Sessions->formulas();
+
+  if (index < 0 || index >= F->dependentsCount)
+    return;
+
+  for (int i = 0; i < F->dependents[index].count; i++)
+    F->formulas[F->dependents[index].formulas[i]].dirty = 1;
+}
+
+static int update(const int index, const Fraction value) {
+
+  if (index < 0 || index >= Fractions->count())
+    return 0;
+
+  *Fractions->get(index) = value;
+
+  changed(index);
+
+  return 1;
+}
+
+/*
+
+  Works a dirty formula out again, with the
+  fractions it uses as they are now
+
+*/
+
+static void recompute(Formula *f) {
+
+  FormulaStore *F = Sessions->formulas();
+
+  f->status = EXPRESSION_OK;
+
+  for (int i = 0; i < f->e.count; i++) {
+
+    ExpressionNode *node = &f->e.nodes[i];
+
+    if (node->kind != EXPRESSION_REFERENCE)
+      continue;
+
+    Fraction value = *Fractions->get(node->index);
+
+    // n/0 is a division by 0 wherever it is used
+    if (!value.denomenator) {
+      f->status = EXPRESSION_DIVIDE_BY_ZERO;
+      break;
+    }
+
+    // The denominator is positive in a node
+    if (value.denomenator < 0) {
+      value.numerator = -value.numerator;
+      value.denomenator = -value.denomenator;
+    }
+
+    node->value = value;
+  }
+
+  if (f->status == EXPRESSION_OK)
+    f->status = Expressions->evaluate(&f->e, &f->value);
+
+  f->dirty = 0;
+
+  F->recomputed++;
+}
+
+static int result(const int formula, BigFraction *restrict value) {
+
+  FormulaStore *F = Sessions->formulas();
+
+  Formula *f = &F->formulas[formula];
+
+  if (f->dirty)
+    recompute(f);
+
+  if (f->status == EXPRESSION_OK) {
+    Bignums->copy(&value->numerator, &f->value.numerator);
+    Bignums->copy(&value->denominator, &f->value.denominator);
+  }
+
+  return f->status;
+}
+
+static const char *text(const int formula) {
+  return Sessions->formulas()->formulas[formula].text;
+}
+
+static int count() {
+  return Sessions->formulas()->count;
+}
+
+static long recomputed() {
+  return Sessions->formulas()->recomputed;
+}
+
+static void freeFormulas() {
+
+  FormulaStore *F = Sessions->formulas();
+
+  for (int i = 0; i < F->count; i++) {
+    free(F->formulas[i].text);
+    Expressions->free(&F->formulas[i].e);
+    Bignums->fractionFree(&F->formulas[i].value);
+  }
+
+  for (int i = 0; i < F->dependentsCount; i++)
+    free(F->dependents[i].formulas);
+
+  free(F->formulas);
+  free(F->dependents);
+
+  F->formulas = NULL;
+  F->dependents = NULL;
+  F->count = F->capacity = F->dependentsCount = 0;
+}
+
+/*
+
+  Abstraction, same as in Software.c
+
+*/
+
+const static formulasDB FormulaFunctions = {
+  &add,
+  &changed,
+  &update,
+  &result,
+  &text,
+  &count,
+  &recomputed,
+  &freeFormulas
+};
+
+const formulasDB *restrict Formulas = &FormulaFunctions;
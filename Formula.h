@@ -0,0 +1,227 @@
+/*
+
+  Formula
+
+  Expressions that use stored fractions, like
+
+    #3 + #5 * #2
+
+  where #n is whatever fraction n (as option 3 numbers them) is
+  at the time, not a copy of it like the operands of an Equation.
+
+  Every stored fraction has the list of formulas that use it.
+  Changing a fraction only marks those formulas as dirty, nothing
+  is worked out then. A dirty formula is worked out again the next
+  time its result is asked for, and a clean one never is, so the
+  cost of a change is the formulas it reaches, and only once,
+  however many times it changes before they are read.
+
+*/
+
+#ifndef FORMULA
+#define FORMULA
+
+#include "Software.h"
+#include "Bignum.h"
+#include "Expression.h"
+
+/*
+
+  What add() returns when the text can't be a formula
+
+*/
+
+#define FORMULA_INVALID -1
+
+/*
+
+  One stored formula
+
+  Type: Formula
+
+*/
+
+typedef struct {
+
+  char *text;
+
+  Expression e;
+
+  // The last result, only right when dirty is 0
+  BigFraction value;
+  int status;
+
+  int dirty;
+
+}
+Formula;
+
+/*
+
+  Formulas that use one fraction
+
+  Type: FormulaDependents
+
+*/
+
+typedef struct {
+
+  int *formulas;
+
+  int count;
+  int capacity;
+
+}
+FormulaDependents;
+
+/*
+
+  The formulas of one session (see Sessions in Software.h),
+  only Formula.c looks inside
+
+  Type: FormulaStore
+
+*/
+
+struct FormulaStore {
+
+  Formula *formulas;
+  int count;
+  int capacity;
+
+  // By fraction index, dependentsCount long
+  FormulaDependents *dependents;
+  int dependentsCount;
+
+  long recomputed;
+
+};
+
+typedef struct {
+
+  /*
+
+    int add(char *text)
+
+    Parses text (see Expression.h) and stores it as a formula,
+    dirty, so it is worked out when it is first read.
+
+    Returns its index, counted from 0, or FORMULA_INVALID if
+    text isn't a valid expression or uses a fraction that
+    isn't stored.
+
+    Access: Formulas->add()
+
+  */
+
+  int(*const add)(const char * restrict text);
+
+  /*
+
+    void changed(int index)
+
+    Tells the formulas that use stored fraction index (from 0,
+    like Fractions->get()) that it changed, which marks them
+    dirty. Call it after changing a fraction in place.
+
+    Access: Formulas->changed()
+
+  */
+
+  void(*const changed)(const int index);
+
+  /*
+
+    int update(int index, Fraction value)
+
+    Sets stored fraction index to value, and marks the
+    formulas that use it dirty.
+
+    Returns 0 (nothing changed) if there is no such
+    fraction, else 1.
+
+    Access: Formulas->update()
+
+  */
+
+  int(*const update)(const int index, const Fraction value);
+
+  /*
+
+    int result(int formula, BigFraction *value)
+
+    Sets value (started with Bignums->fractionInit()) to the
+    result of formula, working it out first if it is dirty.
+
+    Returns EXPRESSION_OK, or EXPRESSION_DIVIDE_BY_ZERO
+    (value unchanged), see Expression.h.
+
+    Access: Formulas->result()
+
+  */
+
+  int(*const result)(const int formula, BigFraction * restrict value);
+
+  /*
+
+    char* text(int formula)
+
+    The text formula was added with.
+
+    Access: Formulas->text()
+
+  */
+
+  const char*(*const text)(const int formula);
+
+  /*
+
+    int count()
+
+    Returns how many formulas are stored.
+
+    Access: Formulas->count()
+
+  */
+
+  int(*const count)();
+
+  /*
+
+    long recomputed()
+
+    Returns how many times a formula has been worked
+    out so far, all formulas together.
+
+    Access: Formulas->recomputed()
+
+  */
+
+  long(*const recomputed)();
+
+  /*
+
+    void free()
+
+    Frees every formula.
+
+    Access: Formulas->free()
+
+  */
+
+  void(*const free)();
+
+}
+formulasDB;
+
+/*
+
+  Call this, Formulas, to access all
+  the publicly available functions.
+
+*/
+
+extern
+const formulasDB * restrict Formulas;
+
+#endif //Formula.h
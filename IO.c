@@ -16,6 +16,8 @@
 #include "IO.h"
 #include "Software.h"
 #include "Operations.h"
+#include "Decimal.h"
+#include "Stats.h"
 
 /*
 
@@ -40,6 +42,17 @@ void showMenu() {
   printf ("4. Evaluate Expression\n");
   printf ("5. Display All Equations\n");
   printf ("6. Quit\n");
+  printf ("7. Create Many Random Fractions\n");
+  printf ("8. Sum All Fractions\n");
+  printf ("9. Multiply All Fractions\n");
+  printf ("10. Sort Fractions\n");
+  printf ("11. Approximate Decimal\n");
+  printf ("12. Store Formula\n");
+  printf ("13. Update Fraction\n");
+  printf ("14. Display Formulas\n");
+  printf ("15. Display Stats\n");
+  printf ("16. Export Equations\n");
+  printf ("17. Snapshot Stores\n");
 
 }
 
@@ -99,7 +112,7 @@ void ClearConsole() {
 */
 
 
-static int ValidateFraction(int numerator, int denominator) {
+int ValidateFraction(int numerator, int denominator) {
   return 
     numerator   > IO_MIN_NUMERATOR   && // These symbolic constatns are in IO.h
     numerator   < IO_MAX_NUMERATOR   &&
@@ -120,30 +133,26 @@ static void removeAllSpaces (char *s) {
   int i = 0;
   int j = 0;
 
+  /*
+
+    i reads every character, j is where the next character
+    that isn't a space goes. Stops at the null terminator,
+    so nothing after the string is ever touched.
+
+  */
+
   while (s[i]) {
-    //while the string is valid
-    if (s[i] == remove) {
-      //if the string char is a space
-      j = i;
-      i++;     
-      //go to next iteration since the current s[i] element is invalid
-      while(s[i]) {
-        //while the string is still valid
-        if (s[i] != remove) {
-          //if the string character is not a bad element
-          //swap to create new string
-          s[j] = s[i];
-          //increment
-          j++;
-        }
-        i++;
-      }
-      //set null terminator
-      s[j] = 0;
+    //if the string character is not a bad element, keep it
+    if (s[i] != remove) {
+      s[j] = s[i];
+      j++;
     }
     i++;
   }
 
+  //set null terminator
+  s[j] = 0;
+
 }
 
 /*
@@ -154,20 +163,31 @@ static void removeAllSpaces (char *s) {
 
 static int split(char *userInput, int *index) {
   
-  int j = 0;
-  char fractionPart[MAX_INPUT];
+  int value = 0;
+  int sign = 1;
+
+  // A minus sign in front of a number, as in "1/2 ^ -3/1"
+  if (userInput[*index] == '-') {
+    sign = -1;
+    (*index)++;
+  }
+
+  /*
+
+    Digits are added up directly instead of being copied out
+    for atoi(), that way a long run of digits (from a client that
+    is not a person typing) stops growing at IO_MAX_NUMERATOR * 10
+    instead of overflowing, and still fails validation.
+
+  */
 
   while (userInput[*index] >= '0' && userInput[*index] <= '9') {
-      //Error in this line
-      //For character array declared as char * it is not letting the values be assigned
-      //printf ("Assinging %c \n", fractionPart[j]);
-      fractionPart[j] = userInput[*index];
-      //printf ("In split loop\n");
+      if (value <= IO_MAX_NUMERATOR)
+        value = value * 10 + (userInput[*index] - '0');
       (*index)++;
-      j++;
   }
 
-  return atoi(fractionPart);
+  return sign * value;
 }
 
 
@@ -210,22 +230,57 @@ static int NotValid(Fraction *f1, Fraction *f2) {
 
 */
 
-static int validOperator(char operator) {
+int validOperator(char operator) {
 
   return 
     operator == OP_ADD ||
     operator == OP_SUB ||
     operator == OP_MUL ||
-    operator == OP_DIV;
+    operator == OP_DIV ||
+    operator == OP_POW;
+}
+
+/*
+
+  Reads a fraction "n/d", or a decimal like 0.25 or 0.1(6)
+  (see Decimal.h), starting at *index, and moves *index past it.
+  Returns 0 if there is neither.
+
+*/
+
+static int readFraction(char *userInput, int *index, Fraction *f) {
+
+  int start = *index;
+
+  f->numerator = split(userInput, index);
+
+  //This increment skips over the invalid character
+  if (userInput[*index] == '/') {
+
+    (*index)++;
+
+    f->denomenator = split(userInput, index);
+
+    return 1;
+  }
+
+  int used = Decimal->fromText(userInput + start, f);
+
+  *index = start + used;
+
+  return used;
 }
 
 /*
 
   Identify fraction parts from user input
 
+  Quiet, returns 0 on invalid input without printing anything,
+  so it can be used for input that doesn't come from the user.
+
 */
 
-static int setExpressionParts (Equation *equation, char *userInput) {
+static int parseParts (Equation *equation, char *userInput) {
 
   //Initiate valid input flag
   int validInput = 1;
@@ -245,18 +300,11 @@ static int setExpressionParts (Equation *equation, char *userInput) {
 
   */
 
-  f1->numerator = split(userInput, &index);
-
-  //This increment skips over the invalid character
-  if (userInput[index] == '/') 
-    index++;
-  else 
-    return validInput = invalidInput();
-
-  f1->denomenator = split(userInput, &index);
+  if (!readFraction(userInput, &index, f1))
+    return validInput = 0;
 
   if(!(ValidateFraction(f1->numerator,f1->denomenator)))
-    return validInput = invalidInput();
+    return validInput = 0;
 
 
   /*
@@ -268,7 +316,7 @@ static int setExpressionParts (Equation *equation, char *userInput) {
   *operator = userInput[index];
 
   if (!validOperator(*operator)) {
-    return validInput = invalidInput();
+    return validInput = 0;
   }
 
   index++;
@@ -279,26 +327,52 @@ static int setExpressionParts (Equation *equation, char *userInput) {
 
   */
 
-  f2->numerator = split(userInput, &index);
-
-  //This increment skips over the invalid character
-  if (userInput[index] == '/') 
-    index++;
-  else 
-    return validInput = invalidInput();
-
-  f2->denomenator = split(userInput, &index);
+  if (!readFraction(userInput, &index, f2))
+    return validInput = 0;
 
   if(!(ValidateFraction(f2->numerator,f2->denomenator)))
-    return validInput = invalidInput();
+    return validInput = 0;
 
   if(userInput[index] != 0)
-    return validInput = invalidInput();
+    return validInput = 0;
 
   return validInput;
 
 }
 
+/*
+
+  parseParts(), counted in Stats.h
+
+*/
+
+int parseExpression (Equation *equation, char *userInput) {
+
+  int valid = parseParts(equation, userInput);
+
+  STATS_COUNT(parses)
+
+  if (!valid)
+    STATS_COUNT(invalidParses)
+
+  return valid;
+}
+
+/*
+
+  Identify fraction parts from user input,
+  and tell the user if they are invalid.
+
+*/
+
+static int setExpressionParts (Equation *equation, char *userInput) {
+
+  if (!parseExpression(equation, userInput))
+    return invalidInput();
+
+  return 1;
+}
+
 /*
 
   Get valid expression from the user
@@ -75,7 +75,37 @@
 
   */
 
-  Equation* GetExpression (Equation *expression);  
+  Equation* GetExpression (Equation *expression);
+
+  /*
+
+    Splits an expression like "1/2 + 3/4" into the parts of
+    *expression, without asking the user anything or printing
+    errors. The text is modified (spaces are removed).
+
+    Returns 1 if the expression was valid, else 0.
+
+  */
+
+  int parseExpression (Equation *expression, char *text);
+
+  /*
+
+    Returns 1 if the numerator and denominator are within
+    the limits above, else returns 0.
+
+  */
+
+  int ValidateFraction(int numerator, int denominator);
+
+  /*
+
+    Returns 1 if the operator is one of the operators
+    the calculator understands (see Operations.h), else 0.
+
+  */
+
+  int validOperator(char operator);
 
   /*
   
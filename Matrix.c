@@ -0,0 +1,892 @@
+/*
+
+  Matrix
+
+  Dixon's p-adic lifting, on whole numbers:
+
+    Each row of a and b is multiplied by the least common multiple
+    of its denominators, which doesn't change the solution, leaving
+    A x = B in whole numbers. With C the inverse of A modulo a prime
+    p (see Modular.h), the only O(n^3) work,
+
+      x(k) = C r(k) modulo p,  r(k + 1) = (r(k) - A x(k)) / p
+
+    from r(0) = B divides exactly every time, and x(0) + x(1) p +
+    x(2) p^2 + ... is x modulo p^K. The r stay about as small as A
+    and B, so every step is O(n^2) products of small numbers.
+
+    The numerator and denominator of every x[i] are below 2^h, by
+    Hadamard's bound on the rows of A and B (and Cramer's rule), so
+    once p^K >= 2^(2h + 2) rational reconstruction finds x[0] = n/d.
+    The rest are tried against c, the least common multiple of the
+    denominators met so far (all divide det A, so c stays below 2^h):
+    y = c x[i] modulo p^K (from -p^K/2 to p^K/2) is then small, and
+    if |y| and c are below 2^e with e + h + 2 <= the bits of p^K,
+    y / c is x[i] (both are x[i] modulo p^K, and too small to differ
+    by a multiple of it). One that isn't is reconstructed on its own
+    and its denominator goes into c, so only the first few are.
+
+  The determinant of A is d g: d divides it (Cramer's rule again),
+  and |g| is below 2^(H - bits of d + 1), with H Hadamard's bound
+  on A alone. g is found with the Chinese remainder theorem from
+  the determinant modulo more primes, one elimination modulo each,
+  until their product passes that bound, so it is always right
+  (and g is usually small, so that is only a few primes). The
+  determinant of a is that over the product of the multipliers.
+
+  A prime can divide det A when A isn't singular, so a p that A is
+  singular modulo only means trying the next one. A is singular
+  once it is singular modulo primes whose product is at least 2^H:
+  det A is 0 modulo that product, and smaller than it.
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Software.h"
+#include "Bignum.h"
+#include "Modular.h"
+#include "Matrix.h"
+
+#define DISPLAY_MALLOC_ERROR { fprintf(stderr, "FATAL ERROR: UNABLE TO ALLOCATE MEMORY IN HEAP"); exit(-1); }
+
+/*
+
+  Most threads used
+
+*/
+
+#define MATRIX_MAX_THREADS 64
+
+/*
+
+  Fewest cells worth a thread of their own, in one step
+  of the elimination
+
+*/
+
+#define MATRIX_PER_THREAD 16384
+
+/*
+
+  One thread's share of a step of the elimination, or of the
+  x[i] made into fractions
+
+  Type: MatrixWorker
+
+*/
+
+typedef struct {
+
+  // x(k)[i] is digits[k * count + i]
+  const uint64_t *digits;
+  int count;
+  long steps;
+
+  // p^(2^j) is powers[j], then p^K, d and h (see above)
+  const Bignum *powers;
+  const Bignum *modulus;
+  const Bignum *denominator;
+  long bound;
+
+  // x[first] to x[last - 1], or rows first to last - 1
+  BigFraction *x;
+  int first;
+  int last;
+
+  // The rows of eliminateModulo(), width a row, and the pivot's
+  uint64_t *cells;
+  int width;
+  const Montgomery *m;
+  int step;
+
+}
+MatrixWorker;
+
+static int create(Matrix *restrict m, int rows, int columns) {
+
+  if (rows < 1 || columns < 1 || rows > MATRIX_MAX_SIZE || columns > MATRIX_MAX_SIZE)
+    return 0;
+
+  Fraction *cells = malloc((size_t) rows * (size_t) columns * sizeof (Fraction));
+
+  if (!cells) DISPLAY_MALLOC_ERROR
+
+  for (long i = 0; i < (long) rows * columns; i++)
+    cells[i] = (Fraction) { 0, 1 };
+
+  *m = (Matrix) { rows, columns, cells };
+
+  return 1;
+}
+
+static void freeMatrix(Matrix *restrict m) {
+
+  free(m->cells);
+
+  *m = (Matrix) { 0, 0, NULL };
+}
+
+static Fraction *cell(const Matrix *restrict m, int row, int column) {
+  return &m->cells[(long) row * m->columns + column];
+}
+
+static void freeRows(Bignum **rows, const int count, const int columns) {
+
+  for (int i = 0; i < count; i++) {
+
+    for (int j = 0; j < columns; j++)
+      Bignums->free(&rows[i][j]);
+
+    free(rows[i]);
+  }
+
+  free(rows);
+}
+
+static long bitLength(const Bignum *a) {
+  return a->length ? 32L * (a->length - 1) + 32 - __builtin_clz(a->limbs[a->length - 1]) : 0;
+}
+
+/*
+
+  The rows of a, with b[i] at the end of row i, as whole numbers,
+  each row multiplied by scales[i], the least common multiple of
+  its denominators. NULL if a denominator is 0.
+
+*/
+
+static Bignum **wholeRows(const Matrix *a, const Fraction *b, Bignum *scales) {
+
+  int columns = a->columns + 1;
+
+  Bignum **rows = malloc((size_t) a->rows * sizeof (Bignum *));
+
+  if (!rows) DISPLAY_MALLOC_ERROR
+
+  Bignum denominator = BIGNUM_ZERO, common = BIGNUM_ZERO;
+  int valid = 1, filled = 0;
+
+  for (int i = 0; i < a->rows && valid; i++, filled++) {
+
+    // All BIGNUM_ZERO
+    rows[i] = calloc((size_t) columns, sizeof (Bignum));
+
+    if (!rows[i]) DISPLAY_MALLOC_ERROR
+
+    const Fraction *row = cell(a, i, 0);
+
+    Bignums->fromInt(&scales[i], 1);
+
+    for (int j = 0; j < columns && valid; j++) {
+
+      const Fraction *f = j < a->columns ? &row[j] : &b[i];
+
+      if (!f->denomenator) {
+        valid = 0;
+        break;
+      }
+
+      // scale = scale / gcd(scale, d) * d, the gcd from scale modulo d
+      Bignums->fromInt(&denominator, llabs(f->denomenator));
+      Bignums->fromInt(&common, (int64_t) Modular->remainder(&scales[i], (uint64_t) llabs(f->denomenator)));
+      Bignums->gcd(&common, &common, &denominator);
+      Bignums->divide(&denominator, NULL, &denominator, &common);
+      Bignums->multiply(&scales[i], &scales[i], &denominator);
+    }
+
+    for (int j = 0; j < columns && valid; j++) {
+
+      const Fraction *f = j < a->columns ? &row[j] : &b[i];
+
+      // numerator * (scale / denominator), with the sign of both
+      Bignums->fromInt(&denominator, f->denomenator);
+      Bignums->divideExact(&denominator, &scales[i], &denominator);
+      Bignums->fromInt(&rows[i][j], f->numerator);
+      Bignums->multiply(&rows[i][j], &rows[i][j], &denominator);
+    }
+  }
+
+  Bignums->free(&denominator);
+  Bignums->free(&common);
+
+  if (!valid) {
+    freeRows(rows, filled, columns);
+    return NULL;
+  }
+
+  return rows;
+}
+
+/*
+
+  The first columns of the rows, modulo m->p in Montgomery
+  form, into cells, width a row
+
+*/
+
+static void rowsModulo(Bignum **rows, const int n, const int columns, const Montgomery *m, uint64_t *cells, const int width) {
+
+  for (int i = 0; i < n; i++)
+    for (int j = 0; j < columns; j++)
+      cells[(long) i * width + j] = montgomeryMultiply(Modular->remainder(&rows[i][j], m->p), m->square, m);
+}
+
+/*
+
+  One step of eliminateModulo(), for the worker's rows: each
+  takes away the pivot's row, which is already divided by the
+  pivot, times its cell in the pivot's column
+
+*/
+
+static void *updateRows(void *argument) {
+
+  MatrixWorker *w = argument;
+
+  const int k = w->step;
+  const uint64_t p = w->m->p;
+  const uint64_t *top = &w->cells[(long) k * w->width];
+
+  for (int i = w->first; i < w->last; i++) {
+
+    uint64_t *row = &w->cells[(long) i * w->width];
+    uint64_t factor = row[k];
+
+    if (i == k || !factor)
+      continue;
+
+    for (int j = k; j < w->width; j++) {
+      uint64_t t = montgomeryMultiply(factor, top[j], w->m);
+      row[j] = row[j] >= t ? row[j] - t : row[j] + p - t;
+    }
+  }
+
+  return NULL;
+}
+
+/*
+
+  Gaussian elimination modulo m->p on the first n columns of
+  cells (n rows, width a row, in Montgomery form), every pivot
+  made 1. Jordan, above the pivots too, which leaves the inverse
+  of the first n columns where the identity was next to them.
+
+  The rows to update are split over Software->Threads() at each
+  step, when there are enough cells to be worth it.
+
+  Returns 0 if a column has no pivot (singular modulo m->p), else
+  1 with the determinant of the first n columns in *determinant.
+
+*/
+
+static int eliminateModulo(uint64_t *cells, const int n, const int width, const Montgomery *m, const int jordan, uint64_t *determinant) {
+
+  const uint64_t p = m->p;
+  uint64_t product = m->one;
+
+  int threads = Software->Threads();
+
+  if (threads > MATRIX_MAX_THREADS)
+    threads = MATRIX_MAX_THREADS;
+
+  MatrixWorker workers[MATRIX_MAX_THREADS];
+
+  for (int k = 0; k < n; k++) {
+
+    int pivot = k;
+
+    while (pivot < n && !cells[(long) pivot * width + k])
+      pivot++;
+
+    if (pivot == n)
+      return 0;
+
+    uint64_t *top = &cells[(long) k * width];
+
+    // Left of k both are 0 already
+    if (pivot != k) {
+
+      uint64_t *other = &cells[(long) pivot * width];
+
+      for (int j = k; j < width; j++) {
+        uint64_t t = top[j];
+        top[j] = other[j];
+        other[j] = t;
+      }
+
+      product = p - product;
+    }
+
+    product = montgomeryMultiply(product, top[k], m);
+
+    // 1 / pivot, out of Montgomery form and back
+    uint64_t inverse = montgomeryMultiply(Modular->inverse(montgomeryMultiply(top[k], 1, m), p), m->square, m);
+
+    for (int j = k; j < width; j++)
+      top[j] = montgomeryMultiply(top[j], inverse, m);
+
+    int start = jordan ? 0 : k + 1;
+
+    // Split the rows, if there is enough to do
+    long updated = (long) (n - start) * (width - k);
+    int used = threads;
+
+    if (used > updated / MATRIX_PER_THREAD)
+      used = (int) (updated / MATRIX_PER_THREAD);
+
+    if (used > n - start)
+      used = n - start;
+
+    if (used < 1)
+      used = 1;
+
+    for (int t = 0; t < used; t++) {
+      workers[t] = (MatrixWorker) { .cells = cells, .width = width, .m = m, .step = k };
+      workers[t].first = start + (int) ((long) (n - start) * t / used);
+      workers[t].last = start + (int) ((long) (n - start) * (t + 1) / used);
+    }
+
+    Software->RunWorkers(&updateRows, workers, sizeof *workers, used);
+  }
+
+  *determinant = montgomeryMultiply(product, 1, m);
+
+  return 1;
+}
+
+/*
+
+  The Bignum that the limbs of sums add up to, sums[l] counting
+  2^(32 l), into limbs (room for count + 4) viewed as r, which
+  only stays good until limbs are written again
+
+*/
+
+static void viewSums(Bignum *r, const unsigned __int128 *sums, const int count, uint32_t *limbs) {
+
+  unsigned __int128 carry = 0;
+  int length = 0;
+
+  for (int l = 0; l < count + 4; l++) {
+
+    carry += l < count ? sums[l] : 0;
+    limbs[l] = (uint32_t) carry;
+    carry >>= 32;
+
+    if (limbs[l])
+      length = l + 1;
+  }
+
+  *r = (Bignum) { limbs, length, count + 4, 0 };
+}
+
+/*
+
+  x(0), x(1), ... into digits, steps of them, with A (the first n
+  columns of rows) inverted modulo p in inverse (in Montgomery form,
+  n + i columns to a row). The last column of rows, r, is used up.
+
+*/
+
+static void lift(Bignum **rows, const int n, const uint64_t *inverse, const Montgomery *m, uint64_t *digits, const long steps) {
+
+  const uint64_t p = m->p;
+
+  // A packed, the magnitudes width limbs each, and their signs
+  int width = 1;
+
+  for (int i = 0; i < n; i++)
+    for (int j = 0; j < n; j++)
+      if (rows[i][j].length > width)
+        width = rows[i][j].length;
+
+  uint32_t *limbs = calloc((size_t) n * (size_t) n * (size_t) width, sizeof (uint32_t));
+  unsigned char *negative = malloc((size_t) n * (size_t) n);
+  uint64_t *remainders = malloc((size_t) n * sizeof (uint64_t));
+  unsigned __int128 *sums = malloc((size_t) 2 * (size_t) width * sizeof (unsigned __int128));
+  uint32_t *view = malloc((size_t) 2 * (size_t) (width + 4) * sizeof (uint32_t));
+
+  if (!limbs || !negative || !remainders || !sums || !view) DISPLAY_MALLOC_ERROR
+
+  for (int i = 0; i < n; i++)
+    for (int j = 0; j < n; j++) {
+
+      const Bignum *a = &rows[i][j];
+
+      memcpy(&limbs[((long) i * n + j) * width], a->limbs, (size_t) a->length * sizeof (uint32_t));
+      negative[(long) i * n + j] = (unsigned char) a->negative;
+    }
+
+  Bignum prime = BIGNUM_ZERO, positive, negatives;
+
+  Bignums->fromInt(&prime, (int64_t) p);
+
+  for (long k = 0; k < steps; k++) {
+
+    uint64_t *digit = &digits[k * n];
+
+    for (int j = 0; j < n; j++)
+      remainders[j] = Modular->remainder(&rows[j][n], p);
+
+    // x(k) = C r(k), the products below p each, so the sum doesn't overflow
+    for (int i = 0; i < n; i++) {
+
+      const uint64_t *c = &inverse[(long) i * 2 * n + n];
+      uint64_t sum = 0;
+
+      for (int j = 0; j < n; j++) {
+        sum += montgomeryMultiply(c[j], remainders[j], m);
+        sum = sum >= p ? sum - p : sum;
+      }
+
+      digit[i] = sum;
+    }
+
+    // r(k + 1) = (r(k) - A x(k)) / p, every limb product summed in 128 bits
+    for (int i = 0; i < n; i++) {
+
+      memset(sums, 0, (size_t) 2 * (size_t) width * sizeof (unsigned __int128));
+
+      for (int j = 0; j < n; j++) {
+
+        const uint32_t *a = &limbs[((long) i * n + j) * width];
+        unsigned __int128 *to = negative[(long) i * n + j] ? sums + width : sums;
+
+        if (!digit[j])
+          continue;
+
+        for (int l = 0; l < width; l++)
+          to[l] += (unsigned __int128) a[l] * digit[j];
+      }
+
+      viewSums(&positive, sums, width, view);
+      viewSums(&negatives, sums + width, width, view + width + 4);
+
+      Bignums->subtract(&rows[i][n], &rows[i][n], &positive);
+      Bignums->add(&rows[i][n], &rows[i][n], &negatives);
+      Bignums->divideExact(&rows[i][n], &rows[i][n], &prime);
+    }
+  }
+
+  Bignums->free(&prime);
+
+  free(limbs);
+  free(negative);
+  free(remainders);
+  free(sums);
+  free(view);
+}
+
+/*
+
+  Sets r to numerator / denominator, reduced, denominator above 0.
+  Both are changed.
+
+*/
+
+static void setFraction(BigFraction *r, Bignum *numerator, Bignum *denominator) {
+
+  Bignum common = BIGNUM_ZERO, zero = BIGNUM_ZERO;
+
+  Bignums->gcd(&common, numerator, denominator);
+  Bignums->divideExact(numerator, numerator, &common);
+  Bignums->divideExact(denominator, denominator, &common);
+
+  if (Bignums->compare(denominator, &zero) < 0) {
+    Bignums->subtract(numerator, &zero, numerator);
+    Bignums->subtract(denominator, &zero, denominator);
+  }
+
+  Bignums->copy(&r->numerator, numerator);
+  Bignums->copy(&r->denominator, denominator);
+
+  Bignums->free(&common);
+}
+
+/*
+
+  x(first)[i] + x(first + 1)[i] p + ... for count digits, the
+  two halves put together with one product, not digit by digit
+
+*/
+
+static void digitsToBignum(Bignum *x, const MatrixWorker *w, const int i, const long first, const long count) {
+
+  if (count == 1) {
+    Bignums->fromInt(x, (int64_t) w->digits[first * w->count + i]);
+    return;
+  }
+
+  // 2^level < count <= 2^(level + 1)
+  int level = 63 - __builtin_clzl((unsigned long) count - 1);
+  long half = 1L << level;
+
+  Bignum high = BIGNUM_ZERO;
+
+  digitsToBignum(&high, w, i, first + half, count - half);
+  Bignums->multiply(&high, &high, &w->powers[level]);
+
+  digitsToBignum(x, w, i, first, half);
+  Bignums->add(x, x, &high);
+
+  Bignums->free(&high);
+}
+
+/*
+
+  The worker's x[i], each y / d if that is small enough,
+  else reconstructed on its own (see above)
+
+*/
+
+static void *finishSolution(void *argument) {
+
+  MatrixWorker *w = argument;
+
+  Bignum value = BIGNUM_ZERO, y = BIGNUM_ZERO, twice = BIGNUM_ZERO, denominator = BIGNUM_ZERO;
+  Bignum common = BIGNUM_ZERO;
+
+  long modulusBits = bitLength(w->modulus);
+
+  // The denominators met so far, all of which divide det A
+  Bignums->copy(&common, w->denominator);
+
+  for (int i = w->first; i < w->last; i++) {
+
+    digitsToBignum(&value, w, i, 0, w->steps);
+
+    // common x[i], from -p^K/2 to p^K/2
+    Bignums->multiply(&y, &common, &value);
+    Bignums->divide(NULL, &y, &y, w->modulus);
+    Bignums->add(&twice, &y, &y);
+
+    if (Bignums->compare(&twice, w->modulus) > 0)
+      Bignums->subtract(&y, &y, w->modulus);
+
+    long bits = bitLength(&y) > bitLength(&common) ? bitLength(&y) : bitLength(&common);
+
+    if (bits + w->bound + 2 <= modulusBits) {
+      Bignums->copy(&denominator, &common);
+      setFraction(&w->x[i], &y, &denominator);
+      continue;
+    }
+
+    // Within the bounds there is always one
+    if (!Modular->reconstruct(&value, w->modulus, &y, &denominator))
+      continue;
+
+    setFraction(&w->x[i], &y, &denominator);
+
+    // common = lcm(common, denominator), so the next ones pass
+    Bignums->gcd(&twice, &common, &denominator);
+    Bignums->divideExact(&denominator, &denominator, &twice);
+    Bignums->multiply(&common, &common, &denominator);
+  }
+
+  Bignums->free(&value);
+  Bignums->free(&y);
+  Bignums->free(&twice);
+  Bignums->free(&denominator);
+  Bignums->free(&common);
+
+  return NULL;
+}
+
+/*
+
+  Sets d to the determinant of a, d g over the product of the
+  scales (see above), g from primes from next on and from first,
+  the determinant modulo p
+
+*/
+
+static void setDeterminant(BigFraction *d, Bignum **rows, const int n, const Bignum *scales, const Bignum *denominator, const long bound, int next, const uint64_t first, const uint64_t p) {
+
+  uint64_t *cells = malloc((size_t) n * (size_t) n * sizeof (uint64_t));
+
+  if (!cells) DISPLAY_MALLOC_ERROR
+
+  // Bits |g| stays below
+  long bits = bound - bitLength(denominator) + 1;
+
+  Bignum g = BIGNUM_ZERO, M = BIGNUM_ZERO, symmetric = BIGNUM_ZERO, twice = BIGNUM_ZERO;
+
+  Bignums->fromInt(&M, 1);
+  Modular->combine(&g, &M, first, p);
+
+  // M above 2 |g|, however small g turns out
+  while (bitLength(&M) < bits + 2) {
+
+    uint64_t q = Modular->prime(next++);
+
+    uint64_t divisor = Modular->remainder(denominator, q);
+
+    // Not a prime g can be found modulo
+    if (!divisor)
+      continue;
+
+    Montgomery m = montgomeryFor(q);
+    uint64_t whole = 0;
+
+    // Singular modulo q leaves it 0, which it is
+    rowsModulo(rows, n, n, &m, cells, n);
+    eliminateModulo(cells, n, n, &m, 0, &whole);
+
+    Modular->combine(&g, &M, modularMultiply(whole, Modular->inverse(divisor, q), q), q);
+  }
+
+  // From -M/2 to M/2
+  Bignums->copy(&symmetric, &g);
+  Bignums->add(&twice, &g, &g);
+
+  if (Bignums->compare(&twice, &M) > 0)
+    Bignums->subtract(&symmetric, &g, &M);
+
+  Bignum numerator = BIGNUM_ZERO, product = BIGNUM_ZERO;
+
+  Bignums->multiply(&numerator, &symmetric, denominator);
+  Bignums->fromInt(&product, 1);
+
+  for (int i = 0; i < n; i++)
+    Bignums->multiply(&product, &product, &scales[i]);
+
+  setFraction(d, &numerator, &product);
+
+  Bignums->free(&g);
+  Bignums->free(&M);
+  Bignums->free(&symmetric);
+  Bignums->free(&twice);
+  Bignums->free(&numerator);
+  Bignums->free(&product);
+
+  free(cells);
+}
+
+/*
+
+  Solves the rows (a and b, made whole by wholeRows()), x or d
+  can be NULL. Returns 0 if a is singular, d is then 0/1.
+
+*/
+
+static int solveRows(Bignum **rows, const int n, const Bignum *scales, BigFraction *x, BigFraction *d) {
+
+  // Hadamard's bounds, on x (a and b) and on the determinant (a)
+  long half = (32 - __builtin_clz((unsigned int) n + 1) + 1) / 2;
+  long bound = 1, determinantBound = 1;
+
+  for (int i = 0; i < n; i++) {
+
+    long widest = 0, widestA = 0;
+
+    for (int j = 0; j <= n; j++) {
+
+      long bits = bitLength(&rows[i][j]);
+
+      if (bits > widest) widest = bits;
+      if (j < n && bits > widestA) widestA = bits;
+    }
+
+    bound += widest + half;
+    determinantBound += widestA + half;
+  }
+
+  uint64_t *cells = malloc((size_t) n * (size_t) n * 2 * sizeof (uint64_t));
+
+  if (!cells) DISPLAY_MALLOC_ERROR
+
+  uint64_t p = 0, whole = 0;
+  int next = 0, found = 0;
+  long singular = 0;
+  Montgomery m;
+
+  // A prime A isn't singular modulo, or enough that it is singular
+  while (!found && singular * MODULAR_PRIME_BITS < determinantBound) {
+
+    p = Modular->prime(next++);
+    m = montgomeryFor(p);
+
+    rowsModulo(rows, n, n, &m, cells, n);
+
+    found = eliminateModulo(cells, n, n, &m, 0, &whole);
+
+    if (!found)
+      singular++;
+  }
+
+  if (!found) {
+
+    if (d) {
+      Bignums->fromInt(&d->numerator, 0);
+      Bignums->fromInt(&d->denominator, 1);
+    }
+
+    free(cells);
+    return 0;
+  }
+
+  // a and its inverse next to each other, modulo p
+  rowsModulo(rows, n, n, &m, cells, 2 * n);
+
+  for (int i = 0; i < n; i++)
+    for (int j = 0; j < n; j++)
+      cells[(long) i * 2 * n + n + j] = i == j ? m.one : 0;
+
+  eliminateModulo(cells, n, 2 * n, &m, 1, &whole);
+
+  // p^K >= 2^(2 bound + 2)
+  long steps = (2 * bound + 2) / MODULAR_PRIME_BITS + 1;
+  uint64_t *digits = malloc((size_t) steps * (size_t) n * sizeof (uint64_t));
+
+  if (!digits) DISPLAY_MALLOC_ERROR
+
+  lift(rows, n, cells, &m, digits, steps);
+
+  // p^(2^j) up to the top bit of K, and p^K from those
+  int levels = 64 - __builtin_clzl((unsigned long) steps);
+  Bignum *powers = calloc((size_t) levels, sizeof (Bignum));
+
+  if (!powers) DISPLAY_MALLOC_ERROR
+
+  Bignum modulus = BIGNUM_ZERO, first = BIGNUM_ZERO;
+  Bignum numerator = BIGNUM_ZERO, denominator = BIGNUM_ZERO, common = BIGNUM_ZERO;
+
+  Bignums->fromInt(&powers[0], (int64_t) p);
+  Bignums->fromInt(&modulus, 1);
+
+  for (int j = 0; j < levels; j++) {
+
+    if (j)
+      Bignums->multiply(&powers[j], &powers[j - 1], &powers[j - 1]);
+
+    if (steps >> j & 1)
+      Bignums->multiply(&modulus, &modulus, &powers[j]);
+  }
+
+  MatrixWorker workers[MATRIX_MAX_THREADS];
+  MatrixWorker all = { digits, n, steps, powers, &modulus, &denominator, bound, x, 0, 1, NULL, 0, NULL, 0 };
+
+  // d, from x[0] reduced
+  digitsToBignum(&first, &all, 0, 0, steps);
+  Modular->reconstruct(&first, &modulus, &numerator, &denominator);
+  Bignums->gcd(&common, &numerator, &denominator);
+  Bignums->divideExact(&denominator, &denominator, &common);
+
+  if (x) {
+
+    int threads = Software->Threads();
+
+    if (threads > MATRIX_MAX_THREADS)
+      threads = MATRIX_MAX_THREADS;
+
+    if (threads > n)
+      threads = n;
+
+    for (int t = 0; t < threads; t++) {
+      workers[t] = all;
+      workers[t].first = (int) ((long) n * t / threads);
+      workers[t].last = (int) ((long) n * (t + 1) / threads);
+    }
+
+    Software->RunWorkers(&finishSolution, workers, sizeof *workers, threads);
+  }
+
+  if (d)
+    setDeterminant(d, rows, n, scales, &denominator, determinantBound, next,
+      modularMultiply(whole, Modular->inverse(Modular->remainder(&denominator, p), p), p), p);
+
+  for (int j = 0; j < levels; j++)
+    Bignums->free(&powers[j]);
+
+  Bignums->free(&modulus);
+  Bignums->free(&first);
+  Bignums->free(&numerator);
+  Bignums->free(&denominator);
+  Bignums->free(&common);
+
+  free(powers);
+  free(digits);
+  free(cells);
+
+  return 1;
+}
+
+static void freeScales(Bignum *scales, const int n) {
+
+  for (int i = 0; i < n; i++)
+    Bignums->free(&scales[i]);
+
+  free(scales);
+}
+
+static int determinant(const Matrix *restrict a, BigFraction *restrict d) {
+
+  if (a->rows != a->columns)
+    return 0;
+
+  const int n = a->rows;
+
+  Bignum *scales = calloc((size_t) n, sizeof (Bignum));
+  Fraction *b = calloc((size_t) n, sizeof (Fraction));
+
+  if (!scales || !b) DISPLAY_MALLOC_ERROR
+
+  // Any b would do, one without a pattern keeps g small
+  for (int i = 0; i < n; i++)
+    b[i] = (Fraction) { (int) ((uint32_t) (i + 1) * 2654435761u % 255) - 127, 1 };
+
+  Bignum **rows = wholeRows(a, b, scales);
+
+  if (rows) {
+    solveRows(rows, n, scales, NULL, d);
+    freeRows(rows, n, n + 1);
+  }
+
+  freeScales(scales, n);
+  free(b);
+
+  return rows != NULL;
+}
+
+static int solve(const Matrix *restrict a, const Fraction *restrict b, BigFraction *restrict x, BigFraction *restrict d) {
+
+  if (a->rows != a->columns)
+    return 0;
+
+  const int n = a->rows;
+
+  Bignum *scales = calloc((size_t) n, sizeof (Bignum));
+
+  if (!scales) DISPLAY_MALLOC_ERROR
+
+  Bignum **rows = wholeRows(a, b, scales);
+  int solved = 0;
+
+  if (rows) {
+    solved = solveRows(rows, n, scales, x, d);
+    freeRows(rows, n, n + 1);
+  }
+
+  freeScales(scales, n);
+
+  return solved;
+}
+
+/*
+
+  Abstraction, same as in Software.c
+
+*/
+
+const static matrixMath MatrixFunctions = {
+  &create,
+  &freeMatrix,
+  &cell,
+  &determinant,
+  &solve
+};
+
+const matrixMath *restrict Matrices = &MatrixFunctions;
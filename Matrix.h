@@ -0,0 +1,145 @@
+/*
+
+  Matrix
+
+  Matrices of fractions, and their determinants and linear
+  systems, worked out exactly.
+
+  Gaussian elimination through Operation() reduces every entry it
+  writes, so nearly all of its time goes into greatest common
+  divisors, and even fraction-free elimination on whole numbers
+  works with entries as long as the determinant at every step.
+  Instead each row is multiplied by the least common multiple of
+  its denominators, which leaves whole numbers, and the system is
+  solved modulo one prime (see Modular.h) and lifted from there
+  to the powers of that prime (Dixon), with 64 bit arithmetic on
+  numbers the size of the entries for nearly all of the work.
+  Only the results are Bignums, made into fractions at the end
+  with rational reconstruction. See Matrix.c.
+
+  The results are split over Software->Threads() when there are
+  enough of them.
+
+*/
+
+#ifndef MATRIX
+#define MATRIX
+
+#include "Software.h"
+#include "Bignum.h"
+
+/*
+
+  Fractions in rows and columns
+
+  Type: Matrix
+
+*/
+
+typedef struct {
+
+  int rows;
+  int columns;
+
+  // rows * columns fractions, row by row
+  Fraction *cells;
+
+}
+Matrix;
+
+/*
+
+  Largest number of rows or columns
+
+*/
+
+#define MATRIX_MAX_SIZE 4096
+
+typedef struct {
+
+  /*
+
+    int create(Matrix *m, int rows, int columns)
+
+    Sets m up with every cell 0/1, free it with Matrices->free().
+
+    Returns 0 (m unchanged) if a size is below 1 or
+    above MATRIX_MAX_SIZE, else 1.
+
+    Access: Matrices->create()
+
+  */
+
+  int(*const create)(Matrix * restrict m, int rows, int columns);
+
+  /*
+
+    void free(Matrix *m)
+
+    Access: Matrices->free()
+
+  */
+
+  void(*const free)(Matrix * restrict m);
+
+  /*
+
+    Fraction* cell(Matrix *m, int row, int column)
+
+    The cell at row, column, both counted from 0.
+
+    Access: Matrices->cell()
+
+  */
+
+  Fraction*(*const cell)(const Matrix * restrict m, int row, int column);
+
+  /*
+
+    int determinant(Matrix *a, BigFraction *d)
+
+    Sets d (started with Bignums->fractionInit()) to the
+    determinant of a.
+
+    Returns 0 (d unchanged) if a isn't square or has a
+    0 denominator, else 1.
+
+    Access: Matrices->determinant()
+
+  */
+
+  int(*const determinant)(const Matrix * restrict a, BigFraction * restrict d);
+
+  /*
+
+    int solve(Matrix *a, Fraction *b, BigFraction *x, BigFraction *d)
+
+    Solves a x = b, a square, b and x a->rows long, every x[i]
+    started with Bignums->fractionInit(). d, if it isn't NULL,
+    is set to the determinant of a on the way, 0/1 if a is
+    singular (started with Bignums->fractionInit() too).
+
+    Returns 0 (x unchanged) if there isn't exactly one solution
+    (a is singular), a isn't square, or there is a 0 denominator,
+    else 1.
+
+    Access: Matrices->solve()
+
+  */
+
+  int(*const solve)(const Matrix * restrict a, const Fraction * restrict b, BigFraction * restrict x, BigFraction * restrict d);
+
+}
+matrixMath;
+
+/*
+
+  Call this, Matrices, to access all
+  the publicly available functions.
+
+*/
+
+extern
+const matrixMath * restrict Matrices;
+
+#endif //Matrix.h
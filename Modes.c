@@ -0,0 +1,1323 @@
+/*
+
+  Modes
+
+  Every non-interactive mode of the program, and the table
+  getModeToRun() uses to look them up by name.
+
+  All modes follow a pattern, they take the arguments that follow
+  their name on the command line, and return the exit code.
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "Software.h"
+#include "Operations.h"
+#include "Wire.h"
+#include "Daemon.h"
+#include "Batch.h"
+#include "SharedQueue.h"
+#include "Random.h"
+#include "Bignum.h"
+#include "Aggregate.h"
+#include "Sort.h"
+#include "Approximate.h"
+#include "Decimal.h"
+#include "Matrix.h"
+#include "Expression.h"
+#include "Modular.h"
+#include "Bench.h"
+#include "Workload.h"
+#include "Columns.h"
+#include "IO.h"
+#include "Modes.h"
+
+/*
+
+  Error Messages
+
+*/
+
+#define DISPLAY_INVALID_RECORD_ERROR(line) fprintf(stderr, "Invalid equation on line %zu, skipped\n", line);
+#define DISPLAY_INVALID_ARGUMENT_ERROR(argument) fprintf(stderr, "Invalid argument: %s\n", argument);
+
+/*
+
+  Number of records handled at once by the binary modes
+
+*/
+
+#define MODES_RECORD_BATCH 4096
+
+/*
+
+  Longest decimal result --wire-to-text --decimal writes
+
+*/
+
+#define MODES_MAX_DECIMAL 4096
+
+/*
+
+  --wire
+
+  Reads binary equation records from stdin, evaluates
+  them, and writes the results to stdout.
+
+*/
+
+static int wireMode(__attribute__((unused)) int argc, __attribute__((unused)) char **argv) {
+
+  static WireRecord records[MODES_RECORD_BATCH];
+  size_t count;
+
+  while ((count = Wire->read(stdin, records, MODES_RECORD_BATCH)) > 0) {
+
+    for (size_t i = 0; i < count; i++)
+      Wire->evaluate(&records[i]);
+
+    if (Wire->write(stdout, records, count) != count)
+      return 1;
+  }
+
+  return 0;
+}
+
+/*
+
+  --wire-to-text [--decimal]
+
+  Converts binary equation records on stdin to
+  one equation per line on stdout. --decimal adds
+  the result as a decimal, "1/2 + 2/3 = 7/6 = 1.1(6)".
+
+*/
+
+static int hasFlag(int argc, char **argv, const char *name);
+
+static int wireToTextMode(int argc, char **argv) {
+
+  static WireRecord records[MODES_RECORD_BATCH];
+  char text[WIRE_MAX_TEXT];
+  char decimal[MODES_MAX_DECIMAL];
+  size_t count;
+
+  int decimals = hasFlag(argc, argv, "--decimal");
+
+  while ((count = Wire->read(stdin, records, MODES_RECORD_BATCH)) > 0)
+    for (size_t i = 0; i < count; i++) {
+
+      Wire->toText(&records[i], text, sizeof (text));
+
+      if (
+        decimals && records[i].status == WIRE_STATUS_OK &&
+        Decimal->toText(records[i].resultNumerator, records[i].resultDenomenator, decimal, sizeof (decimal)))
+        printf("%s = %s\n", text, decimal);
+      else
+        puts(text);
+    }
+
+  return 0;
+}
+
+/*
+
+  --text-to-wire
+
+  Converts one equation per line on stdin, in the format of
+  Equations->getFormatted(), to binary records on stdout.
+
+*/
+
+static int textToWireMode(__attribute__((unused)) int argc, __attribute__((unused)) char **argv) {
+
+  static WireRecord records[MODES_RECORD_BATCH];
+  char line[WIRE_MAX_TEXT];
+  size_t count = 0, lineNumber = 0;
+
+  while (fgets(line, sizeof (line), stdin)) {
+
+    lineNumber++;
+    line[strcspn(line, "\r\n")] = 0;
+
+    if (!Wire->fromText(&records[count], line)) {
+      DISPLAY_INVALID_RECORD_ERROR(lineNumber)
+      continue;
+    }
+
+    if (++count == MODES_RECORD_BATCH) {
+      Wire->write(stdout, records, count);
+      count = 0;
+    }
+  }
+
+  Wire->write(stdout, records, count);
+
+  return 0;
+}
+
+/*
+
+  Reads the daemon and load test options, the ones that
+  aren't given keep the values already in *options.
+
+  Returns 1 if every argument was understood, else 0.
+
+*/
+
+static int getDaemonOptions(int argc, char **argv, daemonOptions *options) {
+
+  for (int i = 1; i < argc; i++) {
+
+    // Every option takes a value
+    if (i + 1 >= argc) {
+      DISPLAY_INVALID_ARGUMENT_ERROR(argv[i])
+      return 0;
+    }
+
+    const char *option = argv[i], *value = argv[++i];
+
+    if (!strcmp(option, "--socket"))
+      options->socketPath = strcmp(value, "none") ? value : NULL;
+    else if (!strcmp(option, "--port"))
+      options->port = atoi(value);
+    else if (!strcmp(option, "--connections"))
+      options->connections = atoi(value);
+    else if (!strcmp(option, "--requests"))
+      options->requests = atol(value);
+    else if (!strcmp(option, "--pipeline"))
+      options->pipeline = atoi(value);
+    else {
+      DISPLAY_INVALID_ARGUMENT_ERROR(option)
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+/*
+
+  --daemon [--socket PATH|none] [--port N]
+
+  Serves expressions until SIGINT or SIGTERM. (See Daemon.h)
+  A port of 0 turns TCP off.
+
+*/
+
+static int daemonMode(int argc, char **argv) {
+
+  daemonOptions options = { DAEMON_DEFAULT_SOCKET, DAEMON_DEFAULT_PORT, 0, 0, 0 };
+
+  if (!getDaemonOptions(argc, argv, &options))
+    return 1;
+
+  return Daemon->serve(&options);
+}
+
+/*
+
+  --loadtest [--socket PATH] [--port N] [--connections N] [--requests N] [--pipeline N]
+
+  Measures a running daemon. Uses the socket unless
+  a port is given.
+
+*/
+
+static int loadTestMode(int argc, char **argv) {
+
+  daemonOptions options = { DAEMON_DEFAULT_SOCKET, 0, 16, 1000000, 32 };
+
+  if (!getDaemonOptions(argc, argv, &options))
+    return 1;
+
+  if (options.port)
+    options.socketPath = NULL;
+
+  if (!options.socketPath && !options.port)
+    options.port = DAEMON_DEFAULT_PORT;
+
+  if (options.connections < 1 || options.pipeline < 1 || options.requests < 1) {
+    DISPLAY_INVALID_ARGUMENT_ERROR("connections, requests and pipeline must be positive")
+    return 1;
+  }
+
+  return Daemon->loadTest(&options);
+}
+
+/*
+
+  --batch [--backend plain|uring] INPUT OUTPUT [INPUT OUTPUT ...]
+
+  Evaluates every line of each INPUT file into its OUTPUT file.
+  (See Batch.h)
+
+*/
+
+static int batchMode(int argc, char **argv) {
+
+  int backend = BATCH_BACKEND_URING;
+  int first = 1;
+
+  if (argc > 2 && !strcmp(argv[1], "--backend")) {
+    backend = strcmp(argv[2], "plain") ? BATCH_BACKEND_URING : BATCH_BACKEND_PLAIN;
+    first = 3;
+  }
+
+  if (argc - first < 2 || (argc - first) % 2) {
+    DISPLAY_INVALID_ARGUMENT_ERROR("expected INPUT OUTPUT pairs")
+    return 1;
+  }
+
+  batchResult result = { 0, 0, 0, 0, 0 };
+
+  for (int i = first; i < argc; i += 2)
+    if (!Batch->evaluate(argv[i], argv[i + 1], backend, &result))
+      return 1;
+
+  fprintf(stderr, "%li lines, %li errors\n", result.lines, result.errors);
+
+  return 0;
+}
+
+/*
+
+  --batch-bench [--runs N] INPUT [INPUT ...]
+
+  Compares the plain and io_uring backends on the INPUT files.
+
+*/
+
+static int batchBenchMode(int argc, char **argv) {
+
+  int runs = 3;
+  int first = 1;
+
+  if (argc > 2 && !strcmp(argv[1], "--runs")) {
+    runs = atoi(argv[2]);
+    first = 3;
+  }
+
+  if (first >= argc || runs < 1) {
+    DISPLAY_INVALID_ARGUMENT_ERROR("expected --runs N > 0 and at least one INPUT")
+    return 1;
+  }
+
+  return !Batch->benchmark(argv + first, argc - first, runs);
+}
+
+/*
+
+  Looks for "--name value" in the arguments, returns
+  the value, or fallback if it isn't there.
+
+*/
+
+static const char *getOption(int argc, char **argv, const char *name, const char *fallback) {
+
+  for (int i = 1; i + 1 < argc; i++)
+    if (!strcmp(argv[i], name))
+      return argv[i + 1];
+
+  return fallback;
+}
+
+/*
+
+  --spin N, by default SHARED_QUEUE_DEFAULT_SPIN, but 0 on a
+  single CPU, where polling only keeps the other side from running.
+
+*/
+
+static int getSpin(int argc, char **argv) {
+
+  int spin = atoi(getOption(argc, argv, "--spin", "-1"));
+
+  if (spin < 0)
+    spin = sysconf(_SC_NPROCESSORS_ONLN) > 1 ? SHARED_QUEUE_DEFAULT_SPIN : 0;
+
+  return spin;
+}
+
+/*
+
+  --shm-serve [--name NAME] [--pairs N] [--spin N]
+
+  Evaluates records from clients on the same machine through
+  shared memory. (See SharedQueue.h)
+
+*/
+
+static int sharedQueueServeMode(int argc, char **argv) {
+
+  int pairs = atoi(getOption(argc, argv, "--pairs", "8"));
+  int spin  = getSpin(argc, argv);
+
+  if (pairs < 1) {
+    DISPLAY_INVALID_ARGUMENT_ERROR("--pairs must be positive")
+    return 1;
+  }
+
+  return SharedQueue->serve(getOption(argc, argv, "--name", SHARED_QUEUE_DEFAULT_NAME), pairs, spin);
+}
+
+/*
+
+  --shm-client [--name NAME] [--spin N]
+
+  Same as --wire, but the records are evaluated by
+  a running --shm-serve.
+
+*/
+
+static int sharedQueueClientMode(int argc, char **argv) {
+
+  static WireRecord records[MODES_RECORD_BATCH];
+  size_t count;
+
+  SharedQueueClient *client = SharedQueue->connect(
+    getOption(argc, argv, "--name", SHARED_QUEUE_DEFAULT_NAME),
+    getSpin(argc, argv)
+  );
+
+  if (!client)
+    return 1;
+
+  while ((count = Wire->read(stdin, records, MODES_RECORD_BATCH)) > 0) {
+    SharedQueue->evaluate(client, records, count);
+    Wire->write(stdout, records, count);
+  }
+
+  SharedQueue->disconnect(client);
+
+  return 0;
+}
+
+/*
+
+  For sorting latencies
+
+*/
+
+static int compareLatency(const void *a, const void *b) {
+  long long x = *(const long long *) a, y = *(const long long *) b;
+  return (x > y) - (x < y);
+}
+
+/*
+
+  --shm-bench [--name NAME] [--requests N] [--batch N] [--spin N]
+
+  Sends batches of records to a running --shm-serve and waits for
+  each batch, printing records/sec and the round trip latency.
+
+*/
+
+static int sharedQueueBenchMode(int argc, char **argv) {
+
+  long requests = atol(getOption(argc, argv, "--requests", "1000000"));
+  long batch    = atol(getOption(argc, argv, "--batch", "1"));
+
+  if (requests < 1 || batch < 1 || batch > SHARED_QUEUE_CAPACITY) {
+    DISPLAY_INVALID_ARGUMENT_ERROR("--requests must be positive, --batch between 1 and the ring capacity")
+    return 1;
+  }
+
+  SharedQueueClient *client = SharedQueue->connect(
+    getOption(argc, argv, "--name", SHARED_QUEUE_DEFAULT_NAME),
+    getSpin(argc, argv)
+  );
+
+  if (!client)
+    return 1;
+
+  long rounds = (requests + batch - 1) / batch;
+  WireRecord *records = malloc((size_t) batch * sizeof (WireRecord));
+  long long *latencies = malloc((size_t) rounds * sizeof (long long));
+
+  if (!records || !latencies) {
+    SharedQueue->disconnect(client);
+    return 1;
+  }
+
+  struct timespec start, before, after;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  for (long round = 0; round < rounds; round++) {
+
+    for (long i = 0; i < batch; i++) {
+      long n = round * batch + i;
+      records[i] = (WireRecord) {
+        (int32_t) (n % 97), (int32_t) (n % 89 + 1),
+        (int32_t) (n % 83 + 1), (int32_t) (n % 79 + 1),
+        0, 0, (uint8_t) "+-*/"[n % 4], 0, { 0, 0 }
+      };
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &before);
+    SharedQueue->evaluate(client, records, (size_t) batch);
+    clock_gettime(CLOCK_MONOTONIC, &after);
+
+    latencies[round] = (after.tv_sec - before.tv_sec) * 1000000000LL + (after.tv_nsec - before.tv_nsec);
+  }
+
+  double seconds = (double) (after.tv_sec - start.tv_sec) + (double) (after.tv_nsec - start.tv_nsec) / 1e9;
+
+  qsort(latencies, (size_t) rounds, sizeof (long long), &compareLatency);
+
+  printf("Records:       %li in batches of %li\n", rounds * batch, batch);
+  printf("Records/sec:   %.0f\n", (double) (rounds * batch) / seconds);
+  printf("Round trip p50: %.2f us\n", latencies[rounds / 2] / 1e3);
+  printf("Round trip p99: %.2f us\n", latencies[(rounds * 99) / 100] / 1e3);
+
+  SharedQueue->disconnect(client);
+  free(records);
+  free(latencies);
+
+  return 0;
+}
+
+/*
+
+  Is "--name" one of the arguments?
+
+*/
+
+static int hasFlag(int argc, char **argv, const char *name) {
+
+  for (int i = 1; i < argc; i++)
+    if (!strcmp(argv[i], name))
+      return 1;
+
+  return 0;
+}
+
+/*
+
+  --random [--count N] [--seed S] [--print]
+
+  Generates N random fractions into the data base, and
+  reports how fast. --print writes them out, one per line.
+
+*/
+
+static int randomMode(int argc, char **argv) {
+
+  long count = atol(getOption(argc, argv, "--count", "1000000"));
+  const char *seed = getOption(argc, argv, "--seed", NULL);
+
+  if (count <= 0 || count > 0x7fffffff) {
+    DISPLAY_INVALID_ARGUMENT_ERROR("--count")
+    return 1;
+  }
+
+  if (seed)
+    Random->seed(strtoull(seed, NULL, 0));
+
+  struct timespec before, after;
+
+  clock_gettime(CLOCK_MONOTONIC, &before);
+  Fraction *f = Random->store((int) count);
+  clock_gettime(CLOCK_MONOTONIC, &after);
+
+  double seconds = (double) (after.tv_sec - before.tv_sec) + (double) (after.tv_nsec - before.tv_nsec) / 1e9;
+
+  if (hasFlag(argc, argv, "--print"))
+    for (long i = 0; i < count; i++)
+      printf("%i/%i\n", f[i].numerator, f[i].denomenator);
+
+  fprintf(stderr, "%li fractions in %.3f s (%.1f million/s)\n", count, seconds, (double) count / seconds / 1e6);
+
+  Software->Exit();
+
+  return 0;
+}
+
+/*
+
+  --aggregate [--count N] [--seed S]
+
+  Generates N random fractions, adds them all up and multiplies
+  them all together, and prints both results to stdout, and how
+  long each took to stderr.
+
+*/
+
+static double secondsSince(const struct timespec *before) {
+
+  struct timespec after;
+
+  clock_gettime(CLOCK_MONOTONIC, &after);
+
+  return (double) (after.tv_sec - before->tv_sec) + (double) (after.tv_nsec - before->tv_nsec) / 1e9;
+}
+
+static int aggregateMode(int argc, char **argv) {
+
+  long count = atol(getOption(argc, argv, "--count", "1000000"));
+  const char *seed = getOption(argc, argv, "--seed", NULL);
+
+  if (count < 0 || count > 0x7fffffff) {
+    DISPLAY_INVALID_ARGUMENT_ERROR("--count")
+    return 1;
+  }
+
+  if (seed)
+    Random->seed(strtoull(seed, NULL, 0));
+
+  if (count)
+    Random->store((int) count);
+
+  void(*const aggregates[])(BigFraction *result) = { Aggregate->sum, Aggregate->product };
+  const char *names[] = { "sum", "product" };
+
+  BigFraction result;
+
+  Bignums->fractionInit(&result);
+
+  for (int i = 0; i < 2; i++) {
+
+    struct timespec before;
+
+    clock_gettime(CLOCK_MONOTONIC, &before);
+    aggregates[i](&result);
+
+    double seconds = secondsSince(&before);
+    char *text = Bignums->fractionToText(&result);
+
+    printf("%s = %s\n", names[i], text);
+    fprintf(stderr, "%s of %li fractions in %.3f s (%.1f million/s), %zu characters\n",
+      names[i], count, seconds, (double) count / seconds / 1e6, strlen(text));
+
+    free(text);
+  }
+
+  Bignums->fractionFree(&result);
+  Software->Exit();
+
+  return 0;
+}
+
+/*
+
+  --sort [--count N] [--seed S] [--print]
+
+  Generates N random fractions, sorts the data base, checks
+  the order, and reports how fast. --print writes them out in
+  order, one per line.
+
+*/
+
+static int sortMode(int argc, char **argv) {
+
+  long count = atol(getOption(argc, argv, "--count", "10000000"));
+  const char *seed = getOption(argc, argv, "--seed", NULL);
+
+  if (count <= 0 || count > 0x7fffffff) {
+    DISPLAY_INVALID_ARGUMENT_ERROR("--count")
+    return 1;
+  }
+
+  if (seed)
+    Random->seed(strtoull(seed, NULL, 0));
+
+  Random->store((int) count);
+
+  struct timespec before;
+
+  clock_gettime(CLOCK_MONOTONIC, &before);
+  Sort->store();
+
+  double seconds = secondsSince(&before);
+  long wrong = 0;
+
+  for (long i = 1; i < count; i++)
+    if (Sort->compare(Fractions->get((int) i - 1), Fractions->get((int) i)) > 0)
+      wrong++;
+
+  if (hasFlag(argc, argv, "--print"))
+    for (long i = 0; i < count; i++)
+      printf("%i/%i\n", Fractions->get((int) i)->numerator, Fractions->get((int) i)->denomenator);
+
+  fprintf(stderr, "%li fractions sorted in %.3f s (%.1f million/s), %li out of order\n",
+    count, seconds, (double) count / seconds / 1e6, wrong);
+
+  Software->Exit();
+
+  return wrong ? 1 : 0;
+}
+
+/*
+
+  --approximate [--max-denominator N | --tolerance T]
+
+  Reads one decimal number per line from stdin, and writes the
+  nearest fraction with a denominator up to N (by default below
+  IO_MAX_DENOMINATOR), or with --tolerance the simplest fraction
+  within T, one per line to stdout.
+
+*/
+
+static int approximateMode(int argc, char **argv) {
+
+  const char *max = getOption(argc, argv, "--max-denominator", NULL);
+  int maxDenominator = max ? atoi(max) : IO_MAX_DENOMINATOR - 1;
+  const char *tolerance = getOption(argc, argv, "--tolerance", NULL);
+
+  if (maxDenominator < 1) {
+    DISPLAY_INVALID_ARGUMENT_ERROR("--max-denominator")
+    return 1;
+  }
+
+  char line[WIRE_MAX_TEXT];
+
+  while (fgets(line, sizeof (line), stdin)) {
+
+    char *end;
+    double value = strtod(line, &end);
+    Fraction f;
+
+    int converted = end != line && (tolerance ?
+      Approximate->simplest(value, strtod(tolerance, NULL), &f) :
+      Approximate->closest(value, maxDenominator, &f));
+
+    if (converted)
+      printf("%i/%i\n", f.numerator, f.denomenator);
+    else
+      printf("error: invalid number\n");
+  }
+
+  return 0;
+}
+
+/*
+
+  Reads one fraction, "n/d", or a decimal like "2" or "0.(3)",
+  from the start of text, returns the characters read, or 0.
+
+*/
+
+static int readMatrixCell(const char *text, Fraction *f) {
+
+  int numerator, denominator, used;
+
+  if (sscanf(text, "%d/%d%n", &numerator, &denominator, &used) == 2) {
+    *f = (Fraction) { numerator, denominator };
+    return used;
+  }
+
+  return Decimal->fromText(text, f);
+}
+
+/*
+
+  --solve [--size N] [--seed S] [--print]
+
+  Solves a x = b exactly, and prints the determinant of a and
+  x, one per line. a and b are read from stdin, the number of
+  rows on the first line then each row of a followed by its b,
+  or with --size they are N x N random fractions, and how long
+  it took goes to stderr (--print to see the results too).
+
+*/
+
+static int solveMode(int argc, char **argv) {
+
+  const char *size = getOption(argc, argv, "--size", NULL);
+  const char *seed = getOption(argc, argv, "--seed", NULL);
+  int random = size != NULL;
+  int n = 0;
+
+  if (seed)
+    Random->seed(strtoull(seed, NULL, 0));
+
+  if (random)
+    n = atoi(size);
+  else if (scanf("%d", &n) != 1)
+    n = 0;
+
+  Matrix a;
+
+  if (!Matrices->create(&a, n, n)) {
+    DISPLAY_INVALID_ARGUMENT_ERROR("size")
+    return 1;
+  }
+
+  Fraction *b = malloc((size_t) n * sizeof (Fraction));
+  BigFraction *x = malloc((size_t) n * sizeof (BigFraction));
+
+  if (!b || !x) {
+    fprintf(stderr, "FATAL ERROR: UNABLE TO ALLOCATE MEMORY IN HEAP");
+    exit(-1);
+  }
+
+  char text[64];
+
+  for (int i = 0; i < n; i++)
+    for (int j = 0; j <= n; j++) {
+
+      Fraction *f = j < n ? Matrices->cell(&a, i, j) : &b[i];
+
+      if (random)
+        Random->fraction(f);
+      else if (scanf("%63s", text) != 1 || readMatrixCell(text, f) != (int) strlen(text)) {
+        DISPLAY_INVALID_RECORD_ERROR((size_t) i + 2)
+        Matrices->free(&a);
+        free(b);
+        free(x);
+        return 1;
+      }
+    }
+
+  for (int i = 0; i < n; i++)
+    Bignums->fractionInit(&x[i]);
+
+  BigFraction d;
+
+  Bignums->fractionInit(&d);
+
+  struct timespec before;
+
+  clock_gettime(CLOCK_MONOTONIC, &before);
+
+  // The determinant comes out of the same elimination
+  int solved = Matrices->solve(&a, b, x, &d);
+  double seconds = secondsSince(&before);
+
+  // Not solved can also be a 0 denominator
+  int valid = 1;
+
+  for (int i = 0; i < n; i++)
+    for (int j = 0; j <= n; j++)
+      if (!(j < n ? Matrices->cell(&a, i, j) : &b[i])->denomenator)
+        valid = 0;
+
+  if (!random || hasFlag(argc, argv, "--print")) {
+
+    if (valid) {
+      char *result = Bignums->fractionToText(&d);
+      printf("det = %s\n", result);
+      free(result);
+    }
+    else
+      printf("error: invalid matrix\n");
+
+    for (int i = 0; i < n && solved; i++) {
+      char *result = Bignums->fractionToText(&x[i]);
+      printf("x%i = %s\n", i + 1, result);
+      free(result);
+    }
+
+    if (valid && !solved)
+      printf("error: no single solution\n");
+  }
+
+  if (random)
+    fprintf(stderr, "%ix%i solved in %.3f s\n", n, n, seconds);
+
+  for (int i = 0; i < n; i++)
+    Bignums->fractionFree(&x[i]);
+
+  Bignums->fractionFree(&d);
+  Matrices->free(&a);
+  free(b);
+  free(x);
+
+  return solved ? 0 : 1;
+}
+
+/*
+
+  --evaluate [--backend direct|modular] [--compare]
+
+  Reads one expression per line from stdin, of any length (see
+  Expression.h), and writes each exact result to stdout. The
+  direct backend works with Bignums at every step, the modular
+  one modulo many primes (see Modular.h). --compare runs both
+  and counts the results that differ. How long it took, and how
+  many nodes were shared or folded away, goes to stderr.
+
+*/
+
+static int evaluateMode(int argc, char **argv) {
+
+  const char *backend = getOption(argc, argv, "--backend", "modular");
+  int compare = hasFlag(argc, argv, "--compare");
+  int modular = !strcmp(backend, "modular");
+
+  if (!modular && strcmp(backend, "direct")) {
+    DISPLAY_INVALID_ARGUMENT_ERROR(backend)
+    return 1;
+  }
+
+  char *line = NULL;
+  size_t size = 0;
+  long lines = 0, errors = 0, different = 0, primes = 0, nodes = 0, written = 0;
+  double seconds[2] = { 0, 0 };
+
+  Expression e = EXPRESSION_EMPTY;
+  BigFraction results[2];
+
+  Bignums->fractionInit(&results[0]);
+  Bignums->fractionInit(&results[1]);
+
+  while (getline(&line, &size, stdin) > 0) {
+
+    lines++;
+    line[strcspn(line, "\r\n")] = 0;
+
+    // #n needs stored fractions, there aren't any here
+    if (!Expressions->parse(line, &e) || e.references) {
+      printf("error: invalid expression\n");
+      errors++;
+      continue;
+    }
+
+    nodes += e.count;
+    written += e.written;
+
+    int status[2];
+
+    // 0 is the direct backend, 1 the modular one
+    for (int b = 0; b < 2; b++) {
+
+      if (!compare && b != modular)
+        continue;
+
+      struct timespec before;
+      int used = 0;
+
+      clock_gettime(CLOCK_MONOTONIC, &before);
+
+      status[b] = b ? Modular->evaluate(&e, &results[b], &used) : Expressions->evaluate(&e, &results[b]);
+
+      seconds[b] += secondsSince(&before);
+      primes += used;
+    }
+
+    int shown = compare ? 1 : modular;
+
+    if (compare && (status[0] != status[1] || (status[0] == EXPRESSION_OK && (
+      Bignums->compare(&results[0].numerator, &results[1].numerator) ||
+      Bignums->compare(&results[0].denominator, &results[1].denominator)))))
+      different++;
+
+    if (status[shown] == EXPRESSION_OK) {
+      char *text = Bignums->fractionToText(&results[shown]);
+      printf("%s\n", text);
+      free(text);
+    }
+    else {
+      printf("error: division by zero\n");
+      errors++;
+    }
+  }
+
+  fprintf(stderr, "%li distinct nodes, %li shared or folded away\n", nodes, written - nodes);
+
+  if (compare || !modular)
+    fprintf(stderr, "direct: %li lines in %.3f s\n", lines, seconds[0]);
+
+  if (compare || modular)
+    fprintf(stderr, "modular: %li lines in %.3f s, %li primes\n", lines, seconds[1], primes);
+
+  if (compare)
+    fprintf(stderr, "%li results differ\n", different);
+
+  fprintf(stderr, "%li errors\n", errors);
+
+  Bignums->fractionFree(&results[0]);
+  Bignums->fractionFree(&results[1]);
+  Expressions->free(&e);
+  free(line);
+
+  return different ? 1 : 0;
+}
+
+/*
+
+  --bench [--dataset NAME] [--benchmark NAME] [--samples N]
+          [--seconds S] [--seed S] [--label TEXT] [--json]
+
+  Times the hot paths (see Bench.h), every benchmark on every
+  data set unless one is named. A line per result goes to
+  stdout, or to stderr with --json, which writes the results
+  to stdout as JSON instead, to keep and compare with other runs.
+
+*/
+
+static int benchMode(int argc, char **argv) {
+
+  benchOptions options = {
+    getOption(argc, argv, "--dataset", "all"),
+    getOption(argc, argv, "--benchmark", "all"),
+    atoi(getOption(argc, argv, "--samples", "10")),
+    atof(getOption(argc, argv, "--seconds", "0.05")),
+    strtoull(getOption(argc, argv, "--seed", "0"), NULL, 0),
+    getOption(argc, argv, "--label", NULL)
+  };
+
+  int json = hasFlag(argc, argv, "--json");
+
+  if (!options.seed)
+    options.seed = RANDOM_DEFAULT_SEED;
+
+  if (options.samples < 1 || options.seconds <= 0) {
+    DISPLAY_INVALID_ARGUMENT_ERROR(options.samples < 1 ? "--samples" : "--seconds")
+    return 1;
+  }
+
+  if (!Bench->run(&options, json ? stderr : stdout, json ? stdout : NULL)) {
+    DISPLAY_INVALID_ARGUMENT_ERROR("--dataset or --benchmark")
+    return 1;
+  }
+
+  Software->Exit();
+
+  return 0;
+}
+
+/*
+
+  --generate [--count N] [--seed S] [--mix +4,-1,*2,/2,^1]
+             [--magnitude bounded|uniform|digits] [--largest N]
+             [--duplicates SHARE] [--noise SHARE] [--invalid SHARE]
+             [--length N|MIN-MAX] [--binary] [--output FILE]
+
+  Writes N made up expressions (see Workload.h) to FILE, or
+  stdout, and how fast to stderr. --mix gives each operator a
+  weight, the ones left out don't come up. --binary writes
+  WireRecords instead of text.
+
+*/
+
+static int getMix(const char *text, int weights[WORKLOAD_OPERATORS]) {
+
+  static const char operators[WORKLOAD_OPERATORS] = { OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_POW };
+
+  memset(weights, 0, WORKLOAD_OPERATORS * sizeof (int));
+
+  while (*text) {
+
+    const char *found = memchr(operators, *text, WORKLOAD_OPERATORS);
+    char *end;
+
+    if (!found)
+      return 0;
+
+    long weight = strtol(text + 1, &end, 10);
+
+    if (end == text + 1 || weight < 0 || weight > 1000000)
+      return 0;
+
+    weights[found - operators] = (int) weight;
+
+    text = *end == ',' ? end + 1 : end;
+
+    if (*end && *end != ',')
+      return 0;
+  }
+
+  return 1;
+}
+
+static int generateMode(int argc, char **argv) {
+
+  workloadOptions options = {
+    .count = atoll(getOption(argc, argv, "--count", "1000000")),
+    .largest = atoi(getOption(argc, argv, "--largest", "999999999")),
+    .duplicates = atof(getOption(argc, argv, "--duplicates", "0")),
+    .noise = atof(getOption(argc, argv, "--noise", "0")),
+    .invalid = atof(getOption(argc, argv, "--invalid", "0")),
+    .binary = hasFlag(argc, argv, "--binary")
+  };
+
+  const char *magnitude = getOption(argc, argv, "--magnitude", "bounded");
+  const char *length = getOption(argc, argv, "--length", "1");
+  const char *seed = getOption(argc, argv, "--seed", NULL);
+  const char *output = getOption(argc, argv, "--output", NULL);
+
+  if (!getMix(getOption(argc, argv, "--mix", "+1,-1,*1,/1,^1"), options.weights)) {
+    DISPLAY_INVALID_ARGUMENT_ERROR("--mix")
+    return 1;
+  }
+
+  if (!strcmp(magnitude, "bounded"))
+    options.magnitude = WORKLOAD_BOUNDED;
+  else if (!strcmp(magnitude, "uniform"))
+    options.magnitude = WORKLOAD_UNIFORM;
+  else if (!strcmp(magnitude, "digits"))
+    options.magnitude = WORKLOAD_DIGITS;
+  else {
+    DISPLAY_INVALID_ARGUMENT_ERROR("--magnitude")
+    return 1;
+  }
+
+  char *dash;
+
+  options.shortest = (int) strtol(length, &dash, 10);
+  options.longest = *dash == '-' ? atoi(dash + 1) : options.shortest;
+
+  if (seed)
+    Random->seed(strtoull(seed, NULL, 0));
+
+  FILE *out = output ? fopen(output, "wb") : stdout;
+
+  if (!out) {
+    DISPLAY_INVALID_ARGUMENT_ERROR(output)
+    return 1;
+  }
+
+  struct timespec before;
+
+  clock_gettime(CLOCK_MONOTONIC, &before);
+
+  long long bytes = Workload->generate(&options, out);
+  double seconds = secondsSince(&before);
+
+  if (output && fclose(out) && bytes >= 0) {
+    DISPLAY_INVALID_ARGUMENT_ERROR(output)
+    bytes = -1;
+  }
+
+  if (bytes < 0)
+    return 1;
+
+  fprintf(stderr, "%lli expressions, %lli bytes in %.3f s (%.1f MB/s)\n", options.count, bytes, seconds, (double) bytes / seconds / 1e6);
+
+  return 0;
+}
+
+/*
+
+  --to-columns FILE
+
+  Writes evaluated binary records from stdin (the output of --wire)
+  to a columnar file, as they arrive (see Columns.h). Records that
+  weren't evaluated are left out.
+
+*/
+
+static int toColumnsMode(int argc, char **argv) {
+
+  static WireRecord records[MODES_RECORD_BATCH];
+  size_t count;
+  long long skipped = 0;
+
+  if (argc < 2) {
+    DISPLAY_INVALID_ARGUMENT_ERROR("FILE")
+    return 1;
+  }
+
+  ColumnsWriter *writer = Columns->create(argv[1]);
+
+  if (!writer)
+    return 1;
+
+  while ((count = Wire->read(stdin, records, MODES_RECORD_BATCH)) > 0)
+    for (size_t i = 0; i < count; i++) {
+
+      WireRecord *r = &records[i];
+
+      if (r->status != WIRE_STATUS_OK) {
+        skipped++;
+        continue;
+      }
+
+      Fraction f1 = { r->operand1Numerator, r->operand1Denomenator };
+      Fraction f2 = { r->operand2Numerator, r->operand2Denomenator };
+      Fraction result = { r->resultNumerator, r->resultDenomenator };
+      char operator = (char) r->operator;
+      Equation e = { &f1, &operator, &f2, &result };
+
+      Columns->append(writer, &e);
+    }
+
+  long long rows = Columns->close(writer);
+
+  if (rows < 0)
+    return 1;
+
+  fprintf(stderr, "%lli equations written, %lli records that weren't evaluated left out\n", rows, skipped);
+
+  return 0;
+}
+
+/*
+
+  --read-columns FILE [--columns NAME,NAME...] [--limit N]
+
+  Shows the rows, min, max and size of every column of a
+  columnar file from its index. With --columns, loads only those
+  columns and writes their first N rows (all by default) to
+  stdout as CSV.
+
+*/
+
+static int readColumnsMode(int argc, char **argv) {
+
+  if (argc < 2) {
+    DISPLAY_INVALID_ARGUMENT_ERROR("FILE")
+    return 1;
+  }
+
+  const char *wanted = getOption(argc, argv, "--columns", NULL);
+  long long limit = atoll(getOption(argc, argv, "--limit", "-1"));
+
+  ColumnsReader *reader = Columns->open(argv[1]);
+
+  if (!reader)
+    return 1;
+
+  long long rows = Columns->rows(reader);
+
+  if (!wanted) {
+
+    printf("%lli rows\n", rows);
+
+    for (int c = 0; c < COLUMNS_COUNT; c++) {
+
+      int32_t min, max;
+      long long bytes;
+
+      if (Columns->stats(reader, c, &min, &max, &bytes))
+        printf("  %-20s min %11i  max %11i  %lli bytes (%.2f per row)\n", Columns->name(c), min, max, bytes, (double) bytes / (double) rows);
+    }
+
+    Columns->closeReader(reader);
+
+    return 0;
+  }
+
+  int picked[COLUMNS_COUNT], count = 0;
+  char names[256];
+
+  snprintf(names, sizeof (names), "%s", wanted);
+
+  for (char *name = strtok(names, ","); name; name = strtok(NULL, ",")) {
+
+    if (count == COLUMNS_COUNT || (picked[count] = Columns->column(name)) < 0) {
+      DISPLAY_INVALID_ARGUMENT_ERROR(name)
+      Columns->closeReader(reader);
+      return 1;
+    }
+
+    count++;
+  }
+
+  if (limit < 0 || limit > rows)
+    limit = rows;
+
+  int32_t *values[COLUMNS_COUNT];
+  int ok = 1;
+
+  for (int i = 0; i < count; i++) {
+
+    if (!(values[i] = malloc((size_t) (rows ? rows : 1) * sizeof (int32_t)))) {
+      fprintf(stderr, "FATAL ERROR: UNABLE TO ALLOCATE MEMORY IN HEAP");
+      exit(-1);
+    }
+
+    ok = ok && Columns->load(reader, picked[i], values[i]);
+  }
+
+  if (ok) {
+
+    for (int i = 0; i < count; i++)
+      printf("%s%s", i ? "," : "", Columns->name(picked[i]));
+
+    printf("\n");
+
+    for (long long row = 0; row < limit; row++)
+      for (int i = 0; i < count; i++) {
+
+        if (picked[i] == COLUMNS_OPERATOR)
+          printf("%s%c", i ? "," : "", (char) values[i][row]);
+        else
+          printf("%s%i", i ? "," : "", values[i][row]);
+
+        if (i == count - 1)
+          printf("\n");
+      }
+  }
+
+  for (int i = 0; i < count; i++)
+    free(values[i]);
+
+  Columns->closeReader(reader);
+
+  return !ok;
+}
+
+/*
+
+  Name -> Mode table
+
+*/
+
+static int usageMode(int argc, char **argv);
+
+static const struct {
+  const char *name;
+  mode *run;
+  const char *description;
+}
+modes[] = {
+  { "--wire",         &wireMode,       "evaluate binary equation records from stdin to stdout" },
+  { "--wire-to-text", &wireToTextMode, "convert binary equation records to text" },
+  { "--text-to-wire", &textToWireMode, "convert text equations to binary records" },
+  { "--daemon",       &daemonMode,     "serve expressions over a Unix socket and localhost TCP" },
+  { "--loadtest",     &loadTestMode,   "measure requests/sec and latency of a running daemon" },
+  { "--batch",        &batchMode,      "evaluate files of expressions, one per line" },
+  { "--batch-bench",  &batchBenchMode, "compare the plain and io_uring batch backends" },
+  { "--shm-serve",    &sharedQueueServeMode,  "evaluate records from shared memory queues" },
+  { "--shm-client",   &sharedQueueClientMode, "like --wire, through a running --shm-serve" },
+  { "--shm-bench",    &sharedQueueBenchMode,  "measure round trips to a running --shm-serve" },
+  { "--random",       &randomMode,     "generate random fractions with a fixed seed" },
+  { "--aggregate",    &aggregateMode,  "sum and multiply many random fractions exactly" },
+  { "--sort",         &sortMode,       "sort many random fractions by exact value" },
+  { "--approximate",  &approximateMode, "turn decimal numbers from stdin into fractions" },
+  { "--solve",        &solveMode,      "solve a linear system of fractions exactly" },
+  { "--evaluate",     &evaluateMode,   "evaluate long expressions from stdin exactly" },
+  { "--bench",        &benchMode,      "time the hot paths on fixed data sets, optionally as JSON" },
+  { "--generate",     &generateMode,   "write made up expressions, as text or binary records" },
+  { "--to-columns",   &toColumnsMode,  "write evaluated binary records to a columnar file" },
+  { "--read-columns", &readColumnsMode, "show the columns of a columnar file, or some of them as CSV" },
+  { "--help",         &usageMode,      "show this list" }
+};
+
+/*
+
+  Lists the available modes
+
+*/
+
+static int usageMode(__attribute__((unused)) int argc, __attribute__((unused)) char **argv) {
+
+  fprintf(stderr, "Usage: fractions [mode]\n\nWithout a mode the interactive menu is shown.\n\nModes:\n");
+
+  for (size_t i = 0; i < sizeof (modes) / sizeof (modes[0]); i++)
+    fprintf(stderr, "  %-16s %s\n", modes[i].name, modes[i].description);
+
+  return 1;
+}
+
+/*
+
+  mode *getModeToRun(const char *name);
+
+*/
+
+mode *getModeToRun(const char *name) {
+
+  for (size_t i = 0; i < sizeof (modes) / sizeof (modes[0]); i++)
+    if (!strcmp(modes[i].name, name))
+      return modes[i].run;
+
+  return &usageMode;
+}
@@ -0,0 +1,37 @@
+/*
+
+  Modes
+
+  Besides the interactive menu, the program can be started in a
+  mode that does one job without asking the user anything, by
+  passing the name of the mode as the first argument:
+
+    ./fractions --wire < equations.bin > results.bin
+
+  How it works:
+
+    Same as getFunctionToRun() in Operations.h, main() gives
+    getModeToRun() the name of the mode, and gets back the function
+    that runs it. The function is handed the arguments that follow
+    the name (argv[0] is the name itself), and its return value is
+    the exit code of the program.
+
+*/
+
+#ifndef MODES
+#define MODES
+
+  // Data Type of the function that will be returned
+  typedef int mode(int argc, char **argv);
+
+  /*
+
+    Takes the name of a mode, and returns the function
+    that runs it. Unknown names return a function that
+    lists the available modes.
+
+  */
+
+  mode *getModeToRun(const char *name);
+
+#endif //Modes.h
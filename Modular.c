@@ -0,0 +1,792 @@
+/*
+
+  Modular
+
+  How many primes:
+
+    If a/b (reduced, b > 0) is known modulo M, and |a| and b are
+    both below 2^h with 2^(2h + 1) <= M, no other fraction that
+    small has the same remainder, so it can be recovered. A bound
+    on the bits of every node's numerator and denominator (adding
+    a/b + c/d has at most the bits of ad + cb over bd, and so on)
+    gives how many primes are always enough.
+
+    That bound is usually far too big (it doesn't know about
+    anything cancelling), so the primes are taken in rounds, twice
+    as many each time, and after each round the fraction is
+    reconstructed from all but the last prime, and checked against
+    the last one. Once the bound is reached the result is certain.
+
+  Chinese remainder theorem, one prime p with remainder r at a time:
+
+    x = x + M ((r - x) / M mod p),  M = M p
+
+  Rational reconstruction (Wang): the extended Euclidean algorithm
+  on M and x keeps r(i) = t(i) x (mod M) at every step, and stops at
+  the first r(i) below 2^h. Then a/b = r(i)/t(i), if |t(i)| is also
+  below 2^h.
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "Software.h"
+#include "Operations.h"
+#include "Bignum.h"
+#include "Expression.h"
+#include "Modular.h"
+
+#define DISPLAY_MALLOC_ERROR { fprintf(stderr, "FATAL ERROR: UNABLE TO ALLOCATE MEMORY IN HEAP"); exit(-1); }
+
+/*
+
+  Bits of the remainders Lehmer's steps are worked out from,
+  so that nothing overflows an int64_t
+
+*/
+
+#define MODULAR_LEHMER_BITS 60
+
+/*
+
+  Most threads used
+
+*/
+
+#define MODULAR_MAX_THREADS 64
+
+/*
+
+  Bounds on bits stop growing here, so they can't overflow
+
+*/
+
+#define MODULAR_MAX_BITS (1L << 40)
+
+/*
+
+  One thread's primes of a round
+
+  Type: ModularWorker
+
+*/
+
+typedef struct {
+
+  const Expression *e;
+
+  const uint64_t *primes;
+  uint64_t *residues;
+
+  // Primes first, first + step, ... below last
+  int first;
+  int last;
+  int step;
+
+  // Room for the numerator and denominator of every node
+  uint64_t *values;
+
+  // A divisor was 0 modulo one of the primes
+  int zeroDivisor;
+
+}
+ModularWorker;
+
+/*
+
+  The primes found so far, from the largest down,
+  shared by every evaluation
+
+*/
+
+static uint64_t *primeTable = NULL;
+static int primeCount = 0;
+static pthread_mutex_t primeLock = PTHREAD_MUTEX_INITIALIZER;
+
+static uint64_t powerModulo(uint64_t base, uint64_t exponent, const uint64_t p) {
+
+  uint64_t result = 1;
+
+  while (exponent) {
+
+    if (exponent & 1)
+      result = modularMultiply(result, base, p);
+
+    base = modularMultiply(base, base, p);
+    exponent >>= 1;
+  }
+
+  return result;
+}
+
+static uint64_t montgomeryPower(uint64_t base, uint64_t exponent, const Montgomery *m) {
+
+  uint64_t result = m->one;
+
+  while (exponent) {
+
+    if (exponent & 1)
+      result = montgomeryMultiply(result, base, m);
+
+    base = montgomeryMultiply(base, base, m);
+    exponent >>= 1;
+  }
+
+  return result;
+}
+
+/*
+
+  1 / a modulo p, a not 0 modulo p (extended Euclidean algorithm)
+
+*/
+
+static uint64_t inverseModulo(const uint64_t a, const uint64_t p) {
+
+  int64_t r0 = (int64_t) p, r1 = (int64_t) (a % p);
+  int64_t t0 = 0, t1 = 1;
+
+  while (r1) {
+
+    int64_t q = r0 / r1;
+    int64_t r = r0 - q * r1;
+    int64_t t = t0 - q * t1;
+
+    r0 = r1;
+    r1 = r;
+    t0 = t1;
+    t1 = t;
+  }
+
+  return (uint64_t) (t0 < 0 ? t0 + (int64_t) p : t0);
+}
+
+/*
+
+  Miller-Rabin with the first 12 primes as bases,
+  which is never wrong below 2^64
+
+*/
+
+static int isPrime(const uint64_t n) {
+
+  static const uint64_t bases[] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37 };
+
+  uint64_t d = n - 1;
+  int s = 0;
+
+  while (!(d & 1)) {
+    d >>= 1;
+    s++;
+  }
+
+  for (size_t i = 0; i < sizeof (bases) / sizeof (bases[0]); i++) {
+
+    uint64_t x = powerModulo(bases[i], d, n);
+
+    if (x == 1 || x == n - 1)
+      continue;
+
+    int composite = 1;
+
+    for (int j = 1; j < s && composite; j++) {
+
+      x = modularMultiply(x, x, n);
+
+      if (x == n - 1)
+        composite = 0;
+    }
+
+    if (composite)
+      return 0;
+  }
+
+  return 1;
+}
+
+/*
+
+  Copies primes first to last - 1 into to, finding more if needed
+
+*/
+
+static void getPrimes(uint64_t *to, const int first, const int last) {
+
+  pthread_mutex_lock(&primeLock);
+
+  if (last > primeCount) {
+
+    uint64_t *table = realloc(primeTable, (size_t) last * sizeof (uint64_t));
+
+    if (!table) DISPLAY_MALLOC_ERROR
+
+    primeTable = table;
+
+    uint64_t candidate = primeCount ? primeTable[primeCount - 1] - 2 : (1ULL << 62) - 1;
+
+    for (; primeCount < last; candidate -= 2)
+      if (isPrime(candidate))
+        primeTable[primeCount++] = candidate;
+  }
+
+  for (int i = first; i < last; i++)
+    to[i] = primeTable[i];
+
+  pthread_mutex_unlock(&primeLock);
+}
+
+static uint64_t prime(const int index) {
+
+  uint64_t found[index + 1];
+
+  getPrimes(found, index, index + 1);
+
+  return found[index];
+}
+
+static inline long capped(const long bits) {
+  return bits > MODULAR_MAX_BITS ? MODULAR_MAX_BITS : bits;
+}
+
+static long bitsOf(unsigned int n) {
+  return n ? 32 - __builtin_clz(n) : 0;
+}
+
+/*
+
+  Bits that are always enough for the numerator
+  and the denominator of the result
+
+*/
+
+static long boundBits(const Expression *e) {
+
+  long *numerator = malloc((size_t) e->count * 2 * sizeof (long));
+
+  if (!numerator) DISPLAY_MALLOC_ERROR
+
+  long *denominator = numerator + e->count;
+
+  for (int i = 0; i < e->count; i++) {
+
+    const ExpressionNode *node = &e->nodes[i];
+    long ln = 0, ld = 0, rn = 0, rd = 0;
+
+    if (!EXPRESSION_LEAF(node->kind)) {
+      ln = numerator[node->left];
+      ld = denominator[node->left];
+    }
+
+    if (node->right >= 0) {
+      rn = numerator[node->right];
+      rd = denominator[node->right];
+    }
+
+    switch (node->kind) {
+
+    case EXPRESSION_NUMBER:
+    case EXPRESSION_REFERENCE:
+      numerator[i] = bitsOf(node->value.numerator < 0 ? -(unsigned int) node->value.numerator : (unsigned int) node->value.numerator);
+      denominator[i] = bitsOf((unsigned int) node->value.denomenator);
+      break;
+
+    case OP_ADD:
+    case OP_SUB:
+      numerator[i] = capped((ln + rd > rn + ld ? ln + rd : rn + ld) + 1);
+      denominator[i] = capped(ld + rd);
+      break;
+
+    case OP_MUL:
+      numerator[i] = capped(ln + rn);
+      denominator[i] = capped(ld + rd);
+      break;
+
+    case OP_DIV:
+      numerator[i] = capped(ln + rd);
+      denominator[i] = capped(ld + rn);
+      break;
+
+    case OP_POW: {
+      long exponent = node->exponent < 0 ? -(long) node->exponent : node->exponent;
+      numerator[i] = capped((node->exponent < 0 ? ld : ln) * exponent);
+      denominator[i] = capped((node->exponent < 0 ? ln : ld) * exponent);
+      break;
+    }
+    }
+  }
+
+  long bits = numerator[e->count - 1] > denominator[e->count - 1] ? numerator[e->count - 1] : denominator[e->count - 1];
+
+  free(numerator);
+
+  return bits;
+}
+
+/*
+
+  The value of e modulo p, into result.
+  Returns 0 if a divisor is 0 modulo p.
+
+  Every node is kept as a numerator and a denominator modulo p,
+  never divided, so there is one inverse at the end instead of
+  one per division. Denominators are products of numbers that
+  aren't 0 modulo p, so they never are either. Both are in
+  Montgomery form until the end.
+
+*/
+
+static int residueOf(const Expression *e, const uint64_t p, uint64_t *values, uint64_t *result) {
+
+  const Montgomery m = montgomeryFor(p);
+
+  uint64_t *numerators = values;
+  uint64_t *denominators = values + e->count;
+
+  for (int i = 0; i < e->count; i++) {
+
+    const ExpressionNode *node = &e->nodes[i];
+    uint64_t ln = 0, ld = m.one, rn = 0, rd = m.one;
+
+    if (!EXPRESSION_LEAF(node->kind)) {
+      ln = numerators[node->left];
+      ld = denominators[node->left];
+    }
+
+    if (node->right >= 0) {
+      rn = numerators[node->right];
+      rd = denominators[node->right];
+    }
+
+    switch (node->kind) {
+
+    case EXPRESSION_NUMBER:
+    case EXPRESSION_REFERENCE: {
+
+      // Ints are far below p
+      int64_t numerator = node->value.numerator;
+
+      uint64_t n = numerator < 0 ? p - (uint64_t) -numerator : (uint64_t) numerator;
+
+      numerators[i] = montgomeryMultiply(n, m.square, &m);
+      denominators[i] = montgomeryMultiply((uint64_t) node->value.denomenator, m.square, &m);
+      break;
+    }
+
+    case OP_ADD:
+    case OP_SUB: {
+
+      uint64_t a = montgomeryMultiply(ln, rd, &m);
+      uint64_t b = montgomeryMultiply(rn, ld, &m);
+
+      if (node->kind == OP_ADD)
+        numerators[i] = a + b >= p ? a + b - p : a + b;
+      else
+        numerators[i] = a >= b ? a - b : a + p - b;
+
+      denominators[i] = montgomeryMultiply(ld, rd, &m);
+      break;
+    }
+
+    case OP_MUL:
+      numerators[i] = montgomeryMultiply(ln, rn, &m);
+      denominators[i] = montgomeryMultiply(ld, rd, &m);
+      break;
+
+    case OP_DIV:
+
+      if (!rn)
+        return 0;
+
+      numerators[i] = montgomeryMultiply(ln, rd, &m);
+      denominators[i] = montgomeryMultiply(ld, rn, &m);
+      break;
+
+    case OP_POW: {
+
+      uint64_t exponent = node->exponent < 0 ? -(uint64_t) node->exponent : (uint64_t) node->exponent;
+
+      if (node->exponent < 0 && !ln)
+        return 0;
+
+      numerators[i] = montgomeryPower(node->exponent < 0 ? ld : ln, exponent, &m);
+      denominators[i] = montgomeryPower(node->exponent < 0 ? ln : ld, exponent, &m);
+      break;
+    }
+    }
+  }
+
+  // Out of Montgomery form
+  uint64_t numerator = montgomeryMultiply(numerators[e->count - 1], 1, &m);
+  uint64_t denominator = montgomeryMultiply(denominators[e->count - 1], 1, &m);
+
+  *result = modularMultiply(numerator, inverseModulo(denominator, p), p);
+
+  return 1;
+}
+
+static void *residues(void *argument) {
+
+  ModularWorker *w = argument;
+
+  for (int i = w->first; i < w->last && !w->zeroDivisor; i += w->step)
+    if (!residueOf(w->e, w->primes[i], w->values, &w->residues[i]))
+      w->zeroDivisor = 1;
+
+  return NULL;
+}
+
+/*
+
+  a modulo p, from 0 to p - 1
+
+*/
+
+static uint64_t bignumModulo(const Bignum *a, const uint64_t p) {
+
+  uint64_t rest = 0;
+
+  // From the top limb down, nothing to allocate
+  for (int i = a->length - 1; i >= 0; i--)
+    rest = (uint64_t) ((((unsigned __int128) rest << 32) | a->limbs[i]) % p);
+
+  return a->negative && rest ? p - rest : rest;
+}
+
+static long bitLength(const Bignum *a) {
+  return a->length ? 32L * (a->length - 1) + 32 - __builtin_clz(a->limbs[a->length - 1]) : 0;
+}
+
+/*
+
+  Adds remainder r modulo p to x modulo M
+
+*/
+
+static void combine(Bignum *x, Bignum *M, const uint64_t r, const uint64_t p) {
+
+  Bignum t = BIGNUM_ZERO;
+
+  uint64_t xp = bignumModulo(x, p);
+  uint64_t difference = r >= xp ? r - xp : r + p - xp;
+
+  Bignums->fromInt(&t, (int64_t) modularMultiply(difference, inverseModulo(bignumModulo(M, p), p), p));
+  Bignums->multiply(&t, &t, M);
+  Bignums->add(x, x, &t);
+
+  Bignums->fromInt(&t, (int64_t) p);
+  Bignums->multiply(M, M, &t);
+
+  Bignums->free(&t);
+}
+
+/*
+
+  (|a| >> shift), the low 64 bits of it
+
+*/
+
+static uint64_t bitsFrom(const Bignum *a, const long shift) {
+
+  long limb = shift / 32;
+  unsigned __int128 window = 0;
+
+  for (int i = 0; i < 3; i++)
+    if (limb + i < a->length)
+      window |= (unsigned __int128) a->limbs[limb + i] << (32 * i);
+
+  return (uint64_t) (window >> (shift % 32));
+}
+
+/*
+
+  x, y = A x + B y, C x + D y
+
+*/
+
+static void transform(Bignum *x, Bignum *y, const int64_t A, const int64_t B, const int64_t C, const int64_t D) {
+
+  Bignum factor = BIGNUM_ZERO, a = BIGNUM_ZERO, b = BIGNUM_ZERO, newX = BIGNUM_ZERO;
+
+  Bignums->fromInt(&factor, A);
+  Bignums->multiply(&a, &factor, x);
+  Bignums->fromInt(&factor, B);
+  Bignums->multiply(&b, &factor, y);
+  Bignums->add(&newX, &a, &b);
+
+  Bignums->fromInt(&factor, C);
+  Bignums->multiply(&a, &factor, x);
+  Bignums->fromInt(&factor, D);
+  Bignums->multiply(&b, &factor, y);
+  Bignums->add(y, &a, &b);
+
+  Bignums->free(x);
+  *x = newX;
+
+  Bignums->free(&factor);
+  Bignums->free(&a);
+  Bignums->free(&b);
+}
+
+/*
+
+  The fraction n/d with |n|, d below 2^h that is x modulo M,
+  2^(2h + 1) <= M. Returns 0 if there isn't one.
+
+  Far from the end, the steps are found from the top
+  MODULAR_LEHMER_BITS bits of the remainders alone, several
+  at a time, and applied to the Bignums at once (Lehmer, as in
+  Knuth, TAOCP vol. 2, 4.5.2, algorithm L). The steps are the
+  same, so it stops at the same place.
+
+*/
+
+static int reconstruct(const Bignum *x, const Bignum *M, Bignum *n, Bignum *d) {
+
+  long h = (bitLength(M) - 2) / 2;
+
+  Bignum r0 = BIGNUM_ZERO, r1 = BIGNUM_ZERO, t0 = BIGNUM_ZERO, t1 = BIGNUM_ZERO;
+  Bignum q = BIGNUM_ZERO, t = BIGNUM_ZERO;
+
+  Bignums->copy(&r0, M);
+  Bignums->copy(&r1, x);
+  Bignums->fromInt(&t1, 1);
+
+  while (bitLength(&r1) > h) {
+
+    long shift = bitLength(&r0) - MODULAR_LEHMER_BITS;
+
+    if (shift > h + 1) {
+
+      int64_t a = (int64_t) bitsFrom(&r0, shift), b = (int64_t) bitsFrom(&r1, shift);
+      int64_t A = 1, B = 0, C = 0, D = 1;
+
+      // Only while the quotient is the same for both ends of what a and b can be
+      while (b + C > 0 && b + D > 0 && a + A >= 0 && a + B >= 0) {
+
+        int64_t quotient = (a + A) / (b + C);
+
+        if (quotient != (a + B) / (b + D))
+          break;
+
+        int64_t T = A - quotient * C;
+        A = C;
+        C = T;
+
+        T = B - quotient * D;
+        B = D;
+        D = T;
+
+        T = a - quotient * b;
+        a = b;
+        b = T;
+      }
+
+      if (B) {
+
+        // Both are worked out before either is kept
+        Bignums->copy(&q, &r0);
+        Bignums->copy(&t, &r1);
+        transform(&q, &t, A, B, C, D);
+
+        // Gone past the end, one step at a time from here
+        if (bitLength(&q) > h) {
+
+          Bignum swap = r0;
+          r0 = q;
+          q = swap;
+
+          swap = r1;
+          r1 = t;
+          t = swap;
+
+          transform(&t0, &t1, A, B, C, D);
+          continue;
+        }
+      }
+    }
+
+    Bignums->divide(&q, &t, &r0, &r1);
+
+    Bignums->free(&r0);
+    r0 = r1;
+    r1 = t;
+    t = (Bignum) BIGNUM_ZERO;
+
+    // t0 - q t1
+    Bignums->multiply(&q, &q, &t1);
+    Bignums->subtract(&t, &t0, &q);
+
+    Bignums->free(&t0);
+    t0 = t1;
+    t1 = t;
+    t = (Bignum) BIGNUM_ZERO;
+  }
+
+  int found = t1.length && bitLength(&t1) <= h;
+
+  if (found) {
+
+    Bignums->copy(n, &r1);
+    Bignums->copy(d, &t1);
+
+    // The sign goes on the numerator
+    if (d->negative) {
+      d->negative = 0;
+      n->negative = n->length ? !n->negative : 0;
+    }
+  }
+
+  Bignums->free(&r0);
+  Bignums->free(&r1);
+  Bignums->free(&t0);
+  Bignums->free(&t1);
+  Bignums->free(&q);
+  Bignums->free(&t);
+
+  return found;
+}
+
+/*
+
+  Is n/d r modulo p?
+
+*/
+
+static int check(const Bignum *n, const Bignum *d, const uint64_t r, const uint64_t p) {
+
+  uint64_t dp = bignumModulo(d, p);
+
+  return dp && modularMultiply(bignumModulo(n, p), inverseModulo(dp, p), p) == r;
+}
+
+static int evaluate(const Expression *restrict e, BigFraction *restrict result, int *restrict primesUsed) {
+
+  if (primesUsed)
+    *primesUsed = 0;
+
+  if (!e->count)
+    return EXPRESSION_OK;
+
+  // Always enough, with one more to check
+  long bits = boundBits(e);
+  long needed = (2 * bits + 1) / MODULAR_PRIME_BITS + 1;
+
+  if (needed > INT32_MAX / 4)
+    needed = INT32_MAX / 4;
+
+  int threads = Software->Threads();
+
+  if (threads > MODULAR_MAX_THREADS)
+    threads = MODULAR_MAX_THREADS;
+
+  ModularWorker workers[MODULAR_MAX_THREADS];
+
+  for (int t = 0; t < threads; t++) {
+
+    workers[t] = (ModularWorker) { e, NULL, NULL, 0, 0, 0, malloc((size_t) e->count * 2 * sizeof (uint64_t)), 0 };
+
+    if (!workers[t].values) DISPLAY_MALLOC_ERROR
+  }
+
+  uint64_t *primes = NULL, *remainders = NULL;
+  int have = 0, combined = 0, found = 0, zeroDivisor = 0;
+
+  Bignum x = BIGNUM_ZERO, M = BIGNUM_ZERO, n = BIGNUM_ZERO, d = BIGNUM_ZERO;
+
+  Bignums->fromInt(&M, 1);
+
+  while (!found && !zeroDivisor && combined < needed) {
+
+    int target = have ? 2 * have : (threads > 1 ? threads : 2);
+
+    if (target > needed + 1)
+      target = (int) needed + 1;
+
+    primes = realloc(primes, (size_t) target * sizeof (uint64_t));
+    remainders = realloc(remainders, (size_t) target * sizeof (uint64_t));
+
+    if (!primes || !remainders) DISPLAY_MALLOC_ERROR
+
+    getPrimes(primes, have, target);
+
+    // Every thread takes every threads-th prime of the round
+    int used = threads < target - have ? threads : target - have;
+
+    for (int t = 0; t < used; t++) {
+      workers[t].primes = primes;
+      workers[t].residues = remainders;
+      workers[t].first = have + t;
+      workers[t].last = target;
+      workers[t].step = used;
+    }
+
+    Software->RunWorkers(&residues, workers, sizeof *workers, used);
+
+    for (int t = 0; t < used; t++)
+      zeroDivisor |= workers[t].zeroDivisor;
+
+    have = target;
+
+    if (zeroDivisor)
+      break;
+
+    // All but the last, which checks the result
+    for (; combined < have - 1; combined++)
+      combine(&x, &M, remainders[combined], primes[combined]);
+
+    found = reconstruct(&x, &M, &n, &d) && check(&n, &d, remainders[have - 1], primes[have - 1]);
+  }
+
+  int status;
+
+  if (found) {
+
+    Bignum common = BIGNUM_ZERO;
+
+    Bignums->gcd(&common, &n, &d);
+    Bignums->divideExact(&result->numerator, &n, &common);
+    Bignums->divideExact(&result->denominator, &d, &common);
+    Bignums->free(&common);
+
+    status = EXPRESSION_OK;
+
+    if (primesUsed)
+      *primesUsed = have;
+  }
+  else
+    // Division by 0, or unlucky, the direct way tells which
+    status = Expressions->evaluate(e, result);
+
+  for (int t = 0; t < threads; t++)
+    free(workers[t].values);
+
+  free(primes);
+  free(remainders);
+
+  Bignums->free(&x);
+  Bignums->free(&M);
+  Bignums->free(&n);
+  Bignums->free(&d);
+
+  return status;
+}
+
+/*
+
+  Abstraction, same as in Software.c
+
+*/
+
+const static modularMath ModularFunctions = {
+  &evaluate,
+  &prime,
+  &bignumModulo,
+  &inverseModulo,
+  &combine,
+  &reconstruct
+};
+
+const modularMath *restrict Modular = &ModularFunctions;
@@ -0,0 +1,195 @@
+/*
+
+  Modular
+
+  Evaluates an Expression without big numbers in the middle:
+
+    1. the expression is worked out modulo many primes just
+       below 2^62, every one on its own (one prime at a time per
+       thread), where every step is a 64 bit operation
+    2. the remainders are put together with the Chinese remainder
+       theorem, into the value modulo the product of the primes
+    3. the fraction is recovered from that with rational
+       reconstruction (the extended Euclidean algorithm)
+    4. it is checked against one more prime that wasn't used
+
+  The cost grows with the size of the result, not with the size
+  of the numbers along the way, so it is an alternative to
+  Expressions->evaluate() for long expressions.
+
+  The primes, the arithmetic modulo them, the Chinese remainder
+  theorem and rational reconstruction are here too, for other
+  exact work done the same way (like Matrices->solve()).
+
+*/
+
+#ifndef MODULAR
+#define MODULAR
+
+#include <stdint.h>
+
+#include "Bignum.h"
+#include "Expression.h"
+
+/*
+
+  Every prime is above 2^MODULAR_PRIME_BITS, and below 2^62
+
+*/
+
+#define MODULAR_PRIME_BITS 61
+
+static inline uint64_t modularMultiply(const uint64_t a, const uint64_t b, const uint64_t p) {
+  return (uint64_t) ((unsigned __int128) a * b % p);
+}
+
+/*
+
+  Montgomery form modulo p: x is kept as x 2^64 modulo p, then
+  multiplying needs no division, only multiplying by -1/p modulo
+  2^64 and a shift. p is below 2^62, so nothing overflows.
+
+  Type: Montgomery
+
+*/
+
+typedef struct {
+
+  uint64_t p;
+
+  // -1/p modulo 2^64
+  uint64_t negativeInverse;
+
+  // 2^128 and 2^64 modulo p (1 in Montgomery form)
+  uint64_t square;
+  uint64_t one;
+
+}
+Montgomery;
+
+static inline Montgomery montgomeryFor(const uint64_t p) {
+
+  // Newton's method, every step doubles the bits that are right (3 to start)
+  uint64_t inverse = p;
+
+  for (int i = 0; i < 5; i++)
+    inverse *= 2 - p * inverse;
+
+  uint64_t one = (uint64_t) (((unsigned __int128) 1 << 64) % p);
+
+  return (Montgomery) { p, -inverse, modularMultiply(one, one, p), one };
+}
+
+/*
+
+  a b / 2^64 modulo p: the product in Montgomery form of two in
+  Montgomery form, or a b itself if only one of them is
+
+*/
+
+static inline uint64_t montgomeryMultiply(const uint64_t a, const uint64_t b, const Montgomery *m) {
+
+  unsigned __int128 t = (unsigned __int128) a * b;
+  uint64_t q = (uint64_t) t * m->negativeInverse;
+  uint64_t u = (uint64_t) ((t + (unsigned __int128) q * m->p) >> 64);
+
+  return u >= m->p ? u - m->p : u;
+}
+
+typedef struct {
+
+  /*
+
+    int evaluate(Expression *e, BigFraction *result, int *primes)
+
+    Same as Expressions->evaluate(), same result. primes, if it
+    isn't NULL, is set to how many primes were used, 0 if it
+    fell back to Expressions->evaluate() (a division by 0, or
+    an unlucky prime dividing a divisor).
+
+    Access: Modular->evaluate()
+
+  */
+
+  int(*const evaluate)(const Expression * restrict e, BigFraction * restrict result, int * restrict primes);
+
+  /*
+
+    uint64_t prime(int index)
+
+    Prime index, counted from 0, from the largest below 2^62
+    down, the same ones every time.
+
+    Access: Modular->prime()
+
+  */
+
+  uint64_t(*const prime)(const int index);
+
+  /*
+
+    uint64_t remainder(Bignum *a, uint64_t p)
+
+    a modulo p, from 0 to p - 1, p below 2^63.
+
+    Access: Modular->remainder()
+
+  */
+
+  uint64_t(*const remainder)(const Bignum * restrict a, const uint64_t p);
+
+  /*
+
+    uint64_t inverse(uint64_t a, uint64_t p)
+
+    1 / a modulo p, a not 0 modulo p.
+
+    Access: Modular->inverse()
+
+  */
+
+  uint64_t(*const inverse)(const uint64_t a, const uint64_t p);
+
+  /*
+
+    void combine(Bignum *x, Bignum *M, uint64_t r, uint64_t p)
+
+    Chinese remainder theorem: x modulo M (start with 0 and 1)
+    becomes the number modulo M p that is also r modulo p.
+
+    Access: Modular->combine()
+
+  */
+
+  void(*const combine)(Bignum * restrict x, Bignum * restrict M, const uint64_t r, const uint64_t p);
+
+  /*
+
+    int reconstruct(Bignum *x, Bignum *M, Bignum *n, Bignum *d)
+
+    Rational reconstruction: sets n/d, d above 0, to the fraction
+    that is x modulo M, with |n| and d below 2^h, where h is the
+    largest with 2^(2h + 1) <= M. There is at most one.
+
+    Returns 0 (n and d unchanged) if there isn't one, else 1.
+
+    Access: Modular->reconstruct()
+
+  */
+
+  int(*const reconstruct)(const Bignum * restrict x, const Bignum * restrict M, Bignum * restrict n, Bignum * restrict d);
+
+}
+modularMath;
+
+/*
+
+  Call this, Modular, to access all
+  the publicly available functions.
+
+*/
+
+extern
+const modularMath * restrict Modular;
+
+#endif //Modular.h
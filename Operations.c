@@ -23,9 +23,24 @@
 // Libraries
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include "IO.h"
 #include "Software.h"
 #include "Operations.h"
+#include "Wire.h"
+#include "Random.h"
+#include "Bignum.h"
+#include "Aggregate.h"
+#include "Sort.h"
+#include "Approximate.h"
+#include "Decimal.h"
+#include "Expression.h"
+#include "Formula.h"
+#include "Tables.h"
+#include "Stats.h"
+#include "Trace.h"
+#include "Columns.h"
+#include "Snapshot.h"
 
 /*
 
@@ -35,6 +50,16 @@
 
 #define DISPLAY_FRACTION_LIMIT_REACHED_ERROR printf("Fractions Limit Reached\n");
 #define DISPLAY_INVALID_OPTION_ERROR printf("No working case. Retry.\n");
+#define DISPLAY_CANNOT_EVALUATE_ERROR printf("Cannot evaluate: division by zero, a power that is not whole, or a result that is too large.\n");
+#define DISPLAY_INVALID_FORMULA_ERROR printf("Invalid formula, or it uses a fraction that is not stored.\n");
+
+/*
+
+  Longest decimal shown next to a fraction
+
+*/
+
+#define DISPLAY_DECIMAL_LENGTH 128
 
 /*
 
@@ -56,6 +81,17 @@ function ();
 */
 
 void CreateRandomFraction();
+void CreateManyRandomFractions();
+void SumAllFractions();
+void MultiplyAllFractions();
+void SortFractions();
+void ApproximateDecimal();
+void StoreFormula();
+void UpdateFraction();
+void DisplayFormulas();
+void DisplayStats();
+void ExportEquations();
+void SnapshotStores();
 void GetFractionFromUser();
 void DisplayFractions();
 void EvaluateFractions();
@@ -115,6 +151,50 @@ function* getFunctionToRun(int Choice) {
   case 256:
     return &ClearConsole;
 
+    // If users wants many random fractions at once
+  case OP_GENERATE_MANY_RANDOM_FRACTIONS:
+    return &CreateManyRandomFractions;
+
+    // If users wants every stored fraction added up
+  case OP_SUM_ALL_FRACTIONS:
+    return &SumAllFractions;
+
+    // If users wants every stored fraction multiplied together
+  case OP_PRODUCT_ALL_FRACTIONS:
+    return &MultiplyAllFractions;
+
+    // If users wants the stored fractions in order
+  case OP_SORT_FRACTIONS:
+    return &SortFractions;
+
+    // If users wants a decimal number stored as a fraction
+  case OP_APPROXIMATE_DECIMAL:
+    return &ApproximateDecimal;
+
+    // If users wants an expression of stored fractions kept up to date
+  case OP_STORE_FORMULA:
+    return &StoreFormula;
+
+    // If users wants to change a stored fraction
+  case OP_UPDATE_FRACTION:
+    return &UpdateFraction;
+
+    // If users wants the formulas with their current results
+  case OP_DISPLAY_FORMULAS:
+    return &DisplayFormulas;
+
+    // If users wants to see what the program has been doing
+  case OP_DISPLAY_STATS:
+    return &DisplayStats;
+
+    // If users wants the equations in a file for other tools
+  case OP_EXPORT_EQUATIONS:
+    return &ExportEquations;
+
+    // If users wants the stores saved, without waiting for it
+  case OP_SNAPSHOT_STORES:
+    return &SnapshotStores;
+
     // If users gives us an invalid input.
   default:
     return &invalidCase;
@@ -127,13 +207,14 @@ function* getFunctionToRun(int Choice) {
 
     Helper functions which will be eventually used.
 
-    static functions because we are abstracting these.
+    static functions because we are abstracting these, except
+    getGCD() and simplifyFractions(), which Bench.c times.
 
 */
 
 /*
 
-  static int getGCD(int numRe, int denRe)
+  int getGCD(int numRe, int denRe)
 
   GCD is an acronym for Greatest Common Factor
 
@@ -143,7 +224,7 @@ function* getFunctionToRun(int Choice) {
 
 */
 
-static int getGCD(int numRe, int denRe) {
+int getGCD(int numRe, int denRe) {
 
   if (numRe == 0) return denRe;
 
@@ -163,7 +244,33 @@ static int getGCD(int numRe, int denRe) {
 
 */
 
-static void simplifyFractions(int *numerator, int *denominator) {
+void simplifyFractions(int *numerator, int *denominator) {
+
+  /*
+
+    Inside the limits in IO.h, the GCD and both divisions come out
+    of Tables.h instead: a lookup, two multiplications and shifts,
+    and the signs put back without a branch.
+
+  */
+
+  int numeratorSign = *numerator >> 31, denominatorSign = *denominator >> 31;
+
+  unsigned int n = ((unsigned int) *numerator ^ (unsigned int) numeratorSign) - (unsigned int) numeratorSign;
+  unsigned int d = ((unsigned int) *denominator ^ (unsigned int) denominatorSign) - (unsigned int) denominatorSign;
+
+  if (n <= TABLES_NUMERATORS && d <= TABLES_DENOMINATORS) {
+
+    uint32_t reciprocal = TablesReciprocal[TablesGCD[n][d]];
+
+    // The sign of the whole fraction goes on the numerator
+    int sign = numeratorSign ^ denominatorSign;
+
+    *numerator = ((int) ((n * reciprocal) >> TABLES_RECIPROCAL_SHIFT) ^ sign) - sign;
+    *denominator = (int) ((d * reciprocal) >> TABLES_RECIPROCAL_SHIFT);
+
+    return;
+  }
 
   int GCD = getGCD(*numerator, *denominator);
 
@@ -231,43 +338,18 @@ void CreateRandomFraction() {
 
     /*
     
-      Setting a random seed, so that everytime 
-      this function is called, it generates numbers 
-      randomly, since the seed is being changed evertime.
+      Generating random numerator and Denomerator,
+      with its sign already decided (its boring to
+      have only positive fractions).
 
-      If you didn't understand what this does,
-      then read it hear:
-      https://www.geeksforgeeks.org/rand-and-srand-in-ccpp/
+      Random.h draws them from a generator that can be
+      seeded (FRACTIONS_SEED), so runs can be repeated.
     
     */
 
-    srand((unsigned int) rand());
-
-    /*
-    
-      Generating random numerator and Denomerator
-    
-    */
-
-   int num,den = 0;
-
-    // Generator Numerator
-    num = rand() % IO_MAX_NUMERATOR;
-
-    // Generate Denominator
-    //While loop checks if denominator is zero and if so regenerate until you get a valid one
-    while (!den)
-      den = rand() % IO_MAX_DENOMINATOR;
-
-    /* 
+    Fraction *f = Fractions->new();
 
-      Its boring to have only positive fractions,
-      so we flip coin to decide wether to make it negetive
-      or positive.
-    
-    */
-    if (rand() % 2)
-      num = -num;
+    Random->fraction(f);
 
     /*
   
@@ -275,10 +357,6 @@ void CreateRandomFraction() {
   
     */
 
-    Fraction *f = Fractions->new();
-    f->numerator = num;
-    f->denomenator = den;
-
     Fractions->Store(f);
 
   }
@@ -294,6 +372,305 @@ void CreateRandomFraction() {
 
 }
 
+/*
+
+  Option 7
+
+  Create Many Random Fractions
+
+  Unlike option 1, this goes past IO_MAX_FRACTIONS,
+  the data base grows to hold them.
+
+*/
+
+void CreateManyRandomFractions() {
+
+  int count = 0;
+
+  printf("How many random fractions? ");
+
+  if (scanf("%i", &count) != 1 || count <= 0) {
+    DISPLAY_INVALID_OPTION_ERROR
+    return;
+  }
+
+  Random->store(count);
+
+  printf("Stored %i random fractions\n", count);
+}
+
+/*
+
+  Options 8 and 9
+
+  Sum / Multiply All Fractions
+
+  The result can be much bigger than an int, so it is
+  worked out with Bignums (see Aggregate.h) and printed,
+  not stored.
+
+*/
+
+static void displayAggregate(const char *name, void(*aggregate)(BigFraction *result)) {
+
+  BigFraction result;
+
+  Bignums->fractionInit(&result);
+
+  aggregate(&result);
+
+  char *text = Bignums->fractionToText(&result);
+
+  printf("%s of %i fractions: %s\n", name, Fractions->count(), text);
+
+  free(text);
+  Bignums->fractionFree(&result);
+}
+
+void SumAllFractions() {
+  displayAggregate("Sum", Aggregate->sum);
+}
+
+void MultiplyAllFractions() {
+  displayAggregate("Product", Aggregate->product);
+}
+
+/*
+
+  Option 10
+
+  Sort Fractions
+
+  Puts the stored fractions in order, smallest first
+  (see Sort.h), option 3 shows them in that order.
+
+*/
+
+void SortFractions() {
+
+  Sort->store();
+
+  printf("Sorted %i fractions\n", Fractions->count());
+}
+
+/*
+
+  Option 11
+
+  Approximate Decimal
+
+  Stores the fraction nearest to a decimal number that
+  has a denominator below IO_MAX_DENOMINATOR (see Approximate.h).
+
+*/
+
+void ApproximateDecimal() {
+
+  if (!Fractions->canStore()) {
+    DISPLAY_FRACTION_LIMIT_REACHED_ERROR
+    return;
+  }
+
+  double value;
+  Fraction approximation;
+
+  printf("Enter a decimal number: ");
+
+  if (
+    scanf("%lf", &value) != 1 ||
+    !Approximate->closest(value, IO_MAX_DENOMINATOR - 1, &approximation) ||
+    !ValidateFraction(approximation.numerator, approximation.denomenator)) {
+    DISPLAY_INVALID_OPTION_ERROR
+    return;
+  }
+
+  Fraction *fraction = Fractions->new();
+
+  *fraction = approximation;
+
+  Fractions->Store(fraction);
+
+  printf("%g is about %i/%i\n", value, fraction->numerator, fraction->denomenator);
+}
+
+/*
+
+  Option 12
+
+  Store Formula
+
+  Like option 4, but #n stands for fraction n itself, not
+  a copy of it, so the result follows it (see Formula.h).
+
+*/
+
+void StoreFormula() {
+
+  char text[MAX_INPUT];
+
+  printf("Please enter a formula (#n is fraction n) : ");
+
+  if (scanf(" %98[^\n]", text) != 1) {
+    DISPLAY_INVALID_OPTION_ERROR
+    return;
+  }
+
+  int formula = Formulas->add(text);
+
+  if (formula == FORMULA_INVALID) {
+    DISPLAY_INVALID_FORMULA_ERROR
+    return;
+  }
+
+  printf("Stored formula %i\n", formula + 1);
+}
+
+/*
+
+  Option 13
+
+  Update Fraction
+
+  Only the formulas that use the fraction are marked to be
+  worked out again, the next time they are displayed.
+
+*/
+
+void UpdateFraction() {
+
+  int index;
+  Fraction value;
+
+  printf("Which fraction? ");
+
+  if (scanf("%i", &index) != 1 || index < 1 || index > Fractions->count()) {
+    DISPLAY_INVALID_OPTION_ERROR
+    return;
+  }
+
+  getUserFraction(&value);
+
+  Formulas->update(index - 1, value);
+
+  printf("Fraction %i is now %i/%i\n", index, value.numerator, value.denomenator);
+}
+
+/*
+
+  Option 14
+
+  Display Formulas
+
+*/
+
+void DisplayFormulas() {
+
+  long before = Formulas->recomputed();
+
+  BigFraction value;
+
+  Bignums->fractionInit(&value);
+
+  for (int i = 0; i < Formulas->count(); i++) {
+
+    printf("Formula %i: %s = ", i + 1, Formulas->text(i));
+
+    if (Formulas->result(i, &value) == EXPRESSION_OK) {
+      char *text = Bignums->fractionToText(&value);
+      printf("%s\n", text);
+      free(text);
+    }
+    else
+      printf("division by zero\n");
+  }
+
+  Bignums->fractionFree(&value);
+
+  printf("Recomputed %li of %i formulas\n", Formulas->recomputed() - before, Formulas->count());
+}
+
+/*
+
+  Option 15
+
+  Display Stats
+
+  Counters and latencies so far, the same as
+  kill -USR1 writes to stderr (see Stats.h),
+  and the memory the equation history takes.
+
+*/
+
+void DisplayStats() {
+
+  Stats->show(stdout);
+
+  int count = Equations->count();
+  long long bytes = Equations->bytes();
+
+  printf("Equation history: %i equations in %lli bytes (%.1f each)\n", count, bytes, count ? (double) bytes / count : 0.0);
+}
+
+/*
+
+  Option 16
+
+  Export Equations
+
+  Every stored equation to a columnar file (see Columns.h).
+
+*/
+
+void ExportEquations() {
+
+  char path[MAX_INPUT];
+
+  printf("File to export to: ");
+
+  if (scanf(" %98[^\n]", path) != 1) {
+    DISPLAY_INVALID_OPTION_ERROR
+    return;
+  }
+
+  long long rows = Columns->export(path);
+
+  if (rows >= 0)
+    printf("Exported %lli equations to %s\n", rows, path);
+}
+
+/*
+
+  Option 17
+
+  Snapshot Stores
+
+  Fractions and equations to a file, written by a forked
+  child while the menu goes on (see Snapshot.h).
+
+*/
+
+void SnapshotStores() {
+
+  char path[MAX_INPUT];
+
+  if (Snapshot->running()) {
+    printf("A snapshot is still being written.\n");
+    return;
+  }
+
+  printf("File to snapshot to: ");
+
+  if (scanf(" %98[^\n]", path) != 1) {
+    DISPLAY_INVALID_OPTION_ERROR
+    return;
+  }
+
+  int pid = Snapshot->save(path);
+
+  if (pid > 0)
+    printf("Snapshot of %i fractions and %i equations started in process %i\n", Fractions->count(), Equations->count(), pid);
+}
+
 /*
 
   Option 2
@@ -381,7 +758,20 @@ static void displayFraction(int index, Fraction *f) {
   
   */
 
-  printf("Fraction %i: %i/%i = %i/%i\n", index + 1, f->numerator, f->denomenator, simplifiednum, simplifiedden);
+  printf("Fraction %i: %i/%i = %i/%i", index + 1, f->numerator, f->denomenator, simplifiednum, simplifiedden);
+
+  /*
+
+    And as a decimal, if it's short enough to read, like 0.1(6)
+
+  */
+
+  char decimal[DISPLAY_DECIMAL_LENGTH];
+
+  if (Decimal->toText(simplifiednum, simplifiedden, decimal, sizeof (decimal)))
+    printf(" = %s", decimal);
+
+  printf("\n");
 
 }
 
@@ -435,6 +825,8 @@ void EvaluateFractions() {
 
   */
   
+  TRACE_SAMPLE_BEGIN
+
   Equation *expression = Equations->new();
 
 
@@ -447,15 +839,26 @@ void EvaluateFractions() {
 
   */
 
+  TRACE_STAGE(stage)
+
   GetExpression(expression);
 
+  TRACE_NEXT(stage, "expression", "read")
+
   /*
 
     Calculate result
 
   */
 
-  Operation(expression);
+  if (!Operation(expression)) {
+    DISPLAY_CANNOT_EVALUATE_ERROR
+    Equations->discard(expression);
+    TRACE_SAMPLE_END
+    return;
+  }
+
+  TRACE_END(stage, "expression", "operation")
 
   /*
       
@@ -467,6 +870,96 @@ void EvaluateFractions() {
 
   Equations->Store(expression);
 
+  TRACE_SAMPLE_END
+}
+
+/*
+
+  static int power(int base, int exponent, int *result)
+
+  Exponentiation by squaring, base^exponent for exponent >= 0,
+  in O(log exponent) multiplications instead of exponent of them.
+
+  Returns 0 if the result doesn't fit in an int.
+
+*/
+
+static int power(int base, int exponent, int *result) {
+
+  int value = 1;
+
+  while (exponent) {
+
+    if (exponent & 1)
+      if (__builtin_mul_overflow(value, base, &value))
+        return 0;
+
+    exponent >>= 1;
+
+    // Only square if it's needed again, so it can't overflow for nothing
+    if (exponent && __builtin_mul_overflow(base, base, &base))
+      return 0;
+  }
+
+  *result = value;
+
+  return 1;
+}
+
+/*
+
+  static int powerFraction(Fraction *base, Fraction *exponent, int *rn, int *rd)
+
+  (a/b)^(c/d), where c/d has to be a whole number k.
+
+  The base is reduced once, and then a^k and b^k are worked out
+  separately. No GCD is needed after that, a and b have no common
+  factor, so neither do their powers. A negative k flips the fraction.
+
+  Returns 0 if k isn't whole, the base is 0 and k negative,
+  or k or the result doesn't fit in an int.
+
+*/
+
+static int powerFraction(Fraction *base, Fraction *exponent, int *rn, int *rd) {
+
+  // Widened, INT32_MIN / -1 doesn't fit in an int
+  if (exponent->denomenator == 0 || (long long) exponent->numerator % exponent->denomenator)
+    return 0;
+
+  long long whole = (long long) exponent->numerator / exponent->denomenator;
+
+  // Neither does -INT32_MIN, flipping the fraction below
+  if (whole > INT32_MAX || whole < -INT32_MAX)
+    return 0;
+
+  int k = (int) whole;
+  int numerator = base->numerator, denominator = base->denomenator;
+
+  if (denominator == 0 || (numerator == 0 && k < 0))
+    return 0;
+
+  simplifyFractions(&numerator, &denominator);
+
+  if (k < 0) {
+
+    int swap = numerator;
+    numerator = denominator;
+    denominator = swap;
+
+    // Keep the sign on the numerator
+    if (denominator == INT32_MIN)
+      return 0;
+
+    if (denominator < 0) {
+      numerator = -numerator;
+      denominator = -denominator;
+    }
+
+    k = -k;
+  }
+
+  return power(numerator, k, rn) && power(denominator, k, rd);
 }
 
 /*
@@ -475,7 +968,59 @@ void EvaluateFractions() {
 
 */
 
-void Operation(Equation * expression) {
+#ifndef FRACTIONS_NO_STATS
+
+/*
+
+  Where an operator is counted in Stats.h, -1 if it isn't one
+
+*/
+
+static int statsIndex(char operator) {
+
+  switch (operator) {
+  case OP_ADD: return 0;
+  case OP_SUB: return 1;
+  case OP_MUL: return 2;
+  case OP_DIV: return 3;
+  case OP_POW: return 4;
+  }
+
+  return -1;
+}
+
+#endif
+
+/*
+
+  calculate() below, counted and timed for Stats.h
+
+*/
+
+static int calculate(Equation * expression);
+
+int Operation(Equation * expression) {
+
+#ifdef FRACTIONS_NO_STATS
+
+  return calculate(expression);
+
+#else
+
+  int index = statsIndex(*expression->operator);
+  int done;
+
+  if (index < 0)
+    return calculate(expression);
+
+  STATS_OPERATION(index, done, calculate(expression))
+
+  return done;
+
+#endif
+}
+
+static int calculate(Equation * expression) {
 
   Fraction * f1 = expression -> operand1;
   Fraction * f2 = expression -> operand2;
@@ -518,14 +1063,94 @@ void Operation(Equation * expression) {
     
     break;
 
+  case OP_POW:
+
+    // Already reduced, nothing left to simplify
+    return powerFraction(f1, f2, rn, rd);
+
   default:
     invalidCase();
-    break;
+    return 0;
 
   }
 
+  // Dividing by zero
+  if (*rd == 0)
+    return 0;
+
   simplifyFractions(rn, rd);
 
+  return 1;
+}
+
+
+/*
+
+  Evaluate an expression that came as text
+
+  The expression is evaluated through a WireRecord so that
+  division by zero and the other errors are caught the same
+  way as in --wire mode.
+
+  One expression is one sample of Trace.h: its parse, Operation()
+  and format stages are traced together, or not at all.
+
+*/
+
+static int formatAnswer(WireRecord *record, int evaluated, char *answer, const int size) {
+
+  if (evaluated)
+    return snprintf(answer, (size_t) size, "%i/%i\n", record->resultNumerator, record->resultDenomenator);
+
+  if (record->status == WIRE_STATUS_DIVIDE_BY_ZERO)
+    return snprintf(answer, (size_t) size, "error: division by zero\n");
+
+  if (record->status == WIRE_STATUS_OVERFLOW)
+    return snprintf(answer, (size_t) size, "error: overflow\n");
+
+  return snprintf(answer, (size_t) size, "error: invalid expression\n");
+}
+
+int answerExpression(char *text, char *answer, const int size) {
+
+  Fraction f1, f2, result;
+  char operator;
+  Equation expression = { &f1, &operator, &f2, &result };
+  WireRecord record;
+  int length;
+
+  TRACE_SAMPLE_BEGIN
+  TRACE_STAGE(whole)
+  TRACE_STAGE(stage)
+
+  if (!parseExpression(&expression, text)) {
+
+    TRACE_NEXT(stage, "expression", "parse")
+
+    length = snprintf(answer, (size_t) size, "error: invalid expression\n");
+
+    TRACE_END(stage, "expression", "format")
+  }
+
+  else {
+
+    TRACE_NEXT(stage, "expression", "parse")
+
+    Wire->fromEquation(&record, &expression);
+
+    int evaluated = Wire->evaluate(&record);
+
+    TRACE_NEXT(stage, "expression", "operation")
+
+    length = formatAnswer(&record, evaluated, answer, size);
+
+    TRACE_END(stage, "expression", "format")
+  }
+
+  TRACE_END(whole, "expression", "expression")
+  TRACE_SAMPLE_END
+
+  return length;
 }
 
 
@@ -577,6 +1202,8 @@ void QuitProgram() {
 
   */
 
+  Formulas -> free();
+
   Software -> Exit();
 }
 
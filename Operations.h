@@ -29,10 +29,54 @@
   */ 
   
   function *getFunctionToRun(int Choice);
-  
-  Fraction *sort(Fraction operand1, Fraction operand2, char operator);
 
-  void Operation(Equation * expression);
+  /*
+
+    Works out expression->result from the operands and the operator,
+    and simplifies it.
+
+    Returns 1 on success, 0 if it can't be worked out (unknown
+    operator, division by zero, a power that isn't whole or
+    doesn't fit in an int).
+
+  */
+
+  int Operation(Equation * expression);
+
+  /*
+
+    Evaluates an expression given as text, like "1/2 + 3/4",
+    and writes the answer line into answer:
+
+      "5/4\n"                       when it was evaluated
+      "error: <what went wrong>\n"  when it wasn't
+
+    Used wherever expressions arrive as text without a user
+    in front of them (daemon, batch files). The text is modified.
+
+    Returns the length of the answer.
+
+  */
+
+  int answerExpression(char *text, char *answer, const int size);
+
+  /*
+
+    Greatest common divisor of numRe and denRe, by Euclid's
+    algorithm. Its sign isn't fixed, only its size.
+
+  */
+
+  int getGCD(int numRe, int denRe);
+
+  /*
+
+    Reduces numerator/denominator in place, with the sign on
+    the numerator. Inside the limits in IO.h it uses Tables.h.
+
+  */
+
+  void simplifyFractions(int *numerator, int *denominator);
 
 #endif //Operations.h
 
@@ -51,7 +95,27 @@
 
 #define OP_QUIT_PROGRAM 6
 
+#define OP_GENERATE_MANY_RANDOM_FRACTIONS 7
+
+#define OP_SUM_ALL_FRACTIONS 8
+#define OP_PRODUCT_ALL_FRACTIONS 9
+
+#define OP_SORT_FRACTIONS 10
+
+#define OP_APPROXIMATE_DECIMAL 11
+
+#define OP_STORE_FORMULA 12
+#define OP_UPDATE_FRACTION 13
+#define OP_DISPLAY_FORMULAS 14
+
+#define OP_DISPLAY_STATS 15
+
+#define OP_EXPORT_EQUATIONS 16
+
+#define OP_SNAPSHOT_STORES 17
+
 #define OP_ADD '+'
 #define OP_SUB '-'
 #define OP_MUL '*'
 #define OP_DIV '/'
+#define OP_POW '^'
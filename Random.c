@@ -0,0 +1,298 @@
+/*
+
+  Random
+
+  xoshiro256** by David Blackman and Sebastiano Vigna,
+  bounded numbers by Daniel Lemire ("Fast Random Integer
+  Generation in an Interval", 2019). See Random.h.
+
+  How bulk generation stays the same for any number of threads:
+
+    The fractions are cut into blocks of RANDOM_BLOCK. Block b is
+    always generated from the main state jumped ahead b times
+    (each jump skips 2^128 numbers, so the streams never overlap).
+    Which thread generates a block doesn't change what is in it.
+
+    Worker w of n starts w jumps ahead and then jumps n times
+    between its blocks, so no thread ever replays another's jumps.
+
+*/
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "Software.h"
+#include "IO.h"
+#include "Random.h"
+
+static RandomState state;
+static int seeded = 0;
+
+/*
+
+  Fractions per block of bulk generation, see the top of this file
+
+*/
+
+#define RANDOM_BLOCK 65536
+
+/*
+
+  Most threads bulk generation uses
+
+*/
+
+#define RANDOM_MAX_THREADS 64
+
+/*
+
+  splitmix64, spreads a single 64 bit seed over the
+  256 bits of state, so that small seeds still work.
+
+*/
+
+static uint64_t splitmix64(uint64_t *x) {
+
+  uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+
+  return z ^ (z >> 31);
+}
+
+static void seed(uint64_t seed) {
+
+  for (int i = 0; i < 4; i++)
+    state.s[i] = splitmix64(&seed);
+
+  seeded = 1;
+}
+
+/*
+
+  Seeds from FRACTIONS_SEED the first time it's needed
+
+*/
+
+static void seedOnce() {
+
+  if (seeded)
+    return;
+
+  const char *text = getenv("FRACTIONS_SEED");
+
+  seed(text ? strtoull(text, NULL, 0) : RANDOM_DEFAULT_SEED);
+}
+
+/*
+
+  Jumps the state ahead by 2^128 numbers, same as calling
+  randomNext() 2^128 times. From the xoshiro256** reference code.
+
+*/
+
+static void jump(RandomState *r) {
+
+  static const uint64_t JUMP[] = {
+    0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+    0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL
+  };
+
+  uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+
+  for (int i = 0; i < 4; i++)
+    for (int b = 0; b < 64; b++) {
+
+      if (JUMP[i] & (1ULL << b)) {
+        s0 ^= r->s[0];
+        s1 ^= r->s[1];
+        s2 ^= r->s[2];
+        s3 ^= r->s[3];
+      }
+
+      randomNext(r);
+    }
+
+  r->s[0] = s0;
+  r->s[1] = s1;
+  r->s[2] = s2;
+  r->s[3] = s3;
+}
+
+/*
+
+  One random fraction from one 64 bit draw, the top half picks
+  the numerator and its sign, the bottom half the denominator.
+
+  The numerator and sign are drawn together from
+  0 .. 2 * IO_MAX_NUMERATOR - 1, which gives exactly the
+  spread CreateRandomFraction() always had (0 is twice as
+  likely as any other value, as it can be "+0" or "-0").
+
+*/
+
+static inline void fractionFrom(RandomState *r, Fraction *restrict f) {
+
+  uint64_t bits = randomNext(r);
+
+  uint32_t signedNumerator = randomBounded(r, (uint32_t) (bits >> 32), 2 * IO_MAX_NUMERATOR);
+  uint32_t denominator = randomBounded(r, (uint32_t) bits, IO_MAX_DENOMINATOR - 1) + 1;
+
+  int numerator = (int) (signedNumerator >> 1);
+
+  f->numerator = signedNumerator & 1 ? -numerator : numerator;
+  f->denomenator = (int) denominator;
+}
+
+/*
+
+  The public functions, all drawing from the one state
+
+*/
+
+static uint64_t next() {
+  seedOnce();
+  return randomNext(&state);
+}
+
+static uint32_t bounded(uint32_t range) {
+  seedOnce();
+  return randomBounded(&state, (uint32_t) (randomNext(&state) >> 32), range);
+}
+
+static void fraction(Fraction *restrict f) {
+  seedOnce();
+  fractionFrom(&state, f);
+}
+
+/*
+
+  One bulk generation worker
+
+  Type: RandomWorker
+
+*/
+
+typedef struct {
+
+  // Stream of this worker's first block
+  RandomState start;
+
+  Fraction *f;
+  long count;
+
+  long firstBlock;
+  long blockStep;
+
+}
+RandomWorker;
+
+static void *generateBlocks(void *argument) {
+
+  RandomWorker *w = argument;
+  RandomState stream = w->start;
+
+  for (long block = w->firstBlock; block * RANDOM_BLOCK < w->count; block += w->blockStep) {
+
+    // A local copy of the stream stays in registers
+    RandomState r = stream;
+
+    long first = block * RANDOM_BLOCK;
+    long last = first + RANDOM_BLOCK < w->count ? first + RANDOM_BLOCK : w->count;
+
+    for (long i = first; i < last; i++)
+      fractionFrom(&r, &w->f[i]);
+
+    // On to the stream of this worker's next block
+    for (long j = 0; j < w->blockStep; j++)
+      jump(&stream);
+  }
+
+  return NULL;
+}
+
+/*
+
+  Number of threads to use for count fractions,
+  Software->Threads(), but no more than there are blocks
+
+*/
+
+static int threadsFor(long count) {
+
+  long cpus = Software->Threads();
+  long blocks = (count + RANDOM_BLOCK - 1) / RANDOM_BLOCK;
+  long threads = cpus < blocks ? cpus : blocks;
+
+  if (threads > RANDOM_MAX_THREADS)
+    threads = RANDOM_MAX_THREADS;
+
+  return threads < 1 ? 1 : (int) threads;
+}
+
+static void fractions(Fraction *restrict f, long count) {
+
+  seedOnce();
+
+  if (count <= 0)
+    return;
+
+  int threads = threadsFor(count);
+  long blocks = (count + RANDOM_BLOCK - 1) / RANDOM_BLOCK;
+
+  RandomWorker workers[RANDOM_MAX_THREADS];
+  RandomState stream = state;
+
+  for (int t = 0; t < threads; t++) {
+    workers[t] = (RandomWorker) { stream, f, count, t, threads };
+    jump(&stream);
+  }
+
+  // Worker 0 runs on this thread, the rest get their own
+  Software->RunWorkers(&generateBlocks, workers, sizeof *workers, threads);
+
+  /*
+
+    The next bulk generation carries on after every block
+    used here, the same for any number of threads.
+
+  */
+
+  for (long b = 0; b < blocks; b++)
+    jump(&state);
+}
+
+static void stream(RandomState *restrict r) {
+  seedOnce();
+  *r = state;
+}
+
+static Fraction *store(int count) {
+
+  Fraction *f = Fractions->reserve(count);
+
+  if (f)
+    fractions(f, count);
+
+  return f;
+}
+
+/*
+
+  Abstraction, same as in Software.c
+
+*/
+
+const static randomGenerator RandomFunctions = {
+  &seed,
+  &next,
+  &bounded,
+  &fraction,
+  &fractions,
+  &store,
+  &stream,
+  &jump
+};
+
+const randomGenerator *restrict Random = &RandomFunctions;
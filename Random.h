@@ -0,0 +1,219 @@
+/*
+
+  Random
+
+  A fast random number generator that can be seeded, so the
+  same seed always gives the same fractions (xoshiro256**,
+  seeded through splitmix64).
+
+  Numbers in a range are drawn with Lemire's method, which needs
+  no division in the common case and has no bias, unlike rand() % n.
+
+  The seed is taken from the FRACTIONS_SEED environment variable
+  the first time a number is drawn, or RANDOM_DEFAULT_SEED if it
+  isn't set, unless Random->seed() is called first.
+
+  Code that draws a lot, on several threads, takes a copy of the
+  state with Random->stream(), gives every thread or block its own
+  stream with Random->jump(), and draws from it with randomNext()
+  and randomBounded() below, which are inlined.
+
+*/
+
+#ifndef RANDOM
+#define RANDOM
+
+#include <stdint.h>
+#include "Software.h"
+
+#define RANDOM_DEFAULT_SEED 0x5eed5eedULL
+
+/*
+
+  Generator state
+
+  Type: RandomState
+
+*/
+
+typedef struct {
+  uint64_t s[4];
+}
+RandomState;
+
+static inline uint64_t randomRotate(const uint64_t x, int k) {
+  return (x << k) | (x >> (64 - k));
+}
+
+/*
+
+  xoshiro256**, 64 random bits
+
+*/
+
+static inline uint64_t randomNext(RandomState *r) {
+
+  const uint64_t result = randomRotate(r->s[1] * 5, 7) * 9;
+  const uint64_t t = r->s[1] << 17;
+
+  r->s[2] ^= r->s[0];
+  r->s[3] ^= r->s[1];
+  r->s[1] ^= r->s[2];
+  r->s[0] ^= r->s[3];
+
+  r->s[2] ^= t;
+
+  r->s[3] = randomRotate(r->s[3], 45);
+
+  return result;
+}
+
+/*
+
+  Lemire's method, x (32 random bits) turned into 0 .. range - 1
+
+  x * range is a 64 bit number whose top 32 bits are the answer.
+  Only when the low 32 bits fall under 2^32 % range (rare for
+  small ranges) is the draw biased, and has to be done again.
+
+*/
+
+static inline uint32_t randomBounded(RandomState *r, uint32_t x, uint32_t range) {
+
+  uint64_t m = (uint64_t) x * range;
+  uint32_t low = (uint32_t) m;
+
+  if (low < range) {
+
+    uint32_t threshold = -range % range;
+
+    while (low < threshold) {
+      x = (uint32_t) (randomNext(r) >> 32);
+      m = (uint64_t) x * range;
+      low = (uint32_t) m;
+    }
+  }
+
+  return (uint32_t) (m >> 32);
+}
+
+typedef struct {
+
+  /*
+
+    void seed(uint64_t seed)
+
+    Restarts the generator from seed.
+
+    Access: Random->seed()
+
+  */
+
+  void(*const seed)(uint64_t seed);
+
+  /*
+
+    uint64_t next()
+
+    Returns 64 random bits.
+
+    Access: Random->next()
+
+  */
+
+  uint64_t(*const next)();
+
+  /*
+
+    uint32_t bounded(uint32_t range)
+
+    Returns a number from 0 to range - 1, every one equally likely.
+
+    Access: Random->bounded()
+
+  */
+
+  uint32_t(*const bounded)(uint32_t range);
+
+  /*
+
+    void fraction(Fraction *f)
+
+    Fills f with a random fraction, numerator from
+    -(IO_MAX_NUMERATOR - 1) to IO_MAX_NUMERATOR - 1 and
+    denominator from 1 to IO_MAX_DENOMINATOR - 1.
+
+    Access: Random->fraction()
+
+  */
+
+  void(*const fraction)(Fraction * restrict f);
+
+  /*
+
+    void fractions(Fraction *f, long count)
+
+    Fills count fractions, using one thread per CPU for large counts.
+    Each block of fractions comes from its own jump ahead stream, so
+    a given seed always gives the same fractions, however many
+    threads there are (but not the same ones fraction() would give).
+
+    Access: Random->fractions()
+
+  */
+
+  void(*const fractions)(Fraction * restrict f, long count);
+
+  /*
+
+    Fraction* store(int count)
+
+    Generates count random fractions straight into the fractions
+    data base (see Fractions->reserve()), and returns the first.
+
+    Access: Random->store()
+
+  */
+
+  Fraction*(*const store)(int count);
+
+  /*
+
+    void stream(RandomState *r)
+
+    Copies the state of the generator (seeded first, like
+    any draw) into r, to draw from without Random.
+
+    Access: Random->stream()
+
+  */
+
+  void(*const stream)(RandomState * restrict r);
+
+  /*
+
+    void jump(RandomState *r)
+
+    Jumps r ahead by 2^128 numbers, so streams that are
+    jumped a different number of times never overlap.
+
+    Access: Random->jump()
+
+  */
+
+  void(*const jump)(RandomState * restrict r);
+
+}
+randomGenerator;
+
+/*
+
+  Call this, Random, to access all
+  the publicly available functions.
+
+*/
+
+extern
+const randomGenerator * restrict Random;
+
+#endif //Random.h
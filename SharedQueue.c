@@ -0,0 +1,603 @@
+/*
+
+  SharedQueue
+
+  Shared memory submission/completion rings, the server that
+  evaluates them, and the client library. See SharedQueue.h.
+
+  Layout of the shared memory object:
+
+    QueueHeader
+    QueuePair[pairs]
+
+  Every counter only ever grows (wrapping at 2^32), the slot of
+  counter n is n & (SHARED_QUEUE_CAPACITY - 1). Counters written by
+  different processes live on different cache lines.
+
+  Sleeping and waking, for both the server and the clients:
+
+    reader: doorbell = load(bell); store(sleeping, 1);
+            check for work; if none, futex_wait(bell, doorbell);
+            store(sleeping, 0)
+
+    writer: publish the records (store tail); if load(sleeping),
+            add 1 to bell and futex_wake(bell)
+
+  Everything is sequentially consistent around these, so either the
+  reader sees the new tail, or the writer sees the reader sleeping,
+  and a wake up can't get lost.
+
+*/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "Software.h"
+#include "Wire.h"
+#include "SharedQueue.h"
+
+/*
+
+  Error Messages
+
+*/
+
+#define DISPLAY_SHARED_MEMORY_ERROR(what) fprintf(stderr, "SharedQueue: %s failed: %s\n", what, strerror(errno));
+#define DISPLAY_MALLOC_ERROR { fprintf(stderr, "FATAL ERROR: UNABLE TO ALLOCATE MEMORY IN HEAP"); exit(-1); }
+
+#define SHARED_QUEUE_MAGIC 0x46524143
+#define SHARED_QUEUE_MASK (SHARED_QUEUE_CAPACITY - 1)
+
+#define CACHE_LINE 64
+
+/*
+
+  Start of the shared memory object
+
+  Type: QueueHeader
+
+*/
+
+typedef struct {
+
+  uint32_t magic;
+  uint32_t pairs;
+
+  // Set when the server is shutting down
+  _Alignas(CACHE_LINE) atomic_uint stopping;
+
+  // The server sleeps on this futex word
+  _Alignas(CACHE_LINE) atomic_uint serverBell;
+  atomic_uint serverSleeping;
+
+}
+QueueHeader;
+
+/*
+
+  One client's pair of rings
+
+  Type: QueuePair
+
+*/
+
+typedef struct {
+
+  // 1 while a client is using the pair
+  _Alignas(CACHE_LINE) atomic_uint attached;
+
+  // Submission ring, written by the client
+  _Alignas(CACHE_LINE) atomic_uint submitTail;
+
+  // Submission ring, read by the server
+  _Alignas(CACHE_LINE) atomic_uint submitHead;
+
+  // Completion ring, written by the server
+  _Alignas(CACHE_LINE) atomic_uint completeTail;
+
+  // Completion ring, read by the client
+  _Alignas(CACHE_LINE) atomic_uint completeHead;
+
+  // The client sleeps on this futex word
+  _Alignas(CACHE_LINE) atomic_uint clientBell;
+  atomic_uint clientSleeping;
+
+  _Alignas(CACHE_LINE) WireRecord submissions[SHARED_QUEUE_CAPACITY];
+  _Alignas(CACHE_LINE) WireRecord completions[SHARED_QUEUE_CAPACITY];
+
+}
+QueuePair;
+
+/*
+
+  A connected client
+
+*/
+
+struct SharedQueueClient {
+
+  QueueHeader *header;
+  QueuePair *pair;
+  size_t size;
+  int spin;
+
+};
+
+/*
+
+  Set by the signal handler to stop the server
+
+*/
+
+static volatile sig_atomic_t stopping = 0;
+
+static void stopServing(__attribute__((unused)) int signal) {
+  stopping = 1;
+}
+
+/*
+
+  Futex system calls, on shared (not process private) memory
+
+*/
+
+static void futexWait(atomic_uint *word, unsigned int value) {
+  syscall(SYS_futex, word, FUTEX_WAIT, value, NULL, NULL, 0);
+}
+
+static void futexWake(atomic_uint *word) {
+  syscall(SYS_futex, word, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+/*
+
+  Tells the CPU we are busy polling
+
+*/
+
+static inline void relax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#endif
+}
+
+/*
+
+  Wakes a reader if it went to sleep
+
+*/
+
+static void ring(atomic_uint *bell, atomic_uint *sleeping) {
+  if (atomic_load(sleeping)) {
+    atomic_fetch_add(bell, 1);
+    futexWake(bell);
+  }
+}
+
+/*
+
+  Size of the shared memory object
+
+*/
+
+static size_t sharedSize(int pairs) {
+  return sizeof (QueueHeader) + (size_t) pairs * sizeof (QueuePair);
+}
+
+static QueuePair *getPair(QueueHeader *header, int index) {
+  return (QueuePair *) ((char *) header + sizeof (QueueHeader)) + index;
+}
+
+/*
+
+  Object name, "/<name>"
+
+*/
+
+static void objectName(const char *name, char *path, size_t size) {
+  snprintf(path, size, "/%s", name);
+}
+
+/*
+
+
+
+  Server
+
+
+
+*/
+
+/*
+
+  Evaluates what is waiting in one pair, as much as
+  fits in its completion ring.
+
+  Returns the number of records evaluated.
+
+*/
+
+static unsigned int servePair(QueuePair *pair) {
+
+  unsigned int head = atomic_load_explicit(&pair->submitHead, memory_order_relaxed);
+  unsigned int tail = atomic_load_explicit(&pair->submitTail, memory_order_acquire);
+  unsigned int completeTail = atomic_load_explicit(&pair->completeTail, memory_order_relaxed);
+  unsigned int completeHead = atomic_load_explicit(&pair->completeHead, memory_order_acquire);
+
+  unsigned int waiting = tail - head;
+  unsigned int room = SHARED_QUEUE_CAPACITY - (completeTail - completeHead);
+  unsigned int count = waiting < room ? waiting : room;
+
+  if (!count)
+    return 0;
+
+  for (unsigned int i = 0; i < count; i++) {
+    WireRecord *record = &pair->completions[(completeTail + i) & SHARED_QUEUE_MASK];
+    *record = pair->submissions[(head + i) & SHARED_QUEUE_MASK];
+    Wire->evaluate(record);
+  }
+
+  atomic_store(&pair->completeTail, completeTail + count);
+  atomic_store(&pair->submitHead, head + count);
+
+  ring(&pair->clientBell, &pair->clientSleeping);
+
+  return count;
+}
+
+/*
+
+  One pass over every attached pair
+
+*/
+
+static unsigned int serveAll(QueueHeader *header) {
+
+  unsigned int done = 0;
+
+  for (uint32_t i = 0; i < header->pairs; i++) {
+
+    QueuePair *pair = getPair(header, (int) i);
+
+    if (atomic_load_explicit(&pair->attached, memory_order_acquire))
+      done += servePair(pair);
+  }
+
+  return done;
+}
+
+/*
+
+  Is there anything at all to do?
+
+*/
+
+static int hasWork(QueueHeader *header) {
+
+  for (uint32_t i = 0; i < header->pairs; i++) {
+
+    QueuePair *pair = getPair(header, (int) i);
+
+    if (atomic_load(&pair->submitTail) != atomic_load(&pair->submitHead))
+      return 1;
+  }
+
+  return 0;
+}
+
+/*
+
+  int serve(char *name, int pairs, int spin)
+
+*/
+
+static int serve(const char *name, int pairs, int spin) {
+
+  char path[256];
+  objectName(name, path, sizeof (path));
+
+  size_t size = sharedSize(pairs);
+
+  // An object left behind by a previous server
+  shm_unlink(path);
+
+  int fd = shm_open(path, O_RDWR | O_CREAT | O_EXCL, 0600);
+
+  if (fd < 0 || ftruncate(fd, (off_t) size) < 0) {
+    DISPLAY_SHARED_MEMORY_ERROR(path)
+    return 1;
+  }
+
+  QueueHeader *header = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+
+  if (header == MAP_FAILED) {
+    DISPLAY_SHARED_MEMORY_ERROR("mmap")
+    shm_unlink(path);
+    return 1;
+  }
+
+  // ftruncate() zeroed everything, which is the empty state
+  header->pairs = (uint32_t) pairs;
+  atomic_store(&header->stopping, 0);
+  header->magic = SHARED_QUEUE_MAGIC;
+
+  struct sigaction action = { .sa_handler = &stopServing };
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGINT, &action, NULL);
+  sigaction(SIGTERM, &action, NULL);
+
+  printf("Serving %i queue pairs on shared memory %s\n", pairs, path);
+  fflush(stdout);
+
+  while (!stopping) {
+
+    if (serveAll(header))
+      continue;
+
+    // Busy poll for a while, new work is usually close behind
+    int idle;
+
+    for (idle = 0; idle < spin && !hasWork(header); idle++)
+      relax();
+
+    if (idle < spin)
+      continue;
+
+    // Then sleep until a client rings
+    unsigned int bell = atomic_load(&header->serverBell);
+    atomic_store(&header->serverSleeping, 1);
+
+    if (!hasWork(header) && !stopping)
+      futexWait(&header->serverBell, bell);
+
+    atomic_store(&header->serverSleeping, 0);
+  }
+
+  // Let clients know, and wake any that are waiting for completions
+  atomic_store(&header->stopping, 1);
+
+  for (int i = 0; i < pairs; i++) {
+    QueuePair *pair = getPair(header, i);
+    atomic_fetch_add(&pair->clientBell, 1);
+    futexWake(&pair->clientBell);
+  }
+
+  munmap(header, size);
+  shm_unlink(path);
+
+  printf("\nShared queue server stopped\n");
+
+  return 0;
+}
+
+/*
+
+
+
+  Client library
+
+
+
+*/
+
+/*
+
+  SharedQueueClient* connect(char *name, int spin)
+
+*/
+
+static SharedQueueClient *connectClient(const char *name, int spin) {
+
+  char path[256];
+  objectName(name, path, sizeof (path));
+
+  int fd = shm_open(path, O_RDWR, 0);
+  struct stat info;
+
+  if (fd < 0 || fstat(fd, &info) < 0 || (size_t) info.st_size < sizeof (QueueHeader)) {
+    DISPLAY_SHARED_MEMORY_ERROR(path)
+    if (fd >= 0) close(fd);
+    return NULL;
+  }
+
+  QueueHeader *header = mmap(NULL, (size_t) info.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+
+  if (header == MAP_FAILED) {
+    DISPLAY_SHARED_MEMORY_ERROR("mmap")
+    return NULL;
+  }
+
+  if (header->magic != SHARED_QUEUE_MAGIC || sharedSize((int) header->pairs) > (size_t) info.st_size) {
+    fprintf(stderr, "SharedQueue: %s is not a fractions queue\n", path);
+    munmap(header, (size_t) info.st_size);
+    return NULL;
+  }
+
+  /*
+
+    Take the first free pair. A pair is only freed once both of
+    its rings are empty, so its counters are ready to use as is.
+
+  */
+
+  for (uint32_t i = 0; i < header->pairs; i++) {
+
+    unsigned int free = 0;
+    QueuePair *pair = getPair(header, (int) i);
+
+    if (atomic_compare_exchange_strong(&pair->attached, &free, 1)) {
+
+      SharedQueueClient *c = malloc(sizeof (SharedQueueClient));
+
+      if (!c) DISPLAY_MALLOC_ERROR
+
+      c->header = header;
+      c->pair = pair;
+      c->size = (size_t) info.st_size;
+      c->spin = spin;
+
+      return c;
+    }
+  }
+
+  fprintf(stderr, "SharedQueue: every queue pair of %s is in use\n", path);
+  munmap(header, (size_t) info.st_size);
+
+  return NULL;
+}
+
+/*
+
+  size_t submit(SharedQueueClient *c, WireRecord *records, size_t count)
+
+*/
+
+static size_t submit(SharedQueueClient *c, const WireRecord *restrict records, size_t count) {
+
+  QueuePair *pair = c->pair;
+
+  unsigned int tail = atomic_load_explicit(&pair->submitTail, memory_order_relaxed);
+  unsigned int head = atomic_load_explicit(&pair->submitHead, memory_order_acquire);
+  unsigned int room = SHARED_QUEUE_CAPACITY - (tail - head);
+
+  if (count > room)
+    count = room;
+
+  if (!count)
+    return 0;
+
+  for (size_t i = 0; i < count; i++)
+    pair->submissions[(tail + i) & SHARED_QUEUE_MASK] = records[i];
+
+  atomic_store(&pair->submitTail, tail + (unsigned int) count);
+
+  ring(&c->header->serverBell, &c->header->serverSleeping);
+
+  return count;
+}
+
+/*
+
+  size_t complete(SharedQueueClient *c, WireRecord *records, size_t count)
+
+*/
+
+static size_t complete(SharedQueueClient *c, WireRecord *restrict records, size_t count) {
+
+  QueuePair *pair = c->pair;
+
+  unsigned int head = atomic_load_explicit(&pair->completeHead, memory_order_relaxed);
+  unsigned int tail;
+  int idle = 0;
+
+  // Spin, then sleep, until something is there
+  while ((tail = atomic_load_explicit(&pair->completeTail, memory_order_acquire)) == head) {
+
+    if (atomic_load(&c->header->stopping))
+      return 0;
+
+    if (idle++ < c->spin) {
+      relax();
+      continue;
+    }
+
+    unsigned int bell = atomic_load(&pair->clientBell);
+    atomic_store(&pair->clientSleeping, 1);
+
+    if (atomic_load(&pair->completeTail) == head)
+      futexWait(&pair->clientBell, bell);
+
+    atomic_store(&pair->clientSleeping, 0);
+  }
+
+  unsigned int available = tail - head;
+
+  if (count > available)
+    count = available;
+
+  for (size_t i = 0; i < count; i++)
+    records[i] = pair->completions[(head + i) & SHARED_QUEUE_MASK];
+
+  atomic_store(&pair->completeHead, head + (unsigned int) count);
+
+  return count;
+}
+
+/*
+
+  void evaluate(SharedQueueClient *c, WireRecord *records, size_t count)
+
+*/
+
+static void evaluate(SharedQueueClient *c, WireRecord *restrict records, size_t count) {
+
+  size_t submitted = 0, completed = 0;
+
+  while (completed < count) {
+
+    submitted += submit(c, records + submitted, count - submitted);
+
+    size_t got = complete(c, records + completed, submitted - completed);
+
+    // The server went away
+    if (!got)
+      return;
+
+    completed += got;
+  }
+}
+
+/*
+
+  void disconnect(SharedQueueClient *c)
+
+*/
+
+static void disconnect(SharedQueueClient *c) {
+
+  QueuePair *pair = c->pair;
+  WireRecord discard[64];
+
+  // Collect (and drop) anything still in flight
+  while (
+    !atomic_load(&c->header->stopping) &&
+    atomic_load(&pair->completeHead) != atomic_load(&pair->submitTail) &&
+    complete(c, discard, 64));
+
+  atomic_store(&pair->attached, 0);
+
+  munmap(c->header, c->size);
+  free(c);
+}
+
+/*
+
+  Abstraction, same as in Software.c
+
+*/
+
+const static sharedQueue SharedQueueFunctions = {
+  &serve,
+  &connectClient,
+  &submit,
+  &complete,
+  &evaluate,
+  &disconnect
+};
+
+const sharedQueue *restrict SharedQueue = &SharedQueueFunctions;
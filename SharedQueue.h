@@ -0,0 +1,152 @@
+/*
+
+  SharedQueue
+
+  Lets programs on the same machine hand us binary equation records
+  (see Wire.h) through shared memory, without sockets or text.
+
+  The server creates a POSIX shared memory object holding several
+  queue pairs, one per connected client. Each pair is two rings:
+
+    submission ring: the client writes records, the server reads them
+    completion ring: the server writes evaluated records back, in the
+                     same order, the client reads them
+
+  Each ring has exactly one writer and one reader, so no locks are
+  needed, only the head and tail counters. When there is nothing to do,
+  the reader busy polls for a while (spin) and then sleeps on a futex,
+  the writer only makes a system call to wake it if it is asleep.
+
+  Client side (the client library):
+
+    SharedQueueClient *c = SharedQueue->connect("fractions", 1000);
+    SharedQueue->evaluate(c, records, count);  // records now hold results
+    SharedQueue->disconnect(c);
+
+*/
+
+#ifndef SHARED_QUEUE
+#define SHARED_QUEUE
+
+#include <stddef.h>
+#include "Wire.h"
+
+#define SHARED_QUEUE_DEFAULT_NAME "fractions"
+
+// Records each ring holds, a power of 2
+#define SHARED_QUEUE_CAPACITY 1024
+
+// Queue pairs, so at most this many clients at once
+#define SHARED_QUEUE_DEFAULT_PAIRS 8
+
+// Polls before going to sleep on the futex
+#define SHARED_QUEUE_DEFAULT_SPIN 2000
+
+/*
+
+  A connected client, only the library looks inside
+
+  Type: SharedQueueClient
+
+*/
+
+typedef struct SharedQueueClient SharedQueueClient;
+
+typedef struct {
+
+  /*
+
+    int serve(char *name, int pairs, int spin)
+
+    Creates the shared memory object /<name> with room for pairs
+    clients, and evaluates submitted records until SIGINT or SIGTERM.
+    spin is how many times to poll for work before sleeping.
+
+    Returns 0 on a clean shutdown, else 1.
+
+    Access: SharedQueue->serve()
+
+  */
+
+  int(*const serve)(const char *name, int pairs, int spin);
+
+  /*
+
+    SharedQueueClient* connect(char *name, int spin)
+
+    Attaches to a free queue pair of a running server.
+    Returns NULL if there is no server or no free pair.
+
+    Access: SharedQueue->connect()
+
+  */
+
+  SharedQueueClient*(*const connect)(const char *name, int spin);
+
+  /*
+
+    size_t submit(SharedQueueClient *c, WireRecord *records, size_t count)
+
+    Puts up to count records on the submission ring without waiting.
+    Returns how many fit.
+
+    Access: SharedQueue->submit()
+
+  */
+
+  size_t(*const submit)(SharedQueueClient *c, const WireRecord * restrict records, size_t count);
+
+  /*
+
+    size_t complete(SharedQueueClient *c, WireRecord *records, size_t count)
+
+    Takes up to count evaluated records from the completion ring,
+    waiting (spinning, then sleeping) until there is at least one.
+    Returns how many were taken.
+
+    Access: SharedQueue->complete()
+
+  */
+
+  size_t(*const complete)(SharedQueueClient *c, WireRecord * restrict records, size_t count);
+
+  /*
+
+    void evaluate(SharedQueueClient *c, WireRecord *records, size_t count)
+
+    Submits every record and waits for all of them, keeping the
+    rings as full as possible. The records are evaluated in place.
+
+    Access: SharedQueue->evaluate()
+
+  */
+
+  void(*const evaluate)(SharedQueueClient *c, WireRecord * restrict records, size_t count);
+
+  /*
+
+    void disconnect(SharedQueueClient *c)
+
+    Waits for anything still in flight, and frees the queue pair
+    for another client.
+
+    Access: SharedQueue->disconnect()
+
+  */
+
+  void(*const disconnect)(SharedQueueClient *c);
+
+}
+sharedQueue;
+
+/*
+
+  Call this, SharedQueue, to access all
+  the publicly available functions.
+
+*/
+
+extern
+const sharedQueue * restrict SharedQueue;
+
+#endif //SharedQueue.h
@@ -0,0 +1,314 @@
+/*
+
+  Snapshot
+
+  The child only reads the stores, through get(), and leaves
+  with _exit() so nothing the parent registered with atexit()
+  (like the trace writer) runs twice.
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "Snapshot.h"
+#include "Software.h"
+#include "Wire.h"
+
+#define DISPLAY_MALLOC_ERROR { fprintf(stderr, "FATAL ERROR: UNABLE TO ALLOCATE MEMORY IN HEAP"); exit(-1); }
+#define DISPLAY_FILE_ERROR(file) fprintf(stderr, "Snapshot: %s: %s\n", file, strerror(errno));
+#define DISPLAY_FORMAT_ERROR(file) fprintf(stderr, "Snapshot: %s is not a snapshot\n", file);
+
+static const char magic[4] = { 'F', 'S', 'N', 'P' };
+
+// The child writing, 0 if there is none
+static pid_t child = 0;
+static char childPath[4096];
+
+static double secondsSince(const struct timespec *start) {
+
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return (double) (now.tv_sec - start->tv_sec) + (double) (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/*
+
+  Every record written, progress every SNAPSHOT_PROGRESS
+
+*/
+
+static void progress(long long written, long long total, const struct timespec *start) {
+
+  if (written % SNAPSHOT_PROGRESS == 0)
+    fprintf(stderr, "Snapshot: %lli of %lli records (%.0f%%) in %.2f s\n", written, total, 100.0 * (double) written / (double) total, secondsSince(start));
+}
+
+/*
+
+  Flushes the directory holding path, returns 1 on success
+
+*/
+
+static int syncDirectory(const char *path) {
+
+  char directory[4096];
+  const char *slash = strrchr(path, '/');
+
+  if (!slash)
+    snprintf(directory, sizeof (directory), ".");
+  else if (slash == path)
+    snprintf(directory, sizeof (directory), "/");
+  else
+    snprintf(directory, sizeof (directory), "%.*s", (int) (slash - path), path);
+
+  int fd = open(directory, O_RDONLY | O_DIRECTORY);
+
+  if (fd < 0 || fsync(fd)) {
+    DISPLAY_FILE_ERROR(directory)
+    if (fd >= 0)
+      close(fd);
+    return 0;
+  }
+
+  close(fd);
+
+  return 1;
+}
+
+/*
+
+  What the child runs, returns its exit status
+
+*/
+
+static int writeImage(const char *path) {
+
+  struct timespec start;
+  char partial[4096 + 16];
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  snprintf(partial, sizeof (partial), "%s.partial", path);
+
+  FILE *out = fopen(partial, "wb");
+
+  if (!out) {
+    DISPLAY_FILE_ERROR(partial)
+    return 1;
+  }
+
+  setvbuf(out, NULL, _IOFBF, 1 << 20);
+
+  int32_t header[3] = { SNAPSHOT_VERSION, Fractions->count(), Equations->count() };
+  long long total = (long long) header[1] + (long long) header[2], written = 0;
+
+  fwrite(magic, sizeof (magic), 1, out);
+  fwrite(header, sizeof (header), 1, out);
+
+  for (int i = 0; i < header[1]; i++) {
+
+    Fraction *f = Fractions->get(i);
+    int32_t values[2] = { f->numerator, f->denomenator };
+
+    fwrite(values, sizeof (values), 1, out);
+    progress(++written, total, &start);
+  }
+
+  for (int i = 0; i < header[2]; i++) {
+
+    WireRecord record;
+
+    Wire->fromEquation(&record, Equations->get(i));
+    fwrite(&record, sizeof (record), 1, out);
+    progress(++written, total, &start);
+  }
+
+  // On disk before it replaces the last snapshot, not just in the page cache
+  int failed = fflush(out) || ferror(out) || fsync(fileno(out));
+
+  if (fclose(out))
+    failed = 1;
+
+  if (failed || rename(partial, path)) {
+    DISPLAY_FILE_ERROR(path)
+    remove(partial);
+    return 1;
+  }
+
+  // And the rename too, which lives in the directory
+  if (!syncDirectory(path))
+    return 1;
+
+  fprintf(stderr, "Snapshot: %i fractions and %i equations written to %s in %.3f s\n", header[1], header[2], path, secondsSince(&start));
+
+  return 0;
+}
+
+/*
+
+  Collects the child if it finished
+
+*/
+
+static int running() {
+
+  int status;
+
+  if (!child || !waitpid(child, &status, WNOHANG))
+    return child != 0;
+
+  if (!WIFEXITED(status) || WEXITSTATUS(status))
+    fprintf(stderr, "Snapshot: writing %s failed, the last snapshot there is left as it was\n", childPath);
+
+  child = 0;
+
+  return 0;
+}
+
+static void waitForSnapshot() {
+
+  if (!child)
+    return;
+
+  fprintf(stderr, "Snapshot: waiting for %s to be written\n", childPath);
+
+  int status;
+
+  if (waitpid(child, &status, 0) == child && (!WIFEXITED(status) || WEXITSTATUS(status)))
+    fprintf(stderr, "Snapshot: writing %s failed, the last snapshot there is left as it was\n", childPath);
+
+  child = 0;
+}
+
+static int save(const char *path) {
+
+  if (running())
+    return 0;
+
+  // Nothing buffered should be written twice
+  fflush(stdout);
+  fflush(stderr);
+
+  pid_t pid = fork();
+
+  if (pid < 0) {
+    DISPLAY_FILE_ERROR("fork")
+    return -1;
+  }
+
+  if (!pid)
+    _exit(writeImage(path));
+
+  child = pid;
+  snprintf(childPath, sizeof (childPath), "%s", path);
+
+  return (int) pid;
+}
+
+static int load(const char *path) {
+
+  FILE *in = fopen(path, "rb");
+
+  if (!in) {
+    DISPLAY_FILE_ERROR(path)
+    return 0;
+  }
+
+  char found[4];
+  int32_t header[3];
+
+  if (fread(found, sizeof (found), 1, in) != 1 || memcmp(found, magic, sizeof (magic)) ||
+      fread(header, sizeof (header), 1, in) != 1 || header[0] != SNAPSHOT_VERSION || header[1] < 0 || header[2] < 0) {
+    DISPLAY_FORMAT_ERROR(path)
+    fclose(in);
+    return 0;
+  }
+
+  int ok = 1;
+
+  if (header[1]) {
+
+    int32_t *values = malloc((size_t) header[1] * 2 * sizeof (int32_t));
+
+    if (!values) DISPLAY_MALLOC_ERROR
+
+    ok = fread(values, 2 * sizeof (int32_t), (size_t) header[1], in) == (size_t) header[1];
+
+    if (ok) {
+
+      Fraction *f = Fractions->reserve(header[1]);
+
+      for (int i = 0; i < header[1]; i++)
+        f[i] = (Fraction) { values[2 * i], values[2 * i + 1] };
+    }
+
+    free(values);
+  }
+
+  int loaded = 0;
+
+  for (int i = 0; ok && i < header[2]; i++) {
+
+    WireRecord record;
+
+    if (fread(&record, sizeof (record), 1, in) != 1) {
+      ok = 0;
+      break;
+    }
+
+    if (!Equations->canStore())
+      continue;
+
+    Equation *e = Equations->new();
+
+    Wire->toEquation(e, &record);
+    Equations->Store(e);
+    loaded++;
+  }
+
+  fclose(in);
+
+  if (!ok) {
+    fprintf(stderr, "Snapshot: %s is cut short\n", path);
+    return 0;
+  }
+
+  if (loaded < header[2])
+    fprintf(stderr, "Snapshot: only %i of %i equations fit in the history (raise FRACTIONS_HISTORY)\n", loaded, header[2]);
+
+  return 1;
+}
+
+static void restore() {
+
+  const char *path = getenv("FRACTIONS_SNAPSHOT");
+
+  if (path && *path && load(path))
+    fprintf(stderr, "Snapshot: loaded %i fractions and %i equations from %s\n", Fractions->count(), Equations->count(), path);
+}
+
+/*
+
+  Abstraction, same as in Software.c
+
+*/
+
+const static snapshotStores SnapshotFunctions = {
+  &save,
+  &running,
+  &waitForSnapshot,
+  &load,
+  &restore
+};
+
+const snapshotStores *restrict Snapshot = &SnapshotFunctions;
@@ -0,0 +1,122 @@
+/*
+
+  Snapshot
+
+  Saves the fraction and equation stores to a file without
+  stopping the program: save() forks, and the child writes the
+  stores as they were at the fork while the parent goes on.
+  Pages the parent changes afterwards are copied by the kernel,
+  so the child never sees them.
+
+  The image, in the byte order of the machine that wrote it:
+
+    "FSNP"  version  fractions  equations       (4 x 4 bytes)
+    fractions, numerator and denominator        (8 bytes each)
+    equations, as WireRecords (see Wire.h)      (28 bytes each)
+
+  It is written to FILE.partial, synced to disk and renamed to
+  FILE once it is complete, so a snapshot that fails (or a crash
+  while writing) leaves the last one alone.
+
+  FRACTIONS_SNAPSHOT=FILE loads an image back into the stores
+  when the menu starts.
+
+*/
+
+#ifndef SNAPSHOT
+#define SNAPSHOT
+
+#define SNAPSHOT_VERSION 1
+
+/*
+
+  Records between two progress reports of the child
+
+*/
+
+#define SNAPSHOT_PROGRESS (1 << 20)
+
+typedef struct {
+
+  /*
+
+    int save(char *path)
+
+    Forks a child that writes the stores to path, and reports
+    its progress and how long it took on stderr.
+
+    Returns the child's process id, 0 if a snapshot is still
+    being written, or -1 if it couldn't fork (and prints why).
+
+    Access: Snapshot->save()
+
+  */
+
+  int(*const save)(const char *path);
+
+  /*
+
+    int running()
+
+    Returns 1 if a snapshot is still being written, else 0.
+    Collects a child that finished, and prints if it failed.
+
+    Access: Snapshot->running()
+
+  */
+
+  int(*const running)();
+
+  /*
+
+    void wait()
+
+    Waits for a snapshot being written, if there is one.
+
+    Access: Snapshot->wait()
+
+  */
+
+  void(*const wait)();
+
+  /*
+
+    int load(char *path)
+
+    Adds every fraction and equation of the image at path to
+    the stores, as many equations as they can hold.
+
+    Returns 1 on success, else 0 (and prints why).
+
+    Access: Snapshot->load()
+
+  */
+
+  int(*const load)(const char *path);
+
+  /*
+
+    void restore()
+
+    Loads the image FRACTIONS_SNAPSHOT names, if it is set.
+
+    Access: Snapshot->restore()
+
+  */
+
+  void(*const restore)();
+
+}
+snapshotStores;
+
+/*
+
+  Call this, Snapshot, to access all
+  the publicly available functions.
+
+*/
+
+extern
+const snapshotStores * restrict Snapshot;
+
+#endif //Snapshot.h
@@ -9,18 +9,165 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
 
 #include "Software.h"
 #include "IO.h"
+#include "Stats.h"
+#include "Trace.h"
+#include "Formula.h"
 
 /*
 
-  Memory allocated for structure instances
+  Fractions are not allocated one by one, they are cut out of
+  blocks of FRACTION_BLOCK fractions (or bigger, for reserve()).
+  All blocks are freed together when the session ends.
 
 */
 
-static Fraction *storedFractionsArray[IO_MAX_FRACTIONS];
-static Equation *storedEquationsArray[IO_MAX_FRACTIONS];
+#define FRACTION_BLOCK 4096
+
+/*
+
+  An equation that didn't fit in a packed word (see below)
+
+*/
+
+typedef struct {
+    Fraction operand1;
+    Fraction operand2;
+    Fraction result;
+    char operator;
+}
+WideEquation;
+
+typedef struct {
+    WideEquation *equations;
+    int count;
+    int capacity;
+}
+WideTable;
+
+/*
+
+  Sharded equations, FRACTIONS_SHARDED=1
+
+  Every thread that stores equations into a session appends them
+  to a shard of its own, on cache lines of its own, so threads
+  don't write to the same memory. Each equation also takes the
+  session's next sequence number, the one shared write left,
+  which is also how it takes its place in the history: a number
+  past the limit is given back and the equation isn't stored.
+
+  Reading puts them back in order: the view maps every sequence
+  number to its shard and place there. It is made again when
+  equations were stored since, once the threads storing are done.
+
+*/
+
+#define SHARD_CACHE_LINE 64
+
+typedef struct {
+    uint64_t sequence;
+    union {
+        Equation *equation;
+        uint64_t word;
+    };
+}
+ShardEntry;
+
+typedef struct {
+    _Alignas(SHARD_CACHE_LINE) pthread_t owner;
+    ShardEntry *entries;
+    int count;
+    int capacity;
+    WideTable wide;
+}
+EquationShard;
+
+typedef struct {
+    int shard;
+    int position;
+}
+ShardView;
+
+/*
+
+  Everything one user stores, Fractions, Equations and Software
+  work on the calling thread's session, the default one unless
+  Sessions->use() picked another
+
+*/
+
+struct Session {
+
+    // Memory allocated for structure instances
+    Fraction **storedFractionsArray;
+    Equation **storedEquationsArray;
+
+    // Fraction blocks, and what is left of the last one
+    Fraction **fractionBlocks;
+    int fractionBlocksCount;
+
+    Fraction *currentBlock;
+    int currentBlockLeft;
+
+    // To track number of Fractions, and how many fit (see below)
+    int StoredFractionsCount;
+    int FractionsLimit;
+    int FractionsCapacity;
+
+    // To track number of Equations, and room in the arrays
+    int StoredEquationsCount;
+    int EquationsCapacity;
+
+    // Packed equations, and the ones that didn't fit
+    uint64_t *packedEquations;
+    WideTable wide;
+
+    // Sharded equations, and the view that orders them
+    EquationShard **shards;
+    int shardCount;
+    int shardCapacity;
+    pthread_mutex_t shardsLock;
+
+    ShardView *view;
+    uint64_t viewed;
+
+    // Changes when the shards are freed, see shardOf()
+    uint64_t id;
+
+    // What get() and forEach() unpack into
+    Fraction unpackedFractions[3];
+    char unpackedOperator;
+    Equation unpacked;
+
+    // What getFormatted() writes into
+    char temp[100];
+
+    // Formulas on the fractions above (see Formula.h)
+    FormulaStore formulas;
+
+    // 0 once Exit() was called
+    int Running;
+
+    // Next sequence number, on a cache line of its own
+    _Alignas(SHARD_CACHE_LINE) uint64_t sequence;
+};
+
+static Session defaultSession = {
+    .FractionsLimit = IO_MAX_FRACTIONS,
+    .shardsLock = PTHREAD_MUTEX_INITIALIZER,
+    .unpacked = { &defaultSession.unpackedFractions[0], &defaultSession.unpackedOperator, &defaultSession.unpackedFractions[1], &defaultSession.unpackedFractions[2] },
+    .Running = 1
+};
+
+static __thread Session *current = &defaultSession;
+
+static uint64_t sessionIds = 0;
 
 
 /*
@@ -44,12 +191,12 @@ static Equation *storedEquationsArray[IO_MAX_FRACTIONS];
 
 /*
 
-  To track number of Fractions
+  Fractions that can be stored, starts at IO_MAX_FRACTIONS,
+  only reserve() goes past it. storedFractionsArray has room
+  for FractionsCapacity pointers.
 
 */
 
-int StoredFractionsCount = 0;
-
 
 /*
 
@@ -58,7 +205,63 @@ int StoredFractionsCount = 0;
 */
 
 static int canStoreFractions() {
-    return StoredFractionsCount < IO_MAX_FRACTIONS;
+    return current->StoredFractionsCount < current->FractionsLimit;
+}
+
+/*
+
+  Cuts count consecutive fractions out of a block
+
+*/
+
+static Fraction* allocateFractions(const int count) {
+
+    if (count > current->currentBlockLeft) {
+
+        int size = count > FRACTION_BLOCK ? count : FRACTION_BLOCK;
+
+        Fraction **blocks = (Fraction**) realloc(current->fractionBlocks, (size_t) (current->fractionBlocksCount + 1) * sizeof (Fraction*));
+        Fraction *block = (Fraction*) malloc((size_t) size * sizeof (Fraction));
+
+        if(!blocks || !block) DISPLAY_MALLOC_ERROR
+
+        current->fractionBlocks = blocks;
+        current->fractionBlocks[current->fractionBlocksCount++] = block;
+
+        current->currentBlock = block;
+        current->currentBlockLeft = size;
+    }
+
+    Fraction *f = current->currentBlock;
+
+    current->currentBlock += count;
+    current->currentBlockLeft -= count;
+
+    return f;
+}
+
+/*
+
+  Makes room for count more pointers in storedFractionsArray
+
+*/
+
+static void growFractions(const int count) {
+
+    if (current->StoredFractionsCount + count <= current->FractionsCapacity)
+        return;
+
+    int capacity = current->FractionsCapacity ? current->FractionsCapacity : IO_MAX_FRACTIONS;
+
+    while (capacity < current->StoredFractionsCount + count)
+        capacity *= 2;
+
+    Fraction **array = (Fraction**) realloc(current->storedFractionsArray, (size_t) capacity * sizeof (Fraction*));
+
+    if(!array) DISPLAY_MALLOC_ERROR
+
+    current->storedFractionsArray = array;
+    current->FractionsCapacity = capacity;
 }
 
 /*
@@ -70,10 +273,7 @@ static int canStoreFractions() {
 static Fraction* newFraction() {
 
     // Allocate in Heap
-    Fraction *f = (Fraction*) malloc(sizeof(Fraction));
-
-    // If Null, throw error
-    if(!f) DISPLAY_MALLOC_ERROR
+    Fraction *f = allocateFractions(1);
 
     // Store Values
     f->numerator   = 0;
@@ -91,8 +291,47 @@ static Fraction* newFraction() {
 */
 
 static void StoreFraction(Fraction* f) {
-    storedFractionsArray[StoredFractionsCount] = f;
-    StoredFractionsCount++;
+    TRACE_STAGE(stage)
+    growFractions(1);
+    current->storedFractionsArray[current->StoredFractionsCount] = f;
+    current->StoredFractionsCount++;
+    STATS_COUNT(fractionsStored)
+    TRACE_END(stage, "expression", "store")
+}
+
+/*
+
+  To store many fractions at once, they are handed out
+  as one array to be filled in place
+
+*/
+
+static Fraction* reserveFractions(const int count) {
+
+    if (count <= 0)
+        return NULL;
+
+    TRACE_BEGIN(start)
+
+    growFractions(count);
+
+    Fraction *block = allocateFractions(count);
+
+    for(int i = 0; i < count; i++) {
+        block[i].numerator   = 0;
+        block[i].denomenator = 0;
+        current->storedFractionsArray[current->StoredFractionsCount + i] = &block[i];
+    }
+
+    current->StoredFractionsCount += count;
+    STATS_ADD(fractionsStored, (uint64_t) count)
+
+    if (current->StoredFractionsCount > current->FractionsLimit)
+        current->FractionsLimit = current->StoredFractionsCount;
+
+    TRACE_END(start, "store", "reserve")
+
+    return block;
 }
 
 /*
@@ -102,7 +341,17 @@ static void StoreFraction(Fraction* f) {
 */
 
 static Fraction* getFraction(const int Index) {
-    return storedFractionsArray[Index];
+    return current->storedFractionsArray[Index];
+}
+
+/*
+
+  Number of fractions stored
+
+*/
+
+static int countFractions() {
+    return current->StoredFractionsCount;
 }
 
 /*
@@ -112,8 +361,8 @@ static Fraction* getFraction(const int Index) {
 */
 
 static void forEachFraction(void(*f)(const int,Fraction *restrict)) {
-    for(int i = 0; i < StoredFractionsCount; i++)
-        f(i, storedFractionsArray[i]);
+    for(int i = 0; i < current->StoredFractionsCount; i++)
+        f(i, current->storedFractionsArray[i]);
 }
 
 
@@ -129,13 +378,72 @@ static void forEachFraction(void(*f)(const int,Fraction *restrict)) {
 */
 
 
-/* 
+/*
+
+  Equations a session can store, FRACTIONS_HISTORY or
+  IO_MAX_FRACTIONS
+
+*/
+
+static int historyLimit = 0;
+
+/*
+
+  Packed equations, FRACTIONS_PACKED=1
+
+  Every equation is one word instead of an Equation, its operator
+  and three fractions (about 100 bytes over five allocations):
+
+    bits  0-7   operand 1 numerator     (-128 to 127)
+          8-14  operand 1 denominator   (0 to 127)
+         15-22  operand 2 numerator
+         23-29  operand 2 denominator
+         30-45  result numerator        (-32768 to 32767)
+         46-60  result denominator      (0 to 32767)
+         61-63  operator, + - * / ^ as 0 to 4
+
+  which holds anything inside the limits of IO.h, and the result
+  of + - * / on it. Anything else (big powers, an operator that
+  isn't one of the five) has PACKED_WIDE as its operator, and the
+  rest of the word is its index in the wide table.
+
+*/
 
-  To track number of Equations
+#define PACKED_WIDE 7
+
+#define PACKED_FIELD(word, shift, bits) (((word) >> (shift)) & ((UINT64_C(1) << (bits)) - 1))
+
+static const char packedOperators[] = "+-*/^";
+
+/*
+
+  Worked out once, by readConfiguration(), before the first
+  equation is made or stored, and they don't change after.
+  Until then nothing is stored, and 0 (plain, unsharded) reads
+  the empty stores the same as any mode would.
 
 */
 
-int StoredEquationsCount = 0;
+static int packed = 0;
+static int sharded = 0;
+
+static pthread_once_t configured = PTHREAD_ONCE_INIT;
+
+static void readConfiguration() {
+
+    const char *text = getenv("FRACTIONS_SHARDED");
+    sharded = text && atoi(text) > 0;
+
+    text = getenv("FRACTIONS_PACKED");
+    packed = text && atoi(text) > 0;
+
+    text = getenv("FRACTIONS_HISTORY");
+    historyLimit = text && atoi(text) > 0 ? atoi(text) : IO_MAX_FRACTIONS;
+}
+
+static void configureEquations() {
+    pthread_once(&configured, &readConfiguration);
+}
 
 /*
 
@@ -143,18 +451,65 @@ int StoredEquationsCount = 0;
 
 */
 
+static int countEquations();
+
 static int canStoreEquation() {
-    return StoredEquationsCount < IO_MAX_FRACTIONS;
+    configureEquations();
+    return countEquations() < historyLimit;
 }
 
 /*
 
   To create a new equation
 
+  Packed or sharded, the equation and its fractions are one
+  allocation (fraction blocks are not for many threads), packed
+  it is freed as soon as it is stored.
+
 */
 
+typedef struct {
+    Equation equation;
+    Fraction fractions[3];
+    char operator;
+}
+LooseEquation;
+
+/*
+
+  To free an equation new() made that won't be stored. Its
+  plain fractions are in the session's blocks, freed with it.
+
+*/
+
+static void discardEquation(Equation *restrict e) {
+
+    if (packed || sharded) {
+        free(e);
+        return;
+    }
+
+    free(e->operator);
+    free(e);
+}
+
 static Equation* newEquation(){
 
+    configureEquations();
+
+    if (packed || sharded) {
+
+        LooseEquation *L = (LooseEquation*) malloc(sizeof (LooseEquation));
+
+        if(!L) DISPLAY_MALLOC_ERROR
+
+        L->fractions[0] = L->fractions[1] = L->fractions[2] = (Fraction) { 0, 0 };
+        L->operator = '\n';
+        L->equation = (Equation) { &L->fractions[0], &L->operator, &L->fractions[1], &L->fractions[2] };
+
+        return &L->equation;
+    }
+
     Equation* E = (Equation*) malloc(sizeof (Equation));
     char*     C = (char*) malloc(sizeof (char));
 
@@ -181,13 +536,303 @@ static Equation* newEquation(){
 
 /*
 
-  To store the equation
+  Makes room for one more equation
+
+*/
+
+static void growEquations() {
+
+    if (current->StoredEquationsCount < current->EquationsCapacity)
+        return;
+
+    int capacity = current->EquationsCapacity ? current->EquationsCapacity * 2 : IO_MAX_FRACTIONS;
+
+    if (packed) {
+
+        uint64_t *array = (uint64_t*) realloc(current->packedEquations, (size_t) capacity * sizeof (uint64_t));
+
+        if(!array) DISPLAY_MALLOC_ERROR
+
+        current->packedEquations = array;
+    }
+
+    else {
+
+        Equation **array = (Equation**) realloc(current->storedEquationsArray, (size_t) capacity * sizeof (Equation*));
+
+        if(!array) DISPLAY_MALLOC_ERROR
+
+        current->storedEquationsArray = array;
+    }
+
+    current->EquationsCapacity = capacity;
+}
+
+/*
+
+  Packs a fraction into numeratorBits and denominatorBits,
+  returns 0 if it doesn't fit
+
+*/
+
+static int packFraction(const Fraction *restrict f, const int numeratorBits, const int denominatorBits, uint64_t *restrict bits) {
+
+    int smallest = -(1 << (numeratorBits - 1));
+    int largest = (1 << (numeratorBits - 1)) - 1;
+
+    if (f->numerator < smallest || f->numerator > largest || f->denomenator < 0 || f->denomenator >= (1 << denominatorBits))
+        return 0;
+
+    *bits = ((uint64_t) (uint32_t) f->numerator & ((UINT64_C(1) << numeratorBits) - 1)) | ((uint64_t) f->denomenator << numeratorBits);
+
+    return 1;
+}
+
+static Fraction unpackFraction(const uint64_t bits, const int numeratorBits, const int denominatorBits) {
+
+    uint64_t numerator = PACKED_FIELD(bits, 0, numeratorBits);
+
+    // Sign extends the numerator
+    int value = (int) numerator - (int) ((numerator >> (numeratorBits - 1)) << numeratorBits);
+
+    return (Fraction) { value, (int) PACKED_FIELD(bits, numeratorBits, denominatorBits) };
+}
+
+static uint64_t packEquation(const Equation *restrict e, WideTable *restrict wide) {
+
+    uint64_t operand1, operand2, result;
+    const char *operator = e->operator ? strchr(packedOperators, *e->operator) : NULL;
+
+    if (operator && *operator &&
+        packFraction(e->operand1, 8, 7, &operand1) &&
+        packFraction(e->operand2, 8, 7, &operand2) &&
+        packFraction(e->result, 16, 15, &result))
+        return operand1 | operand2 << 15 | result << 30 | (uint64_t) (operator - packedOperators) << 61;
+
+    if (wide->count == wide->capacity) {
+
+        int capacity = wide->capacity ? wide->capacity * 2 : IO_MAX_FRACTIONS;
+        WideEquation *array = (WideEquation*) realloc(wide->equations, (size_t) capacity * sizeof (WideEquation));
+
+        if(!array) DISPLAY_MALLOC_ERROR
+
+        wide->equations = array;
+        wide->capacity = capacity;
+    }
+
+    wide->equations[wide->count] = (WideEquation) { *e->operand1, *e->operand2, *e->result, *e->operator };
+
+    return (uint64_t) PACKED_WIDE << 61 | (uint64_t) wide->count++;
+}
+
+static Equation* unpackEquation(const uint64_t word, const WideTable *restrict wide) {
+
+    int operator = (int) (word >> 61);
+
+    if (operator == PACKED_WIDE) {
+
+        WideEquation *w = &wide->equations[PACKED_FIELD(word, 0, 61)];
+
+        current->unpackedFractions[0] = w->operand1;
+        current->unpackedFractions[1] = w->operand2;
+        current->unpackedFractions[2] = w->result;
+        current->unpackedOperator = w->operator;
+    }
+
+    else {
+        current->unpackedFractions[0] = unpackFraction(word, 8, 7);
+        current->unpackedFractions[1] = unpackFraction(word >> 15, 8, 7);
+        current->unpackedFractions[2] = unpackFraction(word >> 30, 16, 15);
+        current->unpackedOperator = packedOperators[operator];
+    }
+
+    return &current->unpacked;
+}
+
+/*
+
+  The calling thread's shard of a session, found (or made) once
+  and then kept until it works on another session
+
+*/
+
+static __thread Session *shardSession = NULL;
+static __thread uint64_t shardSessionId = 0;
+static __thread EquationShard *shard = NULL;
+
+static EquationShard* shardOf(Session *S) {
+
+    if (shardSession == S && shardSessionId == S->id)
+        return shard;
+
+    pthread_t self = pthread_self();
+    EquationShard *found = NULL;
+
+    pthread_mutex_lock(&S->shardsLock);
+
+    // A thread that comes back to a session gets its shard back
+    for(int i = 0; i < S->shardCount && !found; i++)
+        if (pthread_equal(S->shards[i]->owner, self))
+            found = S->shards[i];
+
+    if (!found) {
+
+        if (S->shardCount == S->shardCapacity) {
+
+            int capacity = S->shardCapacity ? S->shardCapacity * 2 : 16;
+            EquationShard **array = (EquationShard**) realloc(S->shards, (size_t) capacity * sizeof (EquationShard*));
+
+            if(!array) DISPLAY_MALLOC_ERROR
+
+            S->shards = array;
+            S->shardCapacity = capacity;
+        }
+
+        found = (EquationShard*) aligned_alloc(SHARD_CACHE_LINE, sizeof (EquationShard));
+
+        if(!found) DISPLAY_MALLOC_ERROR
+
+        memset(found, 0, sizeof (EquationShard));
+        found->owner = self;
+
+        S->shards[S->shardCount++] = found;
+    }
+
+    pthread_mutex_unlock(&S->shardsLock);
+
+    shardSession = S;
+    shardSessionId = S->id;
+    shard = found;
+
+    return found;
+}
+
+/*
+
+  Equations in the history, not the numbers taken past its limit
+  that are about to be given back
+
+*/
+
+static uint64_t shardedCount(Session *S) {
+
+    uint64_t taken = __atomic_load_n(&S->sequence, __ATOMIC_ACQUIRE);
+
+    return taken < (uint64_t) historyLimit ? taken : (uint64_t) historyLimit;
+}
+
+static int storeInShard(Session *S, Equation *restrict e) {
+
+    // The check and the place in the history are one atomic write
+    uint64_t slot = __atomic_fetch_add(&S->sequence, 1, __ATOMIC_RELAXED);
+
+    if (slot >= (uint64_t) historyLimit) {
+        __atomic_fetch_sub(&S->sequence, 1, __ATOMIC_RELAXED);
+        return 0;
+    }
+
+    EquationShard *mine = shardOf(S);
+
+    if (mine->count == mine->capacity) {
+
+        int capacity = mine->capacity ? mine->capacity * 2 : IO_MAX_FRACTIONS;
+        ShardEntry *array = (ShardEntry*) realloc(mine->entries, (size_t) capacity * sizeof (ShardEntry));
+
+        if(!array) DISPLAY_MALLOC_ERROR
+
+        mine->entries = array;
+        mine->capacity = capacity;
+    }
+
+    ShardEntry *entry = &mine->entries[mine->count];
+
+    entry->sequence = slot;
+
+    if (packed) {
+        entry->word = packEquation(e, &mine->wide);
+        free(e);
+    }
+
+    else
+        entry->equation = e;
+
+    mine->count++;
+
+    return 1;
+}
+
+/*
+
+  Puts every shard's equations in the view, each at its
+  sequence number, if some were stored since the last time
+
+*/
+
+static void mergeShards(Session *S) {
+
+    uint64_t total = shardedCount(S);
+
+    if (S->viewed == total)
+        return;
+
+    pthread_mutex_lock(&S->shardsLock);
+
+    ShardView *view = (ShardView*) realloc(S->view, (size_t) total * sizeof (ShardView));
+
+    if(!view) DISPLAY_MALLOC_ERROR
+
+    for(int i = 0; i < S->shardCount; i++)
+        for(int j = 0; j < S->shards[i]->count; j++)
+            view[S->shards[i]->entries[j].sequence] = (ShardView) { i, j };
+
+    S->view = view;
+    S->viewed = total;
+
+    pthread_mutex_unlock(&S->shardsLock);
+}
+
+/*
+
+  To store the equation, if the history has room
 
 */
 
-static void StoreEquation(Equation *restrict e) {
-    storedEquationsArray[StoredEquationsCount] = e;
-    StoredEquationsCount++;
+static int StoreEquation(Equation *restrict e) {
+    TRACE_STAGE(stage)
+    configureEquations();
+
+    if (sharded) {
+
+        if (!storeInShard(current, e)) {
+            discardEquation(e);
+            return 0;
+        }
+    }
+
+    else {
+
+        if (current->StoredEquationsCount >= historyLimit) {
+            discardEquation(e);
+            return 0;
+        }
+
+        growEquations();
+
+        if (packed) {
+            current->packedEquations[current->StoredEquationsCount] = packEquation(e, &current->wide);
+            free(e);
+        }
+
+        else
+            current->storedEquationsArray[current->StoredEquationsCount] = e;
+
+        current->StoredEquationsCount++;
+    }
+
+    STATS_COUNT(equationsStored)
+    TRACE_END(stage, "expression", "store")
+
+    return 1;
 }
 
 /*
@@ -197,36 +842,84 @@ static void StoreEquation(Equation *restrict e) {
 */
 
 static Equation* getEquation(const int Index) {
-    return storedEquationsArray[Index];
+
+    if (sharded) {
+
+        mergeShards(current);
+
+        ShardView at = current->view[Index];
+        EquationShard *in = current->shards[at.shard];
+
+        return packed ? unpackEquation(in->entries[at.position].word, &in->wide) : in->entries[at.position].equation;
+    }
+
+    return packed ? unpackEquation(current->packedEquations[Index], &current->wide) : current->storedEquationsArray[Index];
 }
 
 /*
 
-  This is a local-yet-global temperary string storage,
-  used by getEquationFormatted for storing 
-  newly created string.
+  Number of equations stored
+
+*/
+
+static int countEquations() {
+    return sharded ? (int) shardedCount(current) : current->StoredEquationsCount;
+}
 
-  It's local to this file, technically global,
-  but abstracted, 
+/*
 
-  This is will be Garbage collected upon the program
-  ends.
+  Heap the stored equations take, not counting
+  what the allocator adds to each allocation
 
 */
 
-char temp[100];
+static long long equationBytes() {
+
+    if (sharded) {
+
+        long long bytes = (long long) current->shardCapacity * (long long) sizeof (EquationShard*) + (long long) current->viewed * (long long) sizeof (ShardView);
+
+        for(int i = 0; i < current->shardCount; i++)
+            bytes += (long long) sizeof (EquationShard) +
+                (long long) current->shards[i]->capacity * (long long) sizeof (ShardEntry) +
+                (long long) current->shards[i]->wide.capacity * (long long) sizeof (WideEquation);
+
+        if (!packed)
+            bytes += (long long) countEquations() * (long long) sizeof (LooseEquation);
+
+        return bytes;
+    }
+
+    if (packed)
+        return (long long) current->EquationsCapacity * (long long) sizeof (uint64_t) + (long long) current->wide.capacity * (long long) sizeof (WideEquation);
+
+    return (long long) current->EquationsCapacity * (long long) sizeof (Equation*) +
+        (long long) current->StoredEquationsCount * (long long) (sizeof (Equation) + sizeof (char) + 3 * sizeof (Fraction));
+}
+
+/*
+
+  Whether many threads can store into one session at once
+
+*/
+
+static int concurrentEquations() {
+    configureEquations();
+    return sharded;
+}
 
 /*
 
   Takes in the equation, and returns it's string
-  representation
+  representation, in the session's temp, a temperary
+  string storage that the next call writes over
 
 */
 
 static const char *restrict getEquationFormatted(Equation *restrict E){
     snprintf(
-            temp,
-            sizeof (temp),
+            current->temp,
+            sizeof (current->temp),
             "%i/%i %c %i/%i = %i/%i",
              E->operand1->numerator,
              E->operand1->denomenator,
@@ -237,7 +930,7 @@ static const char *restrict getEquationFormatted(Equation *restrict E){
              E->result->denomenator
              );
 
-    return temp;
+    return current->temp;
 }
 
 /*
@@ -247,8 +940,11 @@ static const char *restrict getEquationFormatted(Equation *restrict E){
 */
 
 static void forEachEquation(void(*f)(const int index, Equation *restrict e)){
-    for(int i = 0; i < StoredEquationsCount; i++)
-        f(i,storedEquationsArray[i]);
+
+    int count = countEquations();
+
+    for(int i = 0; i < count; i++)
+        f(i,getEquation(i));
 }
 
 
@@ -270,29 +966,23 @@ static void forEachEquation(void(*f)(const int index, Equation *restrict e)){
 
 /*
 
-  To track if the program can still run
-  (A callent function will set this to 0 via Exit())
-
-*/
-int Running = 1;
-
-/*
-
-  Returns the value of Running
+  Returns the value of Running, which tracks if the program
+  can still run (A callent function will set this to 0 via Exit())
 
   Basically acts as a getter (if you are familiar with OOP)
 
 */
 
 static int CanRun() {
-    return Running;
+    return current->Running;
 }
 
 
 /*
 
-  freeFractions is used to Garbage Collect all fraction
-  instances store in the heap.
+  freeEquations is used to Garbage Collect all equation
+  instances store in the heap. Their fractions live in
+  the fraction blocks, which are freed separately.
 
   Note: 
   
@@ -305,31 +995,154 @@ static int CanRun() {
 
   To make my life easier, I am passing reference for
   this function to forEach, which iterates over each 
-  fraction stored in the memory and passes reference 
+  equation stored in the memory and passes reference 
   to it.
 
   That function passes this function two arguments,
-  int Index, Fraction *f.
+  int Index, Equation *E.
 
-  We ignore Index, and free fracton. As simple as that.
+  We ignore Index, and free the equation. As simple as that.
 
 */
 
-static void freeFractions(__attribute__((unused)) const int Index, Fraction *restrict f){
-    free(f);
+static void freeEquations(__attribute__((unused)) const int Index, Equation *restrict E) {
+    free(E->operator);
+    free(E);
 }
 
 /*
 
-  Same as the function above, but for equations
+  Frees every fraction block of a session
 
 */
 
-static void freeEquations(__attribute__((unused)) const int Index, Equation *restrict E) {
-    free(E->operand1);
-    free(E->operator);
-    free(E->operand2);
-    free(E->result);
+static void freeFractionBlocks(Session *S) {
+
+    for(int i = 0; i < S->fractionBlocksCount; i++)
+        free(S->fractionBlocks[i]);
+
+    free(S->fractionBlocks);
+    free(S->storedFractionsArray);
+
+    S->fractionBlocks = NULL;
+    S->fractionBlocksCount = 0;
+    S->currentBlockLeft = 0;
+    S->storedFractionsArray = NULL;
+    S->StoredFractionsCount = 0;
+    S->FractionsCapacity = 0;
+}
+
+/*
+
+  Garbage Collects everything a session stored
+
+*/
+
+static void freeShards(Session *S) {
+
+    for(int i = 0; i < S->shardCount; i++) {
+
+        EquationShard *in = S->shards[i];
+
+        // Loose equations, one allocation each
+        if (!packed)
+            for(int j = 0; j < in->count; j++)
+                free(in->entries[j].equation);
+
+        free(in->entries);
+        free(in->wide.equations);
+        free(in);
+    }
+
+    free(S->shards);
+    free(S->view);
+
+    S->shards = NULL;
+    S->shardCount = S->shardCapacity = 0;
+    S->view = NULL;
+    S->viewed = 0;
+    S->sequence = 0;
+
+    // No thread keeps a shard that was freed
+    S->id = __atomic_add_fetch(&sessionIds, 1, __ATOMIC_RELAXED);
+}
+
+static void freeStores(Session *S) {
+
+    if (sharded)
+        freeShards(S);
+
+    else if (packed) {
+        free(S->packedEquations);
+        free(S->wide.equations);
+        S->packedEquations = NULL;
+        S->wide = (WideTable) { NULL, 0, 0 };
+    }
+
+    else {
+
+        for(int i = 0; i < S->StoredEquationsCount; i++)
+            freeEquations(i, S->storedEquationsArray[i]);
+
+        free(S->storedEquationsArray);
+        S->storedEquationsArray = NULL;
+    }
+
+    S->StoredEquationsCount = 0;
+    S->EquationsCapacity = 0;
+
+    freeFractionBlocks(S);
+}
+
+/*
+
+  Threads to split work over, FRACTIONS_THREADS or
+  one per CPU. Worked out once, it doesn't change.
+
+*/
+
+static int Threads() {
+
+    static int threads = 0;
+
+    if (!threads) {
+
+        const char *text = getenv("FRACTIONS_THREADS");
+
+        threads = text ? atoi(text) : (int) sysconf(_SC_NPROCESSORS_ONLN);
+
+        if (threads < 1)
+            threads = 1;
+    }
+
+    return threads;
+}
+
+/*
+
+  Runs task on every worker, worker 0 on this thread
+
+*/
+
+static void RunWorkers(void *(*task)(void *), void *workers, size_t size, int count) {
+
+    pthread_t threads[count > 1 ? count : 1];
+    char started[count > 1 ? count : 1];
+
+    for (int t = 1; t < count; t++) {
+
+        started[t] = !pthread_create(&threads[t], NULL, task, (char *) workers + (size_t) t * size);
+
+        // No thread, so this one does the work
+        if (!started[t])
+            task((char *) workers + (size_t) t * size);
+    }
+
+    task(workers);
+
+    for (int t = 1; t < count; t++)
+        if (started[t])
+            pthread_join(threads[t], NULL);
 }
 
 /*
@@ -340,9 +1153,69 @@ static void freeEquations(__attribute__((unused)) const int Index, Equation *res
 */
 
 static void Exit() {
-    forEachFraction(&freeFractions);
-    forEachEquation(&freeEquations);
-    Running = 0;
+    Formulas->free();
+    freeStores(current);
+    current->Running = 0;
+}
+
+
+
+/*
+
+
+  Sessions
+
+
+  Every session is one allocation, its stores
+  grow on their own as it is used.
+
+*/
+
+static Session* createSession() {
+
+    // Aligned for the cache line of its sequence number
+    Session *S = (Session*) aligned_alloc(SHARD_CACHE_LINE, sizeof (Session));
+
+    if(!S) DISPLAY_MALLOC_ERROR
+
+    memset(S, 0, sizeof (Session));
+    pthread_mutex_init(&S->shardsLock, NULL);
+
+    S->id = __atomic_add_fetch(&sessionIds, 1, __ATOMIC_RELAXED);
+    S->FractionsLimit = IO_MAX_FRACTIONS;
+    S->unpacked = (Equation) { &S->unpackedFractions[0], &S->unpackedOperator, &S->unpackedFractions[1], &S->unpackedFractions[2] };
+    S->Running = 1;
+
+    return S;
+}
+
+static void useSession(Session *S) {
+    current = S ? S : &defaultSession;
+}
+
+static Session* currentSession() {
+    return current;
+}
+
+static FormulaStore* sessionFormulas() {
+    return &current->formulas;
+}
+
+static void destroySession(Session *S) {
+
+    if (!S || S == &defaultSession)
+        return;
+
+    // Formulas->free() works on the current session
+    Session *was = current;
+
+    current = S;
+    Formulas->free();
+    current = was == S ? &defaultSession : was;
+
+    freeStores(S);
+    pthread_mutex_destroy(&S->shardsLock);
+    free(S);
 }
 
 
@@ -406,19 +1279,33 @@ const static fractionsDB FractionFunctions = {
   &newFraction,
   &StoreFraction,
   &getFraction,
-  &forEachFraction
+  &forEachFraction,
+  &reserveFractions,
+  &countFractions
 };
 
 const static equationsDB EquationFunctions = {
   &canStoreEquation,
   &newEquation,
+  &discardEquation,
   &StoreEquation,
   &getEquation,
   &getEquationFormatted,
-  &forEachEquation
+  &forEachEquation,
+  &countEquations,
+  &equationBytes,
+  &concurrentEquations
 };
 
-const static software sfw = {&CanRun,&Exit};
+const static software sfw = {&CanRun,&Exit,&Threads,&RunWorkers};
+
+const static sessionsManager SessionFunctions = {
+  &createSession,
+  &useSession,
+  &currentSession,
+  &destroySession,
+  &sessionFormulas
+};
 
 /*
 
@@ -431,5 +1318,7 @@ const equationsDB *restrict Equations = &EquationFunctions;
 
 const software *restrict Software = &sfw;
 
+const sessionsManager *restrict Sessions = &SessionFunctions;
+
 
 
@@ -8,6 +8,8 @@
 #ifndef SOFTWARE
 #define SOFTWARE
 
+#include <stddef.h>
+
 /*
 
   A simple structure to
@@ -160,6 +162,36 @@ typedef struct {
 
   void( *const forEach)(void( * f)(const int index, Fraction * restrict f));
 
+  /*
+  
+    Fraction* reserve(int count)
+
+    Stores count new fractions (0/0) at once, one after the other
+    in memory, and returns the first one so the caller can fill them
+    in place. Goes past IO_MAX_FRACTIONS if it has to, the data base
+    grows instead.
+
+    If count is not positive, returns null
+
+    Access: Fractions->reserve()
+
+  */
+
+  Fraction*(*const reserve)(const int count);
+
+  /*
+  
+    int count()
+
+    Returns how many fractions are stored, they are
+    at the indexes 0 to count() - 1 for get().
+
+    Access: Fractions->count()
+
+  */
+
+  int(*const count)();
+
 }
 fractionsDB;
 
@@ -185,6 +217,16 @@ const fractionsDB * restrict Fractions;
   Hence, to access functions for operations that involve equations,
   call Equations.
 
+  It holds IO_MAX_FRACTIONS equations, or as many as the
+  FRACTIONS_HISTORY environment variable says. With FRACTIONS_PACKED=1,
+  they are stored packed, about 8 bytes each instead of about 100
+  (see Software.c), and unpacked again when they are read.
+
+  With FRACTIONS_SHARDED=1, many threads can Store() into one session
+  at once, each into a shard of its own. get(), forEach() and count()
+  see them all in the order they were stored, once those threads are
+  done storing (they are not for reading while others store).
+
   Example:
     Equation* E = Equationss->new()
     
@@ -205,6 +247,9 @@ typedef struct {
     Returns 1 if there is enough space to store more equations,
     else returns 0
 
+    Sharded, another thread can take the last place before
+    this one stores, so Store() checks again.
+
     Access: Equationss->canStore()
 
   */
@@ -222,6 +267,9 @@ typedef struct {
 
     If there was an error, returns null 
 
+    Packed, it is freed when it is stored, so don't
+    use it after Store().
+
     Access: Equationss->new()
 
   */
@@ -229,25 +277,45 @@ typedef struct {
 
   Equation*( *const new)();
 
+  /*
+
+    void discard(Equation* e)
+
+    Frees an equation from new() that won't be stored,
+    like one that couldn't be evaluated.
+
+    Access: Equations->discard()
+
+  */
+
+  void(*const discard)(Equation * restrict e);
+
   /*
   
-    void Store(Equation* e)
+    int Store(Equation* e)
 
     Takes reference to the newly created strucutre,
     and stores it in the data base internally.
 
+    Returns 1, or 0 if the history is full, and then
+    e is freed instead.
+
     Access: Equationss->Store()
 
   */
 
 
-  void(*const Store)(Equation * restrict e);
+  int(*const Store)(Equation * restrict e);
 
   /*
   
     Equation* get(int Index)
 
     Takes in int Index, and returns the Equation that is stored in that index.
+
+    Packed, it is unpacked into the same Equation every time, which is
+    only good until the next get() or forEach(), and changing it doesn't
+    change what is stored.
     
     Access: Fractions->get()
 
@@ -294,6 +362,44 @@ typedef struct {
   */
 
   void(*const forEach)(void( * f)(const int index, Equation * restrict e));
+
+  /*
+  
+    int count()
+
+    Returns how many equations are stored.
+
+    Access: Equations->count()
+
+  */
+
+  int(*const count)();
+
+  /*
+  
+    long long bytes()
+
+    Returns how much of the heap the stored equations take,
+    not counting what the allocator adds to each allocation.
+
+    Access: Equations->bytes()
+
+  */
+
+  long long(*const bytes)();
+
+  /*
+  
+    int concurrent()
+
+    Returns 1 if many threads can store into one
+    session at once (FRACTIONS_SHARDED=1), else 0.
+
+    Access: Equations->concurrent()
+
+  */
+
+  int(*const concurrent)();
 }
 
 equationsDB;
@@ -365,6 +471,38 @@ typedef struct {
 
   void( *const Exit)();
 
+
+  /*
+
+    int Threads()
+
+    Returns how many threads work that can be split up
+    should use. One per CPU, unless the FRACTIONS_THREADS
+    environment variable says otherwise.
+
+    Access: Software->Threads()
+  
+  */
+
+  int( *const Threads)();
+
+
+  /*
+
+    void RunWorkers(void *(*task)(void *), void *workers, size_t size, int count)
+
+    Runs task on each of count workers, an array
+    of elements size bytes long. Worker 0 runs on
+    the calling thread, the rest on threads of their
+    own, or on the calling one too if none can be
+    started. Returns once every worker is done.
+
+    Access: Software->RunWorkers(task, workers, sizeof *workers, count)
+
+  */
+
+  void( *const RunWorkers)(void *(*task)(void *), void *workers, size_t size, int count);
+
 }
 software;
 
@@ -378,6 +516,113 @@ software;
 extern
 const software * restrict Software;
 
+/*
+
+  Sessions
+
+  Everything Fractions, Equations and Software store is kept in
+  a session. Each thread works on its own current session, which
+  is the default one until it uses another, so one process can
+  keep the stores of many users apart:
+
+    Session *s = Sessions->create();
+
+    Sessions->use(s);
+    Fractions->Store(f);       // into s
+    Sessions->use(NULL);       // back to the default one
+
+    Sessions->destroy(s);
+
+  A session is not locked, only one thread should use it at a time.
+
+  Type: Session
+
+*/
+
+typedef struct Session Session;
+
+// See Formula.h
+typedef struct FormulaStore FormulaStore;
+
+typedef struct {
+
+  /*
+
+    Session* create()
+
+    Creates a session with empty stores.
+
+    Access: Sessions->create()
+
+  */
+
+  Session*(*const create)();
+
+  /*
+
+    void use(Session *s)
+
+    Makes s the calling thread's current session, that
+    Fractions, Equations and Software work on. NULL is
+    the default session.
+
+    Access: Sessions->use()
+
+  */
+
+  void(*const use)(Session *s);
+
+  /*
+
+    Session* current()
+
+    Returns the calling thread's current session.
+
+    Access: Sessions->current()
+
+  */
+
+  Session*(*const current)();
+
+  /*
+
+    void destroy(Session *s)
+
+    Frees s and everything stored in it, formulas too. If it
+    was the calling thread's current session, the default one
+    is used again. The default session can't be destroyed.
+
+    Access: Sessions->destroy()
+
+  */
+
+  void(*const destroy)(Session *s);
+
+  /*
+
+    FormulaStore* formulas()
+
+    Returns the current session's formulas, for Formula.c.
+
+    Access: Sessions->formulas()
+
+  */
+
+  FormulaStore*(*const formulas)();
+
+}
+sessionsManager;
+
+/*
+
+  Call this, Sessions, to access all
+  the publicly available functions.
+
+*/
+
+extern
+const sessionsManager * restrict Sessions;
+
 /* -- End -- */
 
 #endif
\ No newline at end of file
@@ -0,0 +1,365 @@
+/*
+
+  Sort
+
+  Why comparing doubles first is exact:
+
+    Numerators and denominators are ints, so they are exact as
+    doubles, and division rounds correctly, which never swaps the
+    order of two numbers. So if the doubles of a/b and c/d differ,
+    the fractions are in the same order. Only equal doubles (the
+    same value, or values closer than a double can tell apart)
+    need the exact cross multiplication. 32 bit ints multiply
+    exactly in 64 bits.
+
+  The fractions are copied into SortItems, with their double, so
+  the comparisons read memory in order, sorted, and copied back.
+
+  Merge sort, run by SORT_MAX_THREADS threads at most:
+
+    1. each thread sorts its share (insertion sort of small
+       pieces, then merging pieces of doubling width)
+    2. the shares are merged in pairs, each pair on a thread,
+       until one run is left
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "Software.h"
+#include "Sort.h"
+#include "Formula.h"
+
+#define DISPLAY_MALLOC_ERROR { fprintf(stderr, "FATAL ERROR: UNABLE TO ALLOCATE MEMORY IN HEAP"); exit(-1); }
+
+/*
+
+  Pieces this small are insertion sorted
+
+*/
+
+#define SORT_INSERTION 16
+
+/*
+
+  Fewest fractions worth a thread of their own
+
+*/
+
+#define SORT_PER_THREAD 65536
+
+/*
+
+  Most threads used
+
+*/
+
+#define SORT_MAX_THREADS 64
+
+/*
+
+  A fraction and its value as a double
+
+  Type: SortItem
+
+*/
+
+typedef struct {
+
+  double value;
+
+  int numerator;
+  int denomenator;
+
+}
+SortItem;
+
+/*
+
+  One thread's part of a step
+
+  Type: SortWorker
+
+*/
+
+typedef struct {
+
+  // Read from, and written to
+  SortItem *from;
+  SortItem *to;
+
+  // Runs first to middle - 1 and middle to last - 1
+  long first;
+  long middle;
+  long last;
+
+}
+SortWorker;
+
+static int compareExactly(const int n1, const int d1, const int n2, const int d2) {
+
+  int64_t left  = (int64_t) n1 * d2;
+  int64_t right = (int64_t) n2 * d1;
+
+  // Multiplying by a negative denominator turns it around
+  if ((d1 < 0) != (d2 < 0)) {
+    int64_t t = left;
+    left = right;
+    right = t;
+  }
+
+  return (left > right) - (left < right);
+}
+
+static int compare(const Fraction *a, const Fraction *b) {
+  return compareExactly(a->numerator, a->denomenator, b->numerator, b->denomenator);
+}
+
+static inline int before(const SortItem *a, const SortItem *b) {
+
+  if (a->value != b->value)
+    return a->value < b->value;
+
+  return compareExactly(a->numerator, a->denomenator, b->numerator, b->denomenator) < 0;
+}
+
+static SortItem itemFor(const Fraction *f) {
+
+  /*
+
+    0/0 (reserved, not filled in yet) has no value,
+    it goes last, like an infinity.
+
+  */
+
+  double value = f->denomenator ? (double) f->numerator / f->denomenator : INFINITY;
+
+  return (SortItem) { value, f->numerator, f->denomenator };
+}
+
+/*
+
+  Merges a[0 .. an - 1] and b[0 .. bn - 1] into to,
+  taking from a first when equal, so it is stable
+
+*/
+
+static void merge(const SortItem *a, const long an, const SortItem *b, const long bn, SortItem *to) {
+
+  long i = 0, j = 0, k = 0;
+
+  while (i < an && j < bn)
+    to[k++] = before(&b[j], &a[i]) ? b[j++] : a[i++];
+
+  while (i < an)
+    to[k++] = a[i++];
+
+  while (j < bn)
+    to[k++] = b[j++];
+}
+
+static void insertionSort(SortItem *a, const long count) {
+
+  for (long i = 1; i < count; i++) {
+
+    SortItem item = a[i];
+    long j = i;
+
+    while (j > 0 && before(&item, &a[j - 1])) {
+      a[j] = a[j - 1];
+      j--;
+    }
+
+    a[j] = item;
+  }
+}
+
+/*
+
+  Sorts a[0 .. count - 1], tmp has room for count items.
+  The result ends up in a.
+
+*/
+
+static void sortRun(SortItem *a, SortItem *tmp, const long count) {
+
+  for (long i = 0; i < count; i += SORT_INSERTION)
+    insertionSort(a + i, count - i < SORT_INSERTION ? count - i : SORT_INSERTION);
+
+  SortItem *from = a, *to = tmp;
+
+  for (long width = SORT_INSERTION; width < count; width *= 2) {
+
+    for (long first = 0; first < count; first += 2 * width) {
+
+      long middle = first + width < count ? first + width : count;
+      long last = first + 2 * width < count ? first + 2 * width : count;
+
+      merge(from + first, middle - first, from + middle, last - middle, to + first);
+    }
+
+    SortItem *t = from;
+    from = to;
+    to = t;
+  }
+
+  if (from != a)
+    memcpy(a, from, (size_t) count * sizeof (SortItem));
+}
+
+static void *sortShare(void *argument) {
+
+  SortWorker *w = argument;
+
+  sortRun(w->from + w->first, w->to + w->first, w->last - w->first);
+
+  return NULL;
+}
+
+static void *mergeShares(void *argument) {
+
+  SortWorker *w = argument;
+
+  merge(
+    w->from + w->first, w->middle - w->first,
+    w->from + w->middle, w->last - w->middle,
+    w->to + w->first);
+
+  return NULL;
+}
+
+static void sortItems(SortItem *items, const long count) {
+
+  SortItem *tmp = malloc((size_t) (count ? count : 1) * sizeof (SortItem));
+
+  if (!tmp) DISPLAY_MALLOC_ERROR
+
+  long threads = Software->Threads();
+
+  if (threads > count / SORT_PER_THREAD)
+    threads = count / SORT_PER_THREAD;
+
+  if (threads > SORT_MAX_THREADS)
+    threads = SORT_MAX_THREADS;
+
+  if (threads < 1)
+    threads = 1;
+
+  // Where each share starts, share t is bounds[t] to bounds[t + 1] - 1
+  long bounds[SORT_MAX_THREADS + 1];
+
+  for (long t = 0; t <= threads; t++)
+    bounds[t] = count * t / threads;
+
+  SortWorker workers[SORT_MAX_THREADS];
+
+  for (long t = 0; t < threads; t++)
+    workers[t] = (SortWorker) { items, tmp, bounds[t], bounds[t], bounds[t + 1] };
+
+  Software->RunWorkers(&sortShare, workers, sizeof *workers, (int) threads);
+
+  // Merge neighbouring runs in pairs until one is left
+  SortItem *from = items, *to = tmp;
+
+  for (long step = 1; step < threads; step *= 2) {
+
+    int pairs = 0;
+
+    for (long t = 0; t < threads; t += 2 * step) {
+
+      long middle = t + step < threads ? t + step : threads;
+      long last = t + 2 * step < threads ? t + 2 * step : threads;
+
+      // A run without a partner is merged with nothing, which copies it
+      workers[pairs++] = (SortWorker) { from, to, bounds[t], bounds[middle], bounds[last] };
+    }
+
+    Software->RunWorkers(&mergeShares, workers, sizeof *workers, pairs);
+
+    SortItem *t = from;
+    from = to;
+    to = t;
+  }
+
+  if (from != items)
+    memcpy(items, from, (size_t) count * sizeof (SortItem));
+
+  free(tmp);
+}
+
+static void fractions(Fraction *restrict f, long count) {
+
+  if (count < 2)
+    return;
+
+  SortItem *items = malloc((size_t) count * sizeof (SortItem));
+
+  if (!items) DISPLAY_MALLOC_ERROR
+
+  for (long i = 0; i < count; i++)
+    items[i] = itemFor(&f[i]);
+
+  sortItems(items, count);
+
+  for (long i = 0; i < count; i++)
+    f[i] = (Fraction) { items[i].numerator, items[i].denomenator };
+
+  free(items);
+}
+
+/*
+
+  The data base holds pointers to fractions, which can be anywhere,
+  the values are gathered, sorted, and written back in order.
+
+*/
+
+static void store() {
+
+  int count = Fractions->count();
+
+  if (count < 2)
+    return;
+
+  SortItem *items = malloc((size_t) count * sizeof (SortItem));
+
+  if (!items) DISPLAY_MALLOC_ERROR
+
+  for (int i = 0; i < count; i++)
+    items[i] = itemFor(Fractions->get(i));
+
+  sortItems(items, count);
+
+  for (int i = 0; i < count; i++) {
+
+    Fraction *f = Fractions->get(i);
+
+    if (f->numerator == items[i].numerator && f->denomenator == items[i].denomenator)
+      continue;
+
+    *f = (Fraction) { items[i].numerator, items[i].denomenator };
+
+    // A fraction that moved changes the formulas that use its index
+    Formulas->changed(i);
+  }
+
+  free(items);
+}
+
+/*
+
+  Abstraction, same as in Software.c
+
+*/
+
+const static fractionSorter SortFunctions = {
+  &compare,
+  &fractions,
+  &store
+};
+
+const fractionSorter *restrict Sort = &SortFunctions;
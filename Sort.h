@@ -0,0 +1,74 @@
+/*
+
+  Sort
+
+  Puts fractions in order of their exact value, smallest first.
+  Fractions of equal value keep the order they were in.
+
+  Each fraction is compared by its value as a double, and only
+  when two doubles are equal are the fractions cross multiplied
+  (a/b < c/d when a * d < c * b) to tell them apart exactly.
+  Large arrays are merge sorted on one thread per CPU, and the
+  sorted runs are merged in pairs, also in parallel.
+
+*/
+
+#ifndef SORT
+#define SORT
+
+#include "Software.h"
+
+typedef struct {
+
+  /*
+
+    int compare(Fraction *a, Fraction *b)
+
+    Returns below 0, 0 or above 0 as the value of a is
+    below, equal to or above the value of b, exactly.
+
+    Access: Sort->compare()
+
+  */
+
+  int(*const compare)(const Fraction *a, const Fraction *b);
+
+  /*
+
+    void fractions(Fraction *f, long count)
+
+    Sorts count fractions in place.
+
+    Access: Sort->fractions()
+
+  */
+
+  void(*const fractions)(Fraction * restrict f, long count);
+
+  /*
+
+    void store()
+
+    Sorts the fractions data base, so Fractions->get(0)
+    is the smallest stored fraction.
+
+    Access: Sort->store()
+
+  */
+
+  void(*const store)();
+
+}
+fractionSorter;
+
+/*
+
+  Call this, Sort, to access all
+  the publicly available functions.
+
+*/
+
+extern
+const fractionSorter * restrict Sort;
+
+#endif //Sort.h
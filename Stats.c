@@ -0,0 +1,255 @@
+/*
+
+  Stats
+
+  The blocks are given out under a lock, once per thread, and are
+  never freed: a thread that ends keeps its counts in the totals.
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <time.h>
+#include <signal.h>
+#include <pthread.h>
+
+#include "Software.h"
+#include "Operations.h"
+#include "Stats.h"
+
+#define DISPLAY_MALLOC_ERROR { fprintf(stderr, "FATAL ERROR: UNABLE TO ALLOCATE MEMORY IN HEAP"); exit(-1); }
+
+__thread StatsThread *statsMine = NULL;
+
+static StatsThread *blocks[STATS_MAX_THREADS];
+static int blockCount = 0;
+
+static pthread_mutex_t blocksLock = PTHREAD_MUTEX_INITIALIZER;
+
+static StatsThread *thread() {
+
+  pthread_mutex_lock(&blocksLock);
+
+  if (blockCount < STATS_MAX_THREADS) {
+
+    StatsThread *block = aligned_alloc(STATS_CACHE_LINE, sizeof (StatsThread));
+
+    if (!block) DISPLAY_MALLOC_ERROR
+
+    memset(block, 0, sizeof (StatsThread));
+
+    blocks[blockCount++] = block;
+  }
+
+  statsMine = blocks[blockCount - 1];
+
+  pthread_mutex_unlock(&blocksLock);
+
+  return statsMine;
+}
+
+static uint64_t now() {
+
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+
+  return (uint64_t) t.tv_sec * 1000000000ULL + (uint64_t) t.tv_nsec;
+}
+
+/*
+
+  Below 16 ns a bucket per ns, then the power of 2 and the next
+  4 bits pick the bucket
+
+*/
+
+static int bucketOf(uint64_t nanoseconds) {
+
+  if (nanoseconds < STATS_SUB_BUCKETS)
+    return (int) nanoseconds;
+
+  int power = 63 - __builtin_clzll(nanoseconds);
+
+  if (power > STATS_MAX_POWER)
+    return STATS_BUCKETS - 1;
+
+  return (power - STATS_SUB_BITS + 1) * STATS_SUB_BUCKETS + (int) ((nanoseconds >> (power - STATS_SUB_BITS)) & (STATS_SUB_BUCKETS - 1));
+}
+
+static void record(uint64_t *restrict histogram, uint64_t nanoseconds) {
+
+  uint64_t *bucket = &histogram[bucketOf(nanoseconds)];
+
+  __atomic_store_n(bucket, __atomic_load_n(bucket, __ATOMIC_RELAXED) + 1, __ATOMIC_RELAXED);
+}
+
+#ifndef FRACTIONS_NO_STATS
+
+static const char operators[STATS_OPERATORS] = { OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_POW };
+
+/*
+
+  Percentiles shown for every histogram
+
+*/
+
+static const double percentiles[] = { 50, 90, 99, 99.9 };
+
+#define STATS_PERCENTILES ((int) (sizeof (percentiles) / sizeof (percentiles[0])))
+
+/*
+
+  The largest time that goes in a bucket
+
+*/
+
+static uint64_t bucketTop(int bucket) {
+
+  if (bucket < STATS_SUB_BUCKETS)
+    return (uint64_t) bucket;
+
+  int power = bucket / STATS_SUB_BUCKETS + STATS_SUB_BITS - 1;
+  uint64_t sub = (uint64_t) (bucket % STATS_SUB_BUCKETS);
+
+  return ((STATS_SUB_BUCKETS + sub + 1) << (power - STATS_SUB_BITS)) - 1;
+}
+
+/*
+
+  Adds up one counter over every block
+
+*/
+
+static uint64_t total(size_t offset) {
+
+  uint64_t sum = 0;
+
+  for (int i = 0; i < blockCount; i++)
+    sum += __atomic_load_n((uint64_t *) ((char *) blocks[i] + offset), __ATOMIC_RELAXED);
+
+  return sum;
+}
+
+#define STATS_TOTAL(field) total(offsetof(StatsThread, field))
+
+static void showOperator(FILE *out, int o) {
+
+  static uint64_t histogram[STATS_BUCKETS];
+  uint64_t sampled = 0;
+
+  for (int b = 0; b < STATS_BUCKETS; b++) {
+    histogram[b] = STATS_TOTAL(histogram[o][b]);
+    sampled += histogram[b];
+  }
+
+  fprintf(out, "  %c %14llu %10llu %10llu", operators[o],
+    (unsigned long long) STATS_TOTAL(operations[o]),
+    (unsigned long long) STATS_TOTAL(failures[o]),
+    (unsigned long long) sampled);
+
+  if (!sampled) {
+    fprintf(out, "\n");
+    return;
+  }
+
+  uint64_t seen = 0;
+  int b = 0;
+
+  for (int p = 0; p < STATS_PERCENTILES; p++) {
+
+    // The first bucket where the count reaches the percentile
+    uint64_t wanted = (uint64_t) ((double) sampled * percentiles[p] / 100);
+
+    while (b < STATS_BUCKETS - 1 && seen + histogram[b] <= wanted)
+      seen += histogram[b++];
+
+    fprintf(out, " %9llu", (unsigned long long) bucketTop(b));
+  }
+
+  int top = STATS_BUCKETS - 1;
+
+  while (!histogram[top])
+    top--;
+
+  fprintf(out, " %9llu\n", (unsigned long long) bucketTop(top));
+}
+
+#endif
+
+static void show(FILE *restrict out) {
+
+#ifdef FRACTIONS_NO_STATS
+
+  fprintf(out, "Stats were left out of this build (FRACTIONS_NO_STATS)\n");
+
+#else
+
+  pthread_mutex_lock(&blocksLock);
+
+  fprintf(out, "Stats of %i threads, latencies in ns, 1 in %i timed\n", blockCount, STATS_SAMPLE_EVERY);
+  fprintf(out, "  op          count     failed    sampled       p50       p90       p99     p99.9       max\n");
+
+  for (int o = 0; o < STATS_OPERATORS; o++)
+    showOperator(out, o);
+
+  fprintf(out, "  Expressions parsed: %llu, invalid: %llu\n",
+    (unsigned long long) STATS_TOTAL(parses), (unsigned long long) STATS_TOTAL(invalidParses));
+
+  fprintf(out, "  Fractions stored: %llu, equations stored: %llu\n",
+    (unsigned long long) STATS_TOTAL(fractionsStored), (unsigned long long) STATS_TOTAL(equationsStored));
+
+  pthread_mutex_unlock(&blocksLock);
+
+#endif
+
+  fflush(out);
+}
+
+/*
+
+  Waits for SIGUSR1, forever
+
+*/
+
+static void *listener(void *set) {
+
+  int signal;
+
+  while (!sigwait(set, &signal))
+    show(stderr);
+
+  return NULL;
+}
+
+static void startListener() {
+
+  static sigset_t set;
+  pthread_t id;
+
+  sigemptyset(&set);
+  sigaddset(&set, SIGUSR1);
+
+  pthread_sigmask(SIG_BLOCK, &set, NULL);
+
+  if (!pthread_create(&id, NULL, &listener, &set))
+    pthread_detach(id);
+}
+
+/*
+
+  Abstraction, same as in Software.c
+
+*/
+
+const static statsRecorder StatsFunctions = {
+  &thread,
+  &show,
+  &startListener,
+  &now,
+  &record
+};
+
+const statsRecorder *restrict Stats = &StatsFunctions;
@@ -0,0 +1,245 @@
+/*
+
+  Stats
+
+  Counters and latency histograms of what the program does:
+
+    - Operation(), for each operator: how many, how many failed,
+      and how long they took
+    - parseExpression() (and so setExpressionParts()): how many,
+      how many were invalid
+    - Fractions->Store() / reserve() and Equations->Store():
+      how many were added
+
+  Every thread counts into a block of its own, aligned to a cache
+  line, so counting is a plain increment with nothing shared. The
+  blocks are only added up when they are shown: option 15 in the
+  menu, or kill -USR1 on the process, which writes them to stderr
+  in any mode.
+
+  Latencies go into HDR style histograms: a bucket for every 1/16
+  of each power of 2 (6.25% apart at most), from 1 ns up. Reading
+  the clock costs more than most operations, so only one operation
+  in STATS_SAMPLE_EVERY of each operator is timed (picked by its
+  own counter, so that costs nothing more), and the time includes
+  reading the clock once; the counters count every operation.
+
+  Building with -DFRACTIONS_NO_STATS removes all of it: the STATS_*
+  macros below are then empty, and Stats->show() says so.
+
+*/
+
+#ifndef STATS
+#define STATS
+
+#include <stdio.h>
+#include <stdint.h>
+
+#define STATS_CACHE_LINE 64
+
+/*
+
+  Threads with a block of their own, the ones after
+  share the last block (their counts may then be off)
+
+*/
+
+#define STATS_MAX_THREADS 256
+
+/*
+
+  One operation in this many is timed, on each thread,
+  a power of 2
+
+*/
+
+#define STATS_SAMPLE_EVERY 1024
+
+/*
+
+  Histogram buckets: 16 for 0 ns to 15 ns, then 16 for each
+  power of 2 up to 2^40 ns (18 minutes, longer goes in the last)
+
+*/
+
+#define STATS_SUB_BUCKETS 16
+#define STATS_SUB_BITS 4
+#define STATS_MAX_POWER 40
+#define STATS_BUCKETS (STATS_SUB_BUCKETS * (STATS_MAX_POWER - STATS_SUB_BITS + 2))
+
+/*
+
+  Operators, in the order of Operations.h
+
+*/
+
+#define STATS_OPERATORS 5
+
+/*
+
+  What one thread counted
+
+  Type: StatsThread
+
+*/
+
+typedef struct {
+
+  _Alignas(STATS_CACHE_LINE) uint64_t operations[STATS_OPERATORS];
+  uint64_t failures[STATS_OPERATORS];
+
+  uint64_t parses;
+  uint64_t invalidParses;
+
+  uint64_t fractionsStored;
+  uint64_t equationsStored;
+
+  uint64_t histogram[STATS_OPERATORS][STATS_BUCKETS];
+
+}
+StatsThread;
+
+typedef struct {
+
+  /*
+
+    StatsThread* thread()
+
+    The block of the calling thread, given out the
+    first time the thread asks for it.
+
+    Access: Stats->thread()
+
+  */
+
+  StatsThread*(*const thread)();
+
+  /*
+
+    void show(FILE *out)
+
+    Writes every counter, and the percentiles of every
+    histogram, all threads added up, to out.
+
+    Access: Stats->show()
+
+  */
+
+  void(*const show)(FILE * restrict out);
+
+  /*
+
+    void listen()
+
+    Blocks SIGUSR1 in the calling thread, and in every thread it
+    starts after this, and starts a thread that waits for it and
+    calls show(stderr). Call it at the start of main(), before
+    any other thread is started.
+
+    Access: Stats->listen()
+
+  */
+
+  void(*const listen)();
+
+  /*
+
+    uint64_t now()
+
+    Nanoseconds on the monotonic clock.
+
+    Access: Stats->now()
+
+  */
+
+  uint64_t(*const now)();
+
+  /*
+
+    void record(uint64_t *histogram, uint64_t nanoseconds)
+
+    Adds one latency to a histogram of STATS_BUCKETS.
+
+    Access: Stats->record()
+
+  */
+
+  void(*const record)(uint64_t * restrict histogram, uint64_t nanoseconds);
+
+}
+statsRecorder;
+
+/*
+
+  Call this, Stats, to access all
+  the publicly available functions.
+
+*/
+
+extern
+const statsRecorder * restrict Stats;
+
+#ifndef FRACTIONS_NO_STATS
+
+/*
+
+  The calling thread's block, NULL until it asks
+
+*/
+
+extern __thread StatsThread *statsMine;
+
+static inline StatsThread *statsThread() {
+
+  StatsThread *mine = statsMine;
+
+  if (__builtin_expect(!mine, 0))
+    mine = Stats->thread();
+
+  return mine;
+}
+
+/*
+
+  Only this thread writes its block, show() reads it from another,
+  relaxed atomics keep that defined without a locked instruction
+
+*/
+
+#define STATS_INCREASE(counter, amount) \
+  __atomic_store_n(&(counter), __atomic_load_n(&(counter), __ATOMIC_RELAXED) + (amount), __ATOMIC_RELAXED)
+
+#define STATS_ADD(field, amount) { STATS_INCREASE(statsThread()->field, amount); }
+
+#define STATS_COUNT(field) STATS_ADD(field, 1)
+
+/*
+
+  done = call, counted as an operation with operator index
+  (0 to STATS_OPERATORS - 1), a failure if done is 0, and timed
+  if it is one in STATS_SAMPLE_EVERY
+
+*/
+
+#define STATS_OPERATION(index, done, call) { \
+  StatsThread *statsBlock = statsThread(); \
+  uint64_t statsCount = __atomic_load_n(&statsBlock->operations[index], __ATOMIC_RELAXED); \
+  __atomic_store_n(&statsBlock->operations[index], statsCount + 1, __ATOMIC_RELAXED); \
+  if (__builtin_expect(!(statsCount & (STATS_SAMPLE_EVERY - 1)), 0)) { \
+    uint64_t statsStart = Stats->now(); \
+    done = (call); \
+    Stats->record(statsBlock->histogram[index], Stats->now() - statsStart); } \
+  else \
+    done = (call); \
+  if (__builtin_expect(!(done), 0)) \
+    STATS_INCREASE(statsBlock->failures[index], 1); }
+
+#else
+
+#define STATS_ADD(field, amount) { }
+#define STATS_COUNT(field) { }
+#define STATS_OPERATION(index, done, call) { done = (call); }
+
+#endif
+
+#endif //Stats.h
@@ -0,0 +1,145 @@
+/*
+
+  Tables
+
+  Generated by tools/GenerateTables.c from the limits in IO.h,
+  don't edit it, run that again instead.
+
+  TablesGCD[n][d] is the greatest common divisor of n and d, for
+  every size of numerator and denominator IO.h allows, and
+  x / d is (x * TablesReciprocal[d]) >> TABLES_RECIPROCAL_SHIFT
+  for every x and d up to TABLES_LARGEST (32 bit products).
+
+*/
+
+#ifndef TABLES
+#define TABLES
+
+#include <stdint.h>
+#include "IO.h"
+
+#define TABLES_NUMERATORS 99
+#define TABLES_DENOMINATORS 99
+#define TABLES_LARGEST 99
+#define TABLES_RECIPROCAL_SHIFT 13
+
+#if TABLES_NUMERATORS != (-IO_MIN_NUMERATOR > IO_MAX_NUMERATOR ? -IO_MIN_NUMERATOR : IO_MAX_NUMERATOR) || TABLES_DENOMINATORS != IO_MAX_DENOMINATOR
+#error "Tables.h doesn't match the limits in IO.h, run tools/GenerateTables.c again"
+#endif
+
+static const unsigned char TablesGCD[TABLES_NUMERATORS + 1][TABLES_DENOMINATORS + 1] = {
+  {0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,21,22,23,24,25,26,27,28,29,30,31,32,33,34,35,36,37,38,39,40,41,42,43,44,45,46,47,48,49,50,51,52,53,54,55,56,57,58,59,60,61,62,63,64,65,66,67,68,69,70,71,72,73,74,75,76,77,78,79,80,81,82,83,84,85,86,87,88,89,90,91,92,93,94,95,96,97,98,99},
+  {1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1},
+  {2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1},
+  {3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3},
+  {4,1,2,1,4,1,2,1,4,1,2,1,4,1,2,1,4,1,2,1,4,1,2,1,4,1,2,1,4,1,2,1,4,1,2,1,4,1,2,1,4,1,2,1,4,1,2,1,4,1,2,1,4,1,2,1,4,1,2,1,4,1,2,1,4,1,2,1,4,1,2,1,4,1,2,1,4,1,2,1,4,1,2,1,4,1,2,1,4,1,2,1,4,1,2,1,4,1,2,1},
+  {5,1,1,1,1,5,1,1,1,1,5,1,1,1,1,5,1,1,1,1,5,1,1,1,1,5,1,1,1,1,5,1,1,1,1,5,1,1,1,1,5,1,1,1,1,5,1,1,1,1,5,1,1,1,1,5,1,1,1,1,5,1,1,1,1,5,1,1,1,1,5,1,1,1,1,5,1,1,1,1,5,1,1,1,1,5,1,1,1,1,5,1,1,1,1,5,1,1,1,1},
+  {6,1,2,3,2,1,6,1,2,3,2,1,6,1,2,3,2,1,6,1,2,3,2,1,6,1,2,3,2,1,6,1,2,3,2,1,6,1,2,3,2,1,6,1,2,3,2,1,6,1,2,3,2,1,6,1,2,3,2,1,6,1,2,3,2,1,6,1,2,3,2,1,6,1,2,3,2,1,6,1,2,3,2,1,6,1,2,3,2,1,6,1,2,3,2,1,6,1,2,3},
+  {7,1,1,1,1,1,1,7,1,1,1,1,1,1,7,1,1,1,1,1,1,7,1,1,1,1,1,1,7,1,1,1,1,1,1,7,1,1,1,1,1,1,7,1,1,1,1,1,1,7,1,1,1,1,1,1,7,1,1,1,1,1,1,7,1,1,1,1,1,1,7,1,1,1,1,1,1,7,1,1,1,1,1,1,7,1,1,1,1,1,1,7,1,1,1,1,1,1,7,1},
+  {8,1,2,1,4,1,2,1,8,1,2,1,4,1,2,1,8,1,2,1,4,1,2,1,8,1,2,1,4,1,2,1,8,1,2,1,4,1,2,1,8,1,2,1,4,1,2,1,8,1,2,1,4,1,2,1,8,1,2,1,4,1,2,1,8,1,2,1,4,1,2,1,8,1,2,1,4,1,2,1,8,1,2,1,4,1,2,1,8,1,2,1,4,1,2,1,8,1,2,1},
+  {9,1,1,3,1,1,3,1,1,9,1,1,3,1,1,3,1,1,9,1,1,3,1,1,3,1,1,9,1,1,3,1,1,3,1,1,9,1,1,3,1,1,3,1,1,9,1,1,3,1,1,3,1,1,9,1,1,3,1,1,3,1,1,9,1,1,3,1,1,3,1,1,9,1,1,3,1,1,3,1,1,9,1,1,3,1,1,3,1,1,9,1,1,3,1,1,3,1,1,9},
+  {10,1,2,1,2,5,2,1,2,1,10,1,2,1,2,5,2,1,2,1,10,1,2,1,2,5,2,1,2,1,10,1,2,1,2,5,2,1,2,1,10,1,2,1,2,5,2,1,2,1,10,1,2,1,2,5,2,1,2,1,10,1,2,1,2,5,2,1,2,1,10,1,2,1,2,5,2,1,2,1,10,1,2,1,2,5,2,1,2,1,10,1,2,1,2,5,2,1,2,1},
+  {11,1,1,1,1,1,1,1,1,1,1,11,1,1,1,1,1,1,1,1,1,1,11,1,1,1,1,1,1,1,1,1,1,11,1,1,1,1,1,1,1,1,1,1,11,1,1,1,1,1,1,1,1,1,1,11,1,1,1,1,1,1,1,1,1,1,11,1,1,1,1,1,1,1,1,1,1,11,1,1,1,1,1,1,1,1,1,1,11,1,1,1,1,1,1,1,1,1,1,11},
+  {12,1,2,3,4,1,6,1,4,3,2,1,12,1,2,3,4,1,6,1,4,3,2,1,12,1,2,3,4,1,6,1,4,3,2,1,12,1,2,3,4,1,6,1,4,3,2,1,12,1,2,3,4,1,6,1,4,3,2,1,12,1,2,3,4,1,6,1,4,3,2,1,12,1,2,3,4,1,6,1,4,3,2,1,12,1,2,3,4,1,6,1,4,3,2,1,12,1,2,3},
+  {13,1,1,1,1,1,1,1,1,1,1,1,1,13,1,1,1,1,1,1,1,1,1,1,1,1,13,1,1,1,1,1,1,1,1,1,1,1,1,13,1,1,1,1,1,1,1,1,1,1,1,1,13,1,1,1,1,1,1,1,1,1,1,1,1,13,1,1,1,1,1,1,1,1,1,1,1,1,13,1,1,1,1,1,1,1,1,1,1,1,1,13,1,1,1,1,1,1,1,1},
+  {14,1,2,1,2,1,2,7,2,1,2,1,2,1,14,1,2,1,2,1,2,7,2,1,2,1,2,1,14,1,2,1,2,1,2,7,2,1,2,1,2,1,14,1,2,1,2,1,2,7,2,1,2,1,2,1,14,1,2,1,2,1,2,7,2,1,2,1,2,1,14,1,2,1,2,1,2,7,2,1,2,1,2,1,14,1,2,1,2,1,2,7,2,1,2,1,2,1,14,1},
+  {15,1,1,3,1,5,3,1,1,3,5,1,3,1,1,15,1,1,3,1,5,3,1,1,3,5,1,3,1,1,15,1,1,3,1,5,3,1,1,3,5,1,3,1,1,15,1,1,3,1,5,3,1,1,3,5,1,3,1,1,15,1,1,3,1,5,3,1,1,3,5,1,3,1,1,15,1,1,3,1,5,3,1,1,3,5,1,3,1,1,15,1,1,3,1,5,3,1,1,3},
+  {16,1,2,1,4,1,2,1,8,1,2,1,4,1,2,1,16,1,2,1,4,1,2,1,8,1,2,1,4,1,2,1,16,1,2,1,4,1,2,1,8,1,2,1,4,1,2,1,16,1,2,1,4,1,2,1,8,1,2,1,4,1,2,1,16,1,2,1,4,1,2,1,8,1,2,1,4,1,2,1,16,1,2,1,4,1,2,1,8,1,2,1,4,1,2,1,16,1,2,1},
+  {17,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,17,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,17,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,17,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,17,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,17,1,1,1,1,1,1,1,1,1,1,1,1,1,1},
+  {18,1,2,3,2,1,6,1,2,9,2,1,6,1,2,3,2,1,18,1,2,3,2,1,6,1,2,9,2,1,6,1,2,3,2,1,18,1,2,3,2,1,6,1,2,9,2,1,6,1,2,3,2,1,18,1,2,3,2,1,6,1,2,9,2,1,6,1,2,3,2,1,18,1,2,3,2,1,6,1,2,9,2,1,6,1,2,3,2,1,18,1,2,3,2,1,6,1,2,9},
+  {19,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,19,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,19,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,19,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,19,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,19,1,1,1,1},
+  {20,1,2,1,4,5,2,1,4,1,10,1,4,1,2,5,4,1,2,1,20,1,2,1,4,5,2,1,4,1,10,1,4,1,2,5,4,1,2,1,20,1,2,1,4,5,2,1,4,1,10,1,4,1,2,5,4,1,2,1,20,1,2,1,4,5,2,1,4,1,10,1,4,1,2,5,4,1,2,1,20,1,2,1,4,5,2,1,4,1,10,1,4,1,2,5,4,1,2,1},
+  {21,1,1,3,1,1,3,7,1,3,1,1,3,1,7,3,1,1,3,1,1,21,1,1,3,1,1,3,7,1,3,1,1,3,1,7,3,1,1,3,1,1,21,1,1,3,1,1,3,7,1,3,1,1,3,1,7,3,1,1,3,1,1,21,1,1,3,1,1,3,7,1,3,1,1,3,1,7,3,1,1,3,1,1,21,1,1,3,1,1,3,7,1,3,1,1,3,1,7,3},
+  {22,1,2,1,2,1,2,1,2,1,2,11,2,1,2,1,2,1,2,1,2,1,22,1,2,1,2,1,2,1,2,1,2,11,2,1,2,1,2,1,2,1,2,1,22,1,2,1,2,1,2,1,2,1,2,11,2,1,2,1,2,1,2,1,2,1,22,1,2,1,2,1,2,1,2,1,2,11,2,1,2,1,2,1,2,1,2,1,22,1,2,1,2,1,2,1,2,1,2,11},
+  {23,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,23,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,23,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,23,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,23,1,1,1,1,1,1,1},
+  {24,1,2,3,4,1,6,1,8,3,2,1,12,1,2,3,8,1,6,1,4,3,2,1,24,1,2,3,4,1,6,1,8,3,2,1,12,1,2,3,8,1,6,1,4,3,2,1,24,1,2,3,4,1,6,1,8,3,2,1,12,1,2,3,8,1,6,1,4,3,2,1,24,1,2,3,4,1,6,1,8,3,2,1,12,1,2,3,8,1,6,1,4,3,2,1,24,1,2,3},
+  {25,1,1,1,1,5,1,1,1,1,5,1,1,1,1,5,1,1,1,1,5,1,1,1,1,25,1,1,1,1,5,1,1,1,1,5,1,1,1,1,5,1,1,1,1,5,1,1,1,1,25,1,1,1,1,5,1,1,1,1,5,1,1,1,1,5,1,1,1,1,5,1,1,1,1,25,1,1,1,1,5,1,1,1,1,5,1,1,1,1,5,1,1,1,1,5,1,1,1,1},
+  {26,1,2,1,2,1,2,1,2,1,2,1,2,13,2,1,2,1,2,1,2,1,2,1,2,1,26,1,2,1,2,1,2,1,2,1,2,1,2,13,2,1,2,1,2,1,2,1,2,1,2,1,26,1,2,1,2,1,2,1,2,1,2,1,2,13,2,1,2,1,2,1,2,1,2,1,2,1,26,1,2,1,2,1,2,1,2,1,2,1,2,13,2,1,2,1,2,1,2,1},
+  {27,1,1,3,1,1,3,1,1,9,1,1,3,1,1,3,1,1,9,1,1,3,1,1,3,1,1,27,1,1,3,1,1,3,1,1,9,1,1,3,1,1,3,1,1,9,1,1,3,1,1,3,1,1,27,1,1,3,1,1,3,1,1,9,1,1,3,1,1,3,1,1,9,1,1,3,1,1,3,1,1,27,1,1,3,1,1,3,1,1,9,1,1,3,1,1,3,1,1,9},
+  {28,1,2,1,4,1,2,7,4,1,2,1,4,1,14,1,4,1,2,1,4,7,2,1,4,1,2,1,28,1,2,1,4,1,2,7,4,1,2,1,4,1,14,1,4,1,2,1,4,7,2,1,4,1,2,1,28,1,2,1,4,1,2,7,4,1,2,1,4,1,14,1,4,1,2,1,4,7,2,1,4,1,2,1,28,1,2,1,4,1,2,7,4,1,2,1,4,1,14,1},
+  {29,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,29,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,29,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,29,1,1,1,1,1,1,1,1,1,1,1,1},
+  {30,1,2,3,2,5,6,1,2,3,10,1,6,1,2,15,2,1,6,1,10,3,2,1,6,5,2,3,2,1,30,1,2,3,2,5,6,1,2,3,10,1,6,1,2,15,2,1,6,1,10,3,2,1,6,5,2,3,2,1,30,1,2,3,2,5,6,1,2,3,10,1,6,1,2,15,2,1,6,1,10,3,2,1,6,5,2,3,2,1,30,1,2,3,2,5,6,1,2,3},
+  {31,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,31,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,31,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,31,1,1,1,1,1,1},
+  {32,1,2,1,4,1,2,1,8,1,2,1,4,1,2,1,16,1,2,1,4,1,2,1,8,1,2,1,4,1,2,1,32,1,2,1,4,1,2,1,8,1,2,1,4,1,2,1,16,1,2,1,4,1,2,1,8,1,2,1,4,1,2,1,32,1,2,1,4,1,2,1,8,1,2,1,4,1,2,1,16,1,2,1,4,1,2,1,8,1,2,1,4,1,2,1,32,1,2,1},
+  {33,1,1,3,1,1,3,1,1,3,1,11,3,1,1,3,1,1,3,1,1,3,11,1,3,1,1,3,1,1,3,1,1,33,1,1,3,1,1,3,1,1,3,1,11,3,1,1,3,1,1,3,1,1,3,11,1,3,1,1,3,1,1,3,1,1,33,1,1,3,1,1,3,1,1,3,1,11,3,1,1,3,1,1,3,1,1,3,11,1,3,1,1,3,1,1,3,1,1,33},
+  {34,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,17,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,34,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,17,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,34,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,17,2,1,2,1,2,1,2,1,2,1,2,1,2,1},
+  {35,1,1,1,1,5,1,7,1,1,5,1,1,1,7,5,1,1,1,1,5,7,1,1,1,5,1,1,7,1,5,1,1,1,1,35,1,1,1,1,5,1,7,1,1,5,1,1,1,7,5,1,1,1,1,5,7,1,1,1,5,1,1,7,1,5,1,1,1,1,35,1,1,1,1,5,1,7,1,1,5,1,1,1,7,5,1,1,1,1,5,7,1,1,1,5,1,1,7,1},
+  {36,1,2,3,4,1,6,1,4,9,2,1,12,1,2,3,4,1,18,1,4,3,2,1,12,1,2,9,4,1,6,1,4,3,2,1,36,1,2,3,4,1,6,1,4,9,2,1,12,1,2,3,4,1,18,1,4,3,2,1,12,1,2,9,4,1,6,1,4,3,2,1,36,1,2,3,4,1,6,1,4,9,2,1,12,1,2,3,4,1,18,1,4,3,2,1,12,1,2,9},
+  {37,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,37,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,37,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1},
+  {38,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,19,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,38,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,19,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,38,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,19,2,1,2,1},
+  {39,1,1,3,1,1,3,1,1,3,1,1,3,13,1,3,1,1,3,1,1,3,1,1,3,1,13,3,1,1,3,1,1,3,1,1,3,1,1,39,1,1,3,1,1,3,1,1,3,1,1,3,13,1,3,1,1,3,1,1,3,1,1,3,1,13,3,1,1,3,1,1,3,1,1,3,1,1,39,1,1,3,1,1,3,1,1,3,1,1,3,13,1,3,1,1,3,1,1,3},
+  {40,1,2,1,4,5,2,1,8,1,10,1,4,1,2,5,8,1,2,1,20,1,2,1,8,5,2,1,4,1,10,1,8,1,2,5,4,1,2,1,40,1,2,1,4,5,2,1,8,1,10,1,4,1,2,5,8,1,2,1,20,1,2,1,8,5,2,1,4,1,10,1,8,1,2,5,4,1,2,1,40,1,2,1,4,5,2,1,8,1,10,1,4,1,2,5,8,1,2,1},
+  {41,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,41,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,41,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1},
+  {42,1,2,3,2,1,6,7,2,3,2,1,6,1,14,3,2,1,6,1,2,21,2,1,6,1,2,3,14,1,6,1,2,3,2,7,6,1,2,3,2,1,42,1,2,3,2,1,6,7,2,3,2,1,6,1,14,3,2,1,6,1,2,21,2,1,6,1,2,3,14,1,6,1,2,3,2,7,6,1,2,3,2,1,42,1,2,3,2,1,6,7,2,3,2,1,6,1,14,3},
+  {43,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,43,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,43,1,1,1,1,1,1,1,1,1,1,1,1,1},
+  {44,1,2,1,4,1,2,1,4,1,2,11,4,1,2,1,4,1,2,1,4,1,22,1,4,1,2,1,4,1,2,1,4,11,2,1,4,1,2,1,4,1,2,1,44,1,2,1,4,1,2,1,4,1,2,11,4,1,2,1,4,1,2,1,4,1,22,1,4,1,2,1,4,1,2,1,4,11,2,1,4,1,2,1,4,1,2,1,44,1,2,1,4,1,2,1,4,1,2,11},
+  {45,1,1,3,1,5,3,1,1,9,5,1,3,1,1,15,1,1,9,1,5,3,1,1,3,5,1,9,1,1,15,1,1,3,1,5,9,1,1,3,5,1,3,1,1,45,1,1,3,1,5,3,1,1,9,5,1,3,1,1,15,1,1,9,1,5,3,1,1,3,5,1,9,1,1,15,1,1,3,1,5,9,1,1,3,5,1,3,1,1,45,1,1,3,1,5,3,1,1,9},
+  {46,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,23,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,46,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,23,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,46,1,2,1,2,1,2,1},
+  {47,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,47,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,47,1,1,1,1,1},
+  {48,1,2,3,4,1,6,1,8,3,2,1,12,1,2,3,16,1,6,1,4,3,2,1,24,1,2,3,4,1,6,1,16,3,2,1,12,1,2,3,8,1,6,1,4,3,2,1,48,1,2,3,4,1,6,1,8,3,2,1,12,1,2,3,16,1,6,1,4,3,2,1,24,1,2,3,4,1,6,1,16,3,2,1,12,1,2,3,8,1,6,1,4,3,2,1,48,1,2,3},
+  {49,1,1,1,1,1,1,7,1,1,1,1,1,1,7,1,1,1,1,1,1,7,1,1,1,1,1,1,7,1,1,1,1,1,1,7,1,1,1,1,1,1,7,1,1,1,1,1,1,49,1,1,1,1,1,1,7,1,1,1,1,1,1,7,1,1,1,1,1,1,7,1,1,1,1,1,1,7,1,1,1,1,1,1,7,1,1,1,1,1,1,7,1,1,1,1,1,1,49,1},
+  {50,1,2,1,2,5,2,1,2,1,10,1,2,1,2,5,2,1,2,1,10,1,2,1,2,25,2,1,2,1,10,1,2,1,2,5,2,1,2,1,10,1,2,1,2,5,2,1,2,1,50,1,2,1,2,5,2,1,2,1,10,1,2,1,2,5,2,1,2,1,10,1,2,1,2,25,2,1,2,1,10,1,2,1,2,5,2,1,2,1,10,1,2,1,2,5,2,1,2,1},
+  {51,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,17,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,17,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,51,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,17,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,17,1,3,1,1,3,1,1,3,1,1,3,1,1,3},
+  {52,1,2,1,4,1,2,1,4,1,2,1,4,13,2,1,4,1,2,1,4,1,2,1,4,1,26,1,4,1,2,1,4,1,2,1,4,1,2,13,4,1,2,1,4,1,2,1,4,1,2,1,52,1,2,1,4,1,2,1,4,1,2,1,4,13,2,1,4,1,2,1,4,1,2,1,4,1,26,1,4,1,2,1,4,1,2,1,4,1,2,13,4,1,2,1,4,1,2,1},
+  {53,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,53,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1},
+  {54,1,2,3,2,1,6,1,2,9,2,1,6,1,2,3,2,1,18,1,2,3,2,1,6,1,2,27,2,1,6,1,2,3,2,1,18,1,2,3,2,1,6,1,2,9,2,1,6,1,2,3,2,1,54,1,2,3,2,1,6,1,2,9,2,1,6,1,2,3,2,1,18,1,2,3,2,1,6,1,2,27,2,1,6,1,2,3,2,1,18,1,2,3,2,1,6,1,2,9},
+  {55,1,1,1,1,5,1,1,1,1,5,11,1,1,1,5,1,1,1,1,5,1,11,1,1,5,1,1,1,1,5,1,1,11,1,5,1,1,1,1,5,1,1,1,11,5,1,1,1,1,5,1,1,1,1,55,1,1,1,1,5,1,1,1,1,5,11,1,1,1,5,1,1,1,1,5,1,11,1,1,5,1,1,1,1,5,1,1,11,1,5,1,1,1,1,5,1,1,1,11},
+  {56,1,2,1,4,1,2,7,8,1,2,1,4,1,14,1,8,1,2,1,4,7,2,1,8,1,2,1,28,1,2,1,8,1,2,7,4,1,2,1,8,1,14,1,4,1,2,1,8,7,2,1,4,1,2,1,56,1,2,1,4,1,2,7,8,1,2,1,4,1,14,1,8,1,2,1,4,7,2,1,8,1,2,1,28,1,2,1,8,1,2,7,4,1,2,1,8,1,14,1},
+  {57,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,19,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,19,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,57,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,19,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,19,3,1,1,3},
+  {58,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,29,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,58,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,29,2,1,2,1,2,1,2,1,2,1,2,1},
+  {59,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,59,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1},
+  {60,1,2,3,4,5,6,1,4,3,10,1,12,1,2,15,4,1,6,1,20,3,2,1,12,5,2,3,4,1,30,1,4,3,2,5,12,1,2,3,20,1,6,1,4,15,2,1,12,1,10,3,4,1,6,5,4,3,2,1,60,1,2,3,4,5,6,1,4,3,10,1,12,1,2,15,4,1,6,1,20,3,2,1,12,5,2,3,4,1,30,1,4,3,2,5,12,1,2,3},
+  {61,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,61,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1},
+  {62,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,31,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,62,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,31,2,1,2,1,2,1},
+  {63,1,1,3,1,1,3,7,1,9,1,1,3,1,7,3,1,1,9,1,1,21,1,1,3,1,1,9,7,1,3,1,1,3,1,7,9,1,1,3,1,1,21,1,1,9,1,1,3,7,1,3,1,1,9,1,7,3,1,1,3,1,1,63,1,1,3,1,1,3,7,1,9,1,1,3,1,7,3,1,1,9,1,1,21,1,1,3,1,1,9,7,1,3,1,1,3,1,7,9},
+  {64,1,2,1,4,1,2,1,8,1,2,1,4,1,2,1,16,1,2,1,4,1,2,1,8,1,2,1,4,1,2,1,32,1,2,1,4,1,2,1,8,1,2,1,4,1,2,1,16,1,2,1,4,1,2,1,8,1,2,1,4,1,2,1,64,1,2,1,4,1,2,1,8,1,2,1,4,1,2,1,16,1,2,1,4,1,2,1,8,1,2,1,4,1,2,1,32,1,2,1},
+  {65,1,1,1,1,5,1,1,1,1,5,1,1,13,1,5,1,1,1,1,5,1,1,1,1,5,13,1,1,1,5,1,1,1,1,5,1,1,1,13,5,1,1,1,1,5,1,1,1,1,5,1,13,1,1,5,1,1,1,1,5,1,1,1,1,65,1,1,1,1,5,1,1,1,1,5,1,1,13,1,5,1,1,1,1,5,1,1,1,1,5,13,1,1,1,5,1,1,1,1},
+  {66,1,2,3,2,1,6,1,2,3,2,11,6,1,2,3,2,1,6,1,2,3,22,1,6,1,2,3,2,1,6,1,2,33,2,1,6,1,2,3,2,1,6,1,22,3,2,1,6,1,2,3,2,1,6,11,2,3,2,1,6,1,2,3,2,1,66,1,2,3,2,1,6,1,2,3,2,11,6,1,2,3,2,1,6,1,2,3,22,1,6,1,2,3,2,1,6,1,2,33},
+  {67,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,67,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1},
+  {68,1,2,1,4,1,2,1,4,1,2,1,4,1,2,1,4,17,2,1,4,1,2,1,4,1,2,1,4,1,2,1,4,1,34,1,4,1,2,1,4,1,2,1,4,1,2,1,4,1,2,17,4,1,2,1,4,1,2,1,4,1,2,1,4,1,2,1,68,1,2,1,4,1,2,1,4,1,2,1,4,1,2,1,4,17,2,1,4,1,2,1,4,1,2,1,4,1,2,1},
+  {69,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,23,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,23,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,69,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,23,3,1,1,3,1,1,3},
+  {70,1,2,1,2,5,2,7,2,1,10,1,2,1,14,5,2,1,2,1,10,7,2,1,2,5,2,1,14,1,10,1,2,1,2,35,2,1,2,1,10,1,14,1,2,5,2,1,2,7,10,1,2,1,2,5,14,1,2,1,10,1,2,7,2,5,2,1,2,1,70,1,2,1,2,5,2,7,2,1,10,1,2,1,14,5,2,1,2,1,10,7,2,1,2,5,2,1,14,1},
+  {71,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,71,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1},
+  {72,1,2,3,4,1,6,1,8,9,2,1,12,1,2,3,8,1,18,1,4,3,2,1,24,1,2,9,4,1,6,1,8,3,2,1,36,1,2,3,8,1,6,1,4,9,2,1,24,1,2,3,4,1,18,1,8,3,2,1,12,1,2,9,8,1,6,1,4,3,2,1,72,1,2,3,4,1,6,1,8,9,2,1,12,1,2,3,8,1,18,1,4,3,2,1,24,1,2,9},
+  {73,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,73,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1},
+  {74,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,37,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,74,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1},
+  {75,1,1,3,1,5,3,1,1,3,5,1,3,1,1,15,1,1,3,1,5,3,1,1,3,25,1,3,1,1,15,1,1,3,1,5,3,1,1,3,5,1,3,1,1,15,1,1,3,1,25,3,1,1,3,5,1,3,1,1,15,1,1,3,1,5,3,1,1,3,5,1,3,1,1,75,1,1,3,1,5,3,1,1,3,5,1,3,1,1,15,1,1,3,1,5,3,1,1,3},
+  {76,1,2,1,4,1,2,1,4,1,2,1,4,1,2,1,4,1,2,19,4,1,2,1,4,1,2,1,4,1,2,1,4,1,2,1,4,1,38,1,4,1,2,1,4,1,2,1,4,1,2,1,4,1,2,1,4,19,2,1,4,1,2,1,4,1,2,1,4,1,2,1,4,1,2,1,76,1,2,1,4,1,2,1,4,1,2,1,4,1,2,1,4,1,2,19,4,1,2,1},
+  {77,1,1,1,1,1,1,7,1,1,1,11,1,1,7,1,1,1,1,1,1,7,11,1,1,1,1,1,7,1,1,1,1,11,1,7,1,1,1,1,1,1,7,1,11,1,1,1,1,7,1,1,1,1,1,11,7,1,1,1,1,1,1,7,1,1,11,1,1,1,7,1,1,1,1,1,1,77,1,1,1,1,1,1,7,1,1,1,11,1,1,7,1,1,1,1,1,1,7,11},
+  {78,1,2,3,2,1,6,1,2,3,2,1,6,13,2,3,2,1,6,1,2,3,2,1,6,1,26,3,2,1,6,1,2,3,2,1,6,1,2,39,2,1,6,1,2,3,2,1,6,1,2,3,26,1,6,1,2,3,2,1,6,1,2,3,2,13,6,1,2,3,2,1,6,1,2,3,2,1,78,1,2,3,2,1,6,1,2,3,2,1,6,13,2,3,2,1,6,1,2,3},
+  {79,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,79,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1},
+  {80,1,2,1,4,5,2,1,8,1,10,1,4,1,2,5,16,1,2,1,20,1,2,1,8,5,2,1,4,1,10,1,16,1,2,5,4,1,2,1,40,1,2,1,4,5,2,1,16,1,10,1,4,1,2,5,8,1,2,1,20,1,2,1,16,5,2,1,4,1,10,1,8,1,2,5,4,1,2,1,80,1,2,1,4,5,2,1,8,1,10,1,4,1,2,5,16,1,2,1},
+  {81,1,1,3,1,1,3,1,1,9,1,1,3,1,1,3,1,1,9,1,1,3,1,1,3,1,1,27,1,1,3,1,1,3,1,1,9,1,1,3,1,1,3,1,1,9,1,1,3,1,1,3,1,1,27,1,1,3,1,1,3,1,1,9,1,1,3,1,1,3,1,1,9,1,1,3,1,1,3,1,1,81,1,1,3,1,1,3,1,1,9,1,1,3,1,1,3,1,1,9},
+  {82,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,41,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,82,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1},
+  {83,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,83,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1},
+  {84,1,2,3,4,1,6,7,4,3,2,1,12,1,14,3,4,1,6,1,4,21,2,1,12,1,2,3,28,1,6,1,4,3,2,7,12,1,2,3,4,1,42,1,4,3,2,1,12,7,2,3,4,1,6,1,28,3,2,1,12,1,2,21,4,1,6,1,4,3,14,1,12,1,2,3,4,7,6,1,4,3,2,1,84,1,2,3,4,1,6,7,4,3,2,1,12,1,14,3},
+  {85,1,1,1,1,5,1,1,1,1,5,1,1,1,1,5,1,17,1,1,5,1,1,1,1,5,1,1,1,1,5,1,1,1,17,5,1,1,1,1,5,1,1,1,1,5,1,1,1,1,5,17,1,1,1,5,1,1,1,1,5,1,1,1,1,5,1,1,17,1,5,1,1,1,1,5,1,1,1,1,5,1,1,1,1,85,1,1,1,1,5,1,1,1,1,5,1,1,1,1},
+  {86,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,43,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,86,1,2,1,2,1,2,1,2,1,2,1,2,1},
+  {87,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,29,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,29,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,87,1,1,3,1,1,3,1,1,3,1,1,3},
+  {88,1,2,1,4,1,2,1,8,1,2,11,4,1,2,1,8,1,2,1,4,1,22,1,8,1,2,1,4,1,2,1,8,11,2,1,4,1,2,1,8,1,2,1,44,1,2,1,8,1,2,1,4,1,2,11,8,1,2,1,4,1,2,1,8,1,22,1,4,1,2,1,8,1,2,1,4,11,2,1,8,1,2,1,4,1,2,1,88,1,2,1,4,1,2,1,8,1,2,11},
+  {89,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,89,1,1,1,1,1,1,1,1,1,1},
+  {90,1,2,3,2,5,6,1,2,9,10,1,6,1,2,15,2,1,18,1,10,3,2,1,6,5,2,9,2,1,30,1,2,3,2,5,18,1,2,3,10,1,6,1,2,45,2,1,6,1,10,3,2,1,18,5,2,3,2,1,30,1,2,9,2,5,6,1,2,3,10,1,18,1,2,15,2,1,6,1,10,9,2,1,6,5,2,3,2,1,90,1,2,3,2,5,6,1,2,9},
+  {91,1,1,1,1,1,1,7,1,1,1,1,1,13,7,1,1,1,1,1,1,7,1,1,1,1,13,1,7,1,1,1,1,1,1,7,1,1,1,13,1,1,7,1,1,1,1,1,1,7,1,1,13,1,1,1,7,1,1,1,1,1,1,7,1,13,1,1,1,1,7,1,1,1,1,1,1,7,13,1,1,1,1,1,7,1,1,1,1,1,1,91,1,1,1,1,1,1,7,1},
+  {92,1,2,1,4,1,2,1,4,1,2,1,4,1,2,1,4,1,2,1,4,1,2,23,4,1,2,1,4,1,2,1,4,1,2,1,4,1,2,1,4,1,2,1,4,1,46,1,4,1,2,1,4,1,2,1,4,1,2,1,4,1,2,1,4,1,2,1,4,23,2,1,4,1,2,1,4,1,2,1,4,1,2,1,4,1,2,1,4,1,2,1,92,1,2,1,4,1,2,1},
+  {93,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,31,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,31,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,3,1,1,93,1,1,3,1,1,3},
+  {94,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,47,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,2,1,94,1,2,1,2,1},
+  {95,1,1,1,1,5,1,1,1,1,5,1,1,1,1,5,1,1,1,19,5,1,1,1,1,5,1,1,1,1,5,1,1,1,1,5,1,1,19,1,5,1,1,1,1,5,1,1,1,1,5,1,1,1,1,5,1,19,1,1,5,1,1,1,1,5,1,1,1,1,5,1,1,1,1,5,19,1,1,1,5,1,1,1,1,5,1,1,1,1,5,1,1,1,1,95,1,1,1,1},
+  {96,1,2,3,4,1,6,1,8,3,2,1,12,1,2,3,16,1,6,1,4,3,2,1,24,1,2,3,4,1,6,1,32,3,2,1,12,1,2,3,8,1,6,1,4,3,2,1,48,1,2,3,4,1,6,1,8,3,2,1,12,1,2,3,32,1,6,1,4,3,2,1,24,1,2,3,4,1,6,1,16,3,2,1,12,1,2,3,8,1,6,1,4,3,2,1,96,1,2,3},
+  {97,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,97,1,1},
+  {98,1,2,1,2,1,2,7,2,1,2,1,2,1,14,1,2,1,2,1,2,7,2,1,2,1,2,1,14,1,2,1,2,1,2,7,2,1,2,1,2,1,14,1,2,1,2,1,2,49,2,1,2,1,2,1,14,1,2,1,2,1,2,7,2,1,2,1,2,1,14,1,2,1,2,1,2,7,2,1,2,1,2,1,14,1,2,1,2,1,2,7,2,1,2,1,2,1,98,1},
+  {99,1,1,3,1,1,3,1,1,9,1,11,3,1,1,3,1,1,9,1,1,3,11,1,3,1,1,9,1,1,3,1,1,33,1,1,9,1,1,3,1,1,3,1,11,9,1,1,3,1,1,3,1,1,9,11,1,3,1,1,3,1,1,9,1,1,33,1,1,3,1,1,9,1,1,3,1,11,3,1,1,9,1,1,3,1,1,3,11,1,9,1,1,3,1,1,3,1,1,99}
+};
+
+static const uint16_t TablesReciprocal[TABLES_LARGEST + 1] = {
+  0,8192,4096,2731,2048,1639,1366,1171,1024,911,820,745,
+  683,631,586,547,512,482,456,432,410,391,373,357,
+  342,328,316,304,293,283,274,265,256,249,241,235,
+  228,222,216,211,205,200,196,191,187,183,179,175,
+  171,168,164,161,158,155,152,149,147,144,142,139,
+  137,135,133,131,128,127,125,123,121,119,118,116,
+  114,113,111,110,108,107,106,104,103,102,100,99,
+  98,97,96,95,94,93,92,91,90,89,88,87,
+  86,85,84,83
+};
+
+#endif //Tables.h
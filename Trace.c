@@ -0,0 +1,231 @@
+/*
+
+  Trace
+
+  Buffers are given out under a lock, once per thread, and filled
+  without one: the owner writes a span, then publishes the new
+  count with a release store, so the writer at exit only reads
+  spans that are complete, even from threads still running.
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "Trace.h"
+
+#define DISPLAY_MALLOC_ERROR { fprintf(stderr, "FATAL ERROR: UNABLE TO ALLOCATE MEMORY IN HEAP"); exit(-1); }
+#define DISPLAY_FILE_ERROR(file) fprintf(stderr, "Trace: can't write %s\n", file);
+
+int traceOn = 0;
+
+__thread int traceSampling = 0;
+
+static __thread TraceThread *traceMine = NULL;
+
+// Set once a thread was refused a buffer, so it doesn't ask again
+static __thread int traceRefused = 0;
+
+static TraceThread *buffers[TRACE_MAX_THREADS];
+static int bufferCount = 0;
+
+static pthread_mutex_t buffersLock = PTHREAD_MUTEX_INITIALIZER;
+
+static const char *path = NULL;
+static uint32_t every = 1;
+static uint64_t origin = 0;
+
+static uint64_t now() {
+
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+
+  return (uint64_t) t.tv_sec * 1000000000ULL + (uint64_t) t.tv_nsec;
+}
+
+static TraceThread *thread() {
+
+  if (traceMine || traceRefused)
+    return traceMine;
+
+  pthread_mutex_lock(&buffersLock);
+
+  if (bufferCount < TRACE_MAX_THREADS) {
+
+    TraceThread *buffer = malloc(sizeof (TraceThread));
+
+    // Pages are only touched as spans are added
+    if (!buffer || !(buffer->events = malloc(TRACE_THREAD_EVENTS * sizeof (TraceEvent)))) DISPLAY_MALLOC_ERROR
+
+    buffer->count = 0;
+    buffer->dropped = 0;
+    buffer->untilSample = 0;
+    buffer->id = bufferCount + 1;
+
+    buffers[bufferCount++] = buffer;
+    traceMine = buffer;
+  }
+
+  else
+    traceRefused = 1;
+
+  pthread_mutex_unlock(&buffersLock);
+
+  return traceMine;
+}
+
+static void span(const char *category, const char *name, uint64_t start, uint64_t end) {
+
+  TraceThread *buffer = thread();
+
+  if (!buffer)
+    return;
+
+  uint32_t count = buffer->count;
+
+  if (count == TRACE_THREAD_EVENTS) {
+    __atomic_store_n(&buffer->dropped, buffer->dropped + 1, __ATOMIC_RELAXED);
+    return;
+  }
+
+  TraceEvent *event = &buffer->events[count];
+
+  event->category = category;
+  event->name = name;
+  event->start = start;
+  event->duration = end - start;
+
+  __atomic_store_n(&buffer->count, count + 1, __ATOMIC_RELEASE);
+}
+
+static void sample() {
+
+  TraceThread *buffer = thread();
+
+  if (!buffer)
+    return;
+
+  if (!buffer->untilSample) {
+    buffer->untilSample = every - 1;
+    traceSampling = 1;
+  }
+
+  else
+    buffer->untilSample--;
+}
+
+/*
+
+  Microseconds since start(), with the ns after the point
+
+*/
+
+static void writeTime(FILE *out, uint64_t nanoseconds) {
+  fprintf(out, "%llu.%03llu", (unsigned long long) (nanoseconds / 1000), (unsigned long long) (nanoseconds % 1000));
+}
+
+/*
+
+  Writes every buffer as Chrome trace-event JSON, at exit
+
+*/
+
+static void writeTrace() {
+
+  traceOn = 0;
+
+  FILE *out = fopen(path, "w");
+
+  if (!out) {
+    DISPLAY_FILE_ERROR(path)
+    return;
+  }
+
+  pthread_mutex_lock(&buffersLock);
+
+  int pid = (int) getpid();
+  unsigned long long spans = 0, dropped = 0;
+
+  fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+  fprintf(out, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%i,\"tid\":0,\"args\":{\"name\":\"fractions\"}}", pid);
+
+  for (int t = 0; t < bufferCount; t++) {
+
+    TraceThread *buffer = buffers[t];
+    uint32_t count = __atomic_load_n(&buffer->count, __ATOMIC_ACQUIRE);
+
+    fprintf(out, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%i,\"tid\":%i,\"args\":{\"name\":\"thread %i\"}}", pid, buffer->id, buffer->id);
+
+    for (uint32_t i = 0; i < count; i++) {
+
+      TraceEvent *event = &buffer->events[i];
+
+      fprintf(out, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":%i,\"tid\":%i,\"ts\":", event->name, event->category, pid, buffer->id);
+      writeTime(out, event->start > origin ? event->start - origin : 0);
+      fprintf(out, ",\"dur\":");
+      writeTime(out, event->duration);
+      fprintf(out, "}");
+    }
+
+    spans += count;
+    dropped += __atomic_load_n(&buffer->dropped, __ATOMIC_RELAXED);
+  }
+
+  fprintf(out, "\n],\"otherData\":{\"traceEvery\":%u,\"threads\":%i,\"spans\":%llu,\"dropped\":%llu}}\n", every, bufferCount, spans, dropped);
+
+  pthread_mutex_unlock(&buffersLock);
+
+  if (fclose(out))
+    DISPLAY_FILE_ERROR(path)
+
+  if (dropped)
+    fprintf(stderr, "Trace: %llu spans dropped, buffers were full (raise FRACTIONS_TRACE_EVERY)\n", dropped);
+}
+
+static void start() {
+
+  path = getenv("FRACTIONS_TRACE");
+
+  if (!path || !*path)
+    return;
+
+#ifdef FRACTIONS_NO_TRACE
+
+  fprintf(stderr, "Trace: tracing was left out of this build (FRACTIONS_NO_TRACE)\n");
+  return;
+
+#endif
+
+  const char *text = getenv("FRACTIONS_TRACE_EVERY");
+
+  if (text && atoi(text) > 0)
+    every = (uint32_t) atoi(text);
+
+  origin = now();
+
+  if (atexit(&writeTrace))
+    return;
+
+  traceOn = 1;
+}
+
+/*
+
+  Abstraction, same as in Software.c
+
+*/
+
+const static traceRecorder TraceFunctions = {
+  &start,
+  &thread,
+  &now,
+  &span,
+  &sample
+};
+
+const traceRecorder *restrict Trace = &TraceFunctions;
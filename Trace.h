@@ -0,0 +1,254 @@
+/*
+
+  Trace
+
+  Spans of where the time goes, written as Chrome trace-event JSON
+  that Perfetto (ui.perfetto.dev) or chrome://tracing can open:
+
+    FRACTIONS_TRACE=trace.json ./fractions --batch in.txt out.txt
+
+  in any mode, the file is written when the program exits. Each
+  thread appends the spans it ends to a buffer of its own, so
+  tracing takes no lock (only the first span of a thread does).
+
+  There are two kinds of spans:
+
+    Coarse spans, like reading, evaluating and writing one chunk of
+    a batch, or storing a whole block of fractions, are always
+    traced, there are few of them.
+
+    Stages of one expression (parsing, Operation(), formatting,
+    storing) happen millions of times, so only one expression in
+    FRACTIONS_TRACE_EVERY (1 if not set) on each thread is traced,
+    the others only pay for a countdown. For a run of 100M
+    expressions, FRACTIONS_TRACE_EVERY=1000 keeps the file near
+    half a million spans.
+
+  A thread that fills its buffer stops tracing, how many spans
+  were dropped is written to the trace (otherData) and to stderr.
+
+  Building with -DFRACTIONS_NO_TRACE removes all of it: the
+  TRACE_* macros below are then empty.
+
+*/
+
+#ifndef TRACE
+#define TRACE
+
+#include <stdint.h>
+
+/*
+
+  Spans each thread can hold
+
+*/
+
+#define TRACE_THREAD_EVENTS (1 << 20)
+
+/*
+
+  Threads with a buffer of their own, the ones
+  after aren't traced
+
+*/
+
+#define TRACE_MAX_THREADS 256
+
+/*
+
+  One span, times in ns on the monotonic clock
+
+  Type: TraceEvent
+
+*/
+
+typedef struct {
+
+  // String literals, never copied
+  const char *category;
+  const char *name;
+
+  uint64_t start;
+  uint64_t duration;
+
+}
+TraceEvent;
+
+/*
+
+  What one thread traced
+
+  Type: TraceThread
+
+*/
+
+typedef struct {
+
+  TraceEvent *events;
+
+  // Only the owner writes these, the writer at exit reads them
+  uint32_t count;
+  uint32_t dropped;
+
+  // Expressions left until the next one that is traced
+  uint32_t untilSample;
+
+  // Thread number in the trace, from 1
+  int id;
+
+}
+TraceThread;
+
+typedef struct {
+
+  /*
+
+    void start()
+
+    Starts tracing if FRACTIONS_TRACE names a file, and
+    writes the trace to it at exit. Call it at the start
+    of main(), before any other thread is started.
+
+    Access: Trace->start()
+
+  */
+
+  void(*const start)();
+
+  /*
+
+    TraceThread* thread()
+
+    The buffer of the calling thread, given out the first time
+    the thread asks for it, NULL past TRACE_MAX_THREADS.
+
+    Access: Trace->thread()
+
+  */
+
+  TraceThread*(*const thread)();
+
+  /*
+
+    uint64_t now()
+
+    Nanoseconds on the monotonic clock.
+
+    Access: Trace->now()
+
+  */
+
+  uint64_t(*const now)();
+
+  /*
+
+    void span(char *category, char *name, uint64_t start, uint64_t end)
+
+    Appends a span to the calling thread's buffer, category
+    and name have to be string literals.
+
+    Access: Trace->span()
+
+  */
+
+  void(*const span)(const char *category, const char *name, uint64_t start, uint64_t end);
+
+  /*
+
+    void sample()
+
+    Starts an expression: sets traceSampling if it is
+    one that is traced.
+
+    Access: Trace->sample()
+
+  */
+
+  void(*const sample)();
+
+}
+traceRecorder;
+
+/*
+
+  Call this, Trace, to access all
+  the publicly available functions.
+
+*/
+
+extern
+const traceRecorder * restrict Trace;
+
+#ifndef FRACTIONS_NO_TRACE
+
+/*
+
+  Set by start(), for the whole run
+
+*/
+
+extern int traceOn;
+
+/*
+
+  Set while the calling thread is in an expression that is traced
+
+*/
+
+extern __thread int traceSampling;
+
+/*
+
+  TRACE_BEGIN(start) declares start: the time now if tracing,
+  else 0. TRACE_STAGE(start) is the same for the stages of an
+  expression, only if the expression is traced.
+
+*/
+
+#define TRACE_BEGIN(start) uint64_t start = __builtin_expect(traceOn, 0) ? Trace->now() : 0;
+#define TRACE_STAGE(start) uint64_t start = __builtin_expect(traceSampling, 0) ? Trace->now() : 0;
+
+/*
+
+  Ends the span that started at start, if it is traced
+
+*/
+
+#define TRACE_END(start, category, name) { \
+  if (__builtin_expect((start) != 0, 0)) \
+    Trace->span(category, name, start, Trace->now()); }
+
+/*
+
+  Ends the span that started at start, and starts the
+  next one in it, for stages that follow each other
+
+*/
+
+#define TRACE_NEXT(start, category, name) { \
+  if (__builtin_expect((start) != 0, 0)) { \
+    uint64_t traceNow = Trace->now(); \
+    Trace->span(category, name, start, traceNow); \
+    start = traceNow; } }
+
+/*
+
+  Around an expression, picks whether its stages are traced
+
+*/
+
+#define TRACE_SAMPLE_BEGIN { if (__builtin_expect(traceOn, 0)) Trace->sample(); }
+#define TRACE_SAMPLE_END { traceSampling = 0; }
+
+#else
+
+#define TRACE_BEGIN(start)
+#define TRACE_STAGE(start)
+#define TRACE_END(start, category, name) { }
+#define TRACE_NEXT(start, category, name) { }
+#define TRACE_SAMPLE_BEGIN { }
+#define TRACE_SAMPLE_END { }
+
+#endif
+
+#endif //Trace.h
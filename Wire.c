@@ -0,0 +1,286 @@
+/*
+
+  Wire
+
+  Reading, writing, evaluating and converting binary
+  equation records. See Wire.h for the record layout.
+
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <endian.h>
+
+#include "Software.h"
+#include "IO.h"
+#include "Operations.h"
+#include "Wire.h"
+
+/*
+
+  Number of records converted at once by write()
+
+*/
+
+#define WIRE_WRITE_CHUNK 256
+
+/*
+
+  Converts every field of the record between host and
+  little endian byte order. The conversion is its own
+  inverse, so the same function is used both ways.
+
+  Only needed on big endian hosts.
+
+*/
+
+#if __BYTE_ORDER != __LITTLE_ENDIAN
+static void swapRecord(WireRecord *restrict r) {
+  r->operand1Numerator   = (int32_t) htole32((uint32_t) r->operand1Numerator);
+  r->operand1Denomenator = (int32_t) htole32((uint32_t) r->operand1Denomenator);
+  r->operand2Numerator   = (int32_t) htole32((uint32_t) r->operand2Numerator);
+  r->operand2Denomenator = (int32_t) htole32((uint32_t) r->operand2Denomenator);
+  r->resultNumerator     = (int32_t) htole32((uint32_t) r->resultNumerator);
+  r->resultDenomenator   = (int32_t) htole32((uint32_t) r->resultDenomenator);
+}
+#endif
+
+/*
+
+  Evaluate a record in place
+
+  The record is viewed as an Equation that lives on the
+  stack, so nothing is allocated per record.
+
+*/
+
+static int evaluateRecord(WireRecord *restrict r) {
+
+  r->resultNumerator   = 0;
+  r->resultDenomenator = 0;
+  r->reserved[0] = r->reserved[1] = 0;
+
+  if (!validOperator((char) r->operator)) {
+    r->status = WIRE_STATUS_INVALID_OPERATOR;
+    return 0;
+  }
+
+  if (
+    !ValidateFraction(r->operand1Numerator, r->operand1Denomenator) ||
+    !ValidateFraction(r->operand2Numerator, r->operand2Denomenator)) {
+    r->status = WIRE_STATUS_INVALID_OPERAND;
+    return 0;
+  }
+
+  /*
+
+    Dividing by 0/x would leave a zero denominator behind,
+    and so would 0/x to a negative power.
+
+  */
+
+  if (
+    (r->operator == OP_DIV && r->operand2Numerator == 0) ||
+    (r->operator == OP_POW && r->operand1Numerator == 0 && r->operand2Numerator < 0)) {
+    r->status = WIRE_STATUS_DIVIDE_BY_ZERO;
+    return 0;
+  }
+
+  // Powers have to be whole
+  if (r->operator == OP_POW && r->operand2Numerator % r->operand2Denomenator) {
+    r->status = WIRE_STATUS_INVALID_OPERAND;
+    return 0;
+  }
+
+  Fraction f1 = { r->operand1Numerator, r->operand1Denomenator };
+  Fraction f2 = { r->operand2Numerator, r->operand2Denomenator };
+  Fraction result = { 0, 0 };
+  char operator = (char) r->operator;
+
+  Equation expression = { &f1, &operator, &f2, &result };
+
+  // Everything else was checked above, only a power can still fail
+  if (!Operation(&expression)) {
+    r->status = WIRE_STATUS_OVERFLOW;
+    return 0;
+  }
+
+  r->resultNumerator   = result.numerator;
+  r->resultDenomenator = result.denomenator;
+  r->status = WIRE_STATUS_OK;
+
+  return 1;
+}
+
+/*
+
+  Equation -> Record
+
+*/
+
+static void fromEquation(WireRecord *restrict r, Equation *restrict e) {
+  r->operand1Numerator   = e->operand1->numerator;
+  r->operand1Denomenator = e->operand1->denomenator;
+  r->operand2Numerator   = e->operand2->numerator;
+  r->operand2Denomenator = e->operand2->denomenator;
+  r->resultNumerator     = e->result->numerator;
+  r->resultDenomenator   = e->result->denomenator;
+  r->operator = (uint8_t) *e->operator;
+  r->status = WIRE_STATUS_OK;
+  r->reserved[0] = r->reserved[1] = 0;
+}
+
+/*
+
+  Record -> Equation
+
+*/
+
+static void toEquation(Equation *restrict e, const WireRecord *restrict r) {
+  e->operand1->numerator   = r->operand1Numerator;
+  e->operand1->denomenator = r->operand1Denomenator;
+  e->operand2->numerator   = r->operand2Numerator;
+  e->operand2->denomenator = r->operand2Denomenator;
+  e->result->numerator     = r->resultNumerator;
+  e->result->denomenator   = r->resultDenomenator;
+  *e->operator = (char) r->operator;
+}
+
+/*
+
+  Record -> Text
+
+  Evaluated records go through Equations->getFormatted(),
+  so the text is exactly what the rest of the program prints.
+
+*/
+
+static int toText(const WireRecord *restrict r, char *restrict text, const size_t size) {
+
+  if (r->status != WIRE_STATUS_OK)
+    return snprintf(
+      text,
+      size,
+      "%i/%i %c %i/%i",
+      r->operand1Numerator,
+      r->operand1Denomenator,
+      (char) r->operator,
+      r->operand2Numerator,
+      r->operand2Denomenator
+    );
+
+  Fraction f1 = { r->operand1Numerator, r->operand1Denomenator };
+  Fraction f2 = { r->operand2Numerator, r->operand2Denomenator };
+  Fraction result = { r->resultNumerator, r->resultDenomenator };
+  char operator = (char) r->operator;
+
+  Equation equation = { &f1, &operator, &f2, &result };
+
+  return snprintf(text, size, "%s", Equations->getFormatted(&equation));
+}
+
+/*
+
+  Text -> Record
+
+*/
+
+static int fromText(WireRecord *restrict r, const char *restrict text) {
+
+  int n1, d1, n2, d2, rn = 0, rd = 0;
+  char operator;
+  int used = 0;
+
+  memset(r, 0, sizeof (*r));
+
+  int matched = sscanf(
+    text,
+    " %d/%d %c %d/%d %n= %d/%d %n",
+    &n1, &d1, &operator, &n2, &d2, &used, &rn, &rd, &used
+  );
+
+  // Either "a/b OP c/d" or "a/b OP c/d = x/y", and nothing after it.
+  if ((matched != 5 && matched != 7) || text[used] != 0)
+    return 0;
+
+  r->operand1Numerator   = n1;
+  r->operand1Denomenator = d1;
+  r->operand2Numerator   = n2;
+  r->operand2Denomenator = d2;
+  r->resultNumerator     = rn;
+  r->resultDenomenator   = rd;
+  r->operator = (uint8_t) operator;
+  r->status = matched == 7 ? WIRE_STATUS_OK : WIRE_STATUS_PENDING;
+
+  return 1;
+}
+
+/*
+
+  Read records, little endian -> host
+
+*/
+
+static size_t readRecords(FILE *restrict stream, WireRecord *restrict records, const size_t count) {
+
+  size_t read = fread(records, sizeof (WireRecord), count, stream);
+
+#if __BYTE_ORDER != __LITTLE_ENDIAN
+  for (size_t i = 0; i < read; i++)
+    swapRecord(&records[i]);
+#endif
+
+  return read;
+}
+
+/*
+
+  Write records, host -> little endian
+
+*/
+
+static size_t writeRecords(FILE *restrict stream, const WireRecord *restrict records, const size_t count) {
+
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+  return fwrite(records, sizeof (WireRecord), count, stream);
+#else
+  WireRecord chunk[WIRE_WRITE_CHUNK];
+  size_t written = 0;
+
+  while (written < count) {
+
+    size_t n = count - written < WIRE_WRITE_CHUNK ? count - written : WIRE_WRITE_CHUNK;
+
+    memcpy(chunk, records + written, n * sizeof (WireRecord));
+
+    for (size_t i = 0; i < n; i++)
+      swapRecord(&chunk[i]);
+
+    size_t done = fwrite(chunk, sizeof (WireRecord), n, stream);
+    written += done;
+
+    if (done != n)
+      break;
+  }
+
+  return written;
+#endif
+}
+
+/*
+
+  Abstraction, same as in Software.c
+
+*/
+
+const static wireFormat WireFunctions = {
+  &evaluateRecord,
+  &fromEquation,
+  &toEquation,
+  &toText,
+  &fromText,
+  &readRecords,
+  &writeRecords
+};
+
+const wireFormat *restrict Wire = &WireFunctions;
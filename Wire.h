@@ -0,0 +1,197 @@
+/*
+
+  Wire
+
+  A compact, fixed width binary format for equations, so that
+  other programs can hand us fractions as integers instead of
+  turning them into text first just so we can parse them back.
+
+  Every equation is exactly one WireRecord (28 bytes), every field
+  is stored in little endian byte order:
+
+    offset  size  field
+    0       4     operand1Numerator
+    4       4     operand1Denomenator
+    8       4     operand2Numerator
+    12      4     operand2Denomenator
+    16      4     resultNumerator
+    20      4     resultDenomenator
+    24      1     operator  (OP_ADD, OP_SUB, ... as ASCII)
+    25      1     status    (WIRE_STATUS_*)
+    26      2     reserved  (always 0)
+
+  On input the result fields and status are ignored, on output they
+  hold the simplified result and whether the evaluation worked.
+
+*/
+
+#ifndef WIRE
+#define WIRE
+
+#include <stdio.h>
+#include <stdint.h>
+#include "Software.h"
+
+/*
+
+  Record status codes
+
+*/
+
+#define WIRE_STATUS_OK 0
+#define WIRE_STATUS_PENDING 1
+#define WIRE_STATUS_INVALID_OPERAND 2
+#define WIRE_STATUS_INVALID_OPERATOR 3
+#define WIRE_STATUS_DIVIDE_BY_ZERO 4
+#define WIRE_STATUS_OVERFLOW 5
+
+/*
+
+  Longest text form of a record, "a/b OP c/d = x/y" with
+  every integer at its widest, plus the null terminator.
+
+*/
+
+#define WIRE_MAX_TEXT 100
+
+/*
+
+  A single binary equation record
+
+  Type: WireRecord
+
+*/
+
+typedef struct {
+
+  int32_t operand1Numerator;
+  int32_t operand1Denomenator;
+
+  int32_t operand2Numerator;
+  int32_t operand2Denomenator;
+
+  int32_t resultNumerator;
+  int32_t resultDenomenator;
+
+  uint8_t operator;
+  uint8_t status;
+  uint8_t reserved[2];
+
+}
+WireRecord;
+
+_Static_assert(sizeof(WireRecord) == 28, "WireRecord must stay 28 bytes");
+
+typedef struct {
+
+  /*
+
+    int evaluate(WireRecord *r)
+
+    Evaluates the record in place with Operation(), filling in
+    the result fields and the status.
+
+    Returns 1 if the record was evaluated, else returns 0 and
+    the status tells why.
+
+    Access: Wire->evaluate()
+
+  */
+
+  int(*const evaluate)(WireRecord * restrict r);
+
+  /*
+
+    void fromEquation(WireRecord *r, Equation *e)
+
+    Copies an equation into a record.
+
+    Access: Wire->fromEquation()
+
+  */
+
+  void(*const fromEquation)(WireRecord * restrict r, Equation * restrict e);
+
+  /*
+
+    void toEquation(Equation *e, WireRecord *r)
+
+    Copies a record into an equation created by Equations->new().
+
+    Access: Wire->toEquation()
+
+  */
+
+  void(*const toEquation)(Equation * restrict e, const WireRecord * restrict r);
+
+  /*
+
+    int toText(WireRecord *r, char *text, size_t size)
+
+    Writes the record in the same format as Equations->getFormatted(),
+    "[F1N]/[F1D] [OP] [F2N]/[F2D] = [RN]/[RD]". Records that were not
+    evaluated successfully are written without the "= [RN]/[RD]" part.
+
+    Returns the length of the text.
+
+    Access: Wire->toText()
+
+  */
+
+  int(*const toText)(const WireRecord * restrict r, char * restrict text, const size_t size);
+
+  /*
+
+    int fromText(WireRecord *r, char *text)
+
+    Parses text produced by Equations->getFormatted() (or the
+    same text without the "= [RN]/[RD]" part) into a record.
+
+    Returns 1 on success, else 0.
+
+    Access: Wire->fromText()
+
+  */
+
+  int(*const fromText)(WireRecord * restrict r, const char * restrict text);
+
+  /*
+
+    size_t read(FILE *stream, WireRecord *records, size_t count)
+
+    Reads up to count records from the stream, converting them
+    to host byte order. Returns the number of records read.
+
+    Access: Wire->read()
+
+  */
+
+  size_t(*const read)(FILE * restrict stream, WireRecord * restrict records, const size_t count);
+
+  /*
+
+    size_t write(FILE *stream, WireRecord *records, size_t count)
+
+    Writes count records to the stream in little endian byte order.
+    Returns the number of records written.
+
+    Access: Wire->write()
+
+  */
+
+  size_t(*const write)(FILE * restrict stream, const WireRecord * restrict records, const size_t count);
+
+}
+wireFormat;
+
+/*
+
+  Call this, Wire, to access all
+  the publicly available functions.
+
+*/
+
+extern
+const wireFormat * restrict Wire;
+
+#endif //Wire.h
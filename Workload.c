@@ -0,0 +1,732 @@
+/*
+
+  Workload
+
+  Making the expressions of one block, and the threads that make
+  the blocks. See Workload.h.
+
+  The blocks are made a round at a time: every thread makes one
+  block of the round into a buffer of its own, then the buffers
+  are written out in block order. Thread t makes blocks t, t + n,
+  t + 2n, ... of n threads, so it starts from the stream jumped t
+  times and jumps n times after each block (same as Random.c).
+
+  Everything a line needs is drawn from its block's stream, in
+  the same order, so a block is the same whatever made it.
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Software.h"
+#include "IO.h"
+#include "Operations.h"
+#include "Random.h"
+#include "Wire.h"
+#include "Workload.h"
+
+/*
+
+  Error Messages
+
+*/
+
+#define DISPLAY_MALLOC_ERROR { fprintf(stderr, "FATAL ERROR: UNABLE TO ALLOCATE MEMORY IN HEAP"); exit(-1); }
+#define DISPLAY_OPTION_ERROR(why) fprintf(stderr, "Workload: %s\n", why);
+#define DISPLAY_WRITE_ERROR fprintf(stderr, "Workload: unable to write the output\n");
+
+/*
+
+  Most threads used
+
+*/
+
+#define WORKLOAD_MAX_THREADS 64
+
+/*
+
+  Lines just before that a duplicate can repeat
+
+*/
+
+#define WORKLOAD_RECENT 64
+
+/*
+
+  Most spaces a noisy separator gets
+
+*/
+
+#define WORKLOAD_MAX_SPACES 4
+
+/*
+
+  Longest text of one operator and the fraction after it,
+  " + (-2147483647/2147483647)" with noisy spaces
+
+*/
+
+#define WORKLOAD_OPERATOR_TEXT (2 * WORKLOAD_MAX_SPACES + 32)
+
+static const char operators[WORKLOAD_OPERATORS] = { OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_POW };
+
+/*
+
+  Lines that aren't expressions at all
+
+*/
+
+static const char *const nonsense[] = { "one half + 1/3", "1/2 plus 3/4", "=", "1//2 + 3/4", "(1/2 + 3/4", "" };
+
+#define WORKLOAD_NONSENSE ((uint32_t) (sizeof (nonsense) / sizeof (nonsense[0])))
+
+/*
+
+  The options, worked out into what drawing needs
+
+  Type: WorkloadPlan
+
+*/
+
+typedef struct {
+
+  const workloadOptions *options;
+
+  // Running totals of the weights, to pick an operator
+  uint32_t cumulative[WORKLOAD_OPERATORS];
+  uint32_t total;
+
+  // A share s of lines is drawn as 32 random bits under s * 2^32
+  uint64_t duplicateBelow;
+  uint64_t noiseBelow;
+  uint64_t invalidBelow;
+
+  // Digits of the largest number, and the powers of 10 up to it
+  int digits;
+  long long powers[11];
+
+  // Room one line can take
+  size_t lineSize;
+
+}
+WorkloadPlan;
+
+/*
+
+  One thread, and the block it makes
+
+  Type: WorkloadWorker
+
+*/
+
+typedef struct {
+
+  const WorkloadPlan *plan;
+
+  // Stream of the next block this worker makes
+  RandomState stream;
+
+  // Jumps between its blocks, the number of workers
+  int step;
+
+  // Lines of its block this round, 0 if none
+  long long count;
+
+  char *buffer;
+  size_t capacity;
+  size_t length;
+
+  // Where the latest lines start, and how long they are
+  size_t recentStart[WORKLOAD_RECENT];
+  size_t recentLength[WORKLOAD_RECENT];
+  int recentCount;
+
+}
+WorkloadWorker;
+
+/*
+
+  Drawing
+
+*/
+
+static inline uint32_t draw(RandomState *restrict r, uint32_t range) {
+  return randomBounded(r, (uint32_t) (randomNext(r) >> 32), range);
+}
+
+// Nothing is drawn for a share of 0
+static inline int chance(RandomState *restrict r, uint64_t below) {
+  return below && (randomNext(r) >> 32) < below;
+}
+
+static inline char operatorFrom(RandomState *restrict r, const WorkloadPlan *restrict p) {
+
+  uint32_t x = draw(r, p->total);
+  int o = 0;
+
+  while (x >= p->cumulative[o])
+    o++;
+
+  return operators[o];
+}
+
+/*
+
+  A numerator or denominator of 1 to largest
+
+*/
+
+static inline long long sizeFrom(RandomState *restrict r, const WorkloadPlan *restrict p) {
+
+  if (p->options->magnitude == WORKLOAD_UNIFORM)
+    return 1 + (long long) draw(r, (uint32_t) p->options->largest);
+
+  int digits = 1 + (int) draw(r, (uint32_t) p->digits);
+  long long low = p->powers[digits - 1];
+  long long high = digits == p->digits ? p->options->largest : p->powers[digits] - 1;
+
+  return low + (long long) draw(r, (uint32_t) (high - low + 1));
+}
+
+static inline void fractionFrom(RandomState *restrict r, const WorkloadPlan *restrict p, int *numerator, int *denominator) {
+
+  // Same spread as Random->fraction(), from one draw
+  if (p->options->magnitude == WORKLOAD_BOUNDED) {
+
+    uint64_t bits = randomNext(r);
+    uint32_t signedNumerator = randomBounded(r, (uint32_t) (bits >> 32), 2 * IO_MAX_NUMERATOR);
+
+    *numerator = (int) (signedNumerator >> 1);
+
+    if (signedNumerator & 1)
+      *numerator = -*numerator;
+
+    *denominator = 1 + (int) randomBounded(r, (uint32_t) bits, IO_MAX_DENOMINATOR - 1);
+
+    return;
+  }
+
+  *numerator = (int) sizeFrom(r, p);
+
+  if (randomNext(r) >> 63)
+    *numerator = -*numerator;
+
+  *denominator = (int) sizeFrom(r, p);
+}
+
+static inline int exponentFrom(RandomState *restrict r) {
+  return (int) draw(r, 2 * WORKLOAD_MAX_EXPONENT + 1) - WORKLOAD_MAX_EXPONENT;
+}
+
+/*
+
+  Text
+
+*/
+
+/*
+
+  Two digits at a time, "00" to "99"
+
+*/
+
+static const char pairs[201] =
+  "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+  "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+  "8081828384858687888990919293949596979899";
+
+static inline char *writeNumber(char *restrict at, long long value) {
+
+  if (value < 0) {
+    *at++ = '-';
+    value = -value;
+  }
+
+  int digits = 1;
+
+  for (long long rest = value; rest >= 10; rest /= 10)
+    digits++;
+
+  // From the last digit back
+  char *end = at + digits;
+
+  at = end;
+
+  while (value >= 100) {
+    at -= 2;
+    memcpy(at, pairs + 2 * (value % 100), 2);
+    value /= 100;
+  }
+
+  if (value >= 10)
+    memcpy(at - 2, pairs + 2 * value, 2);
+  else
+    at[-1] = (char) ('0' + value);
+
+  return end;
+}
+
+/*
+
+  One space, or with noise 0 or 2 to WORKLOAD_MAX_SPACES
+
+*/
+
+static inline char *writeSpace(char *restrict at, RandomState *restrict r, const WorkloadPlan *restrict p) {
+
+  if (!chance(r, p->noiseBelow)) {
+    *at = ' ';
+    return at + 1;
+  }
+
+  int spaces = (int) draw(r, WORKLOAD_MAX_SPACES);
+
+  spaces += spaces > 0;
+
+  memset(at, ' ', WORKLOAD_MAX_SPACES);
+
+  return at + spaces;
+}
+
+static inline char *writeFraction(char *restrict at, RandomState *restrict r, const WorkloadPlan *restrict p, int bracket) {
+
+  int numerator, denominator;
+
+  fractionFrom(r, p, &numerator, &denominator);
+
+  if (bracket)
+    *at++ = '(';
+
+  at = writeNumber(at, numerator);
+  *at++ = '/';
+  at = writeNumber(at, denominator);
+
+  if (bracket)
+    *at++ = ')';
+
+  return at;
+}
+
+/*
+
+  An expression of length operators. One operator is
+  written the way the one operator parser takes it,
+
+    1/2 + 3/4    1/2 ^ -3
+
+  more are written for Expression.h, with the fractions in
+  brackets and every ^ on the fraction before it:
+
+    (1/2) + (3/4)^-3 * (5/6)
+
+  A fraction gets one ^ at most, so another operator is drawn
+  when ^ comes up twice in a row.
+
+*/
+
+static char *writeExpression(char *restrict at, RandomState *restrict r, const WorkloadPlan *restrict p, int length) {
+
+  if (length == 1) {
+
+    char operator = operatorFrom(r, p);
+
+    at = writeFraction(at, r, p, 0);
+    at = writeSpace(at, r, p);
+    *at++ = operator;
+    at = writeSpace(at, r, p);
+
+    if (operator == OP_POW)
+      return writeNumber(at, exponentFrom(r));
+
+    return writeFraction(at, r, p, 0);
+  }
+
+  int powered = 0;
+
+  at = writeFraction(at, r, p, 1);
+
+  for (int i = 0; i < length; i++) {
+
+    char operator = operatorFrom(r, p);
+
+    while (operator == OP_POW && powered)
+      operator = operatorFrom(r, p);
+
+    if (operator == OP_POW) {
+      *at++ = OP_POW;
+      at = writeNumber(at, exponentFrom(r));
+      powered = 1;
+      continue;
+    }
+
+    at = writeSpace(at, r, p);
+    *at++ = operator;
+    at = writeSpace(at, r, p);
+    at = writeFraction(at, r, p, 1);
+
+    powered = 0;
+  }
+
+  return at;
+}
+
+/*
+
+  An invalid line, one of four kinds
+
+*/
+
+static char *writeInvalid(char *restrict at, RandomState *restrict r, const WorkloadPlan *restrict p, int length) {
+
+  int numerator, denominator;
+
+  switch (draw(r, 4)) {
+
+  // An operator with nothing after it
+  case 0:
+    at = writeExpression(at, r, p, length);
+    at = writeSpace(at, r, p);
+    *at++ = operatorFrom(r, p);
+    return at;
+
+  // An operator that doesn't exist
+  case 1:
+    at = writeFraction(at, r, p, length > 1);
+    at = writeSpace(at, r, p);
+    *at++ = '%';
+    at = writeSpace(at, r, p);
+    return writeFraction(at, r, p, length > 1);
+
+  // A zero denominator
+  case 2:
+    fractionFrom(r, p, &numerator, &denominator);
+    at = writeNumber(at, numerator);
+    *at++ = '/';
+    *at++ = '0';
+    at = writeSpace(at, r, p);
+    *at++ = OP_ADD;
+    at = writeSpace(at, r, p);
+    return writeFraction(at, r, p, 0);
+
+  // Not an expression at all
+  default: {
+    const char *text = nonsense[draw(r, WORKLOAD_NONSENSE)];
+    size_t size = strlen(text);
+    memcpy(at, text, size);
+    return at + size;
+  }
+
+  }
+}
+
+/*
+
+  Room for one more line in the worker's buffer
+
+*/
+
+static void makeRoom(WorkloadWorker *w, size_t size) {
+
+  if (w->capacity - w->length >= size)
+    return;
+
+  while (w->capacity - w->length < size)
+    w->capacity = w->capacity ? 2 * w->capacity : size;
+
+  w->buffer = realloc(w->buffer, w->capacity);
+
+  if (!w->buffer) DISPLAY_MALLOC_ERROR
+}
+
+/*
+
+  Remembers the line that was just written, for duplicates
+
+*/
+
+static inline void remember(WorkloadWorker *w, long long line, size_t start, size_t length) {
+
+  int slot = (int) (line % WORKLOAD_RECENT);
+
+  w->recentStart[slot] = start;
+  w->recentLength[slot] = length;
+
+  if (w->recentCount < WORKLOAD_RECENT)
+    w->recentCount++;
+}
+
+static void makeTextBlock(WorkloadWorker *w, RandomState *restrict r) {
+
+  const WorkloadPlan *p = w->plan;
+  const workloadOptions *o = p->options;
+
+  for (long long line = 0; line < w->count; line++) {
+
+    makeRoom(w, p->lineSize);
+
+    size_t start = w->length;
+    char *at = w->buffer + start;
+
+    if (w->recentCount && chance(r, p->duplicateBelow)) {
+
+      int slot = (int) draw(r, (uint32_t) w->recentCount);
+
+      memcpy(at, w->buffer + w->recentStart[slot], w->recentLength[slot]);
+      at += w->recentLength[slot];
+    }
+
+    else {
+
+      int length = o->shortest;
+
+      if (o->longest > o->shortest)
+        length += (int) draw(r, (uint32_t) (o->longest - o->shortest + 1));
+
+      if (chance(r, p->invalidBelow))
+        at = writeInvalid(at, r, p, length);
+      else
+        at = writeExpression(at, r, p, length);
+    }
+
+    remember(w, line, start, (size_t) (at - (w->buffer + start)));
+
+    *at++ = '\n';
+    w->length = (size_t) (at - w->buffer);
+  }
+}
+
+/*
+
+  Records, an invalid one has an operator that doesn't
+  exist or a zero denominator
+
+*/
+
+static void makeBinaryBlock(WorkloadWorker *w, RandomState *restrict r) {
+
+  const WorkloadPlan *p = w->plan;
+
+  makeRoom(w, (size_t) w->count * sizeof (WireRecord));
+
+  WireRecord *records = (WireRecord *) w->buffer;
+
+  for (long long i = 0; i < w->count; i++) {
+
+    WireRecord *record = &records[i];
+
+    if (i && chance(r, p->duplicateBelow)) {
+      *record = records[i - 1 - (long long) draw(r, (uint32_t) (i < WORKLOAD_RECENT ? i : WORKLOAD_RECENT))];
+      continue;
+    }
+
+    int n1, d1, n2, d2;
+    char operator = operatorFrom(r, p);
+
+    fractionFrom(r, p, &n1, &d1);
+
+    if (operator == OP_POW) {
+      n2 = exponentFrom(r);
+      d2 = 1;
+    }
+
+    else
+      fractionFrom(r, p, &n2, &d2);
+
+    if (chance(r, p->invalidBelow)) {
+
+      if (draw(r, 2))
+        operator = '%';
+      else
+        d1 = 0;
+    }
+
+    *record = (WireRecord) { n1, d1, n2, d2, 0, 0, (uint8_t) operator, WIRE_STATUS_PENDING, { 0, 0 } };
+  }
+
+  w->length = (size_t) w->count * sizeof (WireRecord);
+}
+
+static void *makeBlocks(void *argument) {
+
+  WorkloadWorker *w = argument;
+
+  w->length = 0;
+  w->recentCount = 0;
+
+  if (w->count > 0) {
+
+    // A local copy of the stream stays in registers
+    RandomState r = w->stream;
+
+    if (w->plan->options->binary)
+      makeBinaryBlock(w, &r);
+    else
+      makeTextBlock(w, &r);
+  }
+
+  // On to the stream of this worker's next block
+  for (int j = 0; j < w->step; j++)
+    Random->jump(&w->stream);
+
+  return NULL;
+}
+
+/*
+
+  Checks the options and works out the plan,
+  returns 0 (and prints why) if they don't make sense
+
+*/
+
+static int makePlan(const workloadOptions *o, WorkloadPlan *p) {
+
+  p->options = o;
+  p->total = 0;
+
+  for (int i = 0; i < WORKLOAD_OPERATORS; i++) {
+
+    if (o->weights[i] < 0) {
+      DISPLAY_OPTION_ERROR("operator weights can't be negative")
+      return 0;
+    }
+
+    p->total += (uint32_t) o->weights[i];
+    p->cumulative[i] = p->total;
+  }
+
+  if (!p->total) {
+    DISPLAY_OPTION_ERROR("at least one operator needs a weight")
+    return 0;
+  }
+
+  if (o->count < 0 || o->shortest < 1 || o->longest < o->shortest || o->longest > WORKLOAD_MAX_LENGTH) {
+    DISPLAY_OPTION_ERROR("the count or the length is out of range")
+    return 0;
+  }
+
+  if (o->longest > 1 && p->total == (uint32_t) o->weights[WORKLOAD_OPERATORS - 1]) {
+    DISPLAY_OPTION_ERROR("expressions longer than one operator need an operator other than ^")
+    return 0;
+  }
+
+  if (o->binary && o->longest > 1) {
+    DISPLAY_OPTION_ERROR("binary records have one operator")
+    return 0;
+  }
+
+  if (o->duplicates < 0 || o->duplicates > 1 || o->noise < 0 || o->noise > 1 || o->invalid < 0 || o->invalid > 1) {
+    DISPLAY_OPTION_ERROR("shares of lines have to be from 0 to 1")
+    return 0;
+  }
+
+  if (o->magnitude != WORKLOAD_BOUNDED && o->largest < 1) {
+    DISPLAY_OPTION_ERROR("the largest number has to be 1 or more")
+    return 0;
+  }
+
+  p->duplicateBelow = (uint64_t) (o->duplicates * 4294967296.0);
+  p->noiseBelow = (uint64_t) (o->noise * 4294967296.0);
+  p->invalidBelow = (uint64_t) (o->invalid * 4294967296.0);
+
+  p->powers[0] = 1;
+  p->digits = 1;
+
+  for (int i = 1; i < 11; i++)
+    p->powers[i] = 10 * p->powers[i - 1];
+
+  while (p->digits < 10 && p->powers[p->digits] <= o->largest)
+    p->digits++;
+
+  p->lineSize = (size_t) (o->longest + 1) * WORKLOAD_OPERATOR_TEXT + 64;
+
+  return 1;
+}
+
+static long long generate(const workloadOptions *restrict options, FILE *restrict out) {
+
+  WorkloadPlan plan;
+
+  if (!makePlan(options, &plan))
+    return -1;
+
+  long long blocks = (options->count + WORKLOAD_BLOCK - 1) / WORKLOAD_BLOCK;
+  long long threads = Software->Threads();
+
+  if (threads > blocks)
+    threads = blocks;
+
+  if (threads > WORKLOAD_MAX_THREADS)
+    threads = WORKLOAD_MAX_THREADS;
+
+  if (threads < 1)
+    threads = 1;
+
+  WorkloadWorker workers[WORKLOAD_MAX_THREADS];
+  RandomState stream;
+
+  Random->stream(&stream);
+
+  for (int t = 0; t < threads; t++) {
+    workers[t] = (WorkloadWorker) { .plan = &plan, .stream = stream, .step = (int) threads };
+    Random->jump(&stream);
+  }
+
+  long long written = 0;
+
+  for (long long round = 0; round * threads < blocks; round++) {
+
+    for (int t = 0; t < threads; t++) {
+
+      long long first = (round * threads + t) * WORKLOAD_BLOCK;
+
+      workers[t].count = first >= options->count ? 0 : options->count - first < WORKLOAD_BLOCK ? options->count - first : WORKLOAD_BLOCK;
+    }
+
+    // Worker 0 runs on this thread, the rest get their own
+    Software->RunWorkers(&makeBlocks, workers, sizeof *workers, (int) threads);
+
+    for (int t = 0; t < threads; t++) {
+
+      size_t length = workers[t].length;
+
+      if (!length)
+        continue;
+
+      if (options->binary ? Wire->write(out, (WireRecord *) workers[t].buffer, length / sizeof (WireRecord)) != length / sizeof (WireRecord)
+                          : fwrite(workers[t].buffer, 1, length, out) != length) {
+        DISPLAY_WRITE_ERROR
+        written = -1;
+        break;
+      }
+
+      written += (long long) length;
+    }
+
+    if (written < 0)
+      break;
+  }
+
+  for (int t = 0; t < threads; t++)
+    free(workers[t].buffer);
+
+  if (written >= 0 && fflush(out)) {
+    DISPLAY_WRITE_ERROR
+    written = -1;
+  }
+
+  return written;
+}
+
+/*
+
+  Abstraction, same as in Software.c
+
+*/
+
+const static workloadGenerator WorkloadFunctions = {
+  &generate
+};
+
+const workloadGenerator *restrict Workload = &WorkloadFunctions;
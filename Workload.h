@@ -0,0 +1,152 @@
+/*
+
+  Workload
+
+  Writes files of made up expressions to test and benchmark with,
+  as text, one expression per line (the input of --batch, the
+  daemon and --evaluate), or as binary WireRecords (the input of
+  --wire and --shm-client).
+
+  What goes in them is set by workloadOptions:
+
+    - how often each operator comes up
+    - how big the numbers are: inside the limits in IO.h (the only
+      ones the one operator text parser takes), anywhere up to a
+      largest value, or spread evenly over the number of digits
+    - how many lines repeat one of the lines just before them
+    - how many separators get more or fewer spaces than one
+    - how many lines are invalid (a missing operand, an unknown
+      operator, a zero denominator, or not an expression at all)
+    - how many operators each expression has, more than one is
+      written in the grammar of Expression.h, with every fraction
+      in brackets: (1/2) + (-3/4)^2 * (5/6)
+
+  The same options and seed always give the same file, however
+  many threads wrote it: lines are made in blocks of WORKLOAD_BLOCK,
+  and block b always draws from the seed's stream jumped b times
+  (see Random.h), on whichever thread.
+
+*/
+
+#ifndef WORKLOAD
+#define WORKLOAD
+
+#include <stdio.h>
+#include <stdint.h>
+
+/*
+
+  Operand sizes
+
+*/
+
+// Inside the limits in IO.h
+#define WORKLOAD_BOUNDED 0
+
+// Numerators and denominators evenly from 1 to largest
+#define WORKLOAD_UNIFORM 1
+
+// Number of digits evenly from 1 to that of largest
+#define WORKLOAD_DIGITS 2
+
+/*
+
+  Operators, in the order of Operations.h (+ - * / ^)
+
+*/
+
+#define WORKLOAD_OPERATORS 5
+
+/*
+
+  Lines per block, see the top of this file
+
+*/
+
+#define WORKLOAD_BLOCK 65536
+
+/*
+
+  Most operators in one expression
+
+*/
+
+#define WORKLOAD_MAX_LENGTH 1000
+
+/*
+
+  Exponents after ^ are from -WORKLOAD_MAX_EXPONENT
+  to WORKLOAD_MAX_EXPONENT
+
+*/
+
+#define WORKLOAD_MAX_EXPONENT 4
+
+/*
+
+  What to write
+
+  Type: workloadOptions
+
+*/
+
+typedef struct {
+
+  long long count;
+
+  // How often each operator comes up, relative to the others
+  int weights[WORKLOAD_OPERATORS];
+
+  // WORKLOAD_BOUNDED, WORKLOAD_UNIFORM or WORKLOAD_DIGITS
+  int magnitude;
+
+  // Largest numerator or denominator, unless WORKLOAD_BOUNDED
+  int largest;
+
+  // Shares of the lines, from 0 to 1
+  double duplicates;
+  double noise;
+  double invalid;
+
+  // Operators per expression, from shortest to longest
+  int shortest;
+  int longest;
+
+  // WireRecords instead of text, only for one operator
+  int binary;
+
+}
+workloadOptions;
+
+typedef struct {
+
+  /*
+
+    long long generate(workloadOptions *options, FILE *out)
+
+    Writes options->count expressions to out, using
+    one thread per CPU.
+
+    Returns the number of bytes written, or -1 if the options
+    don't make sense or out couldn't be written (and prints why).
+
+    Access: Workload->generate()
+
+  */
+
+  long long(*const generate)(const workloadOptions * restrict options, FILE * restrict out);
+
+}
+workloadGenerator;
+
+/*
+
+  Call this, Workload, to access all
+  the publicly available functions.
+
+*/
+
+extern
+const workloadGenerator * restrict Workload;
+
+#endif //Workload.h
@@ -17,6 +17,33 @@
       All those functions are abstracted away.
       The only visible function visible is getFunctionToRun()
 
+    - Modes.h
+      Non-interactive modes, picked by the first command line argument.
+
+    - Wire.h
+      Binary equation records, and converters to and from text.
+
+    - Daemon.h
+      Serves expressions over sockets, and the load test client.
+
+    - Batch.h
+      Evaluates files of expressions, with io_uring or plain read/write.
+
+    - SharedQueue.h
+      Shared memory rings for binary records, and their client library.
+
+    - Random.h
+      Seedable random number generator, and bulk random fractions.
+
+    - Stats.h
+      Counters and latency histograms, shown by option 15 or SIGUSR1.
+
+    - Trace.h
+      Chrome trace-event spans of the evaluation stages, FRACTIONS_TRACE.
+
+    - Snapshot.h
+      Forked background snapshots of the stores, loaded by FRACTIONS_SNAPSHOT.
+
     - DataBase.h
       Contains MultiDimensional Arrays that can be used to store data.
       Syntax Sugar: Just include this header file to access these arrays instead
@@ -34,11 +61,52 @@
 #include "IO.h"
 #include "Operations.h"
 #include "Software.h"
+#include "Modes.h"
+#include "Stats.h"
+#include "Trace.h"
+#include "Snapshot.h"
 
 
 // Entry Point of Program
-int main() {
+int main(int argc, char **argv) {
+
+  /*
+
+    kill -USR1 writes the stats to stderr, in any mode.
+    (See Stats.h)
+
+  */
+
+  Stats->listen();
+
+  /*
+
+    FRACTIONS_TRACE=file writes a trace of the run
+    to file at exit. (See Trace.h)
+
+  */
+
+  Trace->start();
+
+  /*
+
+    If a mode was asked for on the command line,
+    run it instead of the menu. (See Modes.h)
+
+  */
+
+  if (argc > 1)
+    return getModeToRun(argv[1])(argc - 1, argv + 1);
   
+  /*
+
+    FRACTIONS_SNAPSHOT=file loads a snapshot
+    into the stores. (See Snapshot.h)
+
+  */
+
+  Snapshot->restore();
+
   /*
   
     Showing the user menu.
@@ -80,6 +148,9 @@ int main() {
 
   while(Software->CanRun()) 
     getFunctionToRun(getResponse())();
+
+  // A snapshot being written is let finish
+  Snapshot->wait();
   
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,162 @@
+/*
+
+  GenerateTables
+
+  Writes Tables.h to stdout: the greatest common divisor of every
+  numerator and denominator the limits in IO.h allow, and for every
+  divisor that can come out of it a reciprocal to divide by with a
+  multiplication and a shift.
+
+  Run it again whenever the IO_* limits change, from the top folder:
+
+    gcc tools/GenerateTables.c -o generate-tables && ./generate-tables > Tables.h
+
+  Every table entry is checked here, for every value it can be
+  used with, so Tables.h is right by construction: each GCD
+  against the largest number that divides both (checkGCD()), and
+  each reciprocal against the plain division (findShift()).
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "../IO.h"
+
+/*
+
+  Largest sizes the tables cover, numerators by their size,
+  so -IO_MIN_NUMERATOR counts too
+
+*/
+
+#define NUMERATORS (-IO_MIN_NUMERATOR > IO_MAX_NUMERATOR ? -IO_MIN_NUMERATOR : IO_MAX_NUMERATOR)
+#define DENOMINATORS IO_MAX_DENOMINATOR
+
+#define LARGEST (NUMERATORS > DENOMINATORS ? NUMERATORS : DENOMINATORS)
+
+static unsigned int gcd(unsigned int a, unsigned int b) {
+
+  while (b) {
+    unsigned int t = a % b;
+    a = b;
+    b = t;
+  }
+
+  return a;
+}
+
+/*
+
+  Euclid's answer for every pair in the table, against trying
+  every divisor, gcd(n, 0) being n
+
+*/
+
+static void checkGCD() {
+
+  for (unsigned int n = 0; n <= NUMERATORS; n++)
+    for (unsigned int d = 0; d <= DENOMINATORS; d++) {
+
+      unsigned int largest = n > d ? n : d;
+
+      for (unsigned int k = 1; k <= (n < d ? n : d); k++)
+        if (n % k == 0 && d % k == 0)
+          largest = k;
+
+      if (gcd(n, d) != largest) {
+        fprintf(stderr, "gcd(%u, %u) is %u, not %u\n", n, d, largest, gcd(n, d));
+        exit(1);
+      }
+    }
+}
+
+/*
+
+  The smallest shift where ceil(2^shift / d) * x >> shift is x / d
+  for every d and x up to LARGEST, and the products fit in 32 bits
+
+*/
+
+static int findShift() {
+
+  for (int shift = 1; shift < 32; shift++) {
+
+    int exact = 1;
+
+    for (uint64_t d = 1; exact && d <= LARGEST; d++) {
+
+      uint64_t reciprocal = ((1ULL << shift) + d - 1) / d;
+
+      for (uint64_t x = 0; exact && x <= LARGEST; x++)
+        exact = x * reciprocal <= UINT32_MAX && (x * reciprocal) >> shift == x / d;
+    }
+
+    if (exact)
+      return shift;
+  }
+
+  fprintf(stderr, "No shift works for values up to %i\n", LARGEST);
+  exit(1);
+}
+
+int main() {
+
+  if (LARGEST > UINT8_MAX) {
+    fprintf(stderr, "Divisors up to %i don't fit in the unsigned char table\n", LARGEST);
+    return 1;
+  }
+
+  checkGCD();
+
+  int shift = findShift();
+
+  printf("/*\n\n");
+  printf("  Tables\n\n");
+  printf("  Generated by tools/GenerateTables.c from the limits in IO.h,\n");
+  printf("  don't edit it, run that again instead.\n\n");
+  printf("  TablesGCD[n][d] is the greatest common divisor of n and d, for\n");
+  printf("  every size of numerator and denominator IO.h allows, and\n");
+  printf("  x / d is (x * TablesReciprocal[d]) >> TABLES_RECIPROCAL_SHIFT\n");
+  printf("  for every x and d up to TABLES_LARGEST (32 bit products).\n\n");
+  printf("*/\n\n");
+
+  printf("#ifndef TABLES\n#define TABLES\n\n");
+  printf("#include <stdint.h>\n#include \"IO.h\"\n\n");
+
+  printf("#define TABLES_NUMERATORS %i\n", NUMERATORS);
+  printf("#define TABLES_DENOMINATORS %i\n", DENOMINATORS);
+  printf("#define TABLES_LARGEST %i\n", LARGEST);
+  printf("#define TABLES_RECIPROCAL_SHIFT %i\n\n", shift);
+
+  printf("#if TABLES_NUMERATORS != (-IO_MIN_NUMERATOR > IO_MAX_NUMERATOR ? -IO_MIN_NUMERATOR : IO_MAX_NUMERATOR) || TABLES_DENOMINATORS != IO_MAX_DENOMINATOR\n");
+  printf("#error \"Tables.h doesn't match the limits in IO.h, run tools/GenerateTables.c again\"\n");
+  printf("#endif\n\n");
+
+  printf("static const unsigned char TablesGCD[TABLES_NUMERATORS + 1][TABLES_DENOMINATORS + 1] = {\n");
+
+  for (int n = 0; n <= NUMERATORS; n++) {
+
+    printf("  {");
+
+    for (int d = 0; d <= DENOMINATORS; d++)
+      printf("%s%u", d ? "," : "", gcd((unsigned int) n, (unsigned int) d));
+
+    printf("}%s\n", n < NUMERATORS ? "," : "");
+  }
+
+  printf("};\n\n");
+
+  // 0 only comes out of 0/0, which has nothing to divide
+  printf("static const %s TablesReciprocal[TABLES_LARGEST + 1] = {\n  0", (1ULL << shift) <= UINT16_MAX ? "uint16_t" : "uint32_t");
+
+  for (uint64_t d = 1; d <= LARGEST; d++)
+    printf(",%s%llu", d % 12 ? "" : "\n  ", (unsigned long long) (((1ULL << shift) + d - 1) / d));
+
+  printf("\n};\n\n");
+
+  printf("#endif //Tables.h\n");
+
+  return 0;
+}